@@ -146,6 +146,10 @@ link_directories(${GSL_LIBRARY_DIRS})
 
 # -------------------------------
 
+find_package(Threads REQUIRED)
+
+# -------------------------------
+
 if(BUILD_TESTS)
   if(NOT BUILD_DEPENDENCIES)
     find_package(CATCH)
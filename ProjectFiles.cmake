@@ -2,6 +2,30 @@
 set(SRC
   "${SRC_PATH}/TleGen.cpp"
   "${SRC_PATH}/randomGen.cpp"
+  "${SRC_PATH}/tleCatalog.cpp"
+  "${SRC_PATH}/lambertDeltaV.cpp"
+  "${SRC_PATH}/atomTransfer.cpp"
+  "${SRC_PATH}/atomWorkspace.cpp"
+  "${SRC_PATH}/j2Propagator.cpp"
+  "${SRC_PATH}/twoTierScreening.cpp"
+  "${SRC_PATH}/tleFormat.cpp"
+  "${SRC_PATH}/meanElementConverter.cpp"
+  "${SRC_PATH}/ephemerisInterpolator.cpp"
+  "${SRC_PATH}/resultsStore.cpp"
+  "${SRC_PATH}/gridRegression.cpp"
+  "${SRC_PATH}/conjunctionScreening.cpp"
+  "${SRC_PATH}/epochPlanner.cpp"
+  "${SRC_PATH}/gridSearch.cpp"
+  "${SRC_PATH}/elementSampler.cpp"
+  "${SRC_PATH}/tiledEphemeris.cpp"
+  "${SRC_PATH}/atomBatch.cpp"
+  "${SRC_PATH}/autoTuner.cpp"
+  "${SRC_PATH}/catalogGenerator.cpp"
+  "${SRC_PATH}/tleFitter.cpp"
+  "${SRC_PATH}/fitCampaign.cpp"
+  "${SRC_PATH}/mixedPrecisionScreening.cpp"
+  "${SRC_PATH}/pairTraversal.cpp"
+  "${SRC_PATH}/reachabilityMap.cpp"
 )
 
 # Set project main file.
@@ -13,4 +37,34 @@ set(MAIN_SRC
 #set(TEST_SRC
 #  "${TEST_SRC_PATH}/testCppProject.cpp"
 #  "${TEST_SRC_PATH}/testFactorial.cpp"
-#)
\ No newline at end of file
+#)
+
+# Set golden-result regression source files.
+set(REGRESSION_SRC
+  "${TEST_SRC_PATH}/testGridRegression.cpp"
+)
+
+# Set dual-number Jacobian test source files.
+set(JACOBIAN_TEST_SRC
+  "${TEST_SRC_PATH}/testTleFitterJacobian.cpp"
+)
+
+# Set element sampler test source files.
+set(ELEMENT_SAMPLER_TEST_SRC
+  "${TEST_SRC_PATH}/testElementSampler.cpp"
+)
+
+# Set catalog generator test source files.
+set(CATALOG_GENERATOR_TEST_SRC
+  "${TEST_SRC_PATH}/testCatalogGenerator.cpp"
+)
+
+# Set fit campaign test source files.
+set(FIT_CAMPAIGN_TEST_SRC
+  "${TEST_SRC_PATH}/testFitCampaign.cpp"
+)
+
+# Set pair traversal test source files.
+set(PAIR_TRAVERSAL_TEST_SRC
+  "${TEST_SRC_PATH}/testPairTraversal.cpp"
+)
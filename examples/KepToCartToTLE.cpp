@@ -38,6 +38,7 @@
 #include "/media/abhishek/work/TU delft/INTERNSHIP at DINAMICA/work/github/pykep/src/core_functions/par2ic.h"
 
 #include "CppProject/KepToCartToTLE.hpp"
+#include "CppProject/meanElementConverter.hpp"
 
 
 namespace KepToCartToTLE{
@@ -131,8 +132,8 @@ namespace KepToCartToTLE{
 	    // cartesianState[ 4 ] = -5.5;
 	    // cartesianState[ 5 ] = 5.5;
 	    Tle convertedTle;
-	    Tle referenceTle = Tle(); // empty TLE for reference
-	    // std::cout << referenceTle << std::endl << std::endl;
+	    // the conversion epoch has to be representable in a TLE (two digit year) for the analytic reference TLE
+	    const DateTime conversionEpoch( 2016, 2, 1 );
 	    std::string SolverStatus;
 	    const Real absTol = 1.0e-10; // absolute tolerance
 	    const Real relTol = 1.0e-5; // relative tolerance
@@ -155,7 +156,14 @@ namespace KepToCartToTLE{
 	        cartesianState[ 3 ] = CartVel[ i ][ 0 ]/1000;
 	        cartesianState[ 4 ] = CartVel[ i ][ 1 ]/1000;
 	        cartesianState[ 5 ] = CartVel[ i ][ 2 ]/1000;
-	        convertedTle = atom::convertCartesianStateToTwoLineElements< Real, Vector6 >( cartesianState, DateTime( ), SolverStatus, 
+	        Tle referenceTle = Tle(); // empty TLE for reference, replaced by the analytic mean elements when the orbit is bound
+	        try
+	        {
+	            referenceTle = meanElementConverter::createReferenceTle( cartesianState, conversionEpoch );
+	        }
+	        catch( const std::exception& )
+	        { }
+	        convertedTle = atom::convertCartesianStateToTwoLineElements< Real, Vector6 >( cartesianState, conversionEpoch, SolverStatus, 
 	            IterationCount, referenceTle, kMU, kXKMPER, absTol, relTol, maxItr );
 	        findSuccess = SolverStatus.find("success");    
 	        if(findSuccess == std::string::npos)
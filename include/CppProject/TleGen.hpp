@@ -7,12 +7,15 @@
 #ifndef CPP_PROJECT_TLE_GEN_HPP
 #define CPP_PROJECT_TLE_GEN_HPP
 
+#include <string>
+#include <vector>
+
 namespace TleGen
 {
 
 //! Compute TLEs from a given or random orbital element set(s) with an intermediate step of conversion to Cartesian coordinates
 /*!
- *  
+ * The fit is started from an empty reference TLE at the default DateTime epoch.
  * @param  	int newLimit 					defines the total number of keplerian element sets for which TLE has to be generated
  * @param	Vector6randKepElem 	    		the vector containing the set of orbital elements
  * @param 	std::string& SolverStatus		contains the status of the non linear solver inside ATOM
@@ -20,8 +23,40 @@ namespace TleGen
  */
 typedef double Real;
 typedef std::vector< Real > Vector6;
+typedef std::vector < std::vector < Real > > Vector2D;
 
 void TleGen( Vector6 randKepElem, std::string& SolverStatus, int& IterationCount );
+
+//! Same as above, with a choice between the analytic reference TLE and an empty reference TLE
+/*!
+ * The analytic reference TLE needs an epoch that the TLE format can hold, so with it the state is
+ * converted at 2016-02-01 instead of the default DateTime epoch.
+ * @param	const bool useMeanElementGuess	true to start the fit from the analytic mean elements,
+ * 											false to pass an empty Tle() as reference (original behaviour)
+ */
+void TleGen( Vector6 randKepElem, std::string& SolverStatus, int& IterationCount, const bool useMeanElementGuess );
+
+//! Cartesian state [km, km/s] of a set of orbital elements (a [m], e, i, raan, w, EA [rad]).
+Vector6 computeCartesianState( const Vector6& randKepElem );
+
+//! Iteration counts and failures of the TLE fit with an empty and with an analytic reference TLE
+struct ReferenceTleComparison
+{
+	int numberOfSamples;
+	int emptyReferenceFailures;
+	int meanElementReferenceFailures;
+	Real emptyReferenceMeanIterations;			// averaged over successful conversions
+	Real meanElementReferenceMeanIterations;	// averaged over successful conversions
+	int emptyReferenceMaximumIterations;
+	int meanElementReferenceMaximumIterations;
+};
+
+//! Run the TLE fit twice for every element set, with both reference TLEs, and compare the outcome
+/*!
+ * @param	const Vector2D& randKepElem		sets of orbital elements (a [m], e, i, raan, w, EA [rad]), one per row
+ * @return	iteration and failure statistics of both strategies
+ */
+ReferenceTleComparison compareReferenceTles( const Vector2D& randKepElem );
 } // TleGen
 
-#endif // CPP_PROJECT_TLE_GEN_HPP
\ No newline at end of file
+#endif // CPP_PROJECT_TLE_GEN_HPP
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_ATOM_BATCH_HPP
+#define CPP_PROJECT_ATOM_BATCH_HPP
+
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/atomTransfer.hpp"
+
+namespace atomBatch
+{
+
+typedef double Real;
+
+//! One transfer problem of a batch: the states at both ends and the initial guess
+struct TransferProblem
+{
+	Real departurePosition[ 3 ];		// [km]
+	Real departureVelocity[ 3 ];		// [km/s], of the departure object
+	Real arrivalPosition[ 3 ];			// [km]
+	Real arrivalVelocity[ 3 ];			// [km/s], of the arrival object
+	DateTime departureEpoch;
+	Real timeOfFlight;					// [s]
+	Real departureVelocityGuess[ 3 ];	// [km/s], e.g. the Lambert solution
+	Tle referenceTle;					// reference TLE of the nested TLE fits, as atom::executeAtomSolver takes it
+};
+
+//! Solution of one transfer problem
+struct TransferSolution
+{
+	int status;							// GSL status: GSL_SUCCESS, GSL_EMAXITER, GSL_ENOPROG, GSL_ESING or the error of the residual
+	int numberOfIterations;				// transfer solver iterations
+	Real departureVelocity[ 3 ];		// [km/s], of the transfer orbit
+	Real arrivalVelocity[ 3 ];			// [km/s], of the transfer orbit
+};
+
+//! Work counters of a batched solve
+struct BatchStatistics
+{
+	long numberOfProblems;
+	long numberOfTransferRounds;		// lock-step iterations of the transfer solver
+	long numberOfRejectedSteps;			// transfer steps that increased the residual or failed to evaluate
+	long numberOfFitIterations;			// iterations of the nested TLE fits
+	long numberOfPropagations;			// SGP4 evaluations, of the nested fits and of the fitted TLEs
+	Real meanOccupancy;					// mean fraction of the transfer lanes that held a problem
+};
+
+//! ATOM solver that advances a batch of transfer problems in lock-step
+/*!
+ * Solves the transfer problem of atom::executeAtomSolver: the departure velocity whose fitted TLE,
+ * propagated with libsgp4, reaches the arrival position after the time of flight. Instead of one
+ * GSL solver per problem, up to batchSize problems occupy the lanes of one quasi-Newton solver:
+ * every round takes one step for all lanes, with the Jacobian of gsl_multiroot_fdjacobian on the
+ * first step of a lane and Broyden updates afterwards, like GSL's hybrid solvers. A step that
+ * increases the residual, or whose residual cannot be evaluated, is rejected: the lane goes back
+ * and recomputes the Jacobian if it was a Broyden update, and halves the step if the Jacobian is
+ * fresh. A lane whose problem converges or fails is refilled from the queue in the next round.
+ *
+ * The residuals are those of the library: the nested fits are solved by tleFitter::fitTwoLineElements
+ * with the settings of the transfer, written in the TLE format and propagated with libsgp4. All
+ * points a round needs are gathered into structure-of-arrays buffers that are allocated once, but
+ * each point is still fitted and propagated on its own; the batch saves the setup of a solver per
+ * problem, not propagation work.
+ *
+ * Convergence is tested on an accepted step as gsl_multiroot_test_delta does; a rejected step that
+ * passes the test ends the solve at the last accepted point. A solver is not thread-safe; use one
+ * per thread.
+ */
+class BatchTransferSolver
+{
+public:
+
+	//! Solver with room for batchSize transfer problems in flight.
+	explicit BatchTransferSolver( const int batchSize = 64 );
+
+	//! Solve every problem; solutions[ k ] belongs to problems[ k ].
+	void solve( const std::vector< TransferProblem >& problems,
+				const atomTransfer::AtomSolverSettings& settings,
+				std::vector< TransferSolution >& solutions );
+
+	//! Counters of the last call to solve.
+	const BatchStatistics& getStatistics( ) const
+	{
+		return statistics;
+	}
+
+private:
+
+	//! Lock-step state of the lanes, in structure-of-arrays layout
+	struct Lanes
+	{
+		int capacity;
+		std::vector< int > problem;				// problem in the lane, -1 if empty
+		std::vector< int > iterations;
+		std::vector< char > isResidualValid;	// false while the residual at x is to be evaluated
+		std::vector< char > isJacobianNeeded;	// true to evaluate a new Jacobian at x in the next round
+		std::vector< char > isJacobianFresh;	// false once the Jacobian has been updated by Broyden steps
+		std::vector< char > hasStep;
+		std::vector< int > backtracks;			// halvings of the current step
+		std::vector< int > firstPoint;			// first point of the lane in the evaluation of the round
+		std::vector< Real > x;					// [ unknown * capacity + lane ]
+		std::vector< Real > residual;
+		std::vector< Real > arrivalVelocity;	// of the transfer orbit at x
+		std::vector< Real > step;
+		std::vector< Real > jacobian;			// [ ( row * 3 + column ) * capacity + lane ]
+	};
+
+	//! Points whose residuals one round needs; values [ component * numberOfPoints + point ]
+	struct Evaluation
+	{
+		int numberOfPoints;
+		std::vector< int > pointProblem;
+		std::vector< Real > points;
+		std::vector< Real > values;
+		std::vector< Real > arrivalVelocities;
+		std::vector< int > status;
+	};
+
+	//! Residuals and arrival velocities of the evaluation points of a round.
+	void evaluatePoints( const atomTransfer::AtomSolverSettings& settings );
+
+	//! Store the solution of the problem in a lane and empty the lane.
+	void finishLane( const int lane, const int status );
+
+	int batchSize;
+	BatchStatistics statistics;
+	Lanes lanes;
+	Evaluation evaluation;
+	const std::vector< TransferProblem >* transferProblems;
+	std::vector< TransferSolution >* transferSolutions;
+};
+
+} // namespace atomBatch
+
+#endif // CPP_PROJECT_ATOM_BATCH_HPP
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_ATOM_TRANSFER_HPP
+#define CPP_PROJECT_ATOM_TRANSFER_HPP
+
+#include <ostream>
+#include <string>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+namespace atomWorkspace
+{
+class AtomSolverWorkspace;
+}
+
+namespace atomBatch
+{
+struct TransferProblem;
+struct TransferSolution;
+}
+
+namespace atomTransfer
+{
+
+typedef double Real;
+
+//! Result of a single grid point: one transfer between two catalog objects
+struct TransferResult
+{
+	int departureObjectId;
+	int arrivalObjectId;
+	DateTime departureEpoch;
+	Real timeOfFlight;			// [s]
+	Real atomDeltaV;			// [km/s]
+	Real lambertDeltaV;			// [km/s]
+	int numberOfIterations;		// iterations used by the ATOM solver
+	Real transferDepartureVelocity[ 3 ];	// [km/s], departure velocity of the ATOM transfer orbit
+};
+
+//! Convergence settings of the ATOM solver
+struct AtomSolverSettings
+{
+	Real absoluteTolerance;
+	Real relativeTolerance;
+	int maximumIterations;
+	bool useMeanElementReference;	// transfer solves: reference TLE of the analytic mean elements of the Lambert
+									// guess instead of the departure object
+};
+
+//! Settings used by the original grid search: absolute tolerance 1e-10, relative tolerance 1e-5, 100 iterations,
+//! the departure object as reference TLE.
+AtomSolverSettings getDefaultAtomSolverSettings( );
+
+//! Evaluate one transfer with SGP4 states, a Lambert initial guess and the ATOM solver
+/*!
+ * This is the full-fidelity grid point used by the grid search: the departure and arrival states
+ * are obtained from SGP4, the minimum delta-V Lambert solution provides the initial guess and ATOM
+ * computes the SGP4-consistent transfer.
+ * @param	const Tle& departureObject			TLE of the departure object, the ATOM reference TLE (see AtomSolverSettings)
+ * @param	const SGP4& sgp4Departure			SGP4 propagator of the departure object
+ * @param	const Tle& arrivalObject			TLE of the arrival object
+ * @param	const SGP4& sgp4Arrival				SGP4 propagator of the arrival object
+ * @param	const DateTime& departureEpoch		departure epoch of the transfer
+ * @param	const Real timeOfFlight				time of flight of the transfer [s]
+ * @param	TransferResult& result				returns the delta-V of the ATOM and Lambert solutions
+ * @param	std::string& solverStatusSummary	returns the status of the non linear solver inside ATOM
+ * @return	true if ATOM converged, false if it threw an exception
+ */
+bool evaluateTransfer( const Tle& departureObject,
+					   const SGP4& sgp4Departure,
+					   const Tle& arrivalObject,
+					   const SGP4& sgp4Arrival,
+					   const DateTime& departureEpoch,
+					   const Real timeOfFlight,
+					   TransferResult& result,
+					   std::string& solverStatusSummary );
+
+//! Evaluate one transfer with the given ATOM solver settings.
+bool evaluateTransfer( const Tle& departureObject,
+					   const SGP4& sgp4Departure,
+					   const Tle& arrivalObject,
+					   const SGP4& sgp4Arrival,
+					   const DateTime& departureEpoch,
+					   const Real timeOfFlight,
+					   const AtomSolverSettings& solverSettings,
+					   TransferResult& result,
+					   std::string& solverStatusSummary );
+
+//! Evaluate one transfer with a reusable solver workspace
+/*!
+ * Solves the same problem with the same reference TLE as the overloads above, with the transfer
+ * solver owned by the workspace (see atomWorkspace::AtomSolverWorkspace) instead of one set up and
+ * torn down per call; the results are those of the ATOM library solver.
+ * @param	atomWorkspace::AtomSolverWorkspace& workspace	solver workspace of the calling thread
+ */
+bool evaluateTransfer( const Tle& departureObject,
+					   const SGP4& sgp4Departure,
+					   const Tle& arrivalObject,
+					   const SGP4& sgp4Arrival,
+					   const DateTime& departureEpoch,
+					   const Real timeOfFlight,
+					   const AtomSolverSettings& solverSettings,
+					   atomWorkspace::AtomSolverWorkspace& workspace,
+					   TransferResult& result,
+					   std::string& solverStatusSummary );
+
+//! Re-solve a transfer with other solver settings, starting from the solution of an earlier solve
+/*!
+ * Refines a transfer that was solved with loose screening settings: the solver starts from
+ * screeningResult.transferDepartureVelocity instead of the Lambert guess and only needs the
+ * iterations that tighten the solution. The result is the transfer a solve from the Lambert guess
+ * with the same settings converges to, within the solver tolerances; its numberOfIterations counts
+ * the refinement iterations only.
+ * @param	const TransferResult& screeningResult	converged transfer to refine (cell and departure velocity)
+ * @param	const AtomSolverSettings& solverSettings	settings of the refinement solve
+ */
+bool refineTransfer( const Tle& departureObject,
+					 const SGP4& sgp4Departure,
+					 const Tle& arrivalObject,
+					 const SGP4& sgp4Arrival,
+					 const TransferResult& screeningResult,
+					 const AtomSolverSettings& solverSettings,
+					 TransferResult& result,
+					 std::string& solverStatusSummary );
+
+//! Refine a transfer with a reusable solver workspace instead of the ATOM library solver.
+bool refineTransfer( const Tle& departureObject,
+					 const SGP4& sgp4Departure,
+					 const Tle& arrivalObject,
+					 const SGP4& sgp4Arrival,
+					 const TransferResult& screeningResult,
+					 const AtomSolverSettings& solverSettings,
+					 atomWorkspace::AtomSolverWorkspace& workspace,
+					 TransferResult& result,
+					 std::string& solverStatusSummary );
+
+//! Set up one transfer for the batched solver (see atomBatch::BatchTransferSolver)
+/*!
+ * Computes the SGP4 states and the Lambert delta-V and guess as evaluateTransfer does and fills in the
+ * cell of the result; the problem takes the reference TLE that evaluateTransfer passes to the ATOM library.
+ * @param	TransferResult& result					returns the cell and the Lambert delta-V
+ * @param	atomBatch::TransferProblem& problem		returns the transfer problem to solve
+ */
+void prepareBatchTransfer( const Tle& departureObject,
+						   const SGP4& sgp4Departure,
+						   const Tle& arrivalObject,
+						   const SGP4& sgp4Arrival,
+						   const DateTime& departureEpoch,
+						   const Real timeOfFlight,
+						   const AtomSolverSettings& solverSettings,
+						   TransferResult& result,
+						   atomBatch::TransferProblem& problem );
+
+//! Complete the result of a transfer solved by the batched solver; returns true if it converged.
+bool completeBatchTransfer( const atomBatch::TransferProblem& problem,
+							const atomBatch::TransferSolution& solution,
+							TransferResult& result,
+							std::string& solverStatusSummary );
+
+//! Write the column header of the grid output file (layout of Atom_Solver_Grid3.csv).
+void writeTransferHeader( std::ostream& outputfile );
+
+//! Write a transfer result as one row of the grid output file.
+void writeTransferResult( std::ostream& outputfile, const TransferResult& result );
+
+} // namespace atomTransfer
+
+#endif // CPP_PROJECT_ATOM_TRANSFER_HPP
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_ATOM_WORKSPACE_HPP
+#define CPP_PROJECT_ATOM_WORKSPACE_HPP
+
+#include <vector>
+
+#include <gsl/gsl_multiroots.h>
+#include <gsl/gsl_vector.h>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/atomTransfer.hpp"
+
+namespace atomWorkspace
+{
+
+typedef double Real;
+typedef std::vector< Real > Vector3;
+typedef std::vector< Real > Vector6;
+
+//! Solver context for the ATOM transfer solve
+/*!
+ * atom::executeAtomSolver allocates a GSL multiroot solver and its guess vector on every call and
+ * writes a table of the solver state, one row per iteration, into its status summary. The workspace
+ * owns the hybrids solver and guess vector of the transfer problem, allocated once and reset with
+ * gsl_multiroot_fsolver_set on every call, and keeps no summary table. Everything else is done as in
+ * the library: the same solver type, initial guess, iteration loop and convergence test, and the same
+ * residual, the arrival position of atom::convertCartesianStateToTwoLineElements propagated with
+ * libsgp4 over the time of flight. The results are those of the library solver.
+ *
+ * The nested TLE fits run inside the ATOM library, which gives them no context to reuse; they still
+ * set up their own solver on every residual evaluation.
+ *
+ * A workspace is not thread-safe; create one per thread and reuse it for all the calls made on that
+ * thread.
+ */
+class AtomSolverWorkspace
+{
+public:
+
+	AtomSolverWorkspace( );
+
+	~AtomSolverWorkspace( );
+
+	//! Solve the ATOM transfer problem, as atom::executeAtomSolver does
+	/*!
+	 * @param	const Vector3& departurePosition		TEME departure position [km]
+	 * @param	const DateTime& departureEpoch			departure epoch
+	 * @param	const Vector3& arrivalPosition			TEME arrival position [km]
+	 * @param	const Real timeOfFlight					time of flight [s]
+	 * @param	const Vector3& departureVelocityGuess	initial guess of the departure velocity [km/s]
+	 * @param	const Tle& referenceTle					reference TLE of the nested TLE fits
+	 * @param	const AtomSolverSettings& settings		tolerances and iteration limit of the transfer and TLE solvers
+	 * @param	Vector6& transferVelocities				returns the departure and arrival velocity [km/s]
+	 * @param	int& numberOfIterations					returns the number of transfer solver iterations
+	 * @return	GSL status: GSL_SUCCESS, GSL_EMAXITER with the last iterate in transferVelocities, as the
+	 * 			library returns it, or the error that stopped the solver, where the library throws
+	 */
+	int solveTransfer( const Vector3& departurePosition,
+					   const DateTime& departureEpoch,
+					   const Vector3& arrivalPosition,
+					   const Real timeOfFlight,
+					   const Vector3& departureVelocityGuess,
+					   const Tle& referenceTle,
+					   const atomTransfer::AtomSolverSettings& settings,
+					   Vector6& transferVelocities,
+					   int& numberOfIterations );
+
+private:
+
+	AtomSolverWorkspace( const AtomSolverWorkspace& );
+
+	AtomSolverWorkspace& operator=( const AtomSolverWorkspace& );
+
+	static int computeTransferResiduals( const gsl_vector* independentVariables, void* parameters, gsl_vector* residuals );
+
+	//! Fit the TLE of a departure velocity with the ATOM library and propagate it to the arrival epoch.
+	int propagateTransfer( const gsl_vector* departureVelocity, Real arrivalPosition[ 3 ], Real arrivalVelocity[ 3 ] );
+
+	gsl_multiroot_fsolver* transferSolver;
+	gsl_vector* transferGuess;
+
+	// problem of the current call
+	Vector6 departureState;				// departure position and the departure velocity being evaluated
+	DateTime transferEpoch;
+	DateTime arrivalEpoch;
+	Real targetPosition[ 3 ];
+	Tle transferReferenceTle;
+	atomTransfer::AtomSolverSettings transferSettings;
+};
+
+} // namespace atomWorkspace
+
+#endif // CPP_PROJECT_ATOM_WORKSPACE_HPP
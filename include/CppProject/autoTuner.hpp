@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_AUTO_TUNER_HPP
+#define CPP_PROJECT_AUTO_TUNER_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "CppProject/gridSearch.hpp"
+
+namespace autoTuner
+{
+
+typedef double Real;
+
+//! Engine parameters that suit one machine, as found by a calibration run
+/*!
+ * Only the thread count of the grid search is tuned. Batch sizes, tile shapes and cache block sizes
+ * are not: none of them is a parameter of the grid search itself, and a value that only seeds one
+ * comparison mode is not worth storing per machine.
+ */
+struct MachineProfile
+{
+	std::string hostName;
+	int hardwareThreads;			// hardware threads of the machine the profile was tuned on
+	int numberOfThreads;			// threads of the grid search, 0 for one per hardware thread
+	Real cellsPerSecond;			// calibration throughput of the grid slice, 0 if not measured
+};
+
+//! Untuned parameters of the current machine: all hardware threads.
+MachineProfile getDefaultMachineProfile( );
+
+//! Default location of the machine profile, next to the grid output files.
+std::string getMachineProfilePath( );
+
+//! Write a machine profile as a "key = value" text file.
+void writeMachineProfile( const std::string& path, const MachineProfile& profile );
+
+//! Read a machine profile written by writeMachineProfile
+/*!
+ * Keys that are missing keep the values of getDefaultMachineProfile.
+ * @throws std::runtime_error if the file cannot be read or is not a machine profile
+ */
+MachineProfile readMachineProfile( const std::string& path );
+
+//! Load the profile at path if it was tuned on this machine (same host name and hardware threads).
+/*!
+ * @param	MachineProfile& profile		returns the stored profile, or the default profile if none applies
+ * @return	true if a stored profile was loaded
+ */
+bool loadMachineProfile( const std::string& path, MachineProfile& profile );
+
+//! Set the thread count of a profile on a grid search specification
+/*!
+ * The count is calibrated on the grid catalog, whose search has one work item per departure object;
+ * it only suits grid searches of that catalog. Other work keeps its own thread count.
+ */
+void applyMachineProfile( const MachineProfile& profile, gridSearch::GridSearchSpec& spec );
+
+//! Calibration workload and the candidate thread counts
+struct TuningSettings
+{
+	int numberOfEpochSteps;					// departure epochs of the calibration grid slice
+	int numberOfTimeOfFlightSteps;			// times of flight of the calibration grid slice
+	int numberOfRepeats;					// runs per candidate, the fastest counts
+	std::vector< int > threadCounts;		// empty for 1, 2, 4, ... up to the hardware threads
+};
+
+//! Calibration of well under a minute on a small machine: 5 epochs x 50 times of flight.
+TuningSettings getDefaultTuningSettings( );
+
+//! Find the grid thread count with the highest throughput on this machine
+/*!
+ * Every candidate thread count is timed numberOfRepeats times on a slice of the grid of spec (its
+ * catalog with the epochs and times of flight of the settings), and the fastest run counts.
+ * @param	gridSearch::GridSearchEngine& engine		engine whose catalog cache is used
+ * @param	const gridSearch::GridSearchSpec& spec		grid whose slice is calibrated
+ * @param	const TuningSettings& settings				calibration workload and candidates
+ * @param	std::ostream& log							receives one line per timed candidate
+ * @return	the tuned profile of this machine
+ */
+MachineProfile tuneMachineProfile( gridSearch::GridSearchEngine& engine,
+								   const gridSearch::GridSearchSpec& spec,
+								   const TuningSettings& settings,
+								   std::ostream& log );
+
+} // namespace autoTuner
+
+#endif // CPP_PROJECT_AUTO_TUNER_HPP
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_CATALOG_GENERATOR_HPP
+#define CPP_PROJECT_CATALOG_GENERATOR_HPP
+
+#include <string>
+
+#include <libsgp4/DateTime.h>
+
+#include "CppProject/atomTransfer.hpp"
+#include "CppProject/elementSampler.hpp"
+
+namespace catalogGenerator
+{
+
+typedef double Real;
+
+//! Orbit population of a synthetic catalog
+enum Population
+{
+	leoPopulation,		// 200 - 2000 km altitude, e < 0.05, i < 110 deg
+	meoPopulation		// navigation satellite belt: 18000 - 24000 km altitude, e < 0.03, 50 < i < 70 deg
+};
+
+//! Name of a population as used on the command line: "leo" or "meo".
+const char* getPopulationName( const Population population );
+
+//! Population with a given name; throws std::runtime_error for an unknown name.
+Population findPopulation( const std::string& name );
+
+//! Settings of a synthetic catalog
+struct CatalogSettings
+{
+	std::string name;									// object names are "<name> <NORAD number>"
+	elementSampler::ElementRanges ranges;				// [m, -, rad, rad, rad, rad]
+	elementSampler::SamplerSettings sampler;			// design, seed and perigee band of the elements
+	DateTime epoch;										// epoch of every TLE
+	Real bStar;											// drag term of every TLE [1/earth radii]
+	unsigned int firstNoradNumber;						// NORAD number of the first sample
+	atomTransfer::AtomSolverSettings fitSettings;		// settings of the Cartesian-to-TLE fits
+	int objectsPerBlock;								// objects fitted and formatted per write
+	int numberOfThreads;								// 0 for one thread per hardware thread
+};
+
+//! Default settings of a population
+/*!
+ * Scrambled Sobol elements with seed 1 and the perigee at least 200 km above the surface, TLEs at
+ * 2016-02-01 with B* = 1e-4, NORAD numbers from 1, the default ATOM settings, 4096 objects per
+ * block and one thread per hardware thread.
+ */
+CatalogSettings getDefaultCatalogSettings( const Population population );
+
+//! Counts and run time of a catalog generation
+struct CatalogSummary
+{
+	int numberOfSamples;			// sampled element sets
+	int numberOfObjects;			// TLEs written
+	int numberOfFailedFits;			// element sets whose TLE fit did not converge, left out of the catalog
+	Real meanIterations;			// mean fit iterations of the written TLEs
+	long numberOfBytes;
+	Real seconds;
+};
+
+//! Write a synthetic 3-line TLE catalog
+/*!
+ * The Keplerian elements are sampled with elementSampler::sampleKeplerianElements and converted to
+ * Cartesian states, and a TLE is fitted to every state at the catalog epoch with
+ * atom::convertCartesianStateToTwoLineElements, starting from the analytic mean elements. The
+ * objects are processed in blocks: the threads fit the objects of a block and format their name
+ * line and element lines, with checksums, into one text buffer per thread, and the buffers are
+ * appended to the file in order. The file is thus the same for any number of threads, and can be
+ * read with tleCatalog::readTleCatalog and used as the catalog of a grid search.
+ *
+ * Sample k gets NORAD number firstNoradNumber + k; samples whose fit fails are left out, so the
+ * numbers of the written objects can have gaps.
+ * @param	const std::string& path				path of the catalog file, overwritten
+ * @param	const int numberOfSamples			number of element sets to sample
+ * @param	const CatalogSettings& settings		population and generation settings
+ * @return	counts and run time of the generation
+ * @throws	std::runtime_error if the NORAD numbers exceed five digits or the file cannot be written
+ */
+CatalogSummary generateCatalog( const std::string& path, const int numberOfSamples, const CatalogSettings& settings );
+
+} // namespace catalogGenerator
+
+#endif // CPP_PROJECT_CATALOG_GENERATOR_HPP
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_CONJUNCTION_SCREENING_HPP
+#define CPP_PROJECT_CONJUNCTION_SCREENING_HPP
+
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Tle.h>
+
+namespace conjunctionScreening
+{
+
+typedef double Real;
+
+//! Settings of a conjunction screening run
+struct ScreeningSettings
+{
+	Real missDistanceThreshold;		// [km], pairs closer than this are reported
+	Real timeStep;					// [s], sampling step of the spatial hashing stage
+	Real apsisPadding;				// [km], margin on mean-element perigee/apogee for short-period terms and drag
+	int numberOfThreads;			// 0 for one thread per hardware thread
+};
+
+//! Default settings: 5 km threshold, 10 s step, 25 km apsis padding, all hardware threads.
+ScreeningSettings getDefaultSettings( );
+
+//! A close approach between two catalog objects
+struct Conjunction
+{
+	int firstObjectId;				// NORAD number, lower catalog index of the pair
+	int secondObjectId;
+	DateTime timeOfClosestApproach;
+	Real missDistance;				// [km]
+	Real relativeSpeed;				// [km/s]
+};
+
+//! Work done by each stage of a screening run
+struct ScreeningStatistics
+{
+	int numberOfObjects;
+	int numberOfScreenedObjects;	// objects left after the apogee/perigee filter
+	int numberOfSteps;
+	long numberOfDistanceChecks;	// pairs tested in the spatial hashing stage, over all steps
+	long numberOfEncounters;		// pairs refined in the last stage
+	Real screeningDistance;			// [km], distance used by the spatial hashing stage
+};
+
+//! Screen a catalog for conjunctions over a window
+/*!
+ * Three stages:
+ *  1. apogee/perigee filter: objects whose radius band (from the mean elements, widened by the
+ *     padding and threshold) overlaps no other band are dropped, and pairs with disjoint bands are
+ *     never tested;
+ *  2. spatial hashing: at every time step the SGP4 positions are sorted on a grid of cubic cells
+ *     and only objects in the same or neighbouring cells are tested, which costs O(N log N) per
+ *     step. The cell size is the threshold plus half the largest relative speed times the step, so
+ *     a closest approach between two steps is always caught at one of them. Time steps are spread
+ *     over the threads;
+ *  3. refinement: consecutive steps of a pair within the screening distance form an encounter,
+ *     split where the range rate turns from receding to approaching, so each closest approach gets
+ *     its own encounter. For each encounter the time of closest approach is found by bisection on
+ *     the range rate with SGP4, and pairs under the threshold are reported.
+ * Objects are skipped at the steps where SGP4 fails for them (e.g. after decay).
+ * @param	const std::vector< Tle >& catalog			objects to screen
+ * @param	const DateTime& windowStart					start of the screening window
+ * @param	const Real windowMinutes					length of the screening window [min]
+ * @param	const ScreeningSettings& settings			threshold, step and threads
+ * @param	ScreeningStatistics& statistics				returns the work done by each stage
+ * @return	conjunctions sorted by ascending miss distance
+ * @throws	std::runtime_error if the time step is not positive
+ */
+std::vector< Conjunction > screenConjunctions( const std::vector< Tle >& catalog,
+											   const DateTime& windowStart,
+											   const Real windowMinutes,
+											   const ScreeningSettings& settings,
+											   ScreeningStatistics& statistics );
+
+} // namespace conjunctionScreening
+
+#endif // CPP_PROJECT_CONJUNCTION_SCREENING_HPP
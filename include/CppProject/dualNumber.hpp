@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_DUAL_NUMBER_HPP
+#define CPP_PROJECT_DUAL_NUMBER_HPP
+
+#include <cmath>
+
+namespace dualNumber
+{
+
+typedef double Real;
+
+//! Number that carries its gradient with respect to N independent variables (forward-mode differentiation)
+/*!
+ * Evaluating a function templated on its scalar type, such as sgp4Kernel::Propagator, with Dual
+ * arguments returns the value of the function together with its exact partial derivatives, in one
+ * pass. Comparisons only look at the value, so branches are taken as for the plain evaluation.
+ */
+template< int N >
+struct Dual
+{
+	Real value;
+	Real gradient[ N ];
+
+	Dual( )
+		: value( 0.0 )
+	{
+		for( int k = 0; k < N; k++ )
+		{
+			gradient[ k ] = 0.0;
+		}
+	}
+
+	//! Constant: a value without dependence on the variables.
+	Dual( const Real constant )
+		: value( constant )
+	{
+		for( int k = 0; k < N; k++ )
+		{
+			gradient[ k ] = 0.0;
+		}
+	}
+
+	//! Independent variable number index with a given value.
+	static Dual variable( const Real value, const int index )
+	{
+		Dual result( value );
+		result.gradient[ index ] = 1.0;
+		return result;
+	}
+
+	Dual& operator+=( const Dual& other )
+	{
+		value += other.value;
+		for( int k = 0; k < N; k++ )
+		{
+			gradient[ k ] += other.gradient[ k ];
+		}
+		return *this;
+	}
+
+	Dual& operator-=( const Dual& other )
+	{
+		value -= other.value;
+		for( int k = 0; k < N; k++ )
+		{
+			gradient[ k ] -= other.gradient[ k ];
+		}
+		return *this;
+	}
+
+	Dual& operator*=( const Dual& other )
+	{
+		for( int k = 0; k < N; k++ )
+		{
+			gradient[ k ] = gradient[ k ] * other.value + value * other.gradient[ k ];
+		}
+		value *= other.value;
+		return *this;
+	}
+
+	Dual& operator/=( const Dual& other )
+	{
+		const Real inverse = 1.0 / other.value;
+		value *= inverse;
+		for( int k = 0; k < N; k++ )
+		{
+			gradient[ k ] = ( gradient[ k ] - value * other.gradient[ k ] ) * inverse;
+		}
+		return *this;
+	}
+};
+
+//! Dual with the value f( x ) and the gradient f'( x ) times that of x.
+template< int N >
+inline Dual< N > applyChainRule( const Dual< N >& x, const Real value, const Real derivative )
+{
+	Dual< N > result( value );
+	for( int k = 0; k < N; k++ )
+	{
+		result.gradient[ k ] = derivative * x.gradient[ k ];
+	}
+	return result;
+}
+
+template< int N >
+inline Dual< N > operator-( const Dual< N >& x )
+{
+	return applyChainRule( x, -x.value, -1.0 );
+}
+
+template< int N >
+inline Dual< N > operator+( Dual< N > x, const Dual< N >& y )
+{
+	return x += y;
+}
+
+template< int N >
+inline Dual< N > operator+( Dual< N > x, const Real y )
+{
+	x.value += y;
+	return x;
+}
+
+template< int N >
+inline Dual< N > operator+( const Real x, Dual< N > y )
+{
+	y.value += x;
+	return y;
+}
+
+template< int N >
+inline Dual< N > operator-( Dual< N > x, const Dual< N >& y )
+{
+	return x -= y;
+}
+
+template< int N >
+inline Dual< N > operator-( Dual< N > x, const Real y )
+{
+	x.value -= y;
+	return x;
+}
+
+template< int N >
+inline Dual< N > operator-( const Real x, const Dual< N >& y )
+{
+	return applyChainRule( y, x - y.value, -1.0 );
+}
+
+template< int N >
+inline Dual< N > operator*( Dual< N > x, const Dual< N >& y )
+{
+	return x *= y;
+}
+
+template< int N >
+inline Dual< N > operator*( const Dual< N >& x, const Real y )
+{
+	return applyChainRule( x, x.value * y, y );
+}
+
+template< int N >
+inline Dual< N > operator*( const Real x, const Dual< N >& y )
+{
+	return applyChainRule( y, x * y.value, x );
+}
+
+template< int N >
+inline Dual< N > operator/( Dual< N > x, const Dual< N >& y )
+{
+	return x /= y;
+}
+
+template< int N >
+inline Dual< N > operator/( const Dual< N >& x, const Real y )
+{
+	return applyChainRule( x, x.value / y, 1.0 / y );
+}
+
+template< int N >
+inline Dual< N > operator/( const Real x, const Dual< N >& y )
+{
+	const Real value = x / y.value;
+	return applyChainRule( y, value, -value / y.value );
+}
+
+template< int N >
+inline bool operator<( const Dual< N >& x, const Dual< N >& y )
+{
+	return x.value < y.value;
+}
+
+template< int N >
+inline bool operator<( const Dual< N >& x, const Real y )
+{
+	return x.value < y;
+}
+
+template< int N >
+inline bool operator<( const Real x, const Dual< N >& y )
+{
+	return x < y.value;
+}
+
+template< int N >
+inline bool operator<=( const Dual< N >& x, const Dual< N >& y )
+{
+	return x.value <= y.value;
+}
+
+template< int N >
+inline bool operator<=( const Dual< N >& x, const Real y )
+{
+	return x.value <= y;
+}
+
+template< int N >
+inline bool operator<=( const Real x, const Dual< N >& y )
+{
+	return x <= y.value;
+}
+
+template< int N >
+inline bool operator>( const Dual< N >& x, const Dual< N >& y )
+{
+	return x.value > y.value;
+}
+
+template< int N >
+inline bool operator>( const Dual< N >& x, const Real y )
+{
+	return x.value > y;
+}
+
+template< int N >
+inline bool operator>( const Real x, const Dual< N >& y )
+{
+	return x > y.value;
+}
+
+template< int N >
+inline bool operator>=( const Dual< N >& x, const Dual< N >& y )
+{
+	return x.value >= y.value;
+}
+
+template< int N >
+inline bool operator>=( const Dual< N >& x, const Real y )
+{
+	return x.value >= y;
+}
+
+template< int N >
+inline bool operator>=( const Real x, const Dual< N >& y )
+{
+	return x >= y.value;
+}
+
+template< int N >
+inline Dual< N > sin( const Dual< N >& x )
+{
+	return applyChainRule( x, std::sin( x.value ), std::cos( x.value ) );
+}
+
+template< int N >
+inline Dual< N > cos( const Dual< N >& x )
+{
+	return applyChainRule( x, std::cos( x.value ), -std::sin( x.value ) );
+}
+
+template< int N >
+inline Dual< N > sqrt( const Dual< N >& x )
+{
+	const Real value = std::sqrt( x.value );
+	return applyChainRule( x, value, 0.5 / value );
+}
+
+template< int N >
+inline Dual< N > pow( const Dual< N >& x, const Real exponent )
+{
+	const Real value = std::pow( x.value, exponent );
+	return applyChainRule( x, value, exponent * std::pow( x.value, exponent - 1.0 ) );
+}
+
+template< int N >
+inline Dual< N > fabs( const Dual< N >& x )
+{
+	return x.value < 0.0 ? -x : x;
+}
+
+//! Remainder of x / y for a constant y; the derivative is that of x.
+template< int N >
+inline Dual< N > fmod( const Dual< N >& x, const Real y )
+{
+	return applyChainRule( x, std::fmod( x.value, y ), 1.0 );
+}
+
+template< int N >
+inline Dual< N > atan2( const Dual< N >& y, const Dual< N >& x )
+{
+	const Real inverse = 1.0 / ( x.value * x.value + y.value * y.value );
+	Dual< N > result( std::atan2( y.value, x.value ) );
+	for( int k = 0; k < N; k++ )
+	{
+		result.gradient[ k ] = ( x.value * y.gradient[ k ] - y.value * x.gradient[ k ] ) * inverse;
+	}
+	return result;
+}
+
+} // namespace dualNumber
+
+#endif // CPP_PROJECT_DUAL_NUMBER_HPP
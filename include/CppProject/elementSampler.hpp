@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_ELEMENT_SAMPLER_HPP
+#define CPP_PROJECT_ELEMENT_SAMPLER_HPP
+
+#include <string>
+#include <vector>
+
+namespace elementSampler
+{
+
+typedef double Real;
+typedef std::vector< Real > Vector2;
+typedef std::vector< std::vector< Real > > Vector2D;
+
+//! Number of sampled elements: a, e, i, raan, w, E
+const int numberOfElements = 6;
+
+//! Design used to place the samples in the element space
+enum SamplingDesign
+{
+	uniformDesign,			// independent mt19937 draws per element, as randomGen::randomGenWithSeed
+	sobolDesign,			// Sobol sequence with a random linear scramble and digital shift
+	latinHypercubeDesign	// one sample per stratum of every element, strata paired at random
+};
+
+//! Min and max value of every element, as the ranges of randomKepElem::randomKepElem
+struct ElementRanges
+{
+	Vector2 semiMajorAxis;
+	Vector2 eccentricity;
+	Vector2 inclination;
+	Vector2 rightAscendingNode;
+	Vector2 argumentPerigee;
+	Vector2 eccentricAnomaly;
+};
+
+//! Settings of the sampler
+/*!
+ * The perigee band is given in the unit of the semi-major axis; a bound of 0 leaves that side open.
+ */
+struct SamplerSettings
+{
+	SamplingDesign design;
+	int seed;
+	Real minimumPerigeeRadius;
+	Real maximumPerigeeRadius;
+	int numberOfThreads;			// 0 for one thread per hardware thread
+};
+
+//! Default settings: scrambled Sobol design, seed 1, no perigee band, one thread per hardware thread.
+SamplerSettings getDefaultSettings( );
+
+//! Name of a design as used on the command line: "uniform", "sobol" or "lhs".
+const char* getDesignName( const SamplingDesign design );
+
+//! Design with a given name; throws std::runtime_error for an unknown name.
+SamplingDesign findDesign( const std::string& name );
+
+//! Points of a design in the unit hypercube [0, 1)^6
+/*!
+ * The points only depend on the design, the number of samples and the seed, not on the number of
+ * threads. The uniform design reproduces randomGen::randomGenWithSeed over [0, 1) with the seeds
+ * seed, seed + 1, ..., seed + 5 for the six elements.
+ * @param	const SamplingDesign design		design of the points
+ * @param	const int numberOfSamples		number of points
+ * @param	const int seed					seed of the draws, scramble or stratum pairing
+ * @param	const int numberOfThreads		number of threads, 0 for one per hardware thread
+ * @return	numberOfSamples rows of six coordinates
+ */
+Vector2D generateUnitSamples( const SamplingDesign design,
+							  const int numberOfSamples,
+							  const int seed,
+							  const int numberOfThreads );
+
+//! Map points of the unit hypercube onto the element ranges
+/*!
+ * Without a perigee band every coordinate is scaled onto its range. With a band, the eccentricity
+ * range is first narrowed to the values for which some semi-major axis in its range has its perigee
+ * in the band, and the semi-major axis is then scaled onto the part of its range that puts the
+ * perigee in the band for the sampled eccentricity. Every sample thus lies in the band and the
+ * stratification of the design is kept, at the cost of a density that is uniform in the
+ * semi-major axis for a given eccentricity rather than over the constrained region.
+ * Throws std::runtime_error if no orbit in the ranges has its perigee in the band.
+ * @return	rows of a, e, i, raan, w, E, in the layout of randomKepElem::randomKepElem
+ */
+Vector2D mapUnitSamples( const Vector2D& unitSamples, const ElementRanges& ranges, const SamplerSettings& settings );
+
+//! Sample Keplerian elements: generateUnitSamples followed by mapUnitSamples.
+Vector2D sampleKeplerianElements( const ElementRanges& ranges, const int numberOfSamples, const SamplerSettings& settings );
+
+//! Centered L2 discrepancy of points in the unit hypercube (Hickernell); lower is more even.
+Real computeCenteredDiscrepancy( const Vector2D& unitSamples, const int numberOfThreads );
+
+//! Convergence of a design at one sample size, averaged over replicates with different seeds
+struct ConvergencePoint
+{
+	SamplingDesign design;
+	int numberOfSamples;
+	Real meanDiscrepancy;
+	Real rmsMeanPerigeeError;		// RMS error of the estimated mean perigee radius, in the unit of the semi-major axis
+};
+
+//! Compare the convergence of the three designs
+/*!
+ * For every design and sample size the centered discrepancy and the error of the sample mean of the
+ * perigee radius a ( 1 - e ) are computed for a number of replicates; the exact mean over the
+ * unconstrained ranges is E[a] ( 1 - E[e] ). Replicate r uses seed 1 + 6 r, so the uniform draws of
+ * different replicates share no seed.
+ */
+std::vector< ConvergencePoint > compareConvergence( const ElementRanges& ranges,
+													const std::vector< int >& sampleSizes,
+													const int numberOfReplicates,
+													const int numberOfThreads );
+
+} // namespace elementSampler
+
+#endif // CPP_PROJECT_ELEMENT_SAMPLER_HPP
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_EPHEMERIS_INTERPOLATOR_HPP
+#define CPP_PROJECT_EPHEMERIS_INTERPOLATOR_HPP
+
+#include <string>
+#include <vector>
+
+#include <boost/array.hpp>
+#include <boost/cstdint.hpp>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Tle.h>
+
+namespace ephemerisInterpolator
+{
+
+typedef double Real;
+typedef boost::array< Real, 3 > array3;
+
+//! One Chebyshev segment of an object trajectory
+/*!
+ * The coefficients are stored per position component, i.e. x coefficients first, then y and z,
+ * each of length degree + 1. Position in km, time in minutes since the start of the window.
+ */
+struct ChebyshevSegment
+{
+	Real startMinutes;
+	Real lengthMinutes;
+	std::vector< Real > coefficients;
+};
+
+//! Piecewise Chebyshev interpolant of the SGP4 trajectory of one object over a mission window
+class ObjectEphemeris
+{
+public:
+
+	ObjectEphemeris( );
+
+	//! Compute position [km] and velocity [km/s] at the given minutes since the start of the window.
+	/*!
+	 * @throws std::out_of_range if the time lies outside the interpolated interval
+	 */
+	void findState( const Real minutesSinceStart, array3& position, array3& velocity ) const;
+
+	unsigned int noradNumber;
+	boost::uint64_t tleHash;		// computeTleHash of the TLE the interpolant was fitted to
+	int degree;
+	Real maximumPositionError;		// [km], largest error against SGP4 found while fitting
+	bool isErrorBoundMet;			// false if a segment of the shortest length missed the error bound
+	std::vector< ChebyshevSegment > segments;
+};
+
+//! Interpolants of all objects of a catalog over a common window
+struct CatalogEphemeris
+{
+	DateTime windowStart;
+	Real windowMinutes;
+	Real positionErrorBound;		// [km]
+	std::vector< ObjectEphemeris > objects;
+
+	//! Compute the state of object k at an epoch inside the window.
+	void findState( const int k, const DateTime& epoch, array3& position, array3& velocity ) const;
+};
+
+//! 64-bit FNV-1a hash of the two element lines of a TLE, identifying the TLE an interpolant was fitted to.
+boost::uint64_t computeTleHash( const Tle& tle );
+
+//! Fit a piecewise Chebyshev interpolant to the SGP4 trajectory of an object
+/*!
+ * Segments are fitted on Chebyshev nodes and checked against SGP4 at the midpoints between the
+ * nodes and at four evenly spaced points per node, both ends included. A segment that misses the
+ * error bound is halved; a segment that meets it lets the next one grow by half, so the segment
+ * length adapts to the local dynamics. A segment that still misses the bound at the shortest length
+ * (0.5 min) is kept and clears isErrorBoundMet, so callers can reject the object. If SGP4 fails
+ * (e.g. the object decays) the interpolant stops at the last valid segment.
+ * @param	const Tle& tle							TLE of the object
+ * @param	const DateTime& windowStart				start of the mission window
+ * @param	const Real windowMinutes				length of the mission window [min]
+ * @param	const Real positionErrorBound			maximum allowed position error [km]
+ * @param	const int degree						degree of the Chebyshev polynomials
+ * @return	interpolant of the object trajectory
+ */
+ObjectEphemeris fitObjectEphemeris( const Tle& tle,
+									const DateTime& windowStart,
+									const Real windowMinutes,
+									const Real positionErrorBound,
+									const int degree = 12 );
+
+//! Fit interpolants for every object of a catalog.
+CatalogEphemeris fitCatalogEphemeris( const std::vector< Tle >& catalog,
+									  const DateTime& windowStart,
+									  const Real windowMinutes,
+									  const Real positionErrorBound,
+									  const int degree = 12 );
+
+//! Maximum position error [km] of an interpolant against SGP4 on a dense uniform sampling.
+Real verifyObjectEphemeris( const ObjectEphemeris& ephemeris,
+							const Tle& tle,
+							const DateTime& windowStart,
+							const int samplesPerSegment );
+
+//! Default location of the ephemeris file that belongs to a catalog (stored next to it).
+std::string getEphemerisPath( const std::string& catalogPath );
+
+//! Write catalog interpolants to a binary file.
+void writeCatalogEphemeris( const std::string& path, const CatalogEphemeris& ephemeris );
+
+//! Read catalog interpolants from a binary file.
+/*!
+ * @throws std::runtime_error if the file cannot be read, is not an ephemeris file, or holds a degree
+ * 		   or segment count that no fit produces
+ */
+CatalogEphemeris readCatalogEphemeris( const std::string& path );
+
+//! Load the interpolants stored next to the catalog, or fit and store them if they do not match
+/*!
+ * The stored file is reused when it covers the same window with an error bound at least as tight as
+ * the one requested, and was fitted with the same degree to the same TLEs: every object must have
+ * the NORAD number and the hash of the element lines of the catalog entry, so an updated catalog of
+ * the same objects is fitted again.
+ */
+CatalogEphemeris loadOrFitCatalogEphemeris( const std::string& catalogPath,
+											const std::vector< Tle >& catalog,
+											const DateTime& windowStart,
+											const Real windowMinutes,
+											const Real positionErrorBound,
+											const int degree = 12 );
+
+} // namespace ephemerisInterpolator
+
+#endif // CPP_PROJECT_EPHEMERIS_INTERPOLATOR_HPP
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_EPOCH_PLANNER_HPP
+#define CPP_PROJECT_EPOCH_PLANNER_HPP
+
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/j2Propagator.hpp"
+
+namespace epochPlanner
+{
+
+typedef double Real;
+
+//! Phasing geometry of a departure/arrival pair from the TLE mean elements and J2 secular rates
+/*!
+ * The phase angle is the angle between the arrival and departure objects, each measured in its own
+ * orbit plane from the line of intersection of the two planes (from the departure node for
+ * coplanar orbits). It returns to the same value every synodic period. The plane angle between the
+ * two orbits changes with the drift of the relative node.
+ */
+struct PairPhasing
+{
+	j2Propagator::MeanElements departureElements;
+	j2Propagator::MeanElements arrivalElements;
+	Real phaseRate;					// [rad/min], rate of the phase angle (arrival minus departure)
+	Real synodicPeriod;				// [min]
+	Real relativeNodeRate;			// [rad/min], RAAN drift of the arrival plane relative to the departure plane
+	Real nodeAlignmentPeriod;		// [min], period of the relative RAAN drift
+};
+
+//! Compute the phasing geometry of a pair.
+PairPhasing computePairPhasing( const Tle& departureObject, const Tle& arrivalObject );
+
+//! Phase angle [rad] in ( -pi, pi ] and plane angle [rad] of a pair at an epoch.
+void computePhaseAndPlaneAngle( const PairPhasing& phasing, const DateTime& epoch, Real& phaseAngle, Real& planeAngle );
+
+//! Angular distance [rad] of the phase angle at an epoch from the phases that allow a rendezvous
+/*!
+ * During a transfer of duration T the transfer orbit advances at roughly the average rate of the
+ * two orbits, so the arrival object is met if the phase angle at departure equals
+ * -phaseRate * T / 2 (mod 2 pi). Over the times of flight [ 0, maximumTimeOfFlight ] these phases
+ * form an arc; the mismatch is zero inside the arc and the distance to its nearest end outside.
+ */
+Real computePhaseMismatch( const PairPhasing& phasing, const DateTime& epoch, const Real maximumTimeOfFlight );
+
+//! Settings of the epoch planner
+struct PlannerSettings
+{
+	int numberOfEpochs;				// departure epochs to propose per pair
+	Real maximumTimeOfFlight;		// [s], longest time of flight of the grid
+	Real phaseTolerance;			// [rad], accepted phase mismatch
+	Real planeTolerance;			// [rad], accepted plane angle above the smallest one in the window
+	Real samplingStep;				// [min], step on which the window is scanned
+};
+
+//! Default settings: 100 epochs, 16.65 h maximum time of flight, 15 deg phase and 0.5 deg plane tolerance, 1 min scan.
+PlannerSettings getDefaultSettings( );
+
+//! Propose departure epochs of a pair near favourable phase and plane alignment
+/*!
+ * The window is scanned on the sampling step and the epochs with a phase mismatch and plane angle
+ * within the tolerances are kept. The requested number of epochs is spread evenly over the kept
+ * ones, so every favourable phasing window in the mission window gets its share. If fewer epochs
+ * than requested are favourable, all of them are returned; if none are, the epochs with the lowest
+ * phase mismatch are returned instead.
+ * @param	const PairPhasing& phasing			phasing geometry of the pair
+ * @param	const DateTime& windowStart			start of the mission window
+ * @param	const Real windowMinutes			length of the mission window [min]
+ * @param	const PlannerSettings& settings		number of epochs and tolerances
+ * @return	departure epochs in chronological order
+ */
+std::vector< DateTime > planDepartureEpochs( const PairPhasing& phasing,
+											 const DateTime& windowStart,
+											 const Real windowMinutes,
+											 const PlannerSettings& settings );
+
+//! Evenly spaced departure epochs over a window, the first at the window start.
+std::vector< DateTime > computeUniformDepartureEpochs( const DateTime& windowStart,
+													   const Real windowMinutes,
+													   const int numberOfEpochs );
+
+} // namespace epochPlanner
+
+#endif // CPP_PROJECT_EPOCH_PLANNER_HPP
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_FIT_CAMPAIGN_HPP
+#define CPP_PROJECT_FIT_CAMPAIGN_HPP
+
+#include <string>
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+
+#include "CppProject/atomTransfer.hpp"
+#include "CppProject/elementSampler.hpp"
+
+namespace fitCampaign
+{
+
+typedef double Real;
+
+//! Cartesian-to-TLE conversion under test
+enum FitMethod
+{
+	atomFit,			// atom::convertCartesianStateToTwoLineElements
+	analyticFit			// tleFitter::convertCartesianStateToTwoLineElements
+};
+
+//! Outcome of one conversion
+enum FitOutcome
+{
+	convergedFit,		// converged, TLE within the residual tolerance of the state
+	inaccurateFit,		// converged, but the TLE misses the state by more than the residual tolerance
+	iterationLimit,		// GSL_EMAXITER
+	noProgress,			// GSL_ENOPROG or GSL_ENOPROGJ
+	solverError,		// any other solver status
+	thrownException,	// the conversion or the SGP4 check of its TLE threw
+	numberOfOutcomes
+};
+
+//! Name of an outcome as used in the failure map header.
+const char* getOutcomeName( const FitOutcome outcome );
+
+//! Name of a method as used on the command line: "atom" or "analytic".
+const char* getMethodName( const FitMethod method );
+
+//! Method with a given name; throws std::runtime_error for an unknown name.
+FitMethod findMethod( const std::string& name );
+
+//! Buckets of the iteration histogram of a bin: 1, 2-3, 4-7, ..., 64 and more iterations
+const int numberOfIterationBuckets = 7;
+
+//! Buckets of the residual histogram of a bin: below 1 mm, the nine decades from 1 mm to 1000 km, and more
+const int numberOfResidualBuckets = 11;
+
+//! Streaming counts of one (a, e, i) bin
+struct BinStatistics
+{
+	long numberOfSamples;
+	long outcomes[ numberOfOutcomes ];
+	long iterationHistogram[ numberOfIterationBuckets ];		// of the converged and inaccurate fits
+	long residualHistogram[ numberOfResidualBuckets ];			// [km], of the converged and inaccurate fits
+	long iterationSum;
+};
+
+//! Counts of a campaign binned by semi-major axis, eccentricity and inclination
+struct FailureMap
+{
+	elementSampler::ElementRanges ranges;
+	int numberOfSemiMajorAxisBins;
+	int numberOfEccentricityBins;
+	int numberOfInclinationBins;
+	std::vector< BinStatistics > bins;		// [ ( a * numberOfEccentricityBins + e ) * numberOfInclinationBins + i ]
+};
+
+//! Empty map with evenly spaced bins over the semi-major axis, eccentricity and inclination ranges.
+FailureMap createFailureMap( const elementSampler::ElementRanges& ranges,
+							 const int numberOfSemiMajorAxisBins,
+							 const int numberOfEccentricityBins,
+							 const int numberOfInclinationBins );
+
+//! Add the counts of a map with the same bins to a map.
+void mergeFailureMaps( const FailureMap& source, FailureMap& target );
+
+//! Wilson score interval of a failure rate at a normal quantile (1.96 for 95 %)
+/*!
+ * @param	Real& lowerBound	returns the lower bound of the rate
+ * @param	Real& upperBound	returns the upper bound of the rate
+ */
+void computeWilsonInterval( const long numberOfFailures, const long numberOfSamples, const Real quantile,
+							Real& lowerBound, Real& upperBound );
+
+//! Settings of a campaign
+struct CampaignSettings
+{
+	elementSampler::ElementRanges ranges;				// [m, -, rad, rad, rad, rad]
+	elementSampler::SamplerSettings sampler;			// design, seed and perigee band of the states
+	int numberOfSemiMajorAxisBins;
+	int numberOfEccentricityBins;
+	int numberOfInclinationBins;
+	FitMethod method;
+	DateTime epoch;										// epoch of the TLEs; fits start from meanElementConverter::createReferenceTle
+	atomTransfer::AtomSolverSettings fitSettings;
+	Real residualTolerance;								// [km], largest position error of a converged TLE at the epoch
+	int samplesPerRound;
+	long maximumNumberOfSamples;
+	int minimumBinSamples;								// samples a bin needs before its interval counts as converged
+	Real targetHalfWidth;								// half-width of the failure-rate intervals to stop at
+	Real quantile;										// normal quantile of the intervals
+	int numberOfThreads;								// 0 for one thread per hardware thread
+};
+
+//! Default campaign: LEO states with perigees from 100 km, 8 x 10 x 9 bins, the ATOM fit at the
+//! epoch of TleGen::TleGen, 1 km residual tolerance, rounds of 65536 samples up to 10 million samples, and
+//! 95 % intervals of half-width 0.01 with at least 100 samples per bin.
+CampaignSettings getDefaultCampaignSettings( );
+
+//! Counts and run time of a campaign
+struct CampaignSummary
+{
+	long numberOfSamples;
+	long numberOfFailures;					// samples with an outcome other than convergedFit
+	int numberOfRounds;
+	int numberOfOccupiedBins;				// bins that received samples; the others lie outside the perigee band
+	bool isConverged;						// false if the sample limit was reached first
+	Real maximumHalfWidth;					// largest interval half-width of the occupied bins
+	Real seconds;
+};
+
+//! Map the failure envelope of the Cartesian-to-TLE conversion
+/*!
+ * Samples are drawn in rounds of samplesPerRound Keplerian element sets; round r uses the sampler
+ * seed plus 6 r, so the rounds of the uniform design never share a seed and those of the Sobol and
+ * Latin hypercube designs are independent randomisations. The states of a round are converted on
+ * all threads, each into a map of its own, and the maps are merged after the round, so the counts
+ * do not depend on the number of threads. After every round the Wilson interval of the failure rate
+ * of every occupied bin is computed; the campaign stops when all of them are narrower than the
+ * target and hold at least minimumBinSamples samples, or at the sample limit.
+ * @param	const CampaignSettings& settings		sampling, binning, conversion and stopping settings
+ * @param	FailureMap& map							returns the counts of all samples
+ * @return	counts and run time of the campaign
+ */
+CampaignSummary runCampaign( const CampaignSettings& settings, FailureMap& map );
+
+//! Write a failure map as CSV, one line per occupied bin
+/*!
+ * Columns: bin bounds (a [km], e, i [deg]), samples, failure rate and its interval, the count of
+ * every outcome, mean iterations, and the iteration and residual histograms.
+ * @throws	std::runtime_error if the file cannot be written
+ */
+void writeFailureMap( const std::string& path, const FailureMap& map, const Real quantile );
+
+} // namespace fitCampaign
+
+#endif // CPP_PROJECT_FIT_CAMPAIGN_HPP
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_GRID_REGRESSION_HPP
+#define CPP_PROJECT_GRID_REGRESSION_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <libsgp4/Tle.h>
+
+#include "CppProject/resultsStore.hpp"
+
+namespace gridRegression
+{
+
+typedef double Real;
+typedef resultsStore::ResultRecord ResultRecord;
+
+//! Allowed drift of a delta-V against its reference value: | value - reference | <= absolute + relative * | reference |
+struct RegressionTolerance
+{
+	Real absoluteDeltaV;		// [km/s]
+	Real relativeDeltaV;		// [-]
+};
+
+//! Evaluates the grid cells (departure ID, arrival ID, epoch and time-of-flight) given as records
+/*!
+ * Returns one record per converged cell with the delta-V fields filled in; cells on which ATOM
+ * fails are left out, as in the grid output files.
+ */
+typedef std::vector< ResultRecord > ( *CellEvaluator )( const std::vector< Tle >& catalog,
+														 const std::vector< ResultRecord >& cells );
+
+//! Evaluate the cells one by one with SGP4 + Lambert + ATOM, as the original grid loop does.
+std::vector< ResultRecord > evaluateCellsSerial( const std::vector< Tle >& catalog,
+												 const std::vector< ResultRecord >& cells );
+
+//! Evaluate the cells with SGP4 + Lambert + ATOM spread over all hardware threads.
+std::vector< ResultRecord > evaluateCellsParallel( const std::vector< Tle >& catalog,
+												   const std::vector< ResultRecord >& cells );
+
+//! Evaluate the cells spread over all hardware threads with one reusable solver workspace per thread.
+std::vector< ResultRecord > evaluateCellsWorkspace( const std::vector< Tle >& catalog,
+													const std::vector< ResultRecord >& cells );
+
+//! Evaluate the cells spread over all hardware threads with a loose screening solve refined to the default tolerances.
+std::vector< ResultRecord > evaluateCellsRefined( const std::vector< Tle >& catalog,
+												  const std::vector< ResultRecord >& cells );
+
+//! Evaluate the cells spread over all hardware threads with one lock-step batched ATOM solver per thread.
+std::vector< ResultRecord > evaluateCellsBatched( const std::vector< Tle >& catalog,
+												  const std::vector< ResultRecord >& cells );
+
+//! Look up an evaluator by name ("serial", "parallel", "workspace", "refined" or "batched"); returns NULL for an unknown name.
+CellEvaluator findCellEvaluator( const std::string& name );
+
+//! Row-by-row comparison of results against reference results
+struct RegressionComparison
+{
+	int numberOfReferenceRows;
+	int numberOfMatchedRows;		// rows present in both
+	int numberOfMissingRows;		// reference rows without a result (e.g. ATOM no longer converges)
+	int numberOfExtraRows;			// results without a reference row
+	int numberOfDriftingRows;		// matched rows outside the tolerance
+	Real maximumAtomDeltaVDrift;	// [km/s]
+	Real maximumLambertDeltaVDrift;	// [km/s]
+	std::vector< std::pair< ResultRecord, ResultRecord > > driftingRows;	// ( reference, result )
+};
+
+//! Compare results against reference results matched on departure ID, arrival ID, epoch and time-of-flight.
+RegressionComparison compareResults( const std::vector< ResultRecord >& reference,
+									 const std::vector< ResultRecord >& results,
+									 const RegressionTolerance& tolerance );
+
+//! True if the results reproduce the reference: no missing, extra or drifting rows.
+bool isPassing( const RegressionComparison& comparison );
+
+//! Drift and run time of the baseline and candidate evaluators on one reduced scenario
+struct RegressionReport
+{
+	RegressionComparison baseline;
+	RegressionComparison candidate;
+	Real baselineSeconds;
+	Real candidateSeconds;
+};
+
+//! Replay the cells of a reference file with the baseline and candidate evaluators
+/*!
+ * The reference file has the column layout of Atom_Solver_Grid3.csv and defines the scenario: each
+ * of its rows is evaluated again with the objects of the catalog. Both evaluators are timed and
+ * compared against the reference, so speed-up and drift are reported by the same run.
+ * @param	const std::string& catalogPath		TLE catalog holding the objects of the reference rows
+ * @param	const std::string& referencePath	reference results
+ * @param	const RegressionTolerance& tolerance	allowed delta-V drift
+ * @param	CellEvaluator baseline				evaluator the speed-up is measured against
+ * @param	CellEvaluator candidate				evaluator under test
+ * @return	comparison and run time of both evaluators
+ * @throws	std::runtime_error if a reference row refers to an object that is not in the catalog
+ */
+RegressionReport runRegression( const std::string& catalogPath,
+								const std::string& referencePath,
+								const RegressionTolerance& tolerance,
+								CellEvaluator baseline,
+								CellEvaluator candidate );
+
+} // namespace gridRegression
+
+#endif // CPP_PROJECT_GRID_REGRESSION_HPP
@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_GRID_SEARCH_HPP
+#define CPP_PROJECT_GRID_SEARCH_HPP
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/atomTransfer.hpp"
+#include "CppProject/j2Propagator.hpp"
+
+namespace gridSearch
+{
+
+typedef double Real;
+
+//! Departure epochs of the grid for a given departure object.
+/*!
+ * Reproduces the epoch pattern of the original grid loop, in which the departure epoch is advanced
+ * by l * 100 seconds at every epoch step and keeps accumulating across departure objects.
+ */
+std::vector< DateTime > computeDepartureEpochs( const DateTime& startEpoch, const int departureIndex, const int epochSteps );
+
+//! Times of flight of the grid [s]: firstTimeOfFlight + p * timeOfFlightStep.
+std::vector< Real > computeTimesOfFlight( const int timeOfFlightSteps,
+										  const Real firstTimeOfFlight = 10.0,
+										  const Real timeOfFlightStep = 60.0 );
+
+//! How the departure epochs of a pair are chosen
+enum EpochPattern
+{
+	accumulatingEpochs,		// original l * 100 s pattern, accumulating across departure objects
+	uniformEpochs,			// evenly spaced over the mission window
+	plannedEpochs			// proposed per pair by the synodic epoch planner
+};
+
+//! Specification of one grid search run
+/*!
+ * As in the original grid loop, the last object of the catalog is not used as departure or arrival
+ * object.
+ *
+ * With refinementSize set the run is staged: every cell is first solved with screeningSettings, and
+ * only the refinementSize converged cells with the lowest screening delta-V per pair are solved again
+ * with solverSettings, starting from the screening solution (atomTransfer::refineTransfer). The
+ * guarantee that a result matches a single solve with solverSettings covers the refined cells only,
+ * which are passed to ResultSink::consumeResult. The other cells that converged in the screening
+ * solve are passed to ResultSink::consumeScreenedResult with their screening delta-V; cells that fail
+ * the screening solve, and refined cells that fail the tight solve, are reported as failures.
+ *
+ * With shortlistSize set and useSinglePrecisionScreening, every cell of a pair is screened with SGP4
+ * states and Lambert delta-V in single precision and the shortlist grows by the cells within
+ * screeningMargin of its cut; the shortlisted cells are then solved as usual, in double precision.
+ *
+ * With batchSize set the cells of a thread are queued and solved batchSize at a time by an
+ * atomBatch::BatchTransferSolver, in place of the one-at-a-time solver; results reach the sink in the
+ * same order, a batch later. Refinements of a staged run are still solved one at a time.
+ */
+struct GridSearchSpec
+{
+	std::string catalogPath;
+	DateTime startEpoch;
+	EpochPattern epochPattern;
+	int numberOfEpochSteps;
+	Real windowMinutes;						// [min], mission window of the uniform and planned patterns, 0 for the window of the accumulating pattern
+	int numberOfTimeOfFlightSteps;
+	Real firstTimeOfFlight;					// [s]
+	Real timeOfFlightStep;					// [s]
+	int shortlistSize;						// 0 to solve every cell, otherwise the J2 + Lambert shortlist size per pair
+	bool useSinglePrecisionScreening;		// shortlist on SGP4 + Lambert in single precision (mixedPrecisionScreening) instead of J2
+	Real screeningMargin;					// [km/s], single-precision screening: cells within this of the shortlist cut are kept too
+	atomTransfer::AtomSolverSettings solverSettings;
+	int refinementSize;						// 0 to solve every cell with solverSettings, otherwise the cells per pair refined after screening
+	atomTransfer::AtomSolverSettings screeningSettings;	// loose settings of the screening solve when refinementSize is set
+	bool useSolverWorkspace;				// solve with one atomWorkspace::AtomSolverWorkspace per thread instead of one ATOM solver per cell
+	int batchSize;							// 0 to solve cell by cell, otherwise the cells solved together in lock-step
+	int numberOfThreads;					// 0 for one thread per hardware thread
+};
+
+//! Specification of the original grid: 5-object catalog, 2016-02-01, 100 accumulating epochs, 1000 times of flight, one thread.
+/*!
+ * The cells are solved with the ATOM library solver of the original grid; the reusable solver
+ * workspace (useSolverWorkspace), which gives the same results, is opt-in. Refinement and batching
+ * are off, shortlists are screened with J2 and the single-precision screening margin is 1 m/s; the
+ * screening settings are absolute tolerance 1e-4, relative tolerance 1e-3 and 10 iterations.
+ */
+GridSearchSpec getDefaultGridSearchSpec( );
+
+//! Counts and run time of a grid search run
+struct GridSearchSummary
+{
+	long numberOfCells;
+	long numberOfConvergedCells;
+	long numberOfFailedCells;
+	long numberOfRefinedCells;				// cells solved again with the tight settings of a staged run
+	long numberOfScreenedOnlyCells;			// cells of a staged run that converged in screening and were not refined
+	long numberOfIterations;				// ATOM solver iterations of all solves, screening and refinement
+	Real seconds;
+};
+
+//! Receives the results of a grid search run
+/*!
+ * Results are passed by reference as fixed-size records and are only valid during the call. Calls
+ * are serialised by the engine, also when the run uses several threads, so implementations need
+ * no locking; the order of the results is that of the original loop for single-threaded runs only.
+ */
+class ResultSink
+{
+public:
+
+	virtual ~ResultSink( ) { }
+
+	//! Called once before the first result of a run.
+	virtual void beginRun( const GridSearchSpec& ) { }
+
+	//! Called for every converged cell.
+	virtual void consumeResult( const atomTransfer::TransferResult& result ) = 0;
+
+	//! Called for every cell on which ATOM fails; only the cell and the Lambert delta-V are set.
+	virtual void consumeFailure( const atomTransfer::TransferResult& ) { }
+
+	//! Called in a staged run for every cell that converged in screening and was not refined.
+	/*!
+	 * The delta-V is that of the loose screening settings and may differ from a solve with the
+	 * solver settings of the run.
+	 */
+	virtual void consumeScreenedResult( const atomTransfer::TransferResult& ) { }
+
+	//! Called once after the last result of a run.
+	virtual void endRun( const GridSearchSummary& ) { }
+};
+
+//! Writes the results as rows of the grid output file (layout of Atom_Solver_Grid3.csv)
+class CsvResultSink : public ResultSink
+{
+public:
+
+	//! Write the column header before the first result if writeHeader is set.
+	CsvResultSink( std::ostream& outputStream, const bool writeHeader );
+
+	virtual void beginRun( const GridSearchSpec& spec );
+
+	virtual void consumeResult( const atomTransfer::TransferResult& result );
+
+private:
+
+	std::ostream& outputStream;
+	bool isHeaderPending;
+};
+
+//! Keeps the results of a run in memory
+class CollectingResultSink : public ResultSink
+{
+public:
+
+	virtual void consumeResult( const atomTransfer::TransferResult& result );
+
+	std::vector< atomTransfer::TransferResult > results;
+};
+
+//! Keeps the best converged transfer of every pair seen so far
+/*!
+ * The table is updated with every result, so it holds the best answer found at any time during a
+ * run. Results are optionally passed on to another sink as well.
+ */
+class BestTransferSink : public ResultSink
+{
+public:
+
+	//! Pass the results on to forwardSink as well, if it is not NULL.
+	explicit BestTransferSink( ResultSink* forwardSink = NULL );
+
+	virtual void beginRun( const GridSearchSpec& spec );
+
+	virtual void consumeResult( const atomTransfer::TransferResult& result );
+
+	virtual void consumeFailure( const atomTransfer::TransferResult& result );
+
+	virtual void endRun( const GridSearchSummary& summary );
+
+	//! Best transfer per pair, sorted by ascending ATOM delta-V.
+	std::vector< atomTransfer::TransferResult > getBestTransfers( ) const;
+
+private:
+
+	ResultSink* forwardSink;
+	std::map< std::pair< int, int >, atomTransfer::TransferResult > bestTransfers;
+};
+
+//! Passes the results of a run on to another sink in a fixed order
+/*!
+ * A multi-threaded run delivers results in the order the threads finish them. This sink keeps the
+ * results and failures of the run and passes them on at the end of the run, sorted by the catalog
+ * position of the departure object, the departure epoch, the catalog position of the arrival object
+ * and the time of flight: the loop order of a single-threaded run of the full grid with the
+ * accumulating or uniform epochs. The output then does not depend on the number of threads. The
+ * sink holds every cell of the run in memory.
+ */
+class OrderedResultSink : public ResultSink
+{
+public:
+
+	//! Order the results by their position in catalog and pass them on to forwardSink.
+	OrderedResultSink( const std::vector< Tle >& catalog, ResultSink& forwardSink );
+
+	virtual void beginRun( const GridSearchSpec& spec );
+
+	virtual void consumeResult( const atomTransfer::TransferResult& result );
+
+	virtual void consumeFailure( const atomTransfer::TransferResult& result );
+
+	virtual void endRun( const GridSearchSummary& summary );
+
+private:
+
+	struct OrderedCell
+	{
+		int departureIndex;
+		int arrivalIndex;
+		bool isConverged;
+		atomTransfer::TransferResult result;
+	};
+
+	void addCell( const atomTransfer::TransferResult& result, const bool isConverged );
+
+	static bool compareCells( const OrderedCell& first, const OrderedCell& second );
+
+	ResultSink& forwardSink;
+	std::map< int, int > catalogIndex;		// NORAD number to position in the catalog
+	std::vector< OrderedCell > cells;
+};
+
+//! Ranking and budget of an anytime run; budget fields that are 0 do not limit the run
+struct AnytimeSettings
+{
+	int epochsPerWindow;				// consecutive departure epochs of a pair that form one cell
+	int promiseTimeOfFlightStride;		// every n-th time of flight is used for the promise estimate
+	Real maximumSeconds;				// wall-clock budget, ranking included
+	long maximumEvaluations;			// budget of ATOM evaluations
+	Real targetDeltaV;					// [km/s]
+	int numberOfTargetPairs;			// stop once this many (departure, arrival) pairs have a converged transfer at or
+										// below targetDeltaV
+};
+
+//! Cells of 10 epochs, promise from every 20th time of flight, no budget.
+AnytimeSettings getDefaultAnytimeSettings( );
+
+//! Why an anytime run stopped
+enum StopReason
+{
+	searchCompleted,
+	timeBudgetReached,
+	evaluationBudgetReached,
+	targetReached
+};
+
+//! Name of a stop reason for reports.
+std::string getStopReasonName( const StopReason reason );
+
+//! Counts of an anytime run
+struct AnytimeSummary
+{
+	GridSearchSummary gridSummary;
+	StopReason stopReason;
+	long numberOfRankedCells;
+	long numberOfStartedCells;
+	long numberOfTargetPairs;			// pairs with a converged transfer at or below the target delta-V
+	Real rankingSeconds;
+};
+
+//! Grid search engine that can run many specifications in one process
+/*!
+ * Loaded catalogs and their SGP4 and J2 propagators are cached by catalog path and reused by
+ * later runs on the same catalog.
+ */
+class GridSearchEngine
+{
+public:
+
+	//! Run a grid search and pass every result to the sink.
+	GridSearchSummary run( const GridSearchSpec& spec, ResultSink& sink );
+
+	//! Run a grid search in order of promise until the search is complete or the budget is used up
+	/*!
+	 * The grid of every pair is cut into cells of settings.epochsPerWindow consecutive departure
+	 * epochs. The promise of a cell is its lowest J2 + Lambert delta-V over a subset of the times of
+	 * flight, and the cells are solved in ascending order of promise; within a cell the (epoch, time of
+	 * flight) points are solved in ascending order of J2 + Lambert delta-V, limited to
+	 * spec.shortlistSize points if it is set. Threads take the next cell as they finish one. The budget
+	 * is checked before every ATOM evaluation; a run that stops leaves no evaluation half done, and the
+	 * sink has received every result up to that point. The target counts distinct (departure, arrival)
+	 * pairs with a converged transfer at or below settings.targetDeltaV, not evaluations. Cells are solved once with spec.solverSettings;
+	 * spec.refinementSize is not used.
+	 * @param	const GridSearchSpec& spec				grid to search
+	 * @param	const AnytimeSettings& settings			cell size, promise estimate and budget
+	 * @param	ResultSink& sink						receives the results, e.g. a BestTransferSink
+	 * @return	counts of the run and the reason it stopped
+	 */
+	AnytimeSummary runAnytime( const GridSearchSpec& spec, const AnytimeSettings& settings, ResultSink& sink );
+
+	//! Catalog at a path, loaded on first use.
+	const std::vector< Tle >& loadCatalog( const std::string& catalogPath );
+
+	//! Forget all cached catalogs and propagators.
+	void clearCache( );
+
+private:
+
+	//! Catalog and propagators cached per catalog path
+	struct CatalogCache
+	{
+		std::vector< Tle > objects;
+		std::vector< SGP4 > sgp4Propagators;
+		std::vector< j2Propagator::J2Propagator > j2Propagators;
+	};
+
+	const CatalogCache& findCatalogCache( const std::string& catalogPath );
+
+	std::map< std::string, CatalogCache > catalogCaches;
+};
+
+} // namespace gridSearch
+
+#endif // CPP_PROJECT_GRID_SEARCH_HPP
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_J2_PROPAGATOR_HPP
+#define CPP_PROJECT_J2_PROPAGATOR_HPP
+
+#include <boost/array.hpp>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Tle.h>
+
+namespace j2Propagator
+{
+
+typedef double Real;
+typedef boost::array< Real, 3 > array3;
+
+//! Mean elements and secular J2 rates extracted from a TLE
+/*!
+ * Angles are in radians, the semi-major axis in km and all rates in rad/min, following the
+ * un-Kozai'd (Brouwer) mean motion used internally by SGP4.
+ */
+struct MeanElements
+{
+	DateTime epoch;
+	Real semiMajorAxis;
+	Real eccentricity;
+	Real inclination;
+	Real rightAscendingNode;
+	Real argumentPerigee;
+	Real meanAnomaly;
+	Real meanMotion;
+	Real meanMotionDt2; // half the first derivative of the mean motion [rad/min^2]
+	Real rightAscendingNodeRate;
+	Real argumentPerigeeRate;
+	Real meanAnomalyRate;
+};
+
+//! Extract SGP4 mean elements and first-order J2 secular rates from a TLE
+MeanElements computeMeanElements( const Tle& tle );
+
+//! Analytic J2 secular propagator used for cheap screening ahead of SGP4
+/*!
+ * The mean elements of the TLE are advanced with the first-order J2 secular rates on the right
+ * ascension of the ascending node, argument of perigee and mean anomaly, plus the quadratic
+ * along-track term from the TLE mean motion derivative. The position is then obtained from a
+ * two-body Kepler solve. Short-period terms and drag beyond the mean motion derivative are
+ * neglected, so the result is accurate to roughly ten kilometres in LEO over a few days, which is
+ * enough to rank transfer opportunities but not to replace SGP4.
+ */
+class J2Propagator
+{
+public:
+
+	//! Construct the propagator from a TLE.
+	explicit J2Propagator( const Tle& tle );
+
+	//! Compute position [km] and velocity [km/s] in the TEME frame at the given epoch.
+	void findState( const DateTime& epoch, array3& position, array3& velocity ) const;
+
+	//! Compute position [km] and velocity [km/s] at the given minutes since the TLE epoch.
+	void findState( const Real minutesSinceEpoch, array3& position, array3& velocity ) const;
+
+	//! Return the mean elements the propagator was initialised with.
+	const MeanElements& meanElements( ) const { return elements; }
+
+private:
+
+	MeanElements elements;
+};
+
+} // namespace j2Propagator
+
+#endif // CPP_PROJECT_J2_PROPAGATOR_HPP
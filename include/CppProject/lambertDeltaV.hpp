@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_LAMBERT_DELTA_V_HPP
+#define CPP_PROJECT_LAMBERT_DELTA_V_HPP
+
+#include <boost/array.hpp>
+
+namespace lambertDeltaV
+{
+
+typedef double Real;
+typedef boost::array< Real, 3 > array3;
+
+//! Compute the minimum total delta-V over all Lambert solutions between two states
+/*!
+ * Solves the Lambert problem (PyKEP, up to 5 revolutions) between the departure and arrival
+ * positions and returns the smallest sum of departure and arrival delta-V magnitudes over all
+ * solutions. Units follow the gravitational parameter, i.e. km, km/s and km^3/s^2 for kMU.
+ * @param	const array3& departurePosition				position of the departure object
+ * @param	const array3& departureVelocity				velocity of the departure object
+ * @param	const array3& arrivalPosition				position of the arrival object
+ * @param	const array3& arrivalVelocity				velocity of the arrival object
+ * @param	const Real timeOfFlight						time of flight of the transfer [s]
+ * @param	const Real gravitationalParameter			gravitational parameter of the central body
+ * @param	array3& transferDepartureVelocity			returns the transfer orbit velocity at departure for
+ *														the minimum delta-V solution (initial guess for ATOM)
+ * @return	minimum total delta-V of the transfer
+ */
+Real computeLambertDeltaV( const array3& departurePosition,
+						   const array3& departureVelocity,
+						   const array3& arrivalPosition,
+						   const array3& arrivalVelocity,
+						   const Real timeOfFlight,
+						   const Real gravitationalParameter,
+						   array3& transferDepartureVelocity );
+
+} // namespace lambertDeltaV
+
+#endif // CPP_PROJECT_LAMBERT_DELTA_V_HPP
@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_LAMBERT_KERNEL_HPP
+#define CPP_PROJECT_LAMBERT_KERNEL_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace lambertKernel
+{
+
+//! Minimum total delta-V over the Lambert solutions between two states, in any floating-point type
+/*!
+ * Implements the Lambert solver of PyKEP (kep_toolbox::lambert_problem, Izzo's algorithm with
+ * Householder iterations, prograde transfers, up to maximumRevolutions revolutions) and the delta-V
+ * of lambertDeltaV::computeLambertDeltaV, so that the screening of a grid can be run in single
+ * precision. Constants are converted to the scalar type, so an evaluation in float stays in float.
+ * The convergence tolerances of PyKEP are raised to a few units in the last place of the scalar
+ * type where they would be below it.
+ */
+template< typename Scalar >
+class Solver
+{
+public:
+
+	//! State of one end of a transfer with the quantities the solver derives from it alone
+	/*!
+	 * Sweeps that pair one state with many others can create its endpoint once and reuse it.
+	 */
+	struct Endpoint
+	{
+		Scalar position[ 3 ];
+		Scalar velocity[ 3 ];
+		Scalar radius;
+		Scalar radial[ 3 ];			// unit vector along the position
+	};
+
+	//! Endpoint of a position and velocity.
+	static Endpoint createEndpoint( const Scalar position[ 3 ], const Scalar velocity[ 3 ] )
+	{
+		Endpoint endpoint;
+		for( int k = 0; k < 3; k++ )
+		{
+			endpoint.position[ k ] = position[ k ];
+			endpoint.velocity[ k ] = velocity[ k ];
+		}
+		endpoint.radius = norm( position );
+		for( int k = 0; k < 3; k++ )
+		{
+			endpoint.radial[ k ] = position[ k ] / endpoint.radius;
+		}
+		return endpoint;
+	}
+
+	//! Minimum of the departure plus arrival delta-V over all solutions, or the largest Scalar if there is none
+	/*!
+	 * @param	const Scalar departurePosition[ 3 ]		position of the departure object
+	 * @param	const Scalar departureVelocity[ 3 ]		velocity of the departure object
+	 * @param	const Scalar arrivalPosition[ 3 ]		position of the arrival object
+	 * @param	const Scalar arrivalVelocity[ 3 ]		velocity of the arrival object
+	 * @param	const Scalar timeOfFlight				time of flight of the transfer [s]
+	 * @param	const Scalar gravitationalParameter		gravitational parameter, in the units of the states
+	 * @param	const int maximumRevolutions			largest number of revolutions of the transfer
+	 * @return	minimum total delta-V of the transfer
+	 */
+	Scalar computeMinimumDeltaV( const Scalar departurePosition[ 3 ],
+								 const Scalar departureVelocity[ 3 ],
+								 const Scalar arrivalPosition[ 3 ],
+								 const Scalar arrivalVelocity[ 3 ],
+								 const Scalar timeOfFlight,
+								 const Scalar gravitationalParameter,
+								 const int maximumRevolutions )
+	{
+		return computeMinimumDeltaV( createEndpoint( departurePosition, departureVelocity ),
+									 createEndpoint( arrivalPosition, arrivalVelocity ),
+									 timeOfFlight, gravitationalParameter, maximumRevolutions );
+	}
+
+	//! Minimum delta-V between two endpoints, as computeMinimumDeltaV of their states.
+	Scalar computeMinimumDeltaV( const Endpoint& departure,
+								 const Endpoint& arrival,
+								 const Scalar timeOfFlight,
+								 const Scalar gravitationalParameter,
+								 const int maximumRevolutions )
+	{
+		using std::acos;
+		using std::floor;
+		using std::log;
+		using std::pow;
+		using std::sqrt;
+
+		const Scalar noSolution = std::numeric_limits< Scalar >::max( );
+		const Scalar pi = Scalar( 3.14159265358979323846 );
+		if( !( timeOfFlight > Scalar( 0 ) ) || !( gravitationalParameter > Scalar( 0 ) ) )
+		{
+			return noSolution;
+		}
+
+		// geometry of the transfer: chord, semi-perimeter and the radial and transverse unit vectors
+		Scalar chord[ 3 ];
+		for( int k = 0; k < 3; k++ )
+		{
+			chord[ k ] = arrival.position[ k ] - departure.position[ k ];
+		}
+		const Scalar c = norm( chord );
+		const Scalar departureRadius = departure.radius;
+		const Scalar arrivalRadius = arrival.radius;
+		const Scalar s = ( c + departureRadius + arrivalRadius ) / Scalar( 2 );
+
+		const Scalar* departureRadial = departure.radial;
+		const Scalar* arrivalRadial = arrival.radial;
+		const Scalar* departureVelocity = departure.velocity;
+		const Scalar* arrivalVelocity = arrival.velocity;
+		Scalar normal[ 3 ];
+		cross( departureRadial, arrivalRadial, normal );
+		const Scalar normalNorm = norm( normal );
+		for( int k = 0; k < 3; k++ )
+		{
+			normal[ k ] /= normalNorm;
+		}
+
+		lambda2 = std::max( Scalar( 1 ) - c / s, Scalar( 0 ) );
+		lambda = sqrt( lambda2 );
+		Scalar departureTransverse[ 3 ];
+		Scalar arrivalTransverse[ 3 ];
+		if( normal[ 2 ] < Scalar( 0 ) )
+		{
+			// transfer angle larger than 180 degrees
+			lambda = -lambda;
+			cross( departureRadial, normal, departureTransverse );
+			cross( arrivalRadial, normal, arrivalTransverse );
+		}
+		else
+		{
+			cross( normal, departureRadial, departureTransverse );
+			cross( normal, arrivalRadial, arrivalTransverse );
+		}
+		const Scalar departureTransverseNorm = norm( departureTransverse );
+		const Scalar arrivalTransverseNorm = norm( arrivalTransverse );
+		for( int k = 0; k < 3; k++ )
+		{
+			departureTransverse[ k ] /= departureTransverseNorm;
+			arrivalTransverse[ k ] /= arrivalTransverseNorm;
+		}
+		lambda3 = lambda * lambda2;
+		const Scalar T = sqrt( Scalar( 2 ) * gravitationalParameter / ( s * s * s ) ) * timeOfFlight;
+		if( !( T == T ) || !( lambda == lambda ) )
+		{
+			return noSolution;
+		}
+
+		// number of revolutions: the minimum time of flight of the highest one decides if it is feasible
+		int revolutions = static_cast< int >( std::min( floor( T / pi ), Scalar( maximumRevolutions ) + Scalar( 1 ) ) );
+		const Scalar T00 = acos( lambda ) + lambda * sqrt( Scalar( 1 ) - lambda2 );
+		const Scalar T0 = T00 + Scalar( revolutions ) * pi;
+		const Scalar T1 = Scalar( 2 ) / Scalar( 3 ) * ( Scalar( 1 ) - lambda3 );
+		if( revolutions > 0 && T < T0 )
+		{
+			Scalar minimumT = T0;
+			Scalar xOld = Scalar( 0 );
+			Scalar xNew = Scalar( 0 );
+			for( int iteration = 0; ; iteration++ )
+			{
+				Scalar dT, ddT, dddT;
+				computeTimeDerivatives( xOld, minimumT, dT, ddT, dddT );
+				if( dT != Scalar( 0 ) )
+				{
+					xNew = xOld - dT * ddT / ( ddT * ddT - dT * dddT / Scalar( 2 ) );
+				}
+				if( std::fabs( xOld - xNew ) < getTolerance( Scalar( 1.0e-13 ) ) || iteration > 12 )
+				{
+					break;
+				}
+				minimumT = computeTimeOfFlight( xNew, revolutions );
+				xOld = xNew;
+			}
+			if( minimumT > T )
+			{
+				revolutions--;
+			}
+		}
+		revolutions = std::min( revolutions, maximumRevolutions );
+
+		// velocities of a solution x and the delta-V of the transfer
+		const Scalar gamma = sqrt( gravitationalParameter * s / Scalar( 2 ) );
+		const Scalar rho = ( departureRadius - arrivalRadius ) / c;
+		const Scalar sigma = sqrt( Scalar( 1 ) - rho * rho );
+		Scalar minimumDeltaV = noSolution;
+		const auto addSolution = [ & ]( const Scalar x )
+		{
+			const Scalar y = sqrt( Scalar( 1 ) - lambda2 + lambda2 * x * x );
+			const Scalar departureRadialVelocity = gamma * ( ( lambda * y - x ) - rho * ( lambda * y + x ) ) / departureRadius;
+			const Scalar arrivalRadialVelocity = -gamma * ( ( lambda * y - x ) + rho * ( lambda * y + x ) ) / arrivalRadius;
+			const Scalar transverseVelocity = gamma * sigma * ( y + lambda * x );
+			Scalar departureDeltaV[ 3 ];
+			Scalar arrivalDeltaV[ 3 ];
+			for( int k = 0; k < 3; k++ )
+			{
+				departureDeltaV[ k ] = departureRadialVelocity * departureRadial[ k ]
+									   + transverseVelocity / departureRadius * departureTransverse[ k ] - departureVelocity[ k ];
+				arrivalDeltaV[ k ] = arrivalRadialVelocity * arrivalRadial[ k ]
+									 + transverseVelocity / arrivalRadius * arrivalTransverse[ k ] - arrivalVelocity[ k ];
+			}
+			const Scalar deltaV = norm( departureDeltaV ) + norm( arrivalDeltaV );
+			if( deltaV < minimumDeltaV )
+			{
+				minimumDeltaV = deltaV;
+			}
+		};
+
+		// single revolution, from the initial guess of PyKEP
+		Scalar x0;
+		if( T >= T00 )
+		{
+			x0 = -( T - T00 ) / ( T - T00 + Scalar( 4 ) );
+		}
+		else if( T <= T1 )
+		{
+			x0 = T1 * ( T1 - T ) / ( Scalar( 2 ) / Scalar( 5 ) * ( Scalar( 1 ) - lambda2 * lambda3 ) * T ) + Scalar( 1 );
+		}
+		else
+		{
+			x0 = pow( T / T00, Scalar( 0.69314718055994529 ) / log( T1 / T00 ) ) - Scalar( 1 );
+		}
+		addSolution( solveHouseholder( T, x0, 0, getTolerance( Scalar( 1.0e-5 ) ) ) );
+
+		// left and right branch of every multi-revolution solution
+		for( int n = 1; n <= revolutions; n++ )
+		{
+			Scalar ratio = pow( ( Scalar( n ) * pi + pi ) / ( Scalar( 8 ) * T ), Scalar( 2 ) / Scalar( 3 ) );
+			addSolution( solveHouseholder( T, ( ratio - Scalar( 1 ) ) / ( ratio + Scalar( 1 ) ), n,
+										   getTolerance( Scalar( 1.0e-8 ) ) ) );
+			ratio = pow( Scalar( 8 ) * T / ( Scalar( n ) * pi ), Scalar( 2 ) / Scalar( 3 ) );
+			addSolution( solveHouseholder( T, ( ratio - Scalar( 1 ) ) / ( ratio + Scalar( 1 ) ), n,
+										   getTolerance( Scalar( 1.0e-8 ) ) ) );
+		}
+
+		return minimumDeltaV == minimumDeltaV ? minimumDeltaV : noSolution;
+	}
+
+private:
+
+	static Scalar norm( const Scalar vector[ 3 ] )
+	{
+		using std::sqrt;
+		return sqrt( vector[ 0 ] * vector[ 0 ] + vector[ 1 ] * vector[ 1 ] + vector[ 2 ] * vector[ 2 ] );
+	}
+
+	static void cross( const Scalar first[ 3 ], const Scalar second[ 3 ], Scalar result[ 3 ] )
+	{
+		result[ 0 ] = first[ 1 ] * second[ 2 ] - first[ 2 ] * second[ 1 ];
+		result[ 1 ] = first[ 2 ] * second[ 0 ] - first[ 0 ] * second[ 2 ];
+		result[ 2 ] = first[ 0 ] * second[ 1 ] - first[ 1 ] * second[ 0 ];
+	}
+
+	//! Tolerance of PyKEP, raised to 16 units in the last place of Scalar.
+	static Scalar getTolerance( const Scalar tolerance )
+	{
+		return std::max( tolerance, Scalar( 16 ) * std::numeric_limits< Scalar >::epsilon( ) );
+	}
+
+	//! Non-dimensional time of flight of x with n revolutions (Lagrange, Battin or Lancaster form).
+	Scalar computeTimeOfFlight( const Scalar x, const int n ) const
+	{
+		using std::acos;
+		using std::log;
+		using std::pow;
+		using std::sqrt;
+
+		const Scalar pi = Scalar( 3.14159265358979323846 );
+		const Scalar distance = std::fabs( x - Scalar( 1 ) );
+		if( distance < Scalar( 0.2 ) && distance > Scalar( 0.01 ) )
+		{
+			return computeLagrangeTimeOfFlight( x, n );
+		}
+
+		const Scalar E = x * x - Scalar( 1 );
+		const Scalar rho = std::fabs( E );
+		const Scalar z = sqrt( Scalar( 1 ) + lambda2 * E );
+		if( distance < Scalar( 0.01 ) )
+		{
+			// Battin's series near the parabola
+			const Scalar eta = z - lambda * x;
+			const Scalar S1 = ( Scalar( 1 ) - lambda - x * eta ) / Scalar( 2 );
+			const Scalar Q = Scalar( 4 ) / Scalar( 3 ) * computeHypergeometricF( S1, getTolerance( Scalar( 1.0e-11 ) ) );
+			return ( eta * eta * eta * Q + Scalar( 4 ) * lambda * eta ) / Scalar( 2 ) + Scalar( n ) * pi / pow( rho, Scalar( 1.5 ) );
+		}
+
+		// Lancaster's expression
+		const Scalar y = sqrt( rho );
+		const Scalar g = x * z - lambda * E;
+		Scalar d;
+		if( E < Scalar( 0 ) )
+		{
+			d = Scalar( n ) * pi + acos( g );
+		}
+		else
+		{
+			const Scalar f = y * ( z - lambda * x );
+			d = log( f + g );
+		}
+		return ( x - lambda * z - d / y ) / E;
+	}
+
+	Scalar computeLagrangeTimeOfFlight( const Scalar x, const int n ) const
+	{
+		using std::acos;
+		using std::acosh;
+		using std::asin;
+		using std::asinh;
+		using std::sin;
+		using std::sinh;
+		using std::sqrt;
+
+		const Scalar pi = Scalar( 3.14159265358979323846 );
+		const Scalar a = Scalar( 1 ) / ( Scalar( 1 ) - x * x );
+		if( a > Scalar( 0 ) )
+		{
+			const Scalar alfa = Scalar( 2 ) * acos( x );
+			Scalar beta = Scalar( 2 ) * asin( sqrt( lambda2 / a ) );
+			if( lambda < Scalar( 0 ) )
+			{
+				beta = -beta;
+			}
+			return a * sqrt( a ) * ( ( alfa - sin( alfa ) ) - ( beta - sin( beta ) ) + Scalar( 2 ) * pi * Scalar( n ) ) / Scalar( 2 );
+		}
+		const Scalar alfa = Scalar( 2 ) * acosh( x );
+		Scalar beta = Scalar( 2 ) * asinh( sqrt( -lambda2 / a ) );
+		if( lambda < Scalar( 0 ) )
+		{
+			beta = -beta;
+		}
+		return -a * sqrt( -a ) * ( ( beta - sinh( beta ) ) - ( alfa - sinh( alfa ) ) ) / Scalar( 2 );
+	}
+
+	static Scalar computeHypergeometricF( const Scalar z, const Scalar tolerance )
+	{
+		Scalar sum = Scalar( 1 );
+		Scalar term = Scalar( 1 );
+		for( int j = 0; std::fabs( term ) > tolerance && j < 1000; j++ )
+		{
+			term = term * ( Scalar( 3 + j ) ) * ( Scalar( 1 + j ) ) / ( Scalar( 2.5 ) + Scalar( j ) ) * z / Scalar( j + 1 );
+			sum += term;
+		}
+		return sum;
+	}
+
+	//! First three derivatives of the time of flight T( x ).
+	void computeTimeDerivatives( const Scalar x, const Scalar T, Scalar& dT, Scalar& ddT, Scalar& dddT ) const
+	{
+		using std::sqrt;
+
+		const Scalar umx2 = Scalar( 1 ) - x * x;
+		const Scalar y = sqrt( Scalar( 1 ) - lambda2 * umx2 );
+		const Scalar y2 = y * y;
+		const Scalar y3 = y2 * y;
+		dT = Scalar( 1 ) / umx2 * ( Scalar( 3 ) * T * x - Scalar( 2 ) + Scalar( 2 ) * lambda3 * x / y );
+		ddT = Scalar( 1 ) / umx2 * ( Scalar( 3 ) * T + Scalar( 5 ) * x * dT + Scalar( 2 ) * ( Scalar( 1 ) - lambda2 ) * lambda3 / y3 );
+		dddT = Scalar( 1 ) / umx2 * ( Scalar( 7 ) * x * ddT + Scalar( 8 ) * dT
+									  - Scalar( 6 ) * ( Scalar( 1 ) - lambda2 ) * lambda2 * lambda3 * x / y3 / y2 );
+	}
+
+	//! Solve T( x ) = T with at most 15 Householder iterations from x0.
+	Scalar solveHouseholder( const Scalar T, Scalar x0, const int n, const Scalar tolerance ) const
+	{
+		Scalar error = Scalar( 1 );
+		for( int iteration = 0; error > tolerance && iteration < 15; iteration++ )
+		{
+			const Scalar timeOfFlight = computeTimeOfFlight( x0, n );
+			Scalar dT, ddT, dddT;
+			computeTimeDerivatives( x0, timeOfFlight, dT, ddT, dddT );
+			const Scalar delta = timeOfFlight - T;
+			const Scalar dT2 = dT * dT;
+			const Scalar xNew = x0 - delta * ( dT2 - delta * ddT / Scalar( 2 ) )
+									 / ( dT * ( dT2 - delta * ddT ) + dddT * delta * delta / Scalar( 6 ) );
+			error = std::fabs( x0 - xNew );
+			x0 = xNew;
+		}
+		return x0;
+	}
+
+	Scalar lambda;
+	Scalar lambda2;
+	Scalar lambda3;
+};
+
+} // namespace lambertKernel
+
+#endif // CPP_PROJECT_LAMBERT_KERNEL_HPP
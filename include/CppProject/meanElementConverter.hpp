@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_MEAN_ELEMENT_CONVERTER_HPP
+#define CPP_PROJECT_MEAN_ELEMENT_CONVERTER_HPP
+
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Tle.h>
+
+namespace meanElementConverter
+{
+
+typedef double Real;
+typedef std::vector< Real > Vector6;
+
+//! SGP4 mean elements as they appear in a TLE (angles in radians, Kozai mean motion in rev/day)
+struct SgpMeanElements
+{
+	Real inclination;
+	Real rightAscendingNode;
+	Real eccentricity;
+	Real argumentPerigee;
+	Real meanAnomaly;
+	Real meanMotion;
+};
+
+//! Convert an osculating Cartesian state to approximate SGP4 mean elements
+/*!
+ * Analytic inverse of the first-order J2 short-period corrections that SGP4 applies at the epoch
+ * (radius, argument of latitude, node, inclination and the radial and transverse velocities),
+ * followed by the inverse of the Kozai to Brouwer mean motion conversion done by SGP4 during
+ * initialisation. The J3 long-period terms and drag are neglected, so the result is not an exact
+ * SGP4 element set, but it is typically within a few hundred metres of one in LEO, which makes it a
+ * good starting point for the nonlinear TLE fit in ATOM.
+ * @param	const Vector6& cartesianState		TEME position [km] and velocity [km/s]
+ * @return	approximate SGP4 mean elements
+ * @throws	std::domain_error if the state is not on an elliptical orbit
+ */
+SgpMeanElements convertCartesianStateToMeanElements( const Vector6& cartesianState );
+
+//! Build a reference TLE for atom::convertCartesianStateToTwoLineElements from a Cartesian state
+/*!
+ * The name, NORAD number, designator and drag terms are taken from the template TLE; the epoch and
+ * the elements are replaced by the epoch and the analytic mean elements of the state.
+ * @param	const Vector6& cartesianState		TEME position [km] and velocity [km/s]
+ * @param	const DateTime& epoch				epoch of the state
+ * @param	const Tle& templateTle				TLE providing the non-orbital fields
+ * @return	reference TLE close to the solution of the nonlinear fit
+ */
+Tle createReferenceTle( const Vector6& cartesianState, const DateTime& epoch, const Tle& templateTle );
+
+//! Build a reference TLE without a template; the non-orbital fields are set to zero.
+Tle createReferenceTle( const Vector6& cartesianState, const DateTime& epoch );
+
+} // namespace meanElementConverter
+
+#endif // CPP_PROJECT_MEAN_ELEMENT_CONVERTER_HPP
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_MIXED_PRECISION_SCREENING_HPP
+#define CPP_PROJECT_MIXED_PRECISION_SCREENING_HPP
+
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/twoTierScreening.hpp"
+
+namespace mixedPrecisionScreening
+{
+
+typedef double Real;
+typedef float Single;
+
+//! SGP4 states of a list of epochs in single precision, stored component by component (structure of arrays)
+struct StateBlock
+{
+	int numberOfStates;
+	std::vector< Single > values;		// value ( component, state ) at component * numberOfStates + state; x, y, z [km], vx, vy, vz [km/s]
+};
+
+//! Propagate an object to a list of epochs with SGP4 in double precision and store the states in single precision.
+/*!
+ * States that SGP4 cannot compute (e.g. after decay) are stored as NaN.
+ */
+StateBlock sampleStates( const SGP4& propagator, const std::vector< DateTime >& epochs );
+
+//! Lambert delta-V of every cell of a pair grid in single precision
+/*!
+ * Evaluates lambertKernel::Solver< Single > on the states of the blocks, with the revolutions of
+ * lambertDeltaV::computeLambertDeltaV. Cells without a Lambert solution or with a NaN state get
+ * the largest Single.
+ * @param	const StateBlock& departureStates			states at the departure epochs
+ * @param	const StateBlock& arrivalStates				states at the arrival epochs, time of flight p of epoch l at l * timesOfFlight.size( ) + p
+ * @param	const std::vector< Real >& timesOfFlight	times of flight of the grid [s]
+ * @param	std::vector< Single >& deltaVs				returns the delta-V [km/s] of the cells, in the order of the arrival states
+ */
+void sweepDeltaV( const StateBlock& departureStates,
+				  const StateBlock& arrivalStates,
+				  const std::vector< Real >& timesOfFlight,
+				  std::vector< Single >& deltaVs );
+
+//! Settings of the single-precision screening
+struct ScreeningSettings
+{
+	int shortlistSize;				// cells per pair passed on to the double-precision path
+	Real deltaVMargin;				// [km/s], cells within this margin of the shortlist cut are passed on as well
+};
+
+//! Default settings: shortlist of 2000 cells and a margin of 1 m/s.
+ScreeningSettings getDefaultScreeningSettings( );
+
+//! Counterpart of twoTierScreening::screenTransferGrid on SGP4 states and Lambert delta-V in single precision
+/*!
+ * The states of the pair are propagated with SGP4 and stored in single precision, and the delta-V
+ * of every cell is computed in single precision. The shortlistSize cells with the lowest delta-V
+ * are returned, together with every further cell whose delta-V is within deltaVMargin of the last
+ * of them, so that cells the rounding error could have moved across the cut are kept. The shortlist
+ * is meant to be evaluated again in double precision, through SGP4 + Lambert + ATOM.
+ * @return	shortlisted cells, sorted by ascending single-precision delta-V
+ */
+std::vector< twoTierScreening::ScreeningCell > screenTransferGrid( const SGP4& departurePropagator,
+																   const SGP4& arrivalPropagator,
+																   const std::vector< DateTime >& departureEpochs,
+																   const std::vector< Real >& timesOfFlight,
+																   const ScreeningSettings& settings );
+
+//! Agreement between the single-precision screening and the double-precision Lambert ranking
+struct PrecisionCheck
+{
+	int numberOfPairs;
+	long numberOfCells;
+	Real maximumDeltaVDifference;			// [km/s], single vs. double precision, over the cells below maximumCheckedDeltaV
+	Real meanDeltaVDifference;				// [km/s]
+	Real meanShortlistSize;					// cells per pair, margin included
+	long numberOfTopCells;					// double-precision top cells checked, over all pairs
+	long numberOfDroppedTopCells;			// of those, cells missing from the single-precision shortlist
+	Real requiredMargin;					// [km/s], smallest margin that would have kept every top cell
+	Real singleSweepSeconds;				// Lambert delta-V of all cells with lambertKernel::Solver< Single >
+	Real doubleSweepSeconds;				// the same with lambertKernel::Solver< Real >
+};
+
+//! Delta-V of the cells included in the difference statistics of a PrecisionCheck [km/s]
+const Real maximumCheckedDeltaV = 20.0;
+
+//! Check that the single-precision screening keeps the best cells of the double-precision path
+/*!
+ * For every ordered pair of the catalog the full grid is evaluated with SGP4 states and the PyKEP
+ * Lambert solver of lambertDeltaV::computeLambertDeltaV in double precision, the path the grid search
+ * uses, and screened with screenTransferGrid. The check passes if none of the topCells best
+ * double-precision cells of any pair is missing from its shortlist.
+ * @param	const std::vector< Tle >& catalog					catalog of objects
+ * @param	const std::vector< DateTime >& departureEpochs		departure epochs of the grid
+ * @param	const std::vector< Real >& timesOfFlight			times of flight of the grid [s]
+ * @param	const ScreeningSettings& settings					screening settings
+ * @param	const int topCells									number of best double-precision cells checked per pair
+ * @return	agreement statistics
+ */
+PrecisionCheck checkScreeningPrecision( const std::vector< Tle >& catalog,
+										const std::vector< DateTime >& departureEpochs,
+										const std::vector< Real >& timesOfFlight,
+										const ScreeningSettings& settings,
+										const int topCells );
+
+} // namespace mixedPrecisionScreening
+
+#endif // CPP_PROJECT_MIXED_PRECISION_SCREENING_HPP
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_PAIR_TRAVERSAL_HPP
+#define CPP_PROJECT_PAIR_TRAVERSAL_HPP
+
+#include <string>
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Tle.h>
+
+namespace pairTraversal
+{
+
+typedef double Real;
+
+//! Order in which the cells of an all-pairs Lambert sweep are visited
+enum TraversalOrder
+{
+	objectOrder,		// departure object, departure epoch, arrival object, time of flight: the loop order of the grid search
+	blockedOrder		// tiles of departure objects x arrival objects x departure epochs, every state loaded once per tile
+};
+
+//! Name of an order as used on the command line: "object" or "blocked".
+const char* getOrderName( const TraversalOrder order );
+
+//! Order with a given name; throws std::runtime_error for an unknown name.
+TraversalOrder findOrder( const std::string& name );
+
+//! SGP4 states of a catalog on a uniform time grid, held in memory
+struct StateTable
+{
+	DateTime start;
+	Real sampleStep;				// [s]
+	int numberOfObjects;
+	int numberOfSamples;
+	std::vector< Real > values;		// x, y, z [km], vx, vy, vz [km/s] of ( object, sample ) from ( object * numberOfSamples + sample ) * 6; NaN where SGP4 failed
+};
+
+//! Sample the SGP4 states of a catalog; the objects are propagated in parallel.
+StateTable sampleStateTable( const std::vector< Tle >& catalog,
+							 const DateTime& start,
+							 const Real sampleStep,
+							 const int numberOfSamples,
+							 const int numberOfThreads );
+
+//! Grid and tile shape of a sweep; epochs and times of flight are counted in samples of the state table
+struct SweepSettings
+{
+	int numberOfDepartureEpochs;
+	int departureStride;			// samples between departure epochs, the first at sample 0
+	int numberOfTimesOfFlight;
+	int timeOfFlightStride;			// samples between times of flight, the first one stride long
+	int departureObjectsPerTile;
+	int arrivalObjectsPerTile;
+	int epochsPerTile;
+	int numberOfThreads;			// 0 for one thread per hardware thread
+};
+
+//! Default settings: 24 hourly departure epochs and 32 times of flight every 30 minutes on a 1-minute table,
+//! tiles of 8 departure objects x 8 arrival objects x 6 epochs.
+SweepSettings getDefaultSweepSettings( );
+
+//! Samples a state table needs to hold every cell of a sweep.
+int getNumberOfSamples( const SweepSettings& settings );
+
+//! Lowest-delta-V transfer of a departure object
+struct BestTransfer
+{
+	Real deltaV;					// [km/s], infinity if no transfer was solved
+	int arrivalIndex;
+	int departureSample;
+	int timeOfFlightSamples;
+};
+
+//! Hardware cache events of the process during a sweep, all threads included
+struct CacheCounters
+{
+	bool isAvailable;				// false if the kernel does not give access to the counters (perf_event_paranoid, containers)
+	long level1DataMisses;			// L1 data cache read misses
+	long lastLevelReferences;		// last-level cache references
+	long lastLevelMisses;			// last-level cache misses
+};
+
+//! Work, cache events and results of a sweep
+struct SweepResult
+{
+	std::vector< BestTransfer > bestTransfers;		// per departure object
+	long numberOfTransfers;
+	long numberOfStateLoads;		// states read from the table
+	long numberOfEndpoints;			// Lambert endpoints (state, radius and radial unit vector) computed
+	CacheCounters counters;
+	Real seconds;
+};
+
+//! Lowest Lambert delta-V transfer of every departure object over all arrival objects, epochs and times of flight
+/*!
+ * The object order loads the arrival state of every cell from the table and derives its Lambert
+ * endpoint again, so the states of all arrival objects pass through the cache once per departure
+ * epoch. The blocked order cuts the sweep into tiles of departure objects x arrival objects x
+ * departure epochs. For a tile, the endpoints of the departure states and of the arrival states
+ * are computed once; an arrival state that several (epoch, time of flight) cells share is computed
+ * once as well. All cells of the tile are then solved from these small buffers. Departure object
+ * rows (object order) or tile rows (blocked order) are spread over the threads. Both orders solve
+ * the same cells with lambertKernel::Solver< Real > and return the same transfers; ties in delta-V
+ * go to the lowest arrival index, departure sample and time of flight.
+ * @param	const StateTable& table				states of the catalog
+ * @param	const SweepSettings& settings		grid, tile shape and threads
+ * @param	const TraversalOrder order			order of the cells
+ * @return	best transfers, work counters, cache events and run time
+ */
+SweepResult sweepTransfers( const StateTable& table, const SweepSettings& settings, const TraversalOrder order );
+
+} // namespace pairTraversal
+
+#endif // CPP_PROJECT_PAIR_TRAVERSAL_HPP
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_PARALLEL_FOR_HPP
+#define CPP_PROJECT_PARALLEL_FOR_HPP
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace parallelFor
+{
+
+//! Number of threads to use when the caller does not specify one (0 or negative).
+inline int getNumberOfThreads( const int requestedThreads )
+{
+	if( requestedThreads > 0 )
+	{
+		return requestedThreads;
+	}
+	const int hardwareThreads = std::thread::hardware_concurrency( );
+	return hardwareThreads > 0 ? hardwareThreads : 1;
+}
+
+//! Split [0, count) into contiguous blocks and process them on separate threads
+/*!
+ * The function is called as function( begin, end, threadIndex ) once per thread, with the blocks
+ * assigned in order, so results written per thread index can be concatenated deterministically.
+ * With a single thread the function runs on the calling thread.
+ * @param	const int count				number of items
+ * @param	const int requestedThreads	number of threads, 0 for one per hardware thread
+ * @param	Function function			callable taking ( int begin, int end, int threadIndex )
+ */
+template< typename Function >
+void parallelFor( const int count, const int requestedThreads, Function function )
+{
+	const int numberOfThreads = std::max( 1, std::min( getNumberOfThreads( requestedThreads ), count ) );
+	if( numberOfThreads == 1 )
+	{
+		function( 0, count, 0 );
+		return;
+	}
+
+	std::vector< std::thread > threads;
+	for( int t = 0; t < numberOfThreads; t++ )
+	{
+		const int begin = static_cast< int >( static_cast< long long >( count ) * t / numberOfThreads );
+		const int end = static_cast< int >( static_cast< long long >( count ) * ( t + 1 ) / numberOfThreads );
+		threads.push_back( std::thread( function, begin, end, t ) );
+	}
+	for( unsigned int t = 0; t < threads.size( ); t++ )
+	{
+		threads[ t ].join( );
+	}
+}
+
+} // namespace parallelFor
+
+#endif // CPP_PROJECT_PARALLEL_FOR_HPP
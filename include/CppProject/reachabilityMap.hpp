@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_REACHABILITY_MAP_HPP
+#define CPP_PROJECT_REACHABILITY_MAP_HPP
+
+#include <string>
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/j2Propagator.hpp"
+
+namespace reachabilityMap
+{
+
+typedef double Real;
+
+//! Departure object, window and delta-V budget of a reachability query
+struct ReachabilityQuery
+{
+	int departureIndex;					// index of the departure object in the catalog
+	DateTime windowStart;
+	Real windowLength;					// [s], departure epochs from windowStart on, every departureStep
+	Real departureStep;					// [s]
+	Real minimumTimeOfFlight;			// [s]
+	Real maximumTimeOfFlight;			// [s]
+	Real timeOfFlightStep;				// [s]
+	Real deltaVBudget;					// [km/s], two-impulse Lambert delta-V
+	Real boundMargin;					// [km/s], slack on the analytic bounds for the mean vs. osculating elements
+	bool useBounds;						// false to sweep every target, e.g. to check the bounds
+	bool stopAtFirstReachableEpoch;		// stop a target after the first departure epoch that reaches it within the budget
+	int numberOfThreads;				// 0 for one thread per hardware thread
+};
+
+//! Default query: object 0, 500 m/s over two weeks from 2016-02-01, hourly departures, times of flight of
+//! 10 minutes to 12 hours every 10 minutes, bounds with a margin of 20 m/s, lowest delta-V over the whole window.
+ReachabilityQuery getDefaultReachabilityQuery( );
+
+//! Number of departure epochs of a query.
+int getNumberOfDepartureEpochs( const ReachabilityQuery& query );
+
+//! Number of times of flight of a query.
+int getNumberOfTimesOfFlight( const ReachabilityQuery& query );
+
+//! Analytic lower bounds on the two-impulse delta-V between two orbits [km/s]
+struct TransferBounds
+{
+	Real energyBound;					// change of orbital energy, impulses at the highest speed of either orbit
+	Real planeBound;					// smallest angle between the orbit planes over the window, J2 node drift included
+};
+
+//! Lower bounds on the delta-V of any transfer from one orbit to another in the window of a query
+/*!
+ * Both bounds hold for every two-impulse transfer between the orbits, whatever the epochs and the
+ * time of flight:
+ *  - an impulse dv at speed v changes the specific energy by at most v dv + dv^2 / 2, so the energy
+ *    gap between the orbits needs at least sqrt( v^2 + 2 |gap| ) - v, with v the perigee speed of
+ *    the faster orbit (the Hohmann-like bound);
+ *  - the transfer plane contains both position vectors, so the impulses have to turn the velocity
+ *    through the angle between the orbit planes; an impulse that turns the plane by an angle a
+ *    costs at least the transverse speed times sin( a ), and the transverse speed is at least the
+ *    apogee speed h / r_a.
+ * The plane angle is taken at its smallest over the window: the nodes drift at their J2 rates, the
+ * departure over the departure epochs and the arrival over the departure epochs plus the times of
+ * flight. The bounds use the SGP4 mean elements, which differ slightly from the osculating states
+ * of the sweep; ReachabilityQuery::boundMargin absorbs the difference.
+ * @param	const j2Propagator::MeanElements& departure		mean elements of the departure object
+ * @param	const j2Propagator::MeanElements& arrival		mean elements of the target
+ * @param	const ReachabilityQuery& query					window of the query
+ * @return	lower bounds on the delta-V [km/s]
+ */
+TransferBounds computeTransferBounds( const j2Propagator::MeanElements& departure,
+									  const j2Propagator::MeanElements& arrival,
+									  const ReachabilityQuery& query );
+
+//! Outcome of a target of a reachability query
+enum TargetStatus
+{
+	energyPruned,			// energy bound above the budget, no Lambert solve
+	planePruned,			// plane bound above the budget, no Lambert solve
+	unreachable,			// swept, no transfer within the budget
+	reachable				// swept, transfer within the budget found
+};
+
+//! Name of a status: "energy-pruned", "plane-pruned", "unreachable" or "reachable".
+const char* getStatusName( const TargetStatus status );
+
+//! Outcome and best transfer found for a target
+struct TargetResult
+{
+	int targetIndex;
+	TargetStatus status;
+	TransferBounds bounds;
+	Real deltaV;						// [km/s] of the best transfer swept, infinity if the target was pruned or never solved
+	int departureEpochIndex;			// departure at windowStart + departureEpochIndex * departureStep
+	Real timeOfFlight;					// [s]
+	long numberOfTransfers;				// Lambert solves spent on the target
+};
+
+//! Reachable set of a departure object
+struct ReachabilityMap
+{
+	int departureIndex;
+	std::vector< TargetResult > targets;	// every other object of the catalog, in catalog order
+	int numberOfReachable;
+	long numberOfGridCells;					// cells a full grid of the window would solve for the targets
+	long numberOfTransfers;					// Lambert solves done
+	Real boundSeconds;
+	Real sweepSeconds;
+};
+
+//! Find every object of a catalog a departure object reaches within a delta-V budget over a window
+/*!
+ * Targets whose analytic bounds exceed the budget by more than the margin are discarded first. The
+ * remaining targets are swept on the grid of the query with SGP4 states and
+ * lambertKernel::Solver< Real >, one target at a time per thread, the threads taking the next target
+ * as they finish. Departure epochs are swept in order; with stopAtFirstReachableEpoch the sweep of a
+ * target ends with the first epoch that has a transfer within the budget, and the best transfer of
+ * that epoch is returned: the earliest departure within the budget, not the lowest delta-V of the
+ * window. Otherwise the lowest delta-V of the whole grid is returned.
+ * @param	const std::vector< Tle >& catalog		catalog of objects
+ * @param	const ReachabilityQuery& query			departure object, window, grid and budget
+ * @return	outcome of every target
+ */
+ReachabilityMap computeReachabilityMap( const std::vector< Tle >& catalog, const ReachabilityQuery& query );
+
+//! Write the targets of a map as CSV: NORAD number, status, bounds, delta-V, departure epoch and time of flight.
+void writeReachabilityMap( const std::string& path,
+						   const std::vector< Tle >& catalog,
+						   const ReachabilityQuery& query,
+						   const ReachabilityMap& map );
+
+} // namespace reachabilityMap
+
+#endif // CPP_PROJECT_REACHABILITY_MAP_HPP
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_RESULTS_STORE_HPP
+#define CPP_PROJECT_RESULTS_STORE_HPP
+
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include <libsgp4/DateTime.h>
+
+namespace resultsStore
+{
+
+typedef double Real;
+
+//! One row of an Atom_Solver_*.csv result file
+struct ResultRecord
+{
+	boost::int32_t departureObjectId;
+	boost::int32_t arrivalObjectId;
+	boost::int64_t departureEpochTicks;		// DateTime ticks
+	Real timeOfFlight;						// [s]
+	Real atomDeltaV;						// [km/s]
+	Real lambertDeltaV;						// [km/s]
+};
+
+//! Row counts gathered while ingesting result files
+struct IngestionSummary
+{
+	int numberOfFiles;
+	long numberOfRows;
+	long numberOfHeaderRows;
+	long numberOfMalformedRows;
+};
+
+//! Index entry and precomputed statistics of one departure-arrival pair
+/*!
+ * The records of the pair are [ begin, end ) in the store, sorted on epoch and time-of-flight.
+ * The delta-V gain is the Lambert delta-V minus the ATOM delta-V of a record.
+ */
+struct PairSummary
+{
+	int departureObjectId;
+	int arrivalObjectId;
+	unsigned int begin;
+	unsigned int end;
+	unsigned int bestIndex;					// record with the lowest ATOM delta-V
+	int numberOfAtomWins;					// records where ATOM beats Lambert
+	Real meanDeltaVGain;
+	Real maximumDeltaVGain;
+};
+
+//! Histogram of the time-of-flight of the records of a pair
+struct TimeOfFlightHistogram
+{
+	Real firstBinStart;						// [s]
+	Real binWidth;							// [s]
+	std::vector< int > counts;
+};
+
+//! Parse all given result files in parallel
+/*!
+ * Each file is split into newline-aligned chunks that are parsed on separate threads. Repeated
+ * header lines (left behind by runs that appended to the same file) are skipped; rows that cannot be
+ * parsed are counted as malformed and skipped. Missing files are reported and skipped.
+ * @param	const std::vector< std::string >& paths		result files
+ * @param	IngestionSummary& summary					row counts
+ * @param	const int numberOfThreads					0 for one thread per hardware thread
+ * @return	records in file order, duplicates included
+ */
+std::vector< ResultRecord > readResultFiles( const std::vector< std::string >& paths,
+											 IngestionSummary& summary,
+											 const int numberOfThreads = 0 );
+
+//! Deduplicated results indexed by departure-arrival pair and departure epoch
+/*!
+ * Records sharing departure ID, arrival ID, departure epoch and time-of-flight are merged, keeping
+ * the one with the lowest ATOM delta-V.
+ */
+class ResultsStore
+{
+public:
+
+	ResultsStore( );
+
+	//! Merge and index the given records.
+	explicit ResultsStore( std::vector< ResultRecord > records );
+
+	const std::vector< ResultRecord >& records( ) const { return storedRecords; }
+
+	const std::vector< PairSummary >& pairs( ) const { return pairIndex; }
+
+	//! Number of records dropped as duplicates when the store was built.
+	long numberOfDuplicates( ) const { return duplicateCount; }
+
+	//! Index entry of a pair, or NULL if the store holds no results for it.
+	const PairSummary* findPair( const int departureObjectId, const int arrivalObjectId ) const;
+
+	//! Record with the lowest ATOM delta-V of a pair, or NULL if the store holds no results for it.
+	const ResultRecord* findMinimumDeltaV( const int departureObjectId, const int arrivalObjectId ) const;
+
+	//! Records of a pair at a departure epoch, sorted on time-of-flight (empty if there are none).
+	std::vector< ResultRecord > findEpoch( const int departureObjectId,
+										   const int arrivalObjectId,
+										   const DateTime& departureEpoch ) const;
+
+	//! Histogram of the time-of-flight of the records of a pair (empty if there are none).
+	TimeOfFlightHistogram computeTimeOfFlightHistogram( const int departureObjectId,
+														const int arrivalObjectId,
+														const Real binWidth ) const;
+
+private:
+
+	void buildIndex( );
+
+	std::vector< ResultRecord > storedRecords;
+	std::vector< PairSummary > pairIndex;
+	long duplicateCount;
+};
+
+//! Default location of the store built from the result files in a directory.
+std::string getResultsStorePath( const std::string& directory );
+
+//! Write a results store to a binary file.
+void writeResultsStore( const std::string& path, const ResultsStore& store );
+
+//! Read a results store from a binary file.
+/*!
+ * @throws std::runtime_error if the file cannot be read or is not a results store
+ */
+ResultsStore readResultsStore( const std::string& path );
+
+} // namespace resultsStore
+
+#endif // CPP_PROJECT_RESULTS_STORE_HPP
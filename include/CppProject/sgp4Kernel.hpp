@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_SGP4_KERNEL_HPP
+#define CPP_PROJECT_SGP4_KERNEL_HPP
+
+#include <cmath>
+#include <stdexcept>
+
+#include <libsgp4/Globals.h>
+
+namespace sgp4Kernel
+{
+
+//! SGP4 mean elements as they appear in a TLE, plus the drag term
+/*!
+ * Same units as meanElementConverter::SgpMeanElements: angles in radians and the Kozai mean motion
+ * in rev/day.
+ */
+template< typename Scalar >
+struct MeanElements
+{
+	Scalar inclination;
+	Scalar rightAscendingNode;
+	Scalar eccentricity;
+	Scalar argumentPerigee;
+	Scalar meanAnomaly;
+	Scalar meanMotion;
+	Scalar bStar;				// [1/earth radii]
+};
+
+//! Near-earth SGP4 propagator that is initialised from mean elements instead of a Tle
+/*!
+ * Implements the near-earth branch of SGP4 (orbital period below 225 minutes) with the WGS-72
+ * constants of libsgp4, following the structure of libsgp4's SGP4 class. It exists so that solvers
+ * can re-initialise one propagator object with trial elements at full precision; a Tle can only be
+ * built from text, which truncates the elements to the TLE format. The scalar type is a template
+ * parameter so the kernel can also be evaluated in other arithmetic types; math functions are called
+ * unqualified for that reason.
+ */
+template< typename Scalar >
+class Propagator
+{
+public:
+
+	//! Initialise the propagator; throws std::domain_error for deep-space orbits and invalid elements.
+	void initialise( const MeanElements< Scalar >& meanElements )
+	{
+		using std::cos;
+		using std::fabs;
+		using std::pow;
+		using std::sin;
+		using std::sqrt;
+
+		elements = meanElements;
+		if( !( elements.eccentricity >= 0.0 ) || !( elements.eccentricity < 1.0 ) || !( elements.meanMotion > 0.0 ) )
+		{
+			throw std::domain_error( "SGP4 kernel requires 0 <= e < 1 and a positive mean motion" );
+		}
+
+		// recover the original mean motion and semi-major axis from the Kozai mean motion
+		const Scalar meanMotion = elements.meanMotion * kTWOPI / kMINUTES_PER_DAY;
+		const Scalar a1 = pow( kXKE / meanMotion, kTWOTHIRD );
+		cosio = cos( elements.inclination );
+		sinio = sin( elements.inclination );
+		const Scalar theta2 = cosio * cosio;
+		x3thm1 = 3.0 * theta2 - 1.0;
+		const Scalar eosq = elements.eccentricity * elements.eccentricity;
+		const Scalar betao2 = 1.0 - eosq;
+		const Scalar betao = sqrt( betao2 );
+		const Scalar temp = ( 1.5 * kCK2 ) * x3thm1 / ( betao * betao2 );
+		const Scalar del1 = temp / ( a1 * a1 );
+		const Scalar a0 = a1 * ( 1.0 - del1 * ( 1.0 / 3.0 + del1 * ( 1.0 + del1 * 134.0 / 81.0 ) ) );
+		const Scalar del0 = temp / ( a0 * a0 );
+		recoveredMeanMotion = meanMotion / ( 1.0 + del0 );
+		recoveredSemiMajorAxis = a0 / ( 1.0 - del0 );
+
+		const Scalar perigee = ( recoveredSemiMajorAxis * ( 1.0 - elements.eccentricity ) - kAE ) * kXKMPER;
+		if( kTWOPI / recoveredMeanMotion >= 225.0 )
+		{
+			throw std::domain_error( "SGP4 kernel only implements near-earth orbits (period below 225 min)" );
+		}
+
+		// density parameters for low perigees
+		Scalar s4 = kS;
+		Scalar qoms24 = kQOMS2T;
+		if( perigee < 156.0 )
+		{
+			s4 = perigee - 78.0;
+			if( perigee < 98.0 )
+			{
+				s4 = 20.0;
+			}
+			qoms24 = pow( ( 120.0 - s4 ) * kAE / kXKMPER, 4.0 );
+			s4 = s4 / kXKMPER + kAE;
+		}
+
+		const Scalar pinvsq = 1.0 / ( recoveredSemiMajorAxis * recoveredSemiMajorAxis * betao2 * betao2 );
+		const Scalar tsi = 1.0 / ( recoveredSemiMajorAxis - s4 );
+		eta = recoveredSemiMajorAxis * elements.eccentricity * tsi;
+		const Scalar etasq = eta * eta;
+		const Scalar eeta = elements.eccentricity * eta;
+		const Scalar psisq = fabs( 1.0 - etasq );
+		const Scalar coef = qoms24 * pow( tsi, 4.0 );
+		const Scalar coef1 = coef / pow( psisq, 3.5 );
+		const Scalar c2 = coef1 * recoveredMeanMotion
+						  * ( recoveredSemiMajorAxis * ( 1.0 + 1.5 * etasq + eeta * ( 4.0 + etasq ) )
+							  + 0.75 * kCK2 * tsi / psisq * x3thm1 * ( 8.0 + 3.0 * etasq * ( 8.0 + etasq ) ) );
+		c1 = elements.bStar * c2;
+		x1mth2 = 1.0 - theta2;
+		c4 = 2.0 * recoveredMeanMotion * coef1 * recoveredSemiMajorAxis * betao2
+			 * ( eta * ( 2.0 + 0.5 * etasq ) + elements.eccentricity * ( 0.5 + 2.0 * etasq )
+				 - 2.0 * kCK2 * tsi / ( recoveredSemiMajorAxis * psisq )
+				   * ( -3.0 * x3thm1 * ( 1.0 - 2.0 * eeta + etasq * ( 1.5 - 0.5 * eeta ) )
+					   + 0.75 * x1mth2 * ( 2.0 * etasq - eeta * ( 1.0 + etasq ) ) * cos( 2.0 * elements.argumentPerigee ) ) );
+		c5 = 2.0 * coef1 * recoveredSemiMajorAxis * betao2 * ( 1.0 + 2.75 * ( etasq + eeta ) + eeta * etasq );
+
+		// secular rates
+		const Scalar theta4 = theta2 * theta2;
+		const Scalar temp1 = 3.0 * kCK2 * pinvsq * recoveredMeanMotion;
+		const Scalar temp2 = temp1 * kCK2 * pinvsq;
+		const Scalar temp3 = 1.25 * kCK4 * pinvsq * pinvsq * recoveredMeanMotion;
+		meanAnomalyRate = recoveredMeanMotion + 0.5 * temp1 * betao * x3thm1
+						  + 0.0625 * temp2 * betao * ( 13.0 - 78.0 * theta2 + 137.0 * theta4 );
+		const Scalar x1m5th = 1.0 - 5.0 * theta2;
+		argumentPerigeeRate = -0.5 * temp1 * x1m5th + 0.0625 * temp2 * ( 7.0 - 114.0 * theta2 + 395.0 * theta4 )
+							  + temp3 * ( 3.0 - 36.0 * theta2 + 49.0 * theta4 );
+		const Scalar xhdot1 = -temp1 * cosio;
+		rightAscendingNodeRate = xhdot1 + ( 0.5 * temp2 * ( 4.0 - 19.0 * theta2 ) + 2.0 * temp3 * ( 3.0 - 7.0 * theta2 ) ) * cosio;
+		nodeDragCoefficient = 3.5 * betao2 * xhdot1 * c1;
+		t2cof = 1.5 * c1;
+
+		// long-period J3 coefficients; the 1 + cos( i ) divisor is bounded for retrograde equatorial orbits
+		const Scalar a3ovk2 = -kXJ3 / kCK2 * kAE * kAE * kAE;
+		const Scalar divisor = fabs( cosio + 1.0 ) > 1.5e-12 ? Scalar( 1.0 + cosio ) : Scalar( 1.5e-12 );
+		xlcof = 0.125 * a3ovk2 * sinio * ( 3.0 + 5.0 * cosio ) / divisor;
+		aycof = 0.25 * a3ovk2 * sinio;
+		x7thm1 = 7.0 * theta2 - 1.0;
+
+		Scalar c3 = 0.0;
+		xmcof = 0.0;
+		if( elements.eccentricity > 1.0e-4 )
+		{
+			c3 = coef * tsi * a3ovk2 * recoveredMeanMotion * kAE * sinio / elements.eccentricity;
+			xmcof = -kTWOTHIRD * coef * elements.bStar * kAE / eeta;
+		}
+		omgcof = elements.bStar * c3 * cos( elements.argumentPerigee );
+		delmo = pow( 1.0 + eta * cos( elements.meanAnomaly ), 3.0 );
+		sinmo = sin( elements.meanAnomaly );
+
+		// the higher-order drag terms are dropped for perigees below 220 km
+		useSimpleModel = perigee < 220.0;
+		if( !useSimpleModel )
+		{
+			const Scalar c1sq = c1 * c1;
+			d2 = 4.0 * recoveredSemiMajorAxis * tsi * c1sq;
+			const Scalar temp4 = d2 * tsi * c1 / 3.0;
+			d3 = ( 17.0 * recoveredSemiMajorAxis + s4 ) * temp4;
+			d4 = 0.5 * temp4 * recoveredSemiMajorAxis * tsi * ( 221.0 * recoveredSemiMajorAxis + 31.0 * s4 ) * c1;
+			t3cof = d2 + 2.0 * c1sq;
+			t4cof = 0.25 * ( 3.0 * d3 + c1 * ( 12.0 * d2 + 10.0 * c1sq ) );
+			t5cof = 0.2 * ( 3.0 * d4 + 12.0 * c1 * d3 + 6.0 * d2 * d2 + 15.0 * c1sq * ( 2.0 * d2 + c1sq ) );
+		}
+	}
+
+	//! TEME position [km] and velocity [km/s] at a time since the element epoch [min]
+	/*!
+	 * Throws std::domain_error if the elements become invalid or the satellite has decayed.
+	 */
+	void findState( const Scalar& minutesSinceEpoch, Scalar position[ 3 ], Scalar velocity[ 3 ] ) const
+	{
+		using std::cos;
+		using std::fabs;
+		using std::fmod;
+		using std::pow;
+		using std::sin;
+		using std::sqrt;
+		using std::atan2;
+
+		const Scalar& tsince = minutesSinceEpoch;
+
+		// secular gravity and atmospheric drag
+		const Scalar xmdf = elements.meanAnomaly + meanAnomalyRate * tsince;
+		const Scalar omgadf = elements.argumentPerigee + argumentPerigeeRate * tsince;
+		const Scalar xnoddf = elements.rightAscendingNode + rightAscendingNodeRate * tsince;
+		Scalar omega = omgadf;
+		Scalar xmp = xmdf;
+		const Scalar tsq = tsince * tsince;
+		const Scalar xnode = xnoddf + nodeDragCoefficient * tsq;
+		Scalar tempa = 1.0 - c1 * tsince;
+		Scalar tempe = elements.bStar * c4 * tsince;
+		Scalar templ = t2cof * tsq;
+		if( !useSimpleModel )
+		{
+			const Scalar delomg = omgcof * tsince;
+			const Scalar delm = xmcof * ( pow( 1.0 + eta * cos( xmdf ), 3.0 ) - delmo );
+			const Scalar temp = delomg + delm;
+			xmp = xmdf + temp;
+			omega = omgadf - temp;
+			const Scalar tcube = tsq * tsince;
+			const Scalar tfour = tsince * tcube;
+			tempa = tempa - d2 * tsq - d3 * tcube - d4 * tfour;
+			tempe = tempe + elements.bStar * c5 * ( sin( xmp ) - sinmo );
+			templ = templ + t3cof * tcube + tfour * ( t4cof + tsince * t5cof );
+		}
+
+		const Scalar a = recoveredSemiMajorAxis * tempa * tempa;
+		Scalar e = elements.eccentricity - tempe;
+		if( !( e < 1.0 ) || e < -1.0e-3 )
+		{
+			throw std::domain_error( "SGP4 kernel: eccentricity out of range" );
+		}
+		if( e < 1.0e-6 )
+		{
+			e = 1.0e-6;
+		}
+		const Scalar xl = xmp + omega + xnode + recoveredMeanMotion * templ;
+
+		// long-period periodics
+		const Scalar beta2 = 1.0 - e * e;
+		const Scalar xn = kXKE / pow( a, 1.5 );
+		const Scalar axn = e * cos( omega );
+		const Scalar temp11 = 1.0 / ( a * beta2 );
+		const Scalar xll = temp11 * xlcof * axn;
+		const Scalar aynl = temp11 * aycof;
+		const Scalar xlt = xl + xll;
+		const Scalar ayn = e * sin( omega ) + aynl;
+		const Scalar elsq = axn * axn + ayn * ayn;
+		if( !( elsq < 1.0 ) )
+		{
+			throw std::domain_error( "SGP4 kernel: eccentricity out of range" );
+		}
+
+		// Kepler's equation in the equinoctial form
+		const Scalar capu = fmod( xlt - xnode, kTWOPI );
+		Scalar epw = capu;
+		Scalar sinepw = 0.0;
+		Scalar cosepw = 0.0;
+		Scalar ecose = 0.0;
+		Scalar esine = 0.0;
+		const Scalar maximumNewtonRaphson = 1.25 * fabs( sqrt( elsq ) );
+		bool isKeplerRunning = true;
+		for( int i = 0; i < 10 && isKeplerRunning; i++ )
+		{
+			sinepw = sin( epw );
+			cosepw = cos( epw );
+			ecose = axn * cosepw + ayn * sinepw;
+			esine = axn * sinepw - ayn * cosepw;
+			const Scalar f = capu - epw + esine;
+			if( fabs( f ) < 1.0e-12 )
+			{
+				isKeplerRunning = false;
+			}
+			else
+			{
+				const Scalar fdot = 1.0 - ecose;
+				Scalar deltaEpw = f / fdot;
+				if( i == 0 )
+				{
+					if( deltaEpw > maximumNewtonRaphson )
+					{
+						deltaEpw = maximumNewtonRaphson;
+					}
+					else if( deltaEpw < -maximumNewtonRaphson )
+					{
+						deltaEpw = -maximumNewtonRaphson;
+					}
+				}
+				else
+				{
+					deltaEpw = f / ( fdot + 0.5 * esine * deltaEpw );
+				}
+				epw = epw + deltaEpw;
+			}
+		}
+
+		// short-period preliminary quantities
+		const Scalar temp21 = 1.0 - elsq;
+		const Scalar pl = a * temp21;
+		if( pl < 0.0 )
+		{
+			throw std::domain_error( "SGP4 kernel: negative semi-latus rectum" );
+		}
+		const Scalar r = a * ( 1.0 - ecose );
+		const Scalar temp31 = 1.0 / r;
+		const Scalar rdot = kXKE * sqrt( a ) * esine * temp31;
+		const Scalar rfdot = kXKE * sqrt( pl ) * temp31;
+		const Scalar temp32 = a * temp31;
+		const Scalar betal = sqrt( temp21 );
+		const Scalar temp33 = 1.0 / ( 1.0 + betal );
+		const Scalar cosu = temp32 * ( cosepw - axn + ayn * esine * temp33 );
+		const Scalar sinu = temp32 * ( sinepw - ayn - axn * esine * temp33 );
+		const Scalar u = atan2( sinu, cosu );
+		const Scalar sin2u = 2.0 * sinu * cosu;
+		const Scalar cos2u = 2.0 * cosu * cosu - 1.0;
+
+		// short-period periodics
+		const Scalar temp41 = 1.0 / pl;
+		const Scalar temp42 = kCK2 * temp41;
+		const Scalar temp43 = temp42 * temp41;
+		const Scalar rk = r * ( 1.0 - 1.5 * temp43 * betal * x3thm1 ) + 0.5 * temp42 * x1mth2 * cos2u;
+		const Scalar uk = u - 0.25 * temp43 * x7thm1 * sin2u;
+		const Scalar xnodek = xnode + 1.5 * temp43 * cosio * sin2u;
+		const Scalar xinck = elements.inclination + 1.5 * temp43 * cosio * sinio * cos2u;
+		const Scalar rdotk = rdot - xn * temp42 * x1mth2 * sin2u;
+		const Scalar rfdotk = rfdot + xn * temp42 * ( x1mth2 * cos2u + 1.5 * x3thm1 );
+		if( rk < 1.0 )
+		{
+			throw std::domain_error( "SGP4 kernel: satellite has decayed" );
+		}
+
+		// orientation vectors
+		const Scalar sinuk = sin( uk );
+		const Scalar cosuk = cos( uk );
+		const Scalar sinik = sin( xinck );
+		const Scalar cosik = cos( xinck );
+		const Scalar sinnok = sin( xnodek );
+		const Scalar cosnok = cos( xnodek );
+		const Scalar xmx = -sinnok * cosik;
+		const Scalar xmy = cosnok * cosik;
+		const Scalar ux = xmx * sinuk + cosnok * cosuk;
+		const Scalar uy = xmy * sinuk + sinnok * cosuk;
+		const Scalar uz = sinik * sinuk;
+		const Scalar vx = xmx * cosuk - cosnok * sinuk;
+		const Scalar vy = xmy * cosuk - sinnok * sinuk;
+		const Scalar vz = sinik * cosuk;
+
+		position[ 0 ] = rk * ux * kXKMPER;
+		position[ 1 ] = rk * uy * kXKMPER;
+		position[ 2 ] = rk * uz * kXKMPER;
+		velocity[ 0 ] = ( rdotk * ux + rfdotk * vx ) * kXKMPER / 60.0;
+		velocity[ 1 ] = ( rdotk * uy + rfdotk * vy ) * kXKMPER / 60.0;
+		velocity[ 2 ] = ( rdotk * uz + rfdotk * vz ) * kXKMPER / 60.0;
+	}
+
+	//! Elements the propagator was initialised with.
+	const MeanElements< Scalar >& getElements( ) const
+	{
+		return elements;
+	}
+
+private:
+
+	MeanElements< Scalar > elements;
+	Scalar recoveredMeanMotion;			// [rad/min]
+	Scalar recoveredSemiMajorAxis;		// [earth radii]
+	Scalar cosio, sinio;
+	Scalar x3thm1, x1mth2, x7thm1;
+	Scalar eta;
+	Scalar c1, c4, c5;
+	Scalar meanAnomalyRate, argumentPerigeeRate, rightAscendingNodeRate;
+	Scalar nodeDragCoefficient;
+	Scalar t2cof, t3cof, t4cof, t5cof;
+	Scalar xlcof, aycof;
+	Scalar omgcof, xmcof, delmo, sinmo;
+	Scalar d2, d3, d4;
+	bool useSimpleModel;
+};
+
+} // namespace sgp4Kernel
+
+#endif // CPP_PROJECT_SGP4_KERNEL_HPP
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_TILED_EPHEMERIS_HPP
+#define CPP_PROJECT_TILED_EPHEMERIS_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Tle.h>
+
+namespace tiledEphemeris
+{
+
+typedef double Real;
+
+//! Number of stored state components: x, y, z [km], vx, vy, vz [km/s]
+const int numberOfComponents = 6;
+
+//! Layout of a tiled ephemeris file
+/*!
+ * The sampled states form a grid of objects x time samples that is cut into tiles of
+ * objectsPerBlock objects by samplesPerBlock samples. A tile stores its states component by
+ * component (structure of arrays): all x values of the first object, then of the second object, and
+ * so on, followed by the y values. Tiles are stored time block by time block, so the tiles of one
+ * time block (a "column") are contiguous in the file, and each tile starts on a page boundary.
+ * Partial blocks at the end of the catalog or window are padded; samples that SGP4 could not
+ * compute (e.g. after decay) are stored as NaN.
+ */
+struct TileLayout
+{
+	DateTime windowStart;
+	Real sampleStep;				// [s]
+	int numberOfSamples;
+	int numberOfObjects;
+	int objectsPerBlock;
+	int samplesPerBlock;
+
+	int getNumberOfObjectBlocks( ) const;
+
+	int getNumberOfTimeBlocks( ) const;
+
+	//! Bytes of the state values of one tile, without page padding.
+	std::size_t getTileValueBytes( ) const;
+};
+
+//! Default location of the tiled ephemeris file that belongs to a catalog (stored next to it).
+std::string getTiledEphemerisPath( const std::string& catalogPath );
+
+//! Sample the SGP4 states of a catalog over a window and write them as a tiled ephemeris file
+/*!
+ * Only one block of objects is held in memory while writing, so the file can be much larger than
+ * the available memory. The objects of a block are propagated in parallel.
+ * @param	const std::string& path				path of the file to write
+ * @param	const std::vector< Tle >& catalog	objects to sample
+ * @param	const DateTime& windowStart			epoch of the first sample
+ * @param	const Real windowMinutes			length of the window [min]; the last sample is at or before its end
+ * @param	const Real sampleStep				time between samples [s]
+ * @param	const int objectsPerBlock			objects per tile
+ * @param	const int samplesPerBlock			time samples per tile
+ * @param	const int numberOfThreads			number of threads, 0 for one per hardware thread
+ * @return	layout of the written file
+ */
+TileLayout writeTiledEphemeris( const std::string& path,
+								const std::vector< Tle >& catalog,
+								const DateTime& windowStart,
+								const Real windowMinutes,
+								const Real sampleStep,
+								const int objectsPerBlock,
+								const int samplesPerBlock,
+								const int numberOfThreads );
+
+//! Read-only memory-mapped view of a tiled ephemeris file
+/*!
+ * Pages are read by the operating system when a tile is first touched; prefetchTimeBlock asks for
+ * a whole column to be read ahead and releaseTimeBlock lets its pages go, so the resident set can
+ * be kept to the columns in use.
+ */
+class TiledEphemeris
+{
+public:
+
+	//! Map a tiled ephemeris file; throws std::runtime_error if it cannot be mapped or is not one.
+	explicit TiledEphemeris( const std::string& path );
+
+	~TiledEphemeris( );
+
+	const TileLayout& getLayout( ) const
+	{
+		return layout;
+	}
+
+	const std::vector< unsigned int >& getNoradNumbers( ) const
+	{
+		return noradNumbers;
+	}
+
+	//! First value of a tile; value ( component, object, sample ) is at ( component * objectsPerBlock + object ) * samplesPerBlock + sample.
+	const Real* findTile( const int objectBlock, const int timeBlock ) const;
+
+	//! State of an object at a sample: position [km] and velocity [km/s], NaN where SGP4 failed.
+	void findState( const int objectIndex, const int sampleIndex, Real position[ 3 ], Real velocity[ 3 ] ) const;
+
+	//! Ask the operating system to read the tiles of a time block ahead of use.
+	void prefetchTimeBlock( const int timeBlock ) const;
+
+	//! Tell the operating system that the tiles of a time block are no longer needed.
+	void releaseTimeBlock( const int timeBlock ) const;
+
+	//! Bytes of one column (all tiles of a time block) in the file, page padding included.
+	std::size_t getTimeBlockBytes( ) const;
+
+private:
+
+	TiledEphemeris( const TiledEphemeris& );
+
+	TiledEphemeris& operator=( const TiledEphemeris& );
+
+	TileLayout layout;
+	std::vector< unsigned int > noradNumbers;
+	int fileDescriptor;
+	char* mapping;
+	std::size_t mappingBytes;
+	std::size_t dataOffset;
+	std::size_t tileBytes;			// page padded
+};
+
+//! Called for every tile pair of a traversal
+/*!
+ * Arguments: departure object block, arrival object block, departure time block and thread index.
+ * The arrival tiles of the time blocks from the departure time block up to the lookahead of the
+ * longest time of flight are resident during the call. Calls are made concurrently from several
+ * threads, each on its own departure blocks.
+ */
+typedef std::function< void( const int, const int, const int, const int ) > TileVisitor;
+
+//! Counters of a traversal
+struct TraversalStatistics
+{
+	long numberOfTileVisits;
+	int lookaheadTimeBlocks;		// arrival time blocks needed beyond the departure time block
+	std::size_t workingSetBytes;	// columns kept resident at once
+	long majorPageFaults;			// page faults that needed I/O, for the whole process
+	long minorPageFaults;
+	Real seconds;
+};
+
+//! Visit every ( departure block, arrival block, time block ) of a tiled ephemeris
+/*!
+ * Time blocks are visited in order. While time block t is processed, the columns t to t + lookahead
+ * are resident and column t + lookahead + 1 is prefetched; column t is released afterwards, so
+ * every tile is read from disk once and the working set is lookahead + 2 columns, independent of
+ * the window length. Within a time block the departure blocks are spread over the threads and the
+ * arrival blocks are visited in alternating direction, so consecutive rows start on the tile the
+ * previous one ended with.
+ * @param	const TiledEphemeris& ephemeris			tiled ephemeris to traverse
+ * @param	const Real maximumTimeOfFlight			longest time of flight [s], sets the lookahead
+ * @param	const TileVisitor& visitor				called for every tile pair and time block
+ * @param	const int numberOfThreads				number of threads, 0 for one per hardware thread
+ * @return	traversal counters
+ */
+TraversalStatistics traverseTiles( const TiledEphemeris& ephemeris,
+								   const Real maximumTimeOfFlight,
+								   const TileVisitor& visitor,
+								   const int numberOfThreads );
+
+} // namespace tiledEphemeris
+
+#endif // CPP_PROJECT_TILED_EPHEMERIS_HPP
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_TLE_CATALOG_HPP
+#define CPP_PROJECT_TLE_CATALOG_HPP
+
+#include <string>
+#include <vector>
+
+#include <libsgp4/Eci.h>
+#include <libsgp4/Tle.h>
+
+namespace tleCatalog
+{
+
+typedef double Real;
+typedef std::vector< Real > Vector6;
+
+//! Remove newline characters from string.
+void removeNewline( std::string& string );
+
+//! Read a 3-line TLE catalog (name line followed by the two element lines) from file
+/*!
+ * Reading stops at the first empty name line, so trailing newlines at the end of the catalog file
+ * are ignored.
+ * @param	const std::string& catalogPath	path to the catalog file
+ * @return	vector of TLE objects in the order in which they appear in the catalog
+ */
+std::vector< Tle > readTleCatalog( const std::string& catalogPath );
+
+//! Convert SGP4 ECI object to state vector.
+Vector6 getStateVector( const Eci& state );
+
+} // namespace tleCatalog
+
+#endif // CPP_PROJECT_TLE_CATALOG_HPP
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_TLE_FITTER_HPP
+#define CPP_PROJECT_TLE_FITTER_HPP
+
+#include <string>
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/atomTransfer.hpp"
+#include "CppProject/meanElementConverter.hpp"
+
+namespace tleFitter
+{
+
+typedef double Real;
+typedef std::vector< Real > Vector6;
+typedef std::vector< std::vector< Real > > Vector2D;
+
+//! Work counters of one fit
+struct FitStatistics
+{
+	int numberOfIterations;			// solver steps, accepted and rejected
+	int numberOfRejectedSteps;		// steps that left the kernel domain or increased the residual
+	int numberOfPropagations;		// SGP4 kernel evaluations, each giving the residual and its Jacobian
+};
+
+//! Fit SGP4 mean elements to a Cartesian state at the element epoch with the exact Jacobian of SGP4
+/*!
+ * Solves the problem of atom::convertCartesianStateToTwoLineElements for near-earth orbits, the SGP4
+ * mean elements i, raan, e, w, M and n whose state at the epoch is the given state, but at full
+ * precision instead of that of the TLE format, and without finite differences: the kernel is evaluated in dualNumber::Dual arithmetic, so every propagation
+ * returns the residual together with its exact Jacobian. The unknowns are i, raan, the eccentricity
+ * vector ( e sin w, e cos w ), M + w and n, which stay well conditioned for near-circular orbits.
+ * The solver takes Newton steps and switches to Levenberg-Marquardt steps, with a damping that is
+ * raised after a step that increases the residual or leaves the domain of the kernel and lowered
+ * after every accepted step. Convergence is tested on the step of the unknowns as
+ * gsl_multiroot_test_delta does, for accepted steps taken without a rejection since the previous
+ * accepted step; a small step that does not lower the residual only ends the fit if the scaled
+ * residual passes the test of gsl_multiroot_test_residual. Deep-space orbits fail with GSL_EDOM.
+ * @param	const Vector6& cartesianState			TEME position [km] and velocity [km/s]
+ * @param	const Real bStar						drag term of the fitted elements [1/earth radii]
+ * @param	const AtomSolverSettings& settings		tolerances and iteration limit
+ * @param	SgpMeanElements& meanElements			initial guess on input, fitted elements on return
+ * @param	FitStatistics& statistics				returns the work counters of the fit
+ * @return	GSL status: GSL_SUCCESS, GSL_EMAXITER, GSL_ENOPROG if the damping grows without an accepted
+ * 			step, or GSL_EDOM if the guess is outside the kernel domain
+ */
+int fitMeanElements( const Vector6& cartesianState,
+					 const Real bStar,
+					 const atomTransfer::AtomSolverSettings& settings,
+					 meanElementConverter::SgpMeanElements& meanElements,
+					 FitStatistics& statistics );
+
+//! Fit a TLE to a Cartesian state at its epoch with fitMeanElements
+/*!
+ * The fit starts from the analytic mean elements of the state and uses the drag term of the
+ * template TLE; the name, NORAD number, designator and drag terms of the result are those of the
+ * template. The fitted elements are written in the TLE format, so the TLE carries its precision, as
+ * the TLEs of atom::convertCartesianStateToTwoLineElements do.
+ * @param	Tle& fittedTle		returns the fitted TLE; left unchanged if the fit fails
+ * @return	GSL status of the fit, GSL_EDOM if the state has no analytic mean elements
+ */
+int fitTwoLineElements( const Vector6& cartesianState,
+						const DateTime& epoch,
+						const Tle& templateTle,
+						const atomTransfer::AtomSolverSettings& settings,
+						Tle& fittedTle,
+						FitStatistics& statistics );
+
+//! Counterpart of atom::convertCartesianStateToTwoLineElements built on fitTwoLineElements
+/*!
+ * If the fit fails the reference TLE of the analytic mean elements is returned, or the template if
+ * those do not exist.
+ * @param	std::string& solverStatus		returns the GSL status text of the fit, "success" if it converged
+ */
+Tle convertCartesianStateToTwoLineElements( const Vector6& cartesianState,
+											const DateTime& epoch,
+											const Tle& templateTle,
+											const atomTransfer::AtomSolverSettings& settings,
+											std::string& solverStatus,
+											FitStatistics& statistics );
+
+//! Solve a dense linear system in place by Gaussian elimination with partial pivoting
+/*!
+ * @param	Real* matrix		size x size matrix in row-major order; overwritten
+ * @param	Real* vector		right-hand side on input, solution on return
+ * @return	false if the matrix is singular
+ */
+bool solveLinearSystem( const int size, Real* matrix, Real* vector );
+
+//! Fit failures, work and agreement of the ATOM library fit and the analytic-Jacobian fit
+struct FitterComparison
+{
+	int numberOfSamples;
+	int atomFailures;
+	Real atomMeanIterations;
+	Real atomSeconds;
+	int analyticFailures;
+	Real analyticMeanIterations;
+	Real analyticMeanPropagations;
+	Real analyticSeconds;
+	int numberOfCommonFits;					// samples both fits converged on
+	Real maximumPositionDifference;			// [km], between the two TLEs at the epoch, over the common fits
+	Real maximumVelocityDifference;			// [km/s]
+};
+
+//! Fit TLEs to the states of sets of orbital elements with both fitters
+/*!
+ * Both fits start from the reference TLE of meanElementConverter, at the epoch TleGen::TleGen uses
+ * with that reference TLE and with its tolerances; the two TLEs of a sample are compared by propagating them with the
+ * SGP4 library to the epoch.
+ * @param	const Vector2D& randKepElem		rows of a [m], e, i, raan, w, EA [rad]
+ */
+FitterComparison compareFitters( const Vector2D& randKepElem );
+
+} // namespace tleFitter
+
+#endif // CPP_PROJECT_TLE_FITTER_HPP
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_TLE_FORMAT_HPP
+#define CPP_PROJECT_TLE_FORMAT_HPP
+
+#include <string>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Tle.h>
+
+namespace tleFormat
+{
+
+typedef double Real;
+
+//! Fields of a two-line element set, in the units used by the TLE format
+struct TleElements
+{
+	std::string name;						// name line, written as-is
+	unsigned int noradNumber;
+	char classification;
+	std::string internationalDesignator;	// at most 8 characters, e.g. "06015B"
+	DateTime epoch;
+	Real meanMotionDt2;						// [rev/day^2]
+	Real meanMotionDdt6;					// [rev/day^3]
+	Real bStar;								// [1/earth radii]
+	Real inclination;						// [deg]
+	Real rightAscendingNode;				// [deg]
+	Real eccentricity;
+	Real argumentPerigee;					// [deg]
+	Real meanAnomaly;						// [deg]
+	Real meanMotion;						// Kozai mean motion [rev/day]
+	unsigned int elementSetNumber;
+	unsigned int revolutionNumber;
+};
+
+//! Return TLE fields with the name, NORAD number, designator and drag terms copied from a TLE
+/*!
+ * The orbital elements are copied as well, so the result can be used as a template in which only
+ * the elements and epoch are replaced.
+ */
+TleElements getTleElements( const Tle& tle );
+
+//! Compute the modulo-10 checksum of a TLE line (digits count their value, '-' counts as one).
+int computeChecksum( const std::string& line );
+
+//! Format line 1 of a TLE, including its checksum.
+std::string formatLineOne( const TleElements& elements );
+
+//! Format line 2 of a TLE, including its checksum.
+std::string formatLineTwo( const TleElements& elements );
+
+//! Create an SGP4 TLE object from its fields by formatting and parsing the element lines.
+Tle createTle( const TleElements& elements );
+
+} // namespace tleFormat
+
+#endif // CPP_PROJECT_TLE_FORMAT_HPP
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#ifndef CPP_PROJECT_TWO_TIER_SCREENING_HPP
+#define CPP_PROJECT_TWO_TIER_SCREENING_HPP
+
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/j2Propagator.hpp"
+
+namespace twoTierScreening
+{
+
+typedef double Real;
+
+//! A cell of the (departure epoch, time-of-flight) grid with its screening delta-V
+struct ScreeningCell
+{
+	int epochIndex;
+	int timeOfFlightIndex;
+	Real lambertDeltaV;		// [km/s]
+};
+
+//! First tier of the grid: Lambert delta-V over the whole grid using the J2 secular propagator
+/*!
+ * Every (departure epoch, time-of-flight) cell of a departure/arrival pair is evaluated with the
+ * analytic J2 propagator and the Lambert solver only. The cells with the lowest delta-V are
+ * returned, sorted in ascending order, to be passed on to the SGP4 + ATOM tier.
+ * @param	const j2Propagator::J2Propagator& departurePropagator	J2 propagator of the departure object
+ * @param	const j2Propagator::J2Propagator& arrivalPropagator		J2 propagator of the arrival object
+ * @param	const std::vector< DateTime >& departureEpochs			departure epochs of the grid
+ * @param	const std::vector< Real >& timesOfFlight				times of flight of the grid [s]
+ * @param	const int shortlistSize									number of cells to keep
+ * @return	shortlisted cells, sorted by ascending Lambert delta-V
+ */
+std::vector< ScreeningCell > screenTransferGrid( const j2Propagator::J2Propagator& departurePropagator,
+												 const j2Propagator::J2Propagator& arrivalPropagator,
+												 const std::vector< DateTime >& departureEpochs,
+												 const std::vector< Real >& timesOfFlight,
+												 const int shortlistSize );
+
+//! Agreement between the J2 screening tier and the SGP4 tier
+struct TierAgreement
+{
+	int numberOfPairs;
+	int numberOfCells;
+	Real maximumPositionError;				// [km], J2 vs. SGP4 over all evaluated states
+	Real meanPositionError;					// [km]
+	Real meanAbsoluteDeltaVDifference;		// [km/s], Lambert delta-V with J2 vs. SGP4 states
+	Real topCellRecall;						// fraction of the SGP4 top cells found in the J2 shortlist
+};
+
+//! Measure how well the J2 tier reproduces the SGP4 Lambert delta-V ranking on a catalog
+/*!
+ * For every ordered pair of the catalog the full grid is evaluated with both propagators. The recall
+ * is the fraction of the recallDepth best SGP4 cells per pair that are contained in the J2 shortlist
+ * of size shortlistSize, i.e. the fraction of good transfers the two-tier search would still see.
+ * @param	const std::vector< Tle >& catalog					catalog of objects
+ * @param	const std::vector< DateTime >& departureEpochs		departure epochs of the grid
+ * @param	const std::vector< Real >& timesOfFlight			times of flight of the grid [s]
+ * @param	const int shortlistSize								size of the J2 shortlist per pair
+ * @param	const int recallDepth								number of best SGP4 cells checked per pair
+ * @return	agreement statistics
+ */
+TierAgreement measureTierAgreement( const std::vector< Tle >& catalog,
+									const std::vector< DateTime >& departureEpochs,
+									const std::vector< Real >& timesOfFlight,
+									const int shortlistSize,
+									const int recallDepth );
+
+} // namespace twoTierScreening
+
+#endif // CPP_PROJECT_TWO_TIER_SCREENING_HPP
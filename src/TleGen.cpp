@@ -4,6 +4,7 @@
  * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
  */
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
@@ -16,6 +17,7 @@
 
 #include <boost/exception/info.hpp>
 
+#include <gsl/gsl_errno.h>
 #include <gsl/gsl_multiroots.h>
 #include <gsl/gsl_vector.h>
  	
@@ -37,6 +39,7 @@
 
 #include "/media/abhishek/work/TU delft/INTERNSHIP at DINAMICA/work/github/pykep/src/core_functions/par2ic.h"
 
+#include "CppProject/meanElementConverter.hpp"
 #include "CppProject/TleGen.hpp"
 
 
@@ -48,7 +51,8 @@ namespace TleGen{
 	typedef std::vector< Real > Vector2;
 	typedef std::vector < std::vector < Real > > Vector2D;
 
-	void TleGen( Vector6 randKepElem, std::string& SolverStatus, int& IterationCount )
+	//! Cartesian state [km, km/s] of a set of orbital elements (a [m], e, i, raan, w, EA [rad]).
+	Vector6 computeCartesianState( const Vector6& randKepElem )
 	{
 		// grav. parameter 'mu' of earth
     	const double muEarth = kMU*( pow( 10, 9 ) ); // unit m^3/s^2
@@ -74,7 +78,6 @@ namespace TleGen{
 	    // std::cout << testVel[ 1 ] << std::endl;
 	    // std::cout << testVel[ 2 ] << std::endl;
 
-	    // convert the cartesian elements to the corresponding TLE format using the ATOM toolbox
 	    Vector6 cartesianState( 6 );
 	    // cartesianState[ 0 ] = -7.1e3;
 	    // cartesianState[ 1 ] = 2.7e3;
@@ -82,13 +85,6 @@ namespace TleGen{
 	    // cartesianState[ 3 ] = -2.5;
 	    // cartesianState[ 4 ] = -5.5;
 	    // cartesianState[ 5 ] = 5.5;
-	    Tle convertedTle;
-	    Tle referenceTle = Tle(); // empty TLE for reference
-	    // std::cout << referenceTle << std::endl << std::endl;
-	    const Real absTol = 1.0e-10; // absolute tolerance
-	    const Real relTol = 1.0e-5; // relative tolerance
-	    const int maxItr = 100; // maximum allowed iterations per conversion run
-	    
 	    // important note, the atom function converting cartesian to TLEs takes in values in km and km/s.
 	    cartesianState[ 0 ] = CartPos[ 0 ]/1000;
 	    cartesianState[ 1 ] = CartPos[ 1 ]/1000;
@@ -96,7 +92,92 @@ namespace TleGen{
 	    cartesianState[ 3 ] = CartVel[ 0 ]/1000;
 	    cartesianState[ 4 ] = CartVel[ 1 ]/1000;
 	    cartesianState[ 5 ] = CartVel[ 2 ]/1000;
-		convertedTle = atom::convertCartesianStateToTwoLineElements< Real, Vector6 >( cartesianState, DateTime( ), SolverStatus, 
+	    return cartesianState;
+	}
+
+	void TleGen( Vector6 randKepElem, std::string& SolverStatus, int& IterationCount )
+	{
+		TleGen( randKepElem, SolverStatus, IterationCount, false );
+	}
+
+	void TleGen( Vector6 randKepElem, std::string& SolverStatus, int& IterationCount, const bool useMeanElementGuess )
+	{
+	    // convert the cartesian elements to the corresponding TLE format using the ATOM toolbox
+	    const Vector6 cartesianState = computeCartesianState( randKepElem );
+	    Tle convertedTle;
+	    const Real absTol = 1.0e-10; // absolute tolerance
+	    const Real relTol = 1.0e-5; // relative tolerance
+	    const int maxItr = 100; // maximum allowed iterations per conversion run
+	    DateTime conversionEpoch;
+	    Tle referenceTle = Tle(); // empty TLE for reference
+	    if( useMeanElementGuess )
+	    {
+	    	// the epoch of the analytic reference TLE has to be representable in a TLE (two digit year)
+	    	conversionEpoch = DateTime( 2016, 2, 1 );
+	    	try
+	    	{
+	    		referenceTle = meanElementConverter::createReferenceTle( cartesianState, conversionEpoch );
+	    	}
+	    	catch( const std::exception& )
+	    	{
+	    		// unbound state, keep the empty reference TLE and let ATOM report the failure
+	    	}
+	    }
+		convertedTle = atom::convertCartesianStateToTwoLineElements< Real, Vector6 >( cartesianState, conversionEpoch, SolverStatus, 
 	    	IterationCount, referenceTle, kMU, kXKMPER, absTol, relTol, maxItr );
 	}
+
+	ReferenceTleComparison compareReferenceTles( const Vector2D& randKepElem )
+	{
+		ReferenceTleComparison comparison;
+		comparison.numberOfSamples = randKepElem.size( );
+		comparison.emptyReferenceFailures = 0;
+		comparison.meanElementReferenceFailures = 0;
+		comparison.emptyReferenceMeanIterations = 0.0;
+		comparison.meanElementReferenceMeanIterations = 0.0;
+		comparison.emptyReferenceMaximumIterations = 0;
+		comparison.meanElementReferenceMaximumIterations = 0;
+
+		for( int k = 0; k < comparison.numberOfSamples; k++ )
+		{
+			for( int strategy = 0; strategy < 2; strategy++ )
+			{
+				const bool useMeanElementGuess = ( strategy == 1 );
+				int& failures = useMeanElementGuess ? comparison.meanElementReferenceFailures : comparison.emptyReferenceFailures;
+				Real& meanIterations = useMeanElementGuess ? comparison.meanElementReferenceMeanIterations : comparison.emptyReferenceMeanIterations;
+				int& maximumIterations = useMeanElementGuess ? comparison.meanElementReferenceMaximumIterations : comparison.emptyReferenceMaximumIterations;
+
+				std::string SolverStatus;
+				int IterationCount = 0;
+				try
+				{
+					TleGen( randKepElem[ k ], SolverStatus, IterationCount, useMeanElementGuess );
+				}
+				catch( const std::exception& )
+				{
+					SolverStatus = "exception";
+				}
+
+				if( SolverStatus.find( "success" ) == std::string::npos )
+				{
+					failures++;
+					continue;
+				}
+				meanIterations += IterationCount;
+				maximumIterations = std::max( maximumIterations, IterationCount );
+			}
+		}
+
+		const int emptySuccesses = comparison.numberOfSamples - comparison.emptyReferenceFailures;
+		const int meanElementSuccesses = comparison.numberOfSamples - comparison.meanElementReferenceFailures;
+		if( emptySuccesses > 0 )
+		{
+			comparison.emptyReferenceMeanIterations /= emptySuccesses;
+		}
+		if( meanElementSuccesses > 0 )
+		{
+			comparison.meanElementReferenceMeanIterations /= meanElementSuccesses;
+		}
+		return comparison;
+	}
 }
\ No newline at end of file
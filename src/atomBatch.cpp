@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <vector>
+
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_math.h>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Eci.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/atomBatch.hpp"
+#include "CppProject/atomTransfer.hpp"
+#include "CppProject/tleFitter.hpp"
+
+namespace atomBatch
+{
+
+	//! Unknowns of a transfer problem: the departure velocity.
+	const int numberOfUnknowns = 3;
+
+	//! Times a rejected step is halved before the problem fails.
+	const int maximumBacktracks = 8;
+
+	//! Finite-difference step of an unknown, as gsl_multiroot_fdjacobian takes it.
+	Real computeDifferenceStep( const Real x )
+	{
+		const Real step = GSL_SQRT_DBL_EPSILON * std::fabs( x );
+		return step == 0.0 ? GSL_SQRT_DBL_EPSILON : step;
+	}
+
+	//! The step test of gsl_multiroot_test_delta, for the step that led to x.
+	bool isStepConverged( const Real step[ numberOfUnknowns ], const Real x[ numberOfUnknowns ],
+						  const atomTransfer::AtomSolverSettings& settings )
+	{
+		for( int i = 0; i < numberOfUnknowns; i++ )
+		{
+			if( !( std::fabs( step[ i ] ) < settings.absoluteTolerance + settings.relativeTolerance * std::fabs( x[ i ] ) ) )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	BatchTransferSolver::BatchTransferSolver( const int batchSize )
+		: batchSize( std::max( batchSize, 1 ) ),
+		  statistics( ),
+		  transferProblems( NULL ),
+		  transferSolutions( NULL )
+	{ }
+
+	void BatchTransferSolver::evaluatePoints( const atomTransfer::AtomSolverSettings& settings )
+	{
+		const std::vector< TransferProblem >& problems = *transferProblems;
+		const int numberOfPoints = evaluation.numberOfPoints;
+		std::vector< Real > departureState( 6 );
+		for( int point = 0; point < numberOfPoints; point++ )
+		{
+			const TransferProblem& problem = problems[ evaluation.pointProblem[ point ] ];
+			for( int j = 0; j < 3; j++ )
+			{
+				departureState[ j ] = problem.departurePosition[ j ];
+				departureState[ j + 3 ] = evaluation.points[ j * numberOfPoints + point ];
+			}
+
+			// the residual of atom::executeAtomSolver: the TLE fitted to the departure state, propagated
+			// to the arrival epoch
+			Tle transferTle = problem.referenceTle;
+			tleFitter::FitStatistics fitStatistics;
+			evaluation.status[ point ] = tleFitter::fitTwoLineElements( departureState, problem.departureEpoch, problem.referenceTle,
+																		settings, transferTle, fitStatistics );
+			statistics.numberOfFitIterations += fitStatistics.numberOfIterations;
+			statistics.numberOfPropagations += fitStatistics.numberOfPropagations;
+			if( evaluation.status[ point ] != GSL_SUCCESS )
+			{
+				continue;
+			}
+			try
+			{
+				const SGP4 sgp4( transferTle );
+				const Eci arrivalState = sgp4.FindPosition( problem.departureEpoch.AddSeconds( problem.timeOfFlight ) );
+				statistics.numberOfPropagations++;
+				const Real arrivalPosition[ 3 ] = { arrivalState.Position( ).x, arrivalState.Position( ).y, arrivalState.Position( ).z };
+				const Real arrivalVelocity[ 3 ] = { arrivalState.Velocity( ).x, arrivalState.Velocity( ).y, arrivalState.Velocity( ).z };
+				for( int j = 0; j < 3; j++ )
+				{
+					evaluation.values[ j * numberOfPoints + point ] = arrivalPosition[ j ] - problem.arrivalPosition[ j ];
+					evaluation.arrivalVelocities[ j * numberOfPoints + point ] = arrivalVelocity[ j ];
+				}
+			}
+			catch( const std::exception& )
+			{
+				evaluation.status[ point ] = GSL_EBADFUNC;
+			}
+		}
+	}
+
+	void BatchTransferSolver::finishLane( const int lane, const int status )
+	{
+		const int capacity = lanes.capacity;
+		TransferSolution& solution = ( *transferSolutions )[ lanes.problem[ lane ] ];
+		solution.status = status;
+		solution.numberOfIterations = lanes.iterations[ lane ];
+		for( int j = 0; j < 3; j++ )
+		{
+			solution.departureVelocity[ j ] = lanes.x[ j * capacity + lane ];
+			solution.arrivalVelocity[ j ] = lanes.arrivalVelocity[ j * capacity + lane ];
+		}
+		lanes.problem[ lane ] = -1;
+	}
+
+	void BatchTransferSolver::solve( const std::vector< TransferProblem >& problems,
+									 const atomTransfer::AtomSolverSettings& settings,
+									 std::vector< TransferSolution >& solutions )
+	{
+		const int n = numberOfUnknowns;
+		const int numberOfProblems = static_cast< int >( problems.size( ) );
+		statistics = BatchStatistics( );
+		statistics.numberOfProblems = numberOfProblems;
+		solutions.resize( numberOfProblems );
+		transferProblems = &problems;
+		transferSolutions = &solutions;
+
+		const int capacity = std::min( batchSize, std::max( numberOfProblems, 1 ) );
+		lanes.capacity = capacity;
+		lanes.problem.assign( capacity, -1 );
+		lanes.iterations.resize( capacity );
+		lanes.isResidualValid.resize( capacity );
+		lanes.isJacobianNeeded.resize( capacity );
+		lanes.isJacobianFresh.resize( capacity );
+		lanes.hasStep.resize( capacity );
+		lanes.backtracks.resize( capacity );
+		lanes.firstPoint.resize( capacity );
+		lanes.x.resize( n * capacity );
+		lanes.residual.resize( n * capacity );
+		lanes.arrivalVelocity.assign( n * capacity, 0.0 );
+		lanes.step.resize( n * capacity );
+		lanes.jacobian.resize( n * n * capacity );
+
+		int nextProblem = 0;
+		while( true )
+		{
+			// refill the empty lanes from the queue
+			int numberOfActiveLanes = 0;
+			for( int lane = 0; lane < capacity; lane++ )
+			{
+				if( lanes.problem[ lane ] < 0 && nextProblem < numberOfProblems )
+				{
+					const int problem = nextProblem++;
+					lanes.problem[ lane ] = problem;
+					lanes.iterations[ lane ] = 0;
+					lanes.isResidualValid[ lane ] = 0;
+					lanes.isJacobianNeeded[ lane ] = 1;
+					lanes.isJacobianFresh[ lane ] = 0;
+					lanes.hasStep[ lane ] = 0;
+					lanes.backtracks[ lane ] = 0;
+					for( int i = 0; i < n; i++ )
+					{
+						lanes.x[ i * capacity + lane ] = problems[ problem ].departureVelocityGuess[ i ];
+						lanes.arrivalVelocity[ i * capacity + lane ] = 0.0;
+					}
+				}
+				if( lanes.problem[ lane ] >= 0 )
+				{
+					numberOfActiveLanes++;
+				}
+			}
+			if( numberOfActiveLanes == 0 )
+			{
+				break;
+			}
+			statistics.numberOfTransferRounds++;
+			statistics.meanOccupancy += static_cast< Real >( numberOfActiveLanes ) / capacity;
+
+			// the points of the round: the residual at x where it is not known yet and the difference
+			// points where a lane needs a new Jacobian
+			int numberOfPoints = 0;
+			for( int lane = 0; lane < capacity; lane++ )
+			{
+				lanes.firstPoint[ lane ] = numberOfPoints;
+				if( lanes.problem[ lane ] >= 0 )
+				{
+					numberOfPoints += ( lanes.isResidualValid[ lane ] ? 0 : 1 ) + ( lanes.isJacobianNeeded[ lane ] ? n : 0 );
+				}
+			}
+			evaluation.numberOfPoints = numberOfPoints;
+			evaluation.pointProblem.resize( numberOfPoints );
+			evaluation.points.resize( n * numberOfPoints );
+			evaluation.values.resize( n * numberOfPoints );
+			evaluation.arrivalVelocities.resize( n * numberOfPoints );
+			evaluation.status.resize( numberOfPoints );
+			for( int lane = 0; lane < capacity; lane++ )
+			{
+				if( lanes.problem[ lane ] < 0 )
+				{
+					continue;
+				}
+				int point = lanes.firstPoint[ lane ];
+				const int firstColumn = lanes.isResidualValid[ lane ] ? 0 : -1;
+				const int lastColumn = lanes.isJacobianNeeded[ lane ] ? n : 0;
+				for( int column = firstColumn; column < lastColumn; column++, point++ )
+				{
+					evaluation.pointProblem[ point ] = lanes.problem[ lane ];
+					for( int i = 0; i < n; i++ )
+					{
+						const Real x = lanes.x[ i * capacity + lane ];
+						evaluation.points[ i * numberOfPoints + point ] = i == column ? x + computeDifferenceStep( x ) : x;
+					}
+				}
+			}
+
+			evaluatePoints( settings );
+
+			// one quasi-Newton step per lane
+			for( int lane = 0; lane < capacity; lane++ )
+			{
+				if( lanes.problem[ lane ] < 0 )
+				{
+					continue;
+				}
+				Real x[ numberOfUnknowns ];
+				Real residual[ numberOfUnknowns ];
+				Real step[ numberOfUnknowns ];
+				Real jacobian[ numberOfUnknowns * numberOfUnknowns ];
+				for( int i = 0; i < n; i++ )
+				{
+					x[ i ] = lanes.x[ i * capacity + lane ];
+					residual[ i ] = lanes.residual[ i * capacity + lane ];
+					step[ i ] = lanes.step[ i * capacity + lane ];
+					for( int j = 0; j < n; j++ )
+					{
+						jacobian[ i * n + j ] = lanes.jacobian[ ( i * n + j ) * capacity + lane ];
+					}
+				}
+
+				// points of the lane are consecutive
+				int point = lanes.firstPoint[ lane ];
+				if( !lanes.isResidualValid[ lane ] )
+				{
+					const int status = evaluation.status[ point ];
+					Real newResidual[ numberOfUnknowns ];
+					Real oldNorm = 0.0;
+					Real newNorm = 0.0;
+					for( int i = 0; i < n; i++ )
+					{
+						newResidual[ i ] = evaluation.values[ i * numberOfPoints + point ];
+						oldNorm += residual[ i ] * residual[ i ];
+						newNorm += newResidual[ i ] * newResidual[ i ];
+					}
+					if( !lanes.hasStep[ lane ] && status != GSL_SUCCESS )
+					{
+						finishLane( lane, status );
+						continue;
+					}
+
+					if( lanes.hasStep[ lane ] && ( status != GSL_SUCCESS || !( newNorm <= oldNorm ) ) )
+					{
+						// reject the step: x goes back to the last accepted point, where the residual is known
+						statistics.numberOfRejectedSteps++;
+						for( int i = 0; i < n; i++ )
+						{
+							x[ i ] -= step[ i ];
+							lanes.x[ i * capacity + lane ] = x[ i ];
+						}
+						if( isStepConverged( step, x, settings ) )
+						{
+							// the residual only changes by round-off and the truncation of the TLE format here
+							finishLane( lane, GSL_SUCCESS );
+						}
+						else if( !lanes.isJacobianFresh[ lane ] )
+						{
+							lanes.isResidualValid[ lane ] = 1;
+							lanes.isJacobianNeeded[ lane ] = 1;
+						}
+						else if( lanes.backtracks[ lane ] < maximumBacktracks )
+						{
+							for( int i = 0; i < n; i++ )
+							{
+								lanes.step[ i * capacity + lane ] = 0.5 * step[ i ];
+								lanes.x[ i * capacity + lane ] = x[ i ] + 0.5 * step[ i ];
+							}
+							lanes.backtracks[ lane ]++;
+						}
+						else
+						{
+							finishLane( lane, GSL_ENOPROG );
+						}
+						continue;
+					}
+					for( int i = 0; i < n; i++ )
+					{
+						lanes.arrivalVelocity[ i * capacity + lane ] = evaluation.arrivalVelocities[ i * numberOfPoints + point ];
+					}
+					point++;
+
+					if( lanes.hasStep[ lane ] && !lanes.isJacobianNeeded[ lane ] )
+					{
+						// Broyden update of the Jacobian with the accepted step
+						Real stepNorm = 0.0;
+						for( int j = 0; j < n; j++ )
+						{
+							stepNorm += step[ j ] * step[ j ];
+						}
+						for( int i = 0; i < n; i++ )
+						{
+							Real mismatch = newResidual[ i ] - residual[ i ];
+							for( int j = 0; j < n; j++ )
+							{
+								mismatch -= jacobian[ i * n + j ] * step[ j ];
+							}
+							for( int j = 0; j < n; j++ )
+							{
+								jacobian[ i * n + j ] += mismatch * step[ j ] / stepNorm;
+							}
+						}
+						lanes.isJacobianFresh[ lane ] = 0;
+					}
+					for( int i = 0; i < n; i++ )
+					{
+						residual[ i ] = newResidual[ i ];
+						lanes.residual[ i * capacity + lane ] = residual[ i ];
+					}
+					lanes.isResidualValid[ lane ] = 1;
+					lanes.backtracks[ lane ] = 0;
+
+					if( lanes.hasStep[ lane ] && isStepConverged( step, x, settings ) )
+					{
+						finishLane( lane, GSL_SUCCESS );
+						continue;
+					}
+					if( lanes.iterations[ lane ] >= settings.maximumIterations )
+					{
+						finishLane( lane, GSL_EMAXITER );
+						continue;
+					}
+				}
+
+				if( lanes.isJacobianNeeded[ lane ] )
+				{
+					// forward differences from the points requested in this round
+					int status = GSL_SUCCESS;
+					for( int j = 0; j < n; j++, point++ )
+					{
+						const Real differenceStep = computeDifferenceStep( x[ j ] );
+						status = evaluation.status[ point ] != GSL_SUCCESS ? evaluation.status[ point ] : status;
+						for( int i = 0; i < n; i++ )
+						{
+							jacobian[ i * n + j ] = ( evaluation.values[ i * numberOfPoints + point ] - residual[ i ] ) / differenceStep;
+						}
+					}
+					if( status != GSL_SUCCESS )
+					{
+						finishLane( lane, status );
+						continue;
+					}
+					lanes.isJacobianNeeded[ lane ] = 0;
+					lanes.isJacobianFresh[ lane ] = 1;
+				}
+
+				Real matrix[ numberOfUnknowns * numberOfUnknowns ];
+				std::copy( jacobian, jacobian + n * n, matrix );
+				for( int i = 0; i < n; i++ )
+				{
+					step[ i ] = -residual[ i ];
+				}
+				if( !tleFitter::solveLinearSystem( n, matrix, step ) )
+				{
+					if( lanes.isJacobianFresh[ lane ] )
+					{
+						finishLane( lane, GSL_ESING );
+					}
+					else
+					{
+						lanes.isJacobianNeeded[ lane ] = 1;
+					}
+					continue;
+				}
+
+				lanes.iterations[ lane ]++;
+				lanes.hasStep[ lane ] = 1;
+				lanes.isResidualValid[ lane ] = 0;
+				for( int i = 0; i < n; i++ )
+				{
+					lanes.x[ i * capacity + lane ] = x[ i ] + step[ i ];
+					lanes.step[ i * capacity + lane ] = step[ i ];
+					for( int j = 0; j < n; j++ )
+					{
+						lanes.jacobian[ ( i * n + j ) * capacity + lane ] = jacobian[ i * n + j ];
+					}
+				}
+			}
+		}
+		if( statistics.numberOfTransferRounds > 0 )
+		{
+			statistics.meanOccupancy /= statistics.numberOfTransferRounds;
+		}
+
+		transferProblems = NULL;
+		transferSolutions = NULL;
+	}
+
+} // namespace atomBatch
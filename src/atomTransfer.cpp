@@ -0,0 +1,401 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <exception>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/array.hpp>
+
+#include <gsl/gsl_errno.h>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Eci.h>
+#include <libsgp4/Globals.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include <Atom/atom.hpp>
+
+#include <SML/sml.hpp>
+
+#include "CppProject/atomBatch.hpp"
+#include "CppProject/atomTransfer.hpp"
+#include "CppProject/atomWorkspace.hpp"
+#include "CppProject/lambertDeltaV.hpp"
+#include "CppProject/meanElementConverter.hpp"
+#include "CppProject/tleCatalog.hpp"
+
+namespace atomTransfer
+{
+
+	typedef std::vector< Real > Vector6;
+	typedef std::vector< Real > Vector3;
+	typedef boost::array< Real, 3 > array3;
+
+	AtomSolverSettings getDefaultAtomSolverSettings( )
+	{
+		AtomSolverSettings settings;
+		settings.absoluteTolerance = 1.0e-10;
+		settings.relativeTolerance = 1.0e-5;
+		settings.maximumIterations = 100;
+		settings.useMeanElementReference = false;
+		return settings;
+	}
+
+	bool evaluateTransfer( const Tle& departureObject,
+						   const SGP4& sgp4Departure,
+						   const Tle& arrivalObject,
+						   const SGP4& sgp4Arrival,
+						   const DateTime& departureEpoch,
+						   const Real timeOfFlight,
+						   TransferResult& result,
+						   std::string& solverStatusSummary )
+	{
+		return evaluateTransfer( departureObject, sgp4Departure, arrivalObject, sgp4Arrival, departureEpoch, timeOfFlight,
+								 getDefaultAtomSolverSettings( ), result, solverStatusSummary );
+	}
+
+	//! Departure and arrival states of a transfer, the cell of its result and the Lambert delta-V and guess.
+	void prepareTransfer( const Tle& departureObject,
+						  const SGP4& sgp4Departure,
+						  const Tle& arrivalObject,
+						  const SGP4& sgp4Arrival,
+						  const DateTime& departureEpoch,
+						  const Real timeOfFlight,
+						  TransferResult& result,
+						  array3& departurePosition,
+						  array3& departureVelocity,
+						  array3& arrivalPosition,
+						  array3& arrivalVelocity,
+						  array3& minIndexDepartureVelocity )
+	{
+		const Vector6 departureState = tleCatalog::getStateVector( sgp4Departure.FindPosition( departureEpoch ) );
+		const DateTime arrivalEpoch = departureEpoch.AddSeconds( timeOfFlight );
+		const Vector6 arrivalState = tleCatalog::getStateVector( sgp4Arrival.FindPosition( arrivalEpoch ) );
+
+		for( int j = 0; j < 3; j++ )
+		{
+			departurePosition[ j ] = departureState[ j ];
+			departureVelocity[ j ] = departureState[ j + 3 ];
+			arrivalPosition[ j ] = arrivalState[ j ];
+			arrivalVelocity[ j ] = arrivalState[ j + 3 ];
+		}
+
+		result.departureObjectId = static_cast< int >( departureObject.NoradNumber( ) );
+		result.arrivalObjectId = static_cast< int >( arrivalObject.NoradNumber( ) );
+		result.departureEpoch = departureEpoch;
+		result.timeOfFlight = timeOfFlight;
+
+		// best guess for velocity in transfer orbit at the departure point
+		result.lambertDeltaV = lambertDeltaV::computeLambertDeltaV( departurePosition, departureVelocity,
+																	arrivalPosition, arrivalVelocity,
+																	timeOfFlight, kMU, minIndexDepartureVelocity );
+	}
+
+	//! Total delta-V [km/s] of the ATOM solution: departure and arrival velocities of the transfer orbit.
+	Real computeAtomDeltaV( const Vector6& atomVelocities, const array3& departureVelocity, const array3& arrivalVelocity )
+	{
+		array3 atomDepartureVelocity;
+		array3 atomArrivalVelocity;
+		for( int k = 0; k < 3; k++ )
+		{
+			atomDepartureVelocity[ k ] = atomVelocities[ k ];
+			atomArrivalVelocity[ k ] = atomVelocities[ k + 3 ];
+		}
+
+		const array3 atomDepartureDeltaV = sml::add( atomDepartureVelocity, sml::multiply( departureVelocity, -1.0 ) );
+		const array3 atomArrivalDeltaV = sml::add( atomArrivalVelocity, sml::multiply( arrivalVelocity, -1.0 ) );
+		return sml::norm< Real >( atomDepartureDeltaV ) + sml::norm< Real >( atomArrivalDeltaV );
+	}
+
+	//! Reference TLE of the ATOM solve: the departure object, or with useMeanElementReference the analytic mean
+	//! elements of the guessed transfer orbit at departure, if the guess is a bound orbit.
+	Tle getReferenceTle( const Tle& departureObject,
+						 const AtomSolverSettings& solverSettings,
+						 const array3& departurePosition,
+						 const array3& transferVelocityGuess,
+						 const DateTime& departureEpoch )
+	{
+		if( !solverSettings.useMeanElementReference )
+		{
+			return departureObject;
+		}
+		try
+		{
+			Vector6 transferState( 6 );
+			for( int j = 0; j < 3; j++ )
+			{
+				transferState[ j ] = departurePosition[ j ];
+				transferState[ j + 3 ] = transferVelocityGuess[ j ];
+			}
+			return meanElementConverter::createReferenceTle( transferState, departureEpoch, departureObject );
+		}
+		catch( const std::exception& )
+		{
+			return departureObject;
+		}
+	}
+
+	//! Solve a prepared transfer with the ATOM library solver from the given departure velocity guess.
+	bool solveTransfer( const Tle& departureObject,
+						const AtomSolverSettings& solverSettings,
+						const array3& departurePosition,
+						const array3& departureVelocity,
+						const array3& arrivalPosition,
+						const array3& arrivalVelocity,
+						const array3& transferVelocityGuess,
+						TransferResult& result,
+						std::string& solverStatusSummary )
+	{
+		Vector3 departureVelocityGuess( 3 );
+		Vector3 atomDeparturePosition( 3 );
+		Vector3 atomArrivalPosition( 3 );
+		for( int j = 0; j < 3; j++ )
+		{
+			departureVelocityGuess[ j ] = transferVelocityGuess[ j ];
+			atomDeparturePosition[ j ] = departurePosition[ j ];
+			atomArrivalPosition[ j ] = arrivalPosition[ j ];
+		}
+
+		const Tle referenceTle = getReferenceTle( departureObject, solverSettings, departurePosition, transferVelocityGuess, result.departureEpoch );
+		Vector6 atomVelocities( 6 );
+		try
+		{
+			atomVelocities = atom::executeAtomSolver< Real, Vector3, Vector6 >( atomDeparturePosition,
+																				result.departureEpoch,
+																				atomArrivalPosition,
+																				result.timeOfFlight,
+																				departureVelocityGuess,
+																				solverStatusSummary,
+																				result.numberOfIterations,
+																				referenceTle,
+																				kMU,
+																				kXKMPER,
+																				solverSettings.absoluteTolerance,
+																				solverSettings.relativeTolerance,
+																				solverSettings.maximumIterations );
+		}
+		catch( const std::exception& )
+		{
+			return false;
+		}
+
+		for( int j = 0; j < 3; j++ )
+		{
+			result.transferDepartureVelocity[ j ] = atomVelocities[ j ];
+		}
+		result.atomDeltaV = computeAtomDeltaV( atomVelocities, departureVelocity, arrivalVelocity );
+		return true;
+	}
+
+	//! Solve a prepared transfer with a solver workspace from the given departure velocity guess.
+	bool solveTransfer( const Tle& departureObject,
+						const AtomSolverSettings& solverSettings,
+						atomWorkspace::AtomSolverWorkspace& workspace,
+						const array3& departurePosition,
+						const array3& departureVelocity,
+						const array3& arrivalPosition,
+						const array3& arrivalVelocity,
+						const array3& transferVelocityGuess,
+						TransferResult& result,
+						std::string& solverStatusSummary )
+	{
+		const Vector3 workspaceDeparturePosition( departurePosition.begin( ), departurePosition.end( ) );
+		const Vector3 workspaceArrivalPosition( arrivalPosition.begin( ), arrivalPosition.end( ) );
+		const Vector3 departureVelocityGuess( transferVelocityGuess.begin( ), transferVelocityGuess.end( ) );
+		const Tle referenceTle = getReferenceTle( departureObject, solverSettings, departurePosition, transferVelocityGuess, result.departureEpoch );
+
+		Vector6 atomVelocities( 6 );
+		const int status = workspace.solveTransfer( workspaceDeparturePosition, result.departureEpoch, workspaceArrivalPosition,
+													result.timeOfFlight, departureVelocityGuess, referenceTle, solverSettings,
+													atomVelocities, result.numberOfIterations );
+		solverStatusSummary = gsl_strerror( status );
+		// the library solver also returns its last iterate at the iteration limit
+		if( status != GSL_SUCCESS && status != GSL_EMAXITER )
+		{
+			return false;
+		}
+
+		for( int j = 0; j < 3; j++ )
+		{
+			result.transferDepartureVelocity[ j ] = atomVelocities[ j ];
+		}
+		result.atomDeltaV = computeAtomDeltaV( atomVelocities, departureVelocity, arrivalVelocity );
+		return true;
+	}
+
+	bool evaluateTransfer( const Tle& departureObject,
+						   const SGP4& sgp4Departure,
+						   const Tle& arrivalObject,
+						   const SGP4& sgp4Arrival,
+						   const DateTime& departureEpoch,
+						   const Real timeOfFlight,
+						   const AtomSolverSettings& solverSettings,
+						   TransferResult& result,
+						   std::string& solverStatusSummary )
+	{
+		array3 departurePosition;
+		array3 departureVelocity;
+		array3 arrivalPosition;
+		array3 arrivalVelocity;
+		array3 minIndexDepartureVelocity;
+		prepareTransfer( departureObject, sgp4Departure, arrivalObject, sgp4Arrival, departureEpoch, timeOfFlight, result,
+						 departurePosition, departureVelocity, arrivalPosition, arrivalVelocity, minIndexDepartureVelocity );
+		return solveTransfer( departureObject, solverSettings, departurePosition, departureVelocity, arrivalPosition,
+							  arrivalVelocity, minIndexDepartureVelocity, result, solverStatusSummary );
+	}
+
+	bool evaluateTransfer( const Tle& departureObject,
+						   const SGP4& sgp4Departure,
+						   const Tle& arrivalObject,
+						   const SGP4& sgp4Arrival,
+						   const DateTime& departureEpoch,
+						   const Real timeOfFlight,
+						   const AtomSolverSettings& solverSettings,
+						   atomWorkspace::AtomSolverWorkspace& workspace,
+						   TransferResult& result,
+						   std::string& solverStatusSummary )
+	{
+		array3 departurePosition;
+		array3 departureVelocity;
+		array3 arrivalPosition;
+		array3 arrivalVelocity;
+		array3 minIndexDepartureVelocity;
+		prepareTransfer( departureObject, sgp4Departure, arrivalObject, sgp4Arrival, departureEpoch, timeOfFlight, result,
+						 departurePosition, departureVelocity, arrivalPosition, arrivalVelocity, minIndexDepartureVelocity );
+		return solveTransfer( departureObject, solverSettings, workspace, departurePosition, departureVelocity,
+							  arrivalPosition, arrivalVelocity, minIndexDepartureVelocity, result, solverStatusSummary );
+	}
+
+	//! Departure velocity of an earlier solution as the initial guess of a refinement.
+	array3 getTransferVelocity( const TransferResult& screeningResult )
+	{
+		array3 transferVelocity;
+		for( int j = 0; j < 3; j++ )
+		{
+			transferVelocity[ j ] = screeningResult.transferDepartureVelocity[ j ];
+		}
+		return transferVelocity;
+	}
+
+	bool refineTransfer( const Tle& departureObject,
+						 const SGP4& sgp4Departure,
+						 const Tle& arrivalObject,
+						 const SGP4& sgp4Arrival,
+						 const TransferResult& screeningResult,
+						 const AtomSolverSettings& solverSettings,
+						 TransferResult& result,
+						 std::string& solverStatusSummary )
+	{
+		array3 departurePosition;
+		array3 departureVelocity;
+		array3 arrivalPosition;
+		array3 arrivalVelocity;
+		array3 minIndexDepartureVelocity;
+		prepareTransfer( departureObject, sgp4Departure, arrivalObject, sgp4Arrival, screeningResult.departureEpoch,
+						 screeningResult.timeOfFlight, result, departurePosition, departureVelocity, arrivalPosition,
+						 arrivalVelocity, minIndexDepartureVelocity );
+		return solveTransfer( departureObject, solverSettings, departurePosition, departureVelocity, arrivalPosition,
+							  arrivalVelocity, getTransferVelocity( screeningResult ), result, solverStatusSummary );
+	}
+
+	bool refineTransfer( const Tle& departureObject,
+						 const SGP4& sgp4Departure,
+						 const Tle& arrivalObject,
+						 const SGP4& sgp4Arrival,
+						 const TransferResult& screeningResult,
+						 const AtomSolverSettings& solverSettings,
+						 atomWorkspace::AtomSolverWorkspace& workspace,
+						 TransferResult& result,
+						 std::string& solverStatusSummary )
+	{
+		array3 departurePosition;
+		array3 departureVelocity;
+		array3 arrivalPosition;
+		array3 arrivalVelocity;
+		array3 minIndexDepartureVelocity;
+		prepareTransfer( departureObject, sgp4Departure, arrivalObject, sgp4Arrival, screeningResult.departureEpoch,
+						 screeningResult.timeOfFlight, result, departurePosition, departureVelocity, arrivalPosition,
+						 arrivalVelocity, minIndexDepartureVelocity );
+		return solveTransfer( departureObject, solverSettings, workspace, departurePosition, departureVelocity,
+							  arrivalPosition, arrivalVelocity, getTransferVelocity( screeningResult ), result,
+							  solverStatusSummary );
+	}
+
+	void prepareBatchTransfer( const Tle& departureObject,
+							   const SGP4& sgp4Departure,
+							   const Tle& arrivalObject,
+							   const SGP4& sgp4Arrival,
+							   const DateTime& departureEpoch,
+							   const Real timeOfFlight,
+							   const AtomSolverSettings& solverSettings,
+							   TransferResult& result,
+							   atomBatch::TransferProblem& problem )
+	{
+		array3 departurePosition;
+		array3 departureVelocity;
+		array3 arrivalPosition;
+		array3 arrivalVelocity;
+		array3 minIndexDepartureVelocity;
+		prepareTransfer( departureObject, sgp4Departure, arrivalObject, sgp4Arrival, departureEpoch, timeOfFlight, result,
+						 departurePosition, departureVelocity, arrivalPosition, arrivalVelocity, minIndexDepartureVelocity );
+
+		for( int j = 0; j < 3; j++ )
+		{
+			problem.departurePosition[ j ] = departurePosition[ j ];
+			problem.departureVelocity[ j ] = departureVelocity[ j ];
+			problem.arrivalPosition[ j ] = arrivalPosition[ j ];
+			problem.arrivalVelocity[ j ] = arrivalVelocity[ j ];
+			problem.departureVelocityGuess[ j ] = minIndexDepartureVelocity[ j ];
+		}
+		problem.departureEpoch = departureEpoch;
+		problem.timeOfFlight = timeOfFlight;
+		problem.referenceTle = getReferenceTle( departureObject, solverSettings, departurePosition, minIndexDepartureVelocity, departureEpoch );
+	}
+
+	bool completeBatchTransfer( const atomBatch::TransferProblem& problem,
+								const atomBatch::TransferSolution& solution,
+								TransferResult& result,
+								std::string& solverStatusSummary )
+	{
+		result.numberOfIterations = solution.numberOfIterations;
+		solverStatusSummary = gsl_strerror( solution.status );
+		if( solution.status != GSL_SUCCESS )
+		{
+			return false;
+		}
+
+		Vector6 atomVelocities( 6 );
+		array3 departureVelocity;
+		array3 arrivalVelocity;
+		for( int j = 0; j < 3; j++ )
+		{
+			atomVelocities[ j ] = solution.departureVelocity[ j ];
+			atomVelocities[ j + 3 ] = solution.arrivalVelocity[ j ];
+			departureVelocity[ j ] = problem.departureVelocity[ j ];
+			arrivalVelocity[ j ] = problem.arrivalVelocity[ j ];
+			result.transferDepartureVelocity[ j ] = solution.departureVelocity[ j ];
+		}
+		result.atomDeltaV = computeAtomDeltaV( atomVelocities, departureVelocity, arrivalVelocity );
+		return true;
+	}
+
+	void writeTransferHeader( std::ostream& outputfile )
+	{
+		outputfile << "Departure ID" << "," << "Arrival ID" << "," << "Departure Epoch" << "," << "time-of-flight [s]";
+		outputfile << "," << "Atom Delta-V [km/s]" << "," << "Lambert Delta-V [km/s]" << std::endl;
+	}
+
+	void writeTransferResult( std::ostream& outputfile, const TransferResult& result )
+	{
+		outputfile << result.departureObjectId << "," << result.arrivalObjectId << ",";
+		outputfile << result.departureEpoch << "," << result.timeOfFlight << ",";
+		outputfile << result.atomDeltaV << "," << result.lambertDeltaV << std::endl;
+	}
+
+} // namespace atomTransfer
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_multiroots.h>
+#include <gsl/gsl_vector.h>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Eci.h>
+#include <libsgp4/Globals.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include <Atom/atom.hpp>
+
+#include "CppProject/atomTransfer.hpp"
+#include "CppProject/atomWorkspace.hpp"
+
+namespace atomWorkspace
+{
+
+	AtomSolverWorkspace::AtomSolverWorkspace( )
+		: transferSolver( gsl_multiroot_fsolver_alloc( gsl_multiroot_fsolver_hybrids, 3 ) ),
+		  transferGuess( gsl_vector_alloc( 3 ) ),
+		  departureState( 6, 0.0 ),
+		  transferSettings( atomTransfer::getDefaultAtomSolverSettings( ) )
+	{ }
+
+	AtomSolverWorkspace::~AtomSolverWorkspace( )
+	{
+		gsl_vector_free( transferGuess );
+		gsl_multiroot_fsolver_free( transferSolver );
+	}
+
+	int AtomSolverWorkspace::propagateTransfer( const gsl_vector* departureVelocity, Real arrivalPosition[ 3 ], Real arrivalVelocity[ 3 ] )
+	{
+		for( int j = 0; j < 3; j++ )
+		{
+			departureState[ j + 3 ] = gsl_vector_get( departureVelocity, j );
+		}
+
+		// the library throws where the nested fit gets stuck or SGP4 fails; GSL needs a status instead
+		try
+		{
+			std::string solverStatusSummary;
+			int numberOfIterations = 0;
+			const Tle departureTle = atom::convertCartesianStateToTwoLineElements< Real, Vector6 >(
+				departureState, transferEpoch, solverStatusSummary, numberOfIterations, transferReferenceTle, kMU, kXKMPER,
+				transferSettings.absoluteTolerance, transferSettings.relativeTolerance, transferSettings.maximumIterations );
+			const SGP4 sgp4( departureTle );
+			const Eci arrivalState = sgp4.FindPosition( arrivalEpoch );
+			arrivalPosition[ 0 ] = arrivalState.Position( ).x;
+			arrivalPosition[ 1 ] = arrivalState.Position( ).y;
+			arrivalPosition[ 2 ] = arrivalState.Position( ).z;
+			arrivalVelocity[ 0 ] = arrivalState.Velocity( ).x;
+			arrivalVelocity[ 1 ] = arrivalState.Velocity( ).y;
+			arrivalVelocity[ 2 ] = arrivalState.Velocity( ).z;
+		}
+		catch( const std::exception& )
+		{
+			return GSL_EBADFUNC;
+		}
+		return GSL_SUCCESS;
+	}
+
+	int AtomSolverWorkspace::computeTransferResiduals( const gsl_vector* independentVariables, void* parameters, gsl_vector* residuals )
+	{
+		AtomSolverWorkspace& workspace = *static_cast< AtomSolverWorkspace* >( parameters );
+		Real arrivalPosition[ 3 ];
+		Real arrivalVelocity[ 3 ];
+		const int status = workspace.propagateTransfer( independentVariables, arrivalPosition, arrivalVelocity );
+		if( status != GSL_SUCCESS )
+		{
+			return status;
+		}
+		for( int j = 0; j < 3; j++ )
+		{
+			gsl_vector_set( residuals, j, arrivalPosition[ j ] - workspace.targetPosition[ j ] );
+		}
+		return GSL_SUCCESS;
+	}
+
+	int AtomSolverWorkspace::solveTransfer( const Vector3& departurePosition,
+											const DateTime& departureEpoch,
+											const Vector3& arrivalPosition,
+											const Real timeOfFlight,
+											const Vector3& departureVelocityGuess,
+											const Tle& referenceTle,
+											const atomTransfer::AtomSolverSettings& settings,
+											Vector6& transferVelocities,
+											int& numberOfIterations )
+	{
+		for( int j = 0; j < 3; j++ )
+		{
+			departureState[ j ] = departurePosition[ j ];
+			targetPosition[ j ] = arrivalPosition[ j ];
+			gsl_vector_set( transferGuess, j, departureVelocityGuess[ j ] );
+		}
+		transferEpoch = departureEpoch;
+		arrivalEpoch = departureEpoch.AddSeconds( timeOfFlight );
+		transferReferenceTle = referenceTle;
+		transferSettings = settings;
+
+		gsl_multiroot_function function = { &AtomSolverWorkspace::computeTransferResiduals, 3, this };
+		int status = gsl_multiroot_fsolver_set( transferSolver, &function, transferGuess );
+		if( status != GSL_SUCCESS )
+		{
+			return status;
+		}
+
+		// the loop of atom::executeAtomSolver, without its table of the solver state
+		numberOfIterations = 0;
+		do
+		{
+			numberOfIterations++;
+			status = gsl_multiroot_fsolver_iterate( transferSolver );
+			if( status != GSL_SUCCESS )
+			{
+				// the library throws here: the solver is stuck
+				return status;
+			}
+			status = gsl_multiroot_test_delta( transferSolver->dx, transferSolver->x,
+											   settings.absoluteTolerance, settings.relativeTolerance );
+		} while( status == GSL_CONTINUE && numberOfIterations < settings.maximumIterations );
+		if( status == GSL_CONTINUE )
+		{
+			status = GSL_EMAXITER;
+		}
+
+		// the last residual may have been evaluated at a trial point, so the arrival velocity is
+		// recomputed at the solution, as the library does
+		Real arrivalState[ 6 ];
+		const int propagationStatus = propagateTransfer( transferSolver->x, arrivalState, arrivalState + 3 );
+		if( propagationStatus != GSL_SUCCESS )
+		{
+			return propagationStatus;
+		}
+
+		transferVelocities.resize( 6 );
+		for( int j = 0; j < 3; j++ )
+		{
+			transferVelocities[ j ] = gsl_vector_get( transferSolver->x, j );
+			transferVelocities[ j + 3 ] = arrivalState[ j + 3 ];
+		}
+		return status;
+	}
+
+} // namespace atomWorkspace
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "CppProject/autoTuner.hpp"
+#include "CppProject/gridSearch.hpp"
+#include "CppProject/parallelFor.hpp"
+
+namespace autoTuner
+{
+
+	//! Name of this machine, "unknown" if it cannot be read.
+	std::string getHostName( )
+	{
+		char name[ 256 ];
+		if( gethostname( name, sizeof( name ) ) != 0 )
+		{
+			return "unknown";
+		}
+		name[ sizeof( name ) - 1 ] = '\0';
+		return name;
+	}
+
+	MachineProfile getDefaultMachineProfile( )
+	{
+		MachineProfile profile;
+		profile.hostName = getHostName( );
+		profile.hardwareThreads = parallelFor::getNumberOfThreads( 0 );
+		profile.numberOfThreads = 0;
+		profile.cellsPerSecond = 0.0;
+		return profile;
+	}
+
+	std::string getMachineProfilePath( )
+	{
+		return "../../src/Atom_Machine_Profile.txt";
+	}
+
+	const std::string profileHeader = "# ATOM_ADR machine profile";
+
+	void writeMachineProfile( const std::string& path, const MachineProfile& profile )
+	{
+		std::ofstream file( path.c_str( ) );
+		if( !file )
+		{
+			throw std::runtime_error( "Cannot write machine profile: " + path );
+		}
+		file.precision( 10 );
+		file << profileHeader << std::endl;
+		file << "host = " << profile.hostName << std::endl;
+		file << "hardware_threads = " << profile.hardwareThreads << std::endl;
+		file << "threads = " << profile.numberOfThreads << std::endl;
+		file << "cells_per_second = " << profile.cellsPerSecond << std::endl;
+	}
+
+	MachineProfile readMachineProfile( const std::string& path )
+	{
+		std::ifstream file( path.c_str( ) );
+		std::string line;
+		if( !std::getline( file, line ) || line != profileHeader )
+		{
+			throw std::runtime_error( "Not a machine profile: " + path );
+		}
+
+		MachineProfile profile = getDefaultMachineProfile( );
+		while( std::getline( file, line ) )
+		{
+			const std::string::size_type separator = line.find( " = " );
+			if( line.empty( ) || line[ 0 ] == '#' || separator == std::string::npos )
+			{
+				continue;
+			}
+			const std::string key = line.substr( 0, separator );
+			const std::string value = line.substr( separator + 3 );
+			if( key == "host" )
+				profile.hostName = value;
+			else if( key == "hardware_threads" )
+				profile.hardwareThreads = std::atoi( value.c_str( ) );
+			else if( key == "threads" )
+				profile.numberOfThreads = std::atoi( value.c_str( ) );
+			else if( key == "cells_per_second" )
+				profile.cellsPerSecond = std::atof( value.c_str( ) );
+		}
+		return profile;
+	}
+
+	bool loadMachineProfile( const std::string& path, MachineProfile& profile )
+	{
+		profile = getDefaultMachineProfile( );
+		try
+		{
+			const MachineProfile stored = readMachineProfile( path );
+			if( stored.hostName == profile.hostName && stored.hardwareThreads == profile.hardwareThreads )
+			{
+				profile = stored;
+				return true;
+			}
+		}
+		catch( const std::exception& )
+		{
+			// no profile of this machine, keep the defaults
+		}
+		return false;
+	}
+
+	void applyMachineProfile( const MachineProfile& profile, gridSearch::GridSearchSpec& spec )
+	{
+		spec.numberOfThreads = profile.numberOfThreads;
+	}
+
+	TuningSettings getDefaultTuningSettings( )
+	{
+		TuningSettings settings;
+		settings.numberOfEpochSteps = 5;
+		settings.numberOfTimeOfFlightSteps = 50;
+		settings.numberOfRepeats = 2;
+		return settings;
+	}
+
+	//! Sink that only counts, so the calibration measures the solves and not the output.
+	class DiscardingResultSink : public gridSearch::ResultSink
+	{
+	public:
+
+		void consumeResult( const atomTransfer::TransferResult& ) { }
+	};
+
+	//! Cells per second of the grid slice, fastest of the repeats.
+	Real timeGridSlice( gridSearch::GridSearchEngine& engine, const gridSearch::GridSearchSpec& slice, const int numberOfRepeats )
+	{
+		Real bestThroughput = 0.0;
+		for( int repeat = 0; repeat < std::max( numberOfRepeats, 1 ); repeat++ )
+		{
+			DiscardingResultSink sink;
+			const gridSearch::GridSearchSummary summary = engine.run( slice, sink );
+			bestThroughput = std::max( bestThroughput, summary.numberOfCells / std::max( summary.seconds, 1.0e-9 ) );
+		}
+		return bestThroughput;
+	}
+
+	MachineProfile tuneMachineProfile( gridSearch::GridSearchEngine& engine,
+									   const gridSearch::GridSearchSpec& spec,
+									   const TuningSettings& settings,
+									   std::ostream& log )
+	{
+		MachineProfile profile = getDefaultMachineProfile( );
+
+		std::vector< int > threadCounts = settings.threadCounts;
+		if( threadCounts.empty( ) )
+		{
+			for( int threads = 1; threads < profile.hardwareThreads; threads *= 2 )
+			{
+				threadCounts.push_back( threads );
+			}
+			threadCounts.push_back( profile.hardwareThreads );
+		}
+
+		// grid slice: the catalog of spec with the calibration epochs and times of flight
+		gridSearch::GridSearchSpec slice = spec;
+		slice.numberOfEpochSteps = settings.numberOfEpochSteps;
+		slice.numberOfTimeOfFlightSteps = settings.numberOfTimeOfFlightSteps;
+		slice.batchSize = 0;
+
+		for( unsigned int k = 0; k < threadCounts.size( ); k++ )
+		{
+			slice.numberOfThreads = threadCounts[ k ];
+			const Real throughput = timeGridSlice( engine, slice, settings.numberOfRepeats );
+			log << "threads = " << threadCounts[ k ] << ": cells/s = " << throughput << std::endl;
+			if( throughput > profile.cellsPerSecond )
+			{
+				profile.cellsPerSecond = throughput;
+				profile.numberOfThreads = threadCounts[ k ];
+			}
+		}
+		return profile;
+	}
+
+} // namespace autoTuner
@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <SML/sml.hpp>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Globals.h>
+#include <libsgp4/Tle.h>
+
+#include <Atom/convertCartesianStateToTwoLineElements.hpp>
+
+#include "CppProject/catalogGenerator.hpp"
+#include "CppProject/meanElementConverter.hpp"
+#include "CppProject/parallelFor.hpp"
+#include "CppProject/tleFormat.hpp"
+#include "CppProject/TleGen.hpp"
+
+namespace catalogGenerator
+{
+
+	typedef std::vector< Real > Vector6;
+
+	//! Largest NORAD number of the five-digit TLE field
+	const unsigned int maximumNoradNumber = 99999;
+
+	//! Characters of one catalog entry: name line of at most 24 characters and two element lines of 69, with newlines
+	const int entryCharacters = 25 + 2 * 70;
+
+	const char* getPopulationName( const Population population )
+	{
+		switch( population )
+		{
+			case leoPopulation: return "leo";
+			case meoPopulation: return "meo";
+		}
+		return "";
+	}
+
+	Population findPopulation( const std::string& name )
+	{
+		const Population populations[ ] = { leoPopulation, meoPopulation };
+		for( int k = 0; k < 2; k++ )
+		{
+			if( name == getPopulationName( populations[ k ] ) )
+			{
+				return populations[ k ];
+			}
+		}
+		throw std::runtime_error( "Unknown population: " + name );
+	}
+
+	CatalogSettings getDefaultCatalogSettings( const Population population )
+	{
+		const Real km2m = 1000.0;
+		const Real EarthRadius = kXKMPER * km2m; // unit m
+
+		CatalogSettings settings;
+		elementSampler::ElementRanges& ranges = settings.ranges;
+		ranges.rightAscendingNode = { 0.0, sml::convertDegreesToRadians( 360.0 ) };
+		ranges.argumentPerigee = ranges.rightAscendingNode;
+		ranges.eccentricAnomaly = ranges.rightAscendingNode;
+		if( population == leoPopulation )
+		{
+			settings.name = "SYNTHETIC LEO";
+			ranges.semiMajorAxis = { EarthRadius + 200 * km2m, EarthRadius + 2000 * km2m };
+			ranges.eccentricity = { 0.0, 0.05 };
+			ranges.inclination = { 0.0, sml::convertDegreesToRadians( 110.0 ) };
+		}
+		else
+		{
+			settings.name = "SYNTHETIC MEO";
+			ranges.semiMajorAxis = { EarthRadius + 18000 * km2m, EarthRadius + 24000 * km2m };
+			ranges.eccentricity = { 0.0, 0.03 };
+			ranges.inclination = { sml::convertDegreesToRadians( 50.0 ), sml::convertDegreesToRadians( 70.0 ) };
+		}
+
+		settings.sampler = elementSampler::getDefaultSettings( );
+		settings.sampler.minimumPerigeeRadius = EarthRadius + 200 * km2m;
+		settings.epoch = DateTime( 2016, 2, 1 );
+		settings.bStar = 1.0e-4;
+		settings.firstNoradNumber = 1;
+		settings.fitSettings = atomTransfer::getDefaultAtomSolverSettings( );
+		settings.objectsPerBlock = 4096;
+		settings.numberOfThreads = 0;
+		return settings;
+	}
+
+	//! TLE fields of a sample with zero orbital elements: name, NORAD number, designator and drag terms.
+	tleFormat::TleElements getTemplateFields( const CatalogSettings& settings, const int sample )
+	{
+		const unsigned int noradNumber = settings.firstNoradNumber + sample;
+		char text[ 32 ];
+
+		tleFormat::TleElements fields;
+		std::snprintf( text, sizeof( text ), "0 %.14s %u", settings.name.c_str( ), noradNumber );
+		fields.name = text;
+		fields.noradNumber = noradNumber;
+		fields.classification = 'U';
+		// 26 pieces per launch, launch numbers 1 to 999 of the epoch year
+		std::snprintf( text, sizeof( text ), "%02d%03d%c", settings.epoch.Year( ) % 100,
+					   1 + ( sample / 26 ) % 999, 'A' + sample % 26 );
+		fields.internationalDesignator = text;
+		fields.epoch = settings.epoch;
+		fields.meanMotionDt2 = 0.0;
+		fields.meanMotionDdt6 = 0.0;
+		fields.bStar = settings.bStar;
+		fields.inclination = 0.0;
+		fields.rightAscendingNode = 0.0;
+		fields.eccentricity = 0.0;
+		fields.argumentPerigee = 0.0;
+		fields.meanAnomaly = 0.0;
+		fields.meanMotion = 0.0;
+		fields.elementSetNumber = 999;
+		fields.revolutionNumber = 0;
+		return fields;
+	}
+
+	//! Fit the TLE of one sample and append its three lines to a buffer; false if the fit fails.
+	bool appendFittedTle( const Vector6& keplerianElements, const tleFormat::TleElements& fields,
+						  const atomTransfer::AtomSolverSettings& fitSettings, std::string& buffer, int& iterations )
+	{
+		std::string solverStatus;
+		tleFormat::TleElements elements;
+		try
+		{
+			// the ATOM conversion takes the state in km and km/s
+			const Vector6 cartesianState = TleGen::computeCartesianState( keplerianElements );
+			const Tle referenceTle
+				= meanElementConverter::createReferenceTle( cartesianState, fields.epoch, tleFormat::createTle( fields ) );
+			const Tle fittedTle = atom::convertCartesianStateToTwoLineElements< Real, Vector6 >(
+				cartesianState, fields.epoch, solverStatus, iterations, referenceTle, kMU, kXKMPER,
+				fitSettings.absoluteTolerance, fitSettings.relativeTolerance, fitSettings.maximumIterations );
+			elements = tleFormat::getTleElements( fittedTle );
+		}
+		catch( const std::exception& )
+		{
+			return false;
+		}
+		if( solverStatus.find( "success" ) == std::string::npos
+			|| !( elements.eccentricity >= 0.0 && elements.eccentricity < 1.0 && elements.meanMotion > 0.0 ) )
+		{
+			return false;
+		}
+
+		// keep the fitted orbit, with the identification and drag terms of the catalog
+		elements.name = fields.name;
+		elements.noradNumber = fields.noradNumber;
+		elements.classification = fields.classification;
+		elements.internationalDesignator = fields.internationalDesignator;
+		elements.epoch = fields.epoch;
+		elements.meanMotionDt2 = fields.meanMotionDt2;
+		elements.meanMotionDdt6 = fields.meanMotionDdt6;
+		elements.bStar = fields.bStar;
+		elements.elementSetNumber = fields.elementSetNumber;
+		elements.revolutionNumber = fields.revolutionNumber;
+
+		buffer += elements.name;
+		buffer += '\n';
+		buffer += tleFormat::formatLineOne( elements );
+		buffer += '\n';
+		buffer += tleFormat::formatLineTwo( elements );
+		buffer += '\n';
+		return true;
+	}
+
+	CatalogSummary generateCatalog( const std::string& path, const int numberOfSamples, const CatalogSettings& settings )
+	{
+		const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now( );
+		if( numberOfSamples > 0 && ( settings.firstNoradNumber < 1
+			|| static_cast< unsigned long >( settings.firstNoradNumber ) + numberOfSamples - 1 > maximumNoradNumber ) )
+		{
+			throw std::runtime_error( "NORAD numbers of the synthetic catalog exceed five digits: " + path );
+		}
+
+		elementSampler::SamplerSettings samplerSettings = settings.sampler;
+		samplerSettings.numberOfThreads = settings.numberOfThreads;
+		const elementSampler::Vector2D keplerianElements
+			= elementSampler::sampleKeplerianElements( settings.ranges, numberOfSamples, samplerSettings );
+
+		std::ofstream file( path.c_str( ), std::ios::binary );
+		if( !file )
+		{
+			throw std::runtime_error( "Cannot write synthetic catalog file: " + path );
+		}
+
+		const int numberOfThreads = parallelFor::getNumberOfThreads( settings.numberOfThreads );
+		const int objectsPerBlock = std::max( settings.objectsPerBlock, 1 );
+		std::vector< std::string > buffers( numberOfThreads );
+		std::vector< int > failedFits( numberOfThreads, 0 );
+		std::vector< long > iterations( numberOfThreads, 0 );
+		for( int t = 0; t < numberOfThreads; t++ )
+		{
+			buffers[ t ].reserve( static_cast< std::size_t >( objectsPerBlock / numberOfThreads + 1 ) * entryCharacters );
+		}
+
+		CatalogSummary summary;
+		summary.numberOfSamples = numberOfSamples;
+		summary.numberOfObjects = 0;
+		summary.numberOfFailedFits = 0;
+		summary.meanIterations = 0.0;
+		summary.numberOfBytes = 0;
+
+		// one block at a time: fit and format its objects on all threads, then write the text of the
+		// threads in order
+		for( int firstSample = 0; firstSample < numberOfSamples; firstSample += objectsPerBlock )
+		{
+			const int blockSamples = std::min( objectsPerBlock, numberOfSamples - firstSample );
+			parallelFor::parallelFor( blockSamples, numberOfThreads,
+									  [ & ]( const int blockBegin, const int blockEnd, const int thread )
+			{
+				std::string& buffer = buffers[ thread ];
+				buffer.clear( );
+				for( int k = firstSample + blockBegin; k < firstSample + blockEnd; k++ )
+				{
+					int fitIterations = 0;
+					if( appendFittedTle( keplerianElements[ k ], getTemplateFields( settings, k ), settings.fitSettings,
+										 buffer, fitIterations ) )
+					{
+						iterations[ thread ] += fitIterations;
+					}
+					else
+					{
+						failedFits[ thread ]++;
+					}
+				}
+			} );
+
+			for( int t = 0; t < std::min( numberOfThreads, blockSamples ); t++ )
+			{
+				file.write( buffers[ t ].data( ), buffers[ t ].size( ) );
+				summary.numberOfBytes += buffers[ t ].size( );
+			}
+		}
+		file.close( );
+		if( !file )
+		{
+			throw std::runtime_error( "Failed writing synthetic catalog file: " + path );
+		}
+
+		long totalIterations = 0;
+		for( int t = 0; t < numberOfThreads; t++ )
+		{
+			summary.numberOfFailedFits += failedFits[ t ];
+			totalIterations += iterations[ t ];
+		}
+		summary.numberOfObjects = numberOfSamples - summary.numberOfFailedFits;
+		if( summary.numberOfObjects > 0 )
+		{
+			summary.meanIterations = static_cast< Real >( totalIterations ) / summary.numberOfObjects;
+		}
+		summary.seconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+		return summary;
+	}
+
+} // namespace catalogGenerator
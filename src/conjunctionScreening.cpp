@@ -0,0 +1,401 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <boost/array.hpp>
+#include <boost/cstdint.hpp>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Eci.h>
+#include <libsgp4/Globals.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/conjunctionScreening.hpp"
+#include "CppProject/j2Propagator.hpp"
+#include "CppProject/parallelFor.hpp"
+
+namespace conjunctionScreening
+{
+
+	typedef boost::array< Real, 3 > array3;
+
+	ScreeningSettings getDefaultSettings( )
+	{
+		ScreeningSettings settings;
+		settings.missDistanceThreshold = 5.0;
+		settings.timeStep = 10.0;
+		settings.apsisPadding = 25.0;
+		settings.numberOfThreads = 0;
+		return settings;
+	}
+
+	//! Pair within the screening distance at one time step of the hashing stage.
+	struct Approach
+	{
+		int first;
+		int second;
+		int step;
+		Real distance;
+		Real rangeRate;		// [km^2/s], relative position dot relative velocity; negative while approaching
+	};
+
+	//! Order approaches on pair, then time step, so consecutive steps of an encounter are adjacent.
+	bool compareApproaches( const Approach& first, const Approach& second )
+	{
+		if( first.first != second.first )
+			return first.first < second.first;
+		if( first.second != second.second )
+			return first.second < second.second;
+		return first.step < second.step;
+	}
+
+	//! Order conjunctions on ascending miss distance.
+	bool compareConjunctions( const Conjunction& first, const Conjunction& second )
+	{
+		return first.missDistance < second.missDistance;
+	}
+
+	//! Object position sorted into a cubic cell of the spatial hash.
+	struct CellEntry
+	{
+		boost::uint64_t key;
+		int object;
+	};
+
+	bool compareCellEntries( const CellEntry& first, const CellEntry& second )
+	{
+		return first.key < second.key;
+	}
+
+	//! Pack integer cell coordinates into one sortable key (21 bits per axis).
+	boost::uint64_t computeCellKey( const long x, const long y, const long z )
+	{
+		const long offset = 1L << 20;
+		const boost::uint64_t mask = ( 1ULL << 21 ) - 1;
+		return ( ( static_cast< boost::uint64_t >( x + offset ) & mask ) << 42 )
+			 | ( ( static_cast< boost::uint64_t >( y + offset ) & mask ) << 21 )
+			 | ( static_cast< boost::uint64_t >( z + offset ) & mask );
+	}
+
+	//! SGP4 position and velocity at an epoch; false if SGP4 fails (e.g. decayed object).
+	bool findState( const SGP4& sgp4, const DateTime& epoch, array3& position, array3& velocity )
+	{
+		try
+		{
+			const Eci state = sgp4.FindPosition( epoch );
+			position[ 0 ] = state.Position( ).x;
+			position[ 1 ] = state.Position( ).y;
+			position[ 2 ] = state.Position( ).z;
+			velocity[ 0 ] = state.Velocity( ).x;
+			velocity[ 1 ] = state.Velocity( ).y;
+			velocity[ 2 ] = state.Velocity( ).z;
+		}
+		catch( const std::exception& )
+		{
+			return false;
+		}
+		return true;
+	}
+
+	//! Relative position and velocity of two objects at an epoch; false if SGP4 fails for either.
+	bool findRelativeState( const SGP4& first, const SGP4& second, const DateTime& epoch,
+							array3& relativePosition, array3& relativeVelocity )
+	{
+		array3 firstPosition, firstVelocity, secondPosition, secondVelocity;
+		if( !findState( first, epoch, firstPosition, firstVelocity ) || !findState( second, epoch, secondPosition, secondVelocity ) )
+		{
+			return false;
+		}
+		for( int j = 0; j < 3; j++ )
+		{
+			relativePosition[ j ] = secondPosition[ j ] - firstPosition[ j ];
+			relativeVelocity[ j ] = secondVelocity[ j ] - firstVelocity[ j ];
+		}
+		return true;
+	}
+
+	Real computeNorm( const array3& vector )
+	{
+		return std::sqrt( vector[ 0 ] * vector[ 0 ] + vector[ 1 ] * vector[ 1 ] + vector[ 2 ] * vector[ 2 ] );
+	}
+
+	Real computeDot( const array3& first, const array3& second )
+	{
+		return first[ 0 ] * second[ 0 ] + first[ 1 ] * second[ 1 ] + first[ 2 ] * second[ 2 ];
+	}
+
+	//! Mark the objects whose radius band [ low, high ] overlaps the band of at least one other object
+	/*!
+	 * With the bands sorted on their lower bound, an object overlaps an earlier one if the largest
+	 * upper bound before it reaches its lower bound, and a later one if the next lower bound lies
+	 * below its upper bound. This costs O(N log N) instead of testing every pair.
+	 */
+	std::vector< bool > findOverlappingBands( const std::vector< Real >& low, const std::vector< Real >& high )
+	{
+		std::vector< std::pair< Real, int > > order( low.size( ) );
+		for( unsigned int k = 0; k < low.size( ); k++ )
+		{
+			order[ k ] = std::make_pair( low[ k ], k );
+		}
+		std::sort( order.begin( ), order.end( ) );
+
+		std::vector< bool > overlapping( low.size( ), false );
+		Real largestHigh = -1.0e300;
+		for( unsigned int k = 0; k < order.size( ); k++ )
+		{
+			const int object = order[ k ].second;
+			if( largestHigh >= low[ object ] || ( k + 1 < order.size( ) && order[ k + 1 ].first <= high[ object ] ) )
+			{
+				overlapping[ object ] = true;
+			}
+			largestHigh = std::max( largestHigh, high[ object ] );
+		}
+		return overlapping;
+	}
+
+	std::vector< Conjunction > screenConjunctions( const std::vector< Tle >& catalog,
+												   const DateTime& windowStart,
+												   const Real windowMinutes,
+												   const ScreeningSettings& settings,
+												   ScreeningStatistics& statistics )
+	{
+		if( !( settings.timeStep > 0.0 ) )
+		{
+			throw std::runtime_error( "Conjunction screening needs a positive time step" );
+		}
+		const int numberOfObjects = catalog.size( );
+		const Real threshold = settings.missDistanceThreshold;
+		const Real timeStep = settings.timeStep;
+
+		// stage 1: apogee/perigee filter on the mean elements
+		std::vector< Real > bandLow( numberOfObjects );
+		std::vector< Real > bandHigh( numberOfObjects );
+		std::vector< Real > maximumSpeed( numberOfObjects );
+		std::vector< SGP4 > propagators;
+		for( int k = 0; k < numberOfObjects; k++ )
+		{
+			const j2Propagator::MeanElements elements = j2Propagator::computeMeanElements( catalog[ k ] );
+			const Real perigee = elements.semiMajorAxis * ( 1.0 - elements.eccentricity );
+			const Real apogee = elements.semiMajorAxis * ( 1.0 + elements.eccentricity );
+			bandLow[ k ] = perigee - settings.apsisPadding - threshold;
+			bandHigh[ k ] = apogee + settings.apsisPadding;
+			maximumSpeed[ k ] = std::sqrt( kMU / elements.semiMajorAxis * ( 1.0 + elements.eccentricity ) / ( 1.0 - elements.eccentricity ) );
+			propagators.push_back( SGP4( catalog[ k ] ) );
+		}
+		const std::vector< bool > overlapping = findOverlappingBands( bandLow, bandHigh );
+
+		std::vector< int > screenedObjects;
+		Real fastestSpeed = 0.0;
+		Real secondFastestSpeed = 0.0;
+		for( int k = 0; k < numberOfObjects; k++ )
+		{
+			if( !overlapping[ k ] )
+			{
+				continue;
+			}
+			screenedObjects.push_back( k );
+			if( maximumSpeed[ k ] > fastestSpeed )
+			{
+				secondFastestSpeed = fastestSpeed;
+				fastestSpeed = maximumSpeed[ k ];
+			}
+			else
+			{
+				secondFastestSpeed = std::max( secondFastestSpeed, maximumSpeed[ k ] );
+			}
+		}
+
+		// a closest approach between two steps lies within half a step of relative motion of one of them
+		const Real screeningDistance = threshold + 0.5 * ( fastestSpeed + secondFastestSpeed ) * timeStep;
+		const int numberOfSteps = static_cast< int >( std::floor( windowMinutes * 60.0 / timeStep ) ) + 1;
+
+		statistics.numberOfObjects = numberOfObjects;
+		statistics.numberOfScreenedObjects = screenedObjects.size( );
+		statistics.numberOfSteps = numberOfSteps;
+		statistics.screeningDistance = screeningDistance;
+
+		// stage 2: sort-based spatial hashing at every time step, steps spread over the threads
+		const int numberOfThreads = parallelFor::getNumberOfThreads( settings.numberOfThreads );
+		std::vector< std::vector< Approach > > threadApproaches( numberOfThreads );
+		std::vector< long > threadDistanceChecks( numberOfThreads, 0 );
+		parallelFor::parallelFor( numberOfSteps, numberOfThreads,
+								  [ & ]( const int beginStep, const int endStep, const int thread )
+		{
+			std::vector< array3 > positions( numberOfObjects );
+			std::vector< array3 > velocities( numberOfObjects );
+			std::vector< CellEntry > entries;
+			for( int step = beginStep; step < endStep; step++ )
+			{
+				const DateTime epoch = windowStart.AddSeconds( step * timeStep );
+				entries.clear( );
+				for( unsigned int s = 0; s < screenedObjects.size( ); s++ )
+				{
+					const int object = screenedObjects[ s ];
+					if( findState( propagators[ object ], epoch, positions[ object ], velocities[ object ] ) )
+					{
+						const CellEntry entry = { computeCellKey( static_cast< long >( std::floor( positions[ object ][ 0 ] / screeningDistance ) ),
+																  static_cast< long >( std::floor( positions[ object ][ 1 ] / screeningDistance ) ),
+																  static_cast< long >( std::floor( positions[ object ][ 2 ] / screeningDistance ) ) ),
+												  object };
+						entries.push_back( entry );
+					}
+				}
+				std::sort( entries.begin( ), entries.end( ), compareCellEntries );
+
+				for( unsigned int e = 0; e < entries.size( ); e++ )
+				{
+					const int object = entries[ e ].object;
+					const long x = static_cast< long >( std::floor( positions[ object ][ 0 ] / screeningDistance ) );
+					const long y = static_cast< long >( std::floor( positions[ object ][ 1 ] / screeningDistance ) );
+					const long z = static_cast< long >( std::floor( positions[ object ][ 2 ] / screeningDistance ) );
+					for( int dx = -1; dx <= 1; dx++ )
+					for( int dy = -1; dy <= 1; dy++ )
+					for( int dz = -1; dz <= 1; dz++ )
+					{
+						CellEntry neighbourKey = { computeCellKey( x + dx, y + dy, z + dz ), 0 };
+						std::vector< CellEntry >::const_iterator neighbour
+							= std::lower_bound( entries.begin( ), entries.end( ), neighbourKey, compareCellEntries );
+						for( ; neighbour != entries.end( ) && neighbour->key == neighbourKey.key; ++neighbour )
+						{
+							const int other = neighbour->object;
+							if( other <= object || bandLow[ other ] > bandHigh[ object ] || bandLow[ object ] > bandHigh[ other ] )
+							{
+								continue;
+							}
+							threadDistanceChecks[ thread ]++;
+							array3 difference;
+							array3 velocityDifference;
+							for( int j = 0; j < 3; j++ )
+							{
+								difference[ j ] = positions[ other ][ j ] - positions[ object ][ j ];
+								velocityDifference[ j ] = velocities[ other ][ j ] - velocities[ object ][ j ];
+							}
+							const Real distance = computeNorm( difference );
+							if( distance <= screeningDistance )
+							{
+								const Approach approach = { object, other, step, distance, computeDot( difference, velocityDifference ) };
+								threadApproaches[ thread ].push_back( approach );
+							}
+						}
+					}
+				}
+			}
+		} );
+
+		std::vector< Approach > approaches;
+		statistics.numberOfDistanceChecks = 0;
+		for( int t = 0; t < numberOfThreads; t++ )
+		{
+			approaches.insert( approaches.end( ), threadApproaches[ t ].begin( ), threadApproaches[ t ].end( ) );
+			statistics.numberOfDistanceChecks += threadDistanceChecks[ t ];
+		}
+		std::sort( approaches.begin( ), approaches.end( ), compareApproaches );
+
+		// consecutive steps of the same pair form one encounter, represented by its closest step; a pair
+		// that starts to approach again after receding has passed a largest distance, so the run is
+		// split there and every closest approach of a slow pass is refined on its own
+		std::vector< Approach > encounters;
+		for( unsigned int a = 0; a < approaches.size( ); a++ )
+		{
+			const bool isContinuation = a > 0
+										&& approaches[ a ].first == approaches[ a - 1 ].first
+										&& approaches[ a ].second == approaches[ a - 1 ].second
+										&& approaches[ a ].step == approaches[ a - 1 ].step + 1
+										&& !( approaches[ a - 1 ].rangeRate >= 0.0 && approaches[ a ].rangeRate < 0.0 );
+			if( !isContinuation )
+			{
+				encounters.push_back( approaches[ a ] );
+			}
+			else if( approaches[ a ].distance < encounters.back( ).distance )
+			{
+				encounters.back( ) = approaches[ a ];
+			}
+		}
+		statistics.numberOfEncounters = encounters.size( );
+
+		// stage 3: time of closest approach by bisection on the range rate around the closest step
+		const Real windowSeconds = windowMinutes * 60.0;
+		std::vector< std::vector< Conjunction > > threadConjunctions( numberOfThreads );
+		parallelFor::parallelFor( encounters.size( ), numberOfThreads,
+								  [ & ]( const int begin, const int end, const int thread )
+		{
+			array3 relativePosition;
+			array3 relativeVelocity;
+			for( int k = begin; k < end; k++ )
+			{
+				const SGP4& first = propagators[ encounters[ k ].first ];
+				const SGP4& second = propagators[ encounters[ k ].second ];
+				Real lower = std::max( 0.0, ( encounters[ k ].step - 1 ) * timeStep );
+				Real upper = std::min( windowSeconds, ( encounters[ k ].step + 1 ) * timeStep );
+
+				if( !findRelativeState( first, second, windowStart.AddSeconds( lower ), relativePosition, relativeVelocity ) )
+				{
+					continue;
+				}
+				const Real lowerRangeRate = computeDot( relativePosition, relativeVelocity );
+				if( !findRelativeState( first, second, windowStart.AddSeconds( upper ), relativePosition, relativeVelocity ) )
+				{
+					continue;
+				}
+				const Real upperRangeRate = computeDot( relativePosition, relativeVelocity );
+
+				// without a sign change the pair approaches or recedes over the whole bracket, which
+				// happens at the edges of the window: the closest point is then a bracket end
+				Real timeOfClosestApproach = lowerRangeRate >= 0.0 ? lower : upper;
+				if( lowerRangeRate < 0.0 && upperRangeRate > 0.0 )
+				{
+					while( upper - lower > 1.0e-3
+						   && findRelativeState( first, second, windowStart.AddSeconds( 0.5 * ( lower + upper ) ),
+												 relativePosition, relativeVelocity ) )
+					{
+						if( computeDot( relativePosition, relativeVelocity ) < 0.0 )
+						{
+							lower = 0.5 * ( lower + upper );
+						}
+						else
+						{
+							upper = 0.5 * ( lower + upper );
+						}
+					}
+					timeOfClosestApproach = 0.5 * ( lower + upper );
+				}
+
+				const DateTime epoch = windowStart.AddSeconds( timeOfClosestApproach );
+				if( !findRelativeState( first, second, epoch, relativePosition, relativeVelocity ) )
+				{
+					continue;
+				}
+				const Real missDistance = computeNorm( relativePosition );
+				if( missDistance < threshold )
+				{
+					Conjunction conjunction;
+					conjunction.firstObjectId = catalog[ encounters[ k ].first ].NoradNumber( );
+					conjunction.secondObjectId = catalog[ encounters[ k ].second ].NoradNumber( );
+					conjunction.timeOfClosestApproach = epoch;
+					conjunction.missDistance = missDistance;
+					conjunction.relativeSpeed = computeNorm( relativeVelocity );
+					threadConjunctions[ thread ].push_back( conjunction );
+				}
+			}
+		} );
+
+		std::vector< Conjunction > conjunctions;
+		for( int t = 0; t < numberOfThreads; t++ )
+		{
+			conjunctions.insert( conjunctions.end( ), threadConjunctions[ t ].begin( ), threadConjunctions[ t ].end( ) );
+		}
+		std::sort( conjunctions.begin( ), conjunctions.end( ), compareConjunctions );
+		return conjunctions;
+	}
+
+} // namespace conjunctionScreening
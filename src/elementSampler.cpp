@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include "CppProject/elementSampler.hpp"
+#include "CppProject/parallelFor.hpp"
+#include "CppProject/randomGen.hpp"
+
+namespace elementSampler
+{
+
+	typedef boost::mt19937 generator_type;
+
+	//! Number of binary digits of a Sobol coordinate
+	const int numberOfBits = 32;
+
+	//! Primitive polynomials and initial direction numbers of dimensions 2 to 6 (Joe and Kuo, new-joe-kuo-6.21201)
+	const int sobolDegree[ numberOfElements - 1 ] = { 1, 2, 3, 3, 4 };
+	const int sobolCoefficients[ numberOfElements - 1 ] = { 0, 1, 1, 2, 1 };
+	const int sobolInitialNumbers[ numberOfElements - 1 ][ 4 ] = { { 1, 0, 0, 0 },
+																   { 1, 3, 0, 0 },
+																   { 1, 3, 1, 0 },
+																   { 1, 1, 1, 0 },
+																   { 1, 1, 3, 3 } };
+
+	//! Parity of the set bits of a word.
+	boost::uint32_t computeParity( boost::uint32_t word )
+	{
+		word ^= word >> 16;
+		word ^= word >> 8;
+		word ^= word >> 4;
+		word ^= word >> 2;
+		word ^= word >> 1;
+		return word & 1u;
+	}
+
+	//! Direction numbers of one Sobol dimension, the first binary digit in the most significant bit.
+	std::vector< boost::uint32_t > computeDirectionNumbers( const int dimension )
+	{
+		std::vector< boost::uint32_t > directions( numberOfBits );
+		if( dimension == 0 )
+		{
+			for( int k = 0; k < numberOfBits; k++ )
+			{
+				directions[ k ] = 1u << ( numberOfBits - 1 - k );
+			}
+			return directions;
+		}
+
+		const int degree = sobolDegree[ dimension - 1 ];
+		const int coefficients = sobolCoefficients[ dimension - 1 ];
+		for( int k = 0; k < degree; k++ )
+		{
+			directions[ k ] = static_cast< boost::uint32_t >( sobolInitialNumbers[ dimension - 1 ][ k ] ) << ( numberOfBits - 1 - k );
+		}
+		for( int k = degree; k < numberOfBits; k++ )
+		{
+			directions[ k ] = directions[ k - degree ] ^ ( directions[ k - degree ] >> degree );
+			for( int j = 1; j < degree; j++ )
+			{
+				if( ( coefficients >> ( degree - 1 - j ) ) & 1 )
+				{
+					directions[ k ] ^= directions[ k - j ];
+				}
+			}
+		}
+		return directions;
+	}
+
+	//! Apply a random lower-triangular binary matrix with unit diagonal to the digits of the direction numbers.
+	void scrambleDirectionNumbers( std::vector< boost::uint32_t >& directions, generator_type& generator )
+	{
+		std::vector< boost::uint32_t > rows( numberOfBits );
+		for( int j = 0; j < numberOfBits; j++ )
+		{
+			// digit j depends on itself and a random subset of the more significant digits
+			const boost::uint32_t diagonal = 1u << ( numberOfBits - 1 - j );
+			const boost::uint32_t moreSignificant = j == 0 ? 0u : ~( ( diagonal << 1 ) - 1u );
+			rows[ j ] = diagonal | ( static_cast< boost::uint32_t >( generator( ) ) & moreSignificant );
+		}
+		for( int k = 0; k < numberOfBits; k++ )
+		{
+			boost::uint32_t scrambled = 0;
+			for( int j = 0; j < numberOfBits; j++ )
+			{
+				scrambled |= computeParity( directions[ k ] & rows[ j ] ) << ( numberOfBits - 1 - j );
+			}
+			directions[ k ] = scrambled;
+		}
+	}
+
+	//! Seeds of the per-element generators of the Sobol and Latin hypercube designs.
+	std::vector< boost::uint32_t > computeElementSeeds( const int seed )
+	{
+		generator_type generator( seed );
+		std::vector< boost::uint32_t > seeds( numberOfElements );
+		for( int d = 0; d < numberOfElements; d++ )
+		{
+			seeds[ d ] = generator( );
+		}
+		return seeds;
+	}
+
+	SamplerSettings getDefaultSettings( )
+	{
+		SamplerSettings settings;
+		settings.design = sobolDesign;
+		settings.seed = 1;
+		settings.minimumPerigeeRadius = 0.0;
+		settings.maximumPerigeeRadius = 0.0;
+		settings.numberOfThreads = 0;
+		return settings;
+	}
+
+	const char* getDesignName( const SamplingDesign design )
+	{
+		switch( design )
+		{
+			case uniformDesign: return "uniform";
+			case sobolDesign: return "sobol";
+			case latinHypercubeDesign: return "lhs";
+		}
+		return "";
+	}
+
+	SamplingDesign findDesign( const std::string& name )
+	{
+		const SamplingDesign designs[ ] = { uniformDesign, sobolDesign, latinHypercubeDesign };
+		for( int k = 0; k < 3; k++ )
+		{
+			if( name == getDesignName( designs[ k ] ) )
+			{
+				return designs[ k ];
+			}
+		}
+		throw std::runtime_error( "Unknown sampling design: " + name );
+	}
+
+	Vector2D generateUnitSamples( const SamplingDesign design,
+								  const int numberOfSamples,
+								  const int seed,
+								  const int numberOfThreads )
+	{
+		Vector2D samples( numberOfSamples, std::vector< Real >( numberOfElements ) );
+
+		if( design == sobolDesign )
+		{
+			std::vector< std::vector< boost::uint32_t > > directions( numberOfElements );
+			std::vector< boost::uint32_t > shifts( numberOfElements );
+			const std::vector< boost::uint32_t > elementSeeds = computeElementSeeds( seed );
+			for( int d = 0; d < numberOfElements; d++ )
+			{
+				generator_type generator( elementSeeds[ d ] );
+				directions[ d ] = computeDirectionNumbers( d );
+				scrambleDirectionNumbers( directions[ d ], generator );
+				shifts[ d ] = generator( );
+			}
+
+			// every block starts from its first point in Gray code order and continues incrementally
+			parallelFor::parallelFor( numberOfSamples, numberOfThreads,
+									  [ & ]( const int begin, const int end, const int )
+			{
+				std::vector< boost::uint32_t > point( numberOfElements, 0u );
+				const boost::uint32_t gray = static_cast< boost::uint32_t >( begin ) ^ ( static_cast< boost::uint32_t >( begin ) >> 1 );
+				for( int k = 0; k < numberOfBits; k++ )
+				{
+					if( ( gray >> k ) & 1u )
+					{
+						for( int d = 0; d < numberOfElements; d++ )
+						{
+							point[ d ] ^= directions[ d ][ k ];
+						}
+					}
+				}
+				for( int n = begin; n < end; n++ )
+				{
+					for( int d = 0; d < numberOfElements; d++ )
+					{
+						samples[ n ][ d ] = std::ldexp( static_cast< Real >( point[ d ] ^ shifts[ d ] ), -numberOfBits );
+					}
+					// the next point differs in the direction number of the lowest zero bit of n
+					int k = 0;
+					while( ( n >> k ) & 1 )
+					{
+						k++;
+					}
+					for( int d = 0; d < numberOfElements; d++ )
+					{
+						point[ d ] ^= directions[ d ][ k ];
+					}
+				}
+			} );
+			return samples;
+		}
+
+		// uniform and Latin hypercube coordinates are generated per element, one element per thread
+		const std::vector< boost::uint32_t > elementSeeds = computeElementSeeds( seed );
+		parallelFor::parallelFor( numberOfElements, numberOfThreads,
+								  [ & ]( const int begin, const int end, const int )
+		{
+			for( int d = begin; d < end; d++ )
+			{
+				if( design == uniformDesign )
+				{
+					randomGen::VectorLong coordinates( numberOfSamples );
+					randomGen::randomGenWithSeed( randomGen::Vector2( { 0.0, 1.0 } ), numberOfSamples, coordinates, seed + d );
+					for( int n = 0; n < numberOfSamples; n++ )
+					{
+						samples[ n ][ d ] = coordinates[ n ];
+					}
+					continue;
+				}
+
+				// random pairing of the strata (Fisher-Yates) and a random position inside every stratum
+				generator_type generator( elementSeeds[ d ] );
+				std::vector< int > strata( numberOfSamples );
+				for( int n = 0; n < numberOfSamples; n++ )
+				{
+					strata[ n ] = n;
+				}
+				for( int n = numberOfSamples - 1; n > 0; n-- )
+				{
+					boost::uniform_int<> distribution( 0, n );
+					std::swap( strata[ n ], strata[ distribution( generator ) ] );
+				}
+				boost::uniform_real<> distribution( 0.0, 1.0 );
+				boost::variate_generator< generator_type&, boost::uniform_real<> > uniform( generator, distribution );
+				for( int n = 0; n < numberOfSamples; n++ )
+				{
+					samples[ n ][ d ] = ( strata[ n ] + uniform( ) ) / numberOfSamples;
+				}
+			}
+		} );
+		return samples;
+	}
+
+	Vector2D mapUnitSamples( const Vector2D& unitSamples, const ElementRanges& ranges, const SamplerSettings& settings )
+	{
+		const Vector2* elementRanges[ numberOfElements ] = { &ranges.semiMajorAxis, &ranges.eccentricity, &ranges.inclination,
+															  &ranges.rightAscendingNode, &ranges.argumentPerigee,
+															  &ranges.eccentricAnomaly };
+
+		// eccentricities for which some semi-major axis puts the perigee in the band
+		Real minimumEccentricity = ranges.eccentricity[ 0 ];
+		Real maximumEccentricity = ranges.eccentricity[ 1 ];
+		if( settings.minimumPerigeeRadius > 0.0 )
+		{
+			maximumEccentricity = std::min( maximumEccentricity, 1.0 - settings.minimumPerigeeRadius / ranges.semiMajorAxis[ 1 ] );
+		}
+		if( settings.maximumPerigeeRadius > 0.0 )
+		{
+			minimumEccentricity = std::max( minimumEccentricity, 1.0 - settings.maximumPerigeeRadius / ranges.semiMajorAxis[ 0 ] );
+		}
+		if( minimumEccentricity > maximumEccentricity
+			|| ( settings.maximumPerigeeRadius > 0.0 && settings.minimumPerigeeRadius > settings.maximumPerigeeRadius ) )
+		{
+			throw std::runtime_error( "No orbit in the element ranges has its perigee in the perigee band" );
+		}
+
+		Vector2D elements( unitSamples.size( ), std::vector< Real >( numberOfElements ) );
+		parallelFor::parallelFor( unitSamples.size( ), settings.numberOfThreads,
+								  [ & ]( const int begin, const int end, const int )
+		{
+			for( int n = begin; n < end; n++ )
+			{
+				for( int d = 2; d < numberOfElements; d++ )
+				{
+					const Vector2& range = *elementRanges[ d ];
+					elements[ n ][ d ] = range[ 0 ] + unitSamples[ n ][ d ] * ( range[ 1 ] - range[ 0 ] );
+				}
+
+				const Real eccentricity = minimumEccentricity + unitSamples[ n ][ 1 ] * ( maximumEccentricity - minimumEccentricity );
+				Real minimumSemiMajorAxis = ranges.semiMajorAxis[ 0 ];
+				Real maximumSemiMajorAxis = ranges.semiMajorAxis[ 1 ];
+				if( settings.minimumPerigeeRadius > 0.0 )
+				{
+					minimumSemiMajorAxis = std::max( minimumSemiMajorAxis, settings.minimumPerigeeRadius / ( 1.0 - eccentricity ) );
+				}
+				if( settings.maximumPerigeeRadius > 0.0 )
+				{
+					maximumSemiMajorAxis = std::min( maximumSemiMajorAxis, settings.maximumPerigeeRadius / ( 1.0 - eccentricity ) );
+				}
+				elements[ n ][ 0 ] = minimumSemiMajorAxis + unitSamples[ n ][ 0 ] * ( maximumSemiMajorAxis - minimumSemiMajorAxis );
+				elements[ n ][ 1 ] = eccentricity;
+			}
+		} );
+		return elements;
+	}
+
+	Vector2D sampleKeplerianElements( const ElementRanges& ranges, const int numberOfSamples, const SamplerSettings& settings )
+	{
+		return mapUnitSamples( generateUnitSamples( settings.design, numberOfSamples, settings.seed, settings.numberOfThreads ),
+							   ranges, settings );
+	}
+
+	Real computeCenteredDiscrepancy( const Vector2D& unitSamples, const int numberOfThreads )
+	{
+		const int numberOfSamples = unitSamples.size( );
+		if( numberOfSamples == 0 )
+		{
+			return 0.0;
+		}
+
+		// per-row sums are added up in row order so the result does not depend on the number of threads
+		std::vector< Real > singleSums( numberOfSamples );
+		std::vector< Real > pairSums( numberOfSamples );
+		parallelFor::parallelFor( numberOfSamples, numberOfThreads,
+								  [ & ]( const int begin, const int end, const int )
+		{
+			for( int i = begin; i < end; i++ )
+			{
+				Real single = 1.0;
+				for( int d = 0; d < numberOfElements; d++ )
+				{
+					const Real centered = std::fabs( unitSamples[ i ][ d ] - 0.5 );
+					single *= 1.0 + 0.5 * centered - 0.5 * centered * centered;
+				}
+				singleSums[ i ] = single;
+
+				Real pairs = 0.0;
+				for( int j = 0; j < numberOfSamples; j++ )
+				{
+					Real product = 1.0;
+					for( int d = 0; d < numberOfElements; d++ )
+					{
+						product *= 1.0 + 0.5 * std::fabs( unitSamples[ i ][ d ] - 0.5 )
+									   + 0.5 * std::fabs( unitSamples[ j ][ d ] - 0.5 )
+									   - 0.5 * std::fabs( unitSamples[ i ][ d ] - unitSamples[ j ][ d ] );
+					}
+					pairs += product;
+				}
+				pairSums[ i ] = pairs;
+			}
+		} );
+
+		Real singleSum = 0.0;
+		Real pairSum = 0.0;
+		for( int i = 0; i < numberOfSamples; i++ )
+		{
+			singleSum += singleSums[ i ];
+			pairSum += pairSums[ i ];
+		}
+		const Real squaredDiscrepancy = std::pow( 13.0 / 12.0, numberOfElements ) - 2.0 * singleSum / numberOfSamples
+										+ pairSum / ( static_cast< Real >( numberOfSamples ) * numberOfSamples );
+		return std::sqrt( std::max( 0.0, squaredDiscrepancy ) );
+	}
+
+	std::vector< ConvergencePoint > compareConvergence( const ElementRanges& ranges,
+														const std::vector< int >& sampleSizes,
+														const int numberOfReplicates,
+														const int numberOfThreads )
+	{
+		const SamplingDesign designs[ ] = { uniformDesign, sobolDesign, latinHypercubeDesign };
+		const Real exactMeanPerigee = 0.5 * ( ranges.semiMajorAxis[ 0 ] + ranges.semiMajorAxis[ 1 ] )
+									  * ( 1.0 - 0.5 * ( ranges.eccentricity[ 0 ] + ranges.eccentricity[ 1 ] ) );
+
+		std::vector< ConvergencePoint > convergence;
+		for( unsigned int s = 0; s < sampleSizes.size( ); s++ )
+		{
+			for( int k = 0; k < 3; k++ )
+			{
+				ConvergencePoint point;
+				point.design = designs[ k ];
+				point.numberOfSamples = sampleSizes[ s ];
+				point.meanDiscrepancy = 0.0;
+				point.rmsMeanPerigeeError = 0.0;
+
+				SamplerSettings settings = getDefaultSettings( );
+				settings.design = designs[ k ];
+				settings.numberOfThreads = numberOfThreads;
+				for( int r = 0; r < numberOfReplicates; r++ )
+				{
+					settings.seed = 1 + numberOfElements * r;
+					const Vector2D unitSamples = generateUnitSamples( settings.design, sampleSizes[ s ], settings.seed, numberOfThreads );
+					const Vector2D elements = mapUnitSamples( unitSamples, ranges, settings );
+
+					Real meanPerigee = 0.0;
+					for( unsigned int n = 0; n < elements.size( ); n++ )
+					{
+						meanPerigee += elements[ n ][ 0 ] * ( 1.0 - elements[ n ][ 1 ] );
+					}
+					meanPerigee /= elements.size( );
+
+					point.meanDiscrepancy += computeCenteredDiscrepancy( unitSamples, numberOfThreads );
+					point.rmsMeanPerigeeError += ( meanPerigee - exactMeanPerigee ) * ( meanPerigee - exactMeanPerigee );
+				}
+				point.meanDiscrepancy /= numberOfReplicates;
+				point.rmsMeanPerigeeError = std::sqrt( point.rmsMeanPerigeeError / numberOfReplicates );
+				convergence.push_back( point );
+			}
+		}
+		return convergence;
+	}
+
+} // namespace elementSampler
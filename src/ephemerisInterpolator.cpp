@@ -0,0 +1,431 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Eci.h>
+#include <libsgp4/Globals.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/ephemerisInterpolator.hpp"
+
+namespace ephemerisInterpolator
+{
+
+	//! Shortest segment [min]; a segment of this length is kept even if it misses the error bound.
+	const Real minimumSegmentLength = 0.5;
+
+	//! Longest segment [min].
+	const Real maximumSegmentLength = 360.0;
+
+	//! Highest degree an ephemeris file may hold.
+	const int maximumDegree = 64;
+
+	//! Evenly spaced points per Chebyshev node at which a segment is checked against SGP4.
+	const int checkPointsPerNode = 4;
+
+	//! Evaluate a Chebyshev series and its derivative with respect to x at x in [-1, 1].
+	void evaluateChebyshev( const Real* coefficients, const int degree, const Real x, Real& value, Real& derivative )
+	{
+		// T_k(x) and U_{k-1}(x) by their recurrences; T_k'(x) = k U_{k-1}(x)
+		Real tPrevious = 1.0;
+		Real tCurrent = x;
+		Real uPrevious = 0.0;
+		Real uCurrent = 1.0;
+		value = coefficients[ 0 ];
+		derivative = 0.0;
+		if( degree == 0 )
+		{
+			return;
+		}
+		value += coefficients[ 1 ] * tCurrent;
+		derivative += coefficients[ 1 ] * uCurrent;
+		for( int k = 2; k <= degree; k++ )
+		{
+			const Real tNext = 2.0 * x * tCurrent - tPrevious;
+			const Real uNext = 2.0 * x * uCurrent - uPrevious;
+			tPrevious = tCurrent;
+			tCurrent = tNext;
+			uPrevious = uCurrent;
+			uCurrent = uNext;
+			value += coefficients[ k ] * tCurrent;
+			derivative += k * coefficients[ k ] * uCurrent;
+		}
+	}
+
+	//! Position of an object from SGP4 at the given minutes since the TLE epoch.
+	void findSgp4Position( const SGP4& sgp4, const Real minutesSinceTleEpoch, array3& position )
+	{
+		const Eci state = sgp4.FindPosition( minutesSinceTleEpoch );
+		position[ 0 ] = state.Position( ).x;
+		position[ 1 ] = state.Position( ).y;
+		position[ 2 ] = state.Position( ).z;
+	}
+
+	//! Fit one Chebyshev segment to SGP4 and return its maximum position error at the check points.
+	Real fitSegment( const SGP4& sgp4,
+					 const Real windowOffsetMinutes,
+					 const Real startMinutes,
+					 const Real lengthMinutes,
+					 const int degree,
+					 std::vector< Real >& coefficients )
+	{
+		const int numberOfNodes = degree + 1;
+		std::vector< array3 > nodePositions( numberOfNodes );
+		for( int j = 0; j < numberOfNodes; j++ )
+		{
+			const Real x = std::cos( kPI * ( j + 0.5 ) / numberOfNodes );
+			findSgp4Position( sgp4, windowOffsetMinutes + startMinutes + 0.5 * lengthMinutes * ( x + 1.0 ), nodePositions[ j ] );
+		}
+
+		coefficients.assign( 3 * numberOfNodes, 0.0 );
+		for( int component = 0; component < 3; component++ )
+		{
+			for( int k = 0; k < numberOfNodes; k++ )
+			{
+				Real sum = 0.0;
+				for( int j = 0; j < numberOfNodes; j++ )
+				{
+					sum += nodePositions[ j ][ component ] * std::cos( kPI * k * ( j + 0.5 ) / numberOfNodes );
+				}
+				coefficients[ component * numberOfNodes + k ] = ( k == 0 ? 1.0 : 2.0 ) * sum / numberOfNodes;
+			}
+		}
+
+		// check the fit halfway between the nodes, where the error of an interpolant on Chebyshev nodes
+		// peaks, and on an even grid over the segment that includes both ends
+		const int numberOfEvenPoints = checkPointsPerNode * numberOfNodes + 1;
+		Real maximumError = 0.0;
+		for( int j = 0; j < numberOfNodes - 1 + numberOfEvenPoints; j++ )
+		{
+			const Real x = j < numberOfNodes - 1 ? std::cos( kPI * ( j + 1.0 ) / numberOfNodes )
+												 : -1.0 + 2.0 * ( j - numberOfNodes + 1 ) / ( numberOfEvenPoints - 1 );
+			array3 reference;
+			findSgp4Position( sgp4, windowOffsetMinutes + startMinutes + 0.5 * lengthMinutes * ( x + 1.0 ), reference );
+
+			Real errorSquared = 0.0;
+			for( int component = 0; component < 3; component++ )
+			{
+				Real value;
+				Real derivative;
+				evaluateChebyshev( &coefficients[ component * numberOfNodes ], degree, x, value, derivative );
+				errorSquared += ( value - reference[ component ] ) * ( value - reference[ component ] );
+			}
+			maximumError = std::max( maximumError, std::sqrt( errorSquared ) );
+		}
+		return maximumError;
+	}
+
+	ObjectEphemeris::ObjectEphemeris( )
+		: noradNumber( 0 ),
+		  tleHash( 0 ),
+		  degree( 0 ),
+		  maximumPositionError( 0.0 ),
+		  isErrorBoundMet( true )
+	{ }
+
+	void ObjectEphemeris::findState( const Real minutesSinceStart, array3& position, array3& velocity ) const
+	{
+		if( segments.empty( ) || minutesSinceStart < segments.front( ).startMinutes
+			|| minutesSinceStart > segments.back( ).startMinutes + segments.back( ).lengthMinutes )
+		{
+			throw std::out_of_range( "Epoch outside of the interpolated ephemeris window" );
+		}
+
+		// binary search for the last segment starting at or before the requested time
+		int lower = 0;
+		int upper = segments.size( ) - 1;
+		while( lower < upper )
+		{
+			const int middle = ( lower + upper + 1 ) / 2;
+			if( segments[ middle ].startMinutes <= minutesSinceStart )
+			{
+				lower = middle;
+			}
+			else
+			{
+				upper = middle - 1;
+			}
+		}
+
+		const ChebyshevSegment& segment = segments[ lower ];
+		const Real x = 2.0 * ( minutesSinceStart - segment.startMinutes ) / segment.lengthMinutes - 1.0;
+		const Real velocityScale = 2.0 / segment.lengthMinutes / 60.0; // km/min per unit x to km/s
+		const int numberOfNodes = degree + 1;
+		for( int component = 0; component < 3; component++ )
+		{
+			Real derivative;
+			evaluateChebyshev( &segment.coefficients[ component * numberOfNodes ], degree, x, position[ component ], derivative );
+			velocity[ component ] = derivative * velocityScale;
+		}
+	}
+
+	void CatalogEphemeris::findState( const int k, const DateTime& epoch, array3& position, array3& velocity ) const
+	{
+		objects[ k ].findState( ( epoch - windowStart ).TotalMinutes( ), position, velocity );
+	}
+
+	boost::uint64_t computeTleHash( const Tle& tle )
+	{
+		const std::string lines = tle.Line1( ) + "\n" + tle.Line2( );
+		boost::uint64_t hash = 14695981039346656037ULL;
+		for( unsigned int k = 0; k < lines.size( ); k++ )
+		{
+			hash ^= static_cast< unsigned char >( lines[ k ] );
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	ObjectEphemeris fitObjectEphemeris( const Tle& tle,
+										const DateTime& windowStart,
+										const Real windowMinutes,
+										const Real positionErrorBound,
+										const int degree )
+	{
+		const SGP4 sgp4( tle );
+		const Real windowOffsetMinutes = ( windowStart - tle.Epoch( ) ).TotalMinutes( );
+
+		ObjectEphemeris ephemeris;
+		ephemeris.noradNumber = tle.NoradNumber( );
+		ephemeris.tleHash = computeTleHash( tle );
+		ephemeris.degree = degree;
+
+		Real startMinutes = 0.0;
+		Real lengthMinutes = 30.0;
+		while( startMinutes < windowMinutes )
+		{
+			ChebyshevSegment segment;
+			segment.startMinutes = startMinutes;
+			Real error = 0.0;
+			try
+			{
+				while( true )
+				{
+					segment.lengthMinutes = std::min( lengthMinutes, windowMinutes - startMinutes );
+					error = fitSegment( sgp4, windowOffsetMinutes, startMinutes, segment.lengthMinutes, degree, segment.coefficients );
+					if( error <= positionErrorBound || lengthMinutes <= minimumSegmentLength )
+					{
+						break;
+					}
+					lengthMinutes *= 0.5;
+				}
+			}
+			catch( const std::exception& )
+			{
+				// SGP4 failed inside this segment, the ephemeris ends at the previous one
+				break;
+			}
+
+			// a segment that misses the bound at the shortest length is kept, so the interpolant covers
+			// the window, but the object is flagged
+			ephemeris.isErrorBoundMet = ephemeris.isErrorBoundMet && error <= positionErrorBound;
+			ephemeris.maximumPositionError = std::max( ephemeris.maximumPositionError, error );
+			ephemeris.segments.push_back( segment );
+			startMinutes += segment.lengthMinutes;
+			lengthMinutes = std::min( 1.5 * lengthMinutes, maximumSegmentLength );
+		}
+
+		return ephemeris;
+	}
+
+	CatalogEphemeris fitCatalogEphemeris( const std::vector< Tle >& catalog,
+										  const DateTime& windowStart,
+										  const Real windowMinutes,
+										  const Real positionErrorBound,
+										  const int degree )
+	{
+		CatalogEphemeris ephemeris;
+		ephemeris.windowStart = windowStart;
+		ephemeris.windowMinutes = windowMinutes;
+		ephemeris.positionErrorBound = positionErrorBound;
+		for( unsigned int k = 0; k < catalog.size( ); k++ )
+		{
+			ephemeris.objects.push_back( fitObjectEphemeris( catalog[ k ], windowStart, windowMinutes, positionErrorBound, degree ) );
+		}
+		return ephemeris;
+	}
+
+	Real verifyObjectEphemeris( const ObjectEphemeris& ephemeris,
+								const Tle& tle,
+								const DateTime& windowStart,
+								const int samplesPerSegment )
+	{
+		const SGP4 sgp4( tle );
+		const Real windowOffsetMinutes = ( windowStart - tle.Epoch( ) ).TotalMinutes( );
+
+		Real maximumError = 0.0;
+		for( unsigned int s = 0; s < ephemeris.segments.size( ); s++ )
+		{
+			const ChebyshevSegment& segment = ephemeris.segments[ s ];
+			for( int j = 0; j <= samplesPerSegment; j++ )
+			{
+				const Real minutes = segment.startMinutes + segment.lengthMinutes * j / samplesPerSegment;
+				array3 position;
+				array3 velocity;
+				array3 reference;
+				ephemeris.findState( minutes, position, velocity );
+				findSgp4Position( sgp4, windowOffsetMinutes + minutes, reference );
+				maximumError = std::max( maximumError, std::sqrt( ( position[ 0 ] - reference[ 0 ] ) * ( position[ 0 ] - reference[ 0 ] )
+																  + ( position[ 1 ] - reference[ 1 ] ) * ( position[ 1 ] - reference[ 1 ] )
+																  + ( position[ 2 ] - reference[ 2 ] ) * ( position[ 2 ] - reference[ 2 ] ) ) );
+			}
+		}
+		return maximumError;
+	}
+
+	std::string getEphemerisPath( const std::string& catalogPath )
+	{
+		return catalogPath + ".eph";
+	}
+
+	const char ephemerisMagic[ 8 ] = { 'A', 'T', 'O', 'M', 'E', 'P', 'H', '3' };
+
+	template< typename T >
+	void writeValue( std::ofstream& file, const T value )
+	{
+		file.write( reinterpret_cast< const char* >( &value ), sizeof( T ) );
+	}
+
+	template< typename T >
+	T readValue( std::ifstream& file )
+	{
+		T value;
+		file.read( reinterpret_cast< char* >( &value ), sizeof( T ) );
+		return value;
+	}
+
+	void writeCatalogEphemeris( const std::string& path, const CatalogEphemeris& ephemeris )
+	{
+		std::ofstream file( path.c_str( ), std::ios::binary );
+		file.write( ephemerisMagic, sizeof( ephemerisMagic ) );
+		writeValue< boost::int64_t >( file, ephemeris.windowStart.Ticks( ) );
+		writeValue< Real >( file, ephemeris.windowMinutes );
+		writeValue< Real >( file, ephemeris.positionErrorBound );
+		writeValue< boost::uint32_t >( file, ephemeris.objects.size( ) );
+		for( unsigned int k = 0; k < ephemeris.objects.size( ); k++ )
+		{
+			const ObjectEphemeris& object = ephemeris.objects[ k ];
+			writeValue< boost::uint32_t >( file, object.noradNumber );
+			writeValue< boost::uint64_t >( file, object.tleHash );
+			writeValue< boost::int32_t >( file, object.degree );
+			writeValue< Real >( file, object.maximumPositionError );
+			writeValue< boost::uint8_t >( file, object.isErrorBoundMet ? 1 : 0 );
+			writeValue< boost::uint32_t >( file, object.segments.size( ) );
+			for( unsigned int s = 0; s < object.segments.size( ); s++ )
+			{
+				writeValue< Real >( file, object.segments[ s ].startMinutes );
+				writeValue< Real >( file, object.segments[ s ].lengthMinutes );
+				file.write( reinterpret_cast< const char* >( &object.segments[ s ].coefficients[ 0 ] ),
+							sizeof( Real ) * object.segments[ s ].coefficients.size( ) );
+			}
+		}
+	}
+
+	CatalogEphemeris readCatalogEphemeris( const std::string& path )
+	{
+		std::ifstream file( path.c_str( ), std::ios::binary );
+		char magic[ 8 ];
+		if( !file.read( magic, sizeof( magic ) ) || std::memcmp( magic, ephemerisMagic, sizeof( magic ) ) != 0 )
+		{
+			throw std::runtime_error( "Not an ephemeris file: " + path );
+		}
+
+		CatalogEphemeris ephemeris;
+		ephemeris.windowStart = DateTime( readValue< boost::int64_t >( file ) );
+		ephemeris.windowMinutes = readValue< Real >( file );
+		ephemeris.positionErrorBound = readValue< Real >( file );
+		const boost::uint32_t numberOfObjects = readValue< boost::uint32_t >( file );
+		if( !file || !( ephemeris.windowMinutes >= 0.0 ) )
+		{
+			throw std::runtime_error( "Corrupt ephemeris file: " + path );
+		}
+		// halving stops at or just below the shortest length, and the last segment may be shorter still
+		const Real maximumNumberOfSegments = std::ceil( ephemeris.windowMinutes / ( 0.5 * minimumSegmentLength ) ) + 1.0;
+		for( unsigned int k = 0; k < numberOfObjects; k++ )
+		{
+			ephemeris.objects.push_back( ObjectEphemeris( ) );
+			ObjectEphemeris& object = ephemeris.objects.back( );
+			object.noradNumber = readValue< boost::uint32_t >( file );
+			object.tleHash = readValue< boost::uint64_t >( file );
+			object.degree = readValue< boost::int32_t >( file );
+			object.maximumPositionError = readValue< Real >( file );
+			object.isErrorBoundMet = readValue< boost::uint8_t >( file ) != 0;
+			const boost::uint32_t numberOfSegments = readValue< boost::uint32_t >( file );
+			if( !file || object.degree < 0 || object.degree > maximumDegree || numberOfSegments > maximumNumberOfSegments )
+			{
+				throw std::runtime_error( "Corrupt ephemeris file: " + path );
+			}
+			object.segments.resize( numberOfSegments );
+			for( unsigned int s = 0; s < numberOfSegments; s++ )
+			{
+				object.segments[ s ].startMinutes = readValue< Real >( file );
+				object.segments[ s ].lengthMinutes = readValue< Real >( file );
+				if( !file || !( object.segments[ s ].lengthMinutes > 0.0 ) )
+				{
+					throw std::runtime_error( "Corrupt ephemeris file: " + path );
+				}
+				object.segments[ s ].coefficients.resize( 3 * ( object.degree + 1 ) );
+				file.read( reinterpret_cast< char* >( &object.segments[ s ].coefficients[ 0 ] ),
+						   sizeof( Real ) * object.segments[ s ].coefficients.size( ) );
+			}
+		}
+
+		if( !file )
+		{
+			throw std::runtime_error( "Truncated ephemeris file: " + path );
+		}
+		return ephemeris;
+	}
+
+	CatalogEphemeris loadOrFitCatalogEphemeris( const std::string& catalogPath,
+												const std::vector< Tle >& catalog,
+												const DateTime& windowStart,
+												const Real windowMinutes,
+												const Real positionErrorBound,
+												const int degree )
+	{
+		const std::string path = getEphemerisPath( catalogPath );
+		try
+		{
+			const CatalogEphemeris stored = readCatalogEphemeris( path );
+			bool matches = stored.windowStart == windowStart
+						   && stored.windowMinutes >= windowMinutes
+						   && stored.positionErrorBound <= positionErrorBound
+						   && stored.objects.size( ) == catalog.size( );
+			for( unsigned int k = 0; matches && k < catalog.size( ); k++ )
+			{
+				matches = stored.objects[ k ].noradNumber == catalog[ k ].NoradNumber( )
+						  && stored.objects[ k ].tleHash == computeTleHash( catalog[ k ] )
+						  && stored.objects[ k ].degree == degree;
+			}
+			if( matches )
+			{
+				return stored;
+			}
+		}
+		catch( const std::exception& )
+		{
+			// no usable file next to the catalog, fit a new one below
+		}
+
+		const CatalogEphemeris ephemeris = fitCatalogEphemeris( catalog, windowStart, windowMinutes, positionErrorBound, degree );
+		writeCatalogEphemeris( path, ephemeris );
+		return ephemeris;
+	}
+
+} // namespace ephemerisInterpolator
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <boost/array.hpp>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Globals.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/epochPlanner.hpp"
+#include "CppProject/j2Propagator.hpp"
+
+namespace epochPlanner
+{
+
+	typedef boost::array< Real, 3 > array3;
+
+	//! Orbit normal and direction of the mean argument of latitude of an object at an epoch.
+	void computeOrbitGeometry( const j2Propagator::MeanElements& elements, const DateTime& epoch,
+							   array3& orbitNormal, array3& direction )
+	{
+		const Real t = ( epoch - elements.epoch ).TotalMinutes( );
+		const Real raan = elements.rightAscendingNode + elements.rightAscendingNodeRate * t;
+		const Real argumentLatitude = elements.argumentPerigee + elements.meanAnomaly
+									  + ( elements.argumentPerigeeRate + elements.meanAnomalyRate ) * t;
+		const Real cosRaan = std::cos( raan );
+		const Real sinRaan = std::sin( raan );
+		const Real cosInclination = std::cos( elements.inclination );
+		const Real sinInclination = std::sin( elements.inclination );
+
+		orbitNormal[ 0 ] = sinInclination * sinRaan;
+		orbitNormal[ 1 ] = -sinInclination * cosRaan;
+		orbitNormal[ 2 ] = cosInclination;
+		direction[ 0 ] = cosRaan * std::cos( argumentLatitude ) - sinRaan * std::sin( argumentLatitude ) * cosInclination;
+		direction[ 1 ] = sinRaan * std::cos( argumentLatitude ) + cosRaan * std::sin( argumentLatitude ) * cosInclination;
+		direction[ 2 ] = std::sin( argumentLatitude ) * sinInclination;
+	}
+
+	array3 computeCross( const array3& first, const array3& second )
+	{
+		array3 result;
+		result[ 0 ] = first[ 1 ] * second[ 2 ] - first[ 2 ] * second[ 1 ];
+		result[ 1 ] = first[ 2 ] * second[ 0 ] - first[ 0 ] * second[ 2 ];
+		result[ 2 ] = first[ 0 ] * second[ 1 ] - first[ 1 ] * second[ 0 ];
+		return result;
+	}
+
+	Real computeDot( const array3& first, const array3& second )
+	{
+		return first[ 0 ] * second[ 0 ] + first[ 1 ] * second[ 1 ] + first[ 2 ] * second[ 2 ];
+	}
+
+	//! Angle [rad] from a reference direction to a direction, both in the plane with the given normal.
+	Real computeInPlaneAngle( const array3& reference, const array3& direction, const array3& orbitNormal )
+	{
+		return std::atan2( computeDot( computeCross( reference, direction ), orbitNormal ), computeDot( reference, direction ) );
+	}
+
+	//! Wrap an angle to ( -pi, pi ].
+	Real wrapAngle( const Real angle )
+	{
+		Real wrapped = std::fmod( angle + kPI, kTWOPI );
+		if( wrapped <= 0.0 )
+		{
+			wrapped += kTWOPI;
+		}
+		return wrapped - kPI;
+	}
+
+	PairPhasing computePairPhasing( const Tle& departureObject, const Tle& arrivalObject )
+	{
+		PairPhasing phasing;
+		phasing.departureElements = j2Propagator::computeMeanElements( departureObject );
+		phasing.arrivalElements = j2Propagator::computeMeanElements( arrivalObject );
+
+		const j2Propagator::MeanElements& departure = phasing.departureElements;
+		const j2Propagator::MeanElements& arrival = phasing.arrivalElements;
+		phasing.phaseRate = ( arrival.argumentPerigeeRate + arrival.meanAnomalyRate )
+							- ( departure.argumentPerigeeRate + departure.meanAnomalyRate );
+		phasing.relativeNodeRate = arrival.rightAscendingNodeRate - departure.rightAscendingNodeRate;
+		phasing.synodicPeriod = phasing.phaseRate != 0.0 ? kTWOPI / std::fabs( phasing.phaseRate )
+														 : std::numeric_limits< Real >::infinity( );
+		phasing.nodeAlignmentPeriod = phasing.relativeNodeRate != 0.0 ? kTWOPI / std::fabs( phasing.relativeNodeRate )
+																	  : std::numeric_limits< Real >::infinity( );
+		return phasing;
+	}
+
+	void computePhaseAndPlaneAngle( const PairPhasing& phasing, const DateTime& epoch, Real& phaseAngle, Real& planeAngle )
+	{
+		array3 departureNormal, departureDirection, arrivalNormal, arrivalDirection;
+		computeOrbitGeometry( phasing.departureElements, epoch, departureNormal, departureDirection );
+		computeOrbitGeometry( phasing.arrivalElements, epoch, arrivalNormal, arrivalDirection );
+
+		planeAngle = std::acos( std::max( -1.0, std::min( 1.0, computeDot( departureNormal, arrivalNormal ) ) ) );
+
+		// the line of intersection lies in both planes; for (nearly) coplanar orbits any common
+		// direction will do, so the departure node is used
+		array3 reference = computeCross( departureNormal, arrivalNormal );
+		const Real referenceNorm = std::sqrt( computeDot( reference, reference ) );
+		if( referenceNorm < 1.0e-8 )
+		{
+			reference[ 0 ] = -departureNormal[ 1 ];
+			reference[ 1 ] = departureNormal[ 0 ];
+			reference[ 2 ] = 0.0;
+			const Real nodeNorm = std::sqrt( computeDot( reference, reference ) );
+			if( nodeNorm < 1.0e-8 )
+			{
+				reference[ 0 ] = 1.0;
+				reference[ 1 ] = 0.0;
+			}
+			else
+			{
+				reference[ 0 ] /= nodeNorm;
+				reference[ 1 ] /= nodeNorm;
+			}
+		}
+		else
+		{
+			for( int j = 0; j < 3; j++ )
+			{
+				reference[ j ] /= referenceNorm;
+			}
+		}
+
+		phaseAngle = wrapAngle( computeInPlaneAngle( reference, arrivalDirection, arrivalNormal )
+								- computeInPlaneAngle( reference, departureDirection, departureNormal ) );
+	}
+
+	Real computePhaseMismatch( const PairPhasing& phasing, const DateTime& epoch, const Real maximumTimeOfFlight )
+	{
+		Real phaseAngle, planeAngle;
+		computePhaseAndPlaneAngle( phasing, epoch, phaseAngle, planeAngle );
+
+		// arc of rendezvous phases from 0 (zero time of flight) to its end at the longest time of flight
+		const Real arcEnd = -0.5 * phasing.phaseRate * maximumTimeOfFlight / 60.0;
+		const Real arcLength = std::fabs( arcEnd );
+		if( arcLength >= kTWOPI )
+		{
+			return 0.0;
+		}
+
+		// measure the phase along the arc direction, in [ 0, 2 pi )
+		Real alongArc = std::fmod( arcEnd < 0.0 ? -phaseAngle : phaseAngle, kTWOPI );
+		if( alongArc < 0.0 )
+		{
+			alongArc += kTWOPI;
+		}
+		if( alongArc <= arcLength )
+		{
+			return 0.0;
+		}
+		return std::min( alongArc - arcLength, kTWOPI - alongArc );
+	}
+
+	PlannerSettings getDefaultSettings( )
+	{
+		PlannerSettings settings;
+		settings.numberOfEpochs = 100;
+		settings.maximumTimeOfFlight = 10.0 + 999.0 * 60.0;
+		settings.phaseTolerance = 15.0 * kPI / 180.0;
+		settings.planeTolerance = 0.5 * kPI / 180.0;
+		settings.samplingStep = 1.0;
+		return settings;
+	}
+
+	std::vector< DateTime > planDepartureEpochs( const PairPhasing& phasing,
+												 const DateTime& windowStart,
+												 const Real windowMinutes,
+												 const PlannerSettings& settings )
+	{
+		const int numberOfSamples = static_cast< int >( std::floor( windowMinutes / settings.samplingStep ) ) + 1;
+		std::vector< Real > phaseMismatch( numberOfSamples );
+		std::vector< Real > planeAngle( numberOfSamples );
+		Real smallestPlaneAngle = std::numeric_limits< Real >::max( );
+		for( int k = 0; k < numberOfSamples; k++ )
+		{
+			const DateTime epoch = windowStart.AddMinutes( k * settings.samplingStep );
+			Real phaseAngle;
+			computePhaseAndPlaneAngle( phasing, epoch, phaseAngle, planeAngle[ k ] );
+			phaseMismatch[ k ] = computePhaseMismatch( phasing, epoch, settings.maximumTimeOfFlight );
+			smallestPlaneAngle = std::min( smallestPlaneAngle, planeAngle[ k ] );
+		}
+
+		std::vector< int > favourable;
+		for( int k = 0; k < numberOfSamples; k++ )
+		{
+			if( phaseMismatch[ k ] <= settings.phaseTolerance && planeAngle[ k ] <= smallestPlaneAngle + settings.planeTolerance )
+			{
+				favourable.push_back( k );
+			}
+		}
+
+		std::vector< int > selected;
+		if( favourable.empty( ) )
+		{
+			// nothing within the tolerances: fall back on the best phased samples
+			std::vector< std::pair< Real, int > > ranking( numberOfSamples );
+			for( int k = 0; k < numberOfSamples; k++ )
+			{
+				ranking[ k ] = std::make_pair( phaseMismatch[ k ], k );
+			}
+			const int numberOfSelected = std::min( settings.numberOfEpochs, numberOfSamples );
+			std::partial_sort( ranking.begin( ), ranking.begin( ) + numberOfSelected, ranking.end( ) );
+			for( int j = 0; j < numberOfSelected; j++ )
+			{
+				selected.push_back( ranking[ j ].second );
+			}
+			std::sort( selected.begin( ), selected.end( ) );
+		}
+		else if( static_cast< int >( favourable.size( ) ) <= settings.numberOfEpochs )
+		{
+			selected = favourable;
+		}
+		else
+		{
+			for( int j = 0; j < settings.numberOfEpochs; j++ )
+			{
+				selected.push_back( favourable[ static_cast< long >( j ) * favourable.size( ) / settings.numberOfEpochs ] );
+			}
+		}
+
+		std::vector< DateTime > departureEpochs;
+		for( unsigned int j = 0; j < selected.size( ); j++ )
+		{
+			departureEpochs.push_back( windowStart.AddMinutes( selected[ j ] * settings.samplingStep ) );
+		}
+		return departureEpochs;
+	}
+
+	std::vector< DateTime > computeUniformDepartureEpochs( const DateTime& windowStart,
+														   const Real windowMinutes,
+														   const int numberOfEpochs )
+	{
+		std::vector< DateTime > departureEpochs( numberOfEpochs );
+		for( int l = 0; l < numberOfEpochs; l++ )
+		{
+			departureEpochs[ l ] = windowStart.AddMinutes( windowMinutes * l / numberOfEpochs );
+		}
+		return departureEpochs;
+	}
+
+} // namespace epochPlanner
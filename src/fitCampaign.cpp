@@ -0,0 +1,457 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gsl/gsl_errno.h>
+
+#include <SML/sml.hpp>
+
+#include <libsgp4/Eci.h>
+#include <libsgp4/Globals.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include <Atom/convertCartesianStateToTwoLineElements.hpp>
+
+#include "CppProject/fitCampaign.hpp"
+#include "CppProject/meanElementConverter.hpp"
+#include "CppProject/parallelFor.hpp"
+#include "CppProject/tleCatalog.hpp"
+#include "CppProject/tleFitter.hpp"
+#include "CppProject/TleGen.hpp"
+
+namespace fitCampaign
+{
+
+	typedef std::vector< Real > Vector6;
+
+	const char* getOutcomeName( const FitOutcome outcome )
+	{
+		switch( outcome )
+		{
+			case convergedFit: return "converged";
+			case inaccurateFit: return "inaccurate";
+			case iterationLimit: return "iteration_limit";
+			case noProgress: return "no_progress";
+			case solverError: return "solver_error";
+			case thrownException: return "exception";
+			case numberOfOutcomes: break;
+		}
+		return "";
+	}
+
+	const char* getMethodName( const FitMethod method )
+	{
+		switch( method )
+		{
+			case atomFit: return "atom";
+			case analyticFit: return "analytic";
+		}
+		return "";
+	}
+
+	FitMethod findMethod( const std::string& name )
+	{
+		const FitMethod methods[ ] = { atomFit, analyticFit };
+		for( int k = 0; k < 2; k++ )
+		{
+			if( name == getMethodName( methods[ k ] ) )
+			{
+				return methods[ k ];
+			}
+		}
+		throw std::runtime_error( "Unknown fit method: " + name );
+	}
+
+	//! Index of the even bin of a value in a range, clamped to the first and last bin.
+	int findBinIndex( const Real value, const elementSampler::Vector2& range, const int numberOfBins )
+	{
+		const Real width = range[ 1 ] - range[ 0 ];
+		if( !( width > 0.0 ) )
+		{
+			return 0;
+		}
+		const int index = static_cast< int >( std::floor( ( value - range[ 0 ] ) / width * numberOfBins ) );
+		return std::min( std::max( index, 0 ), numberOfBins - 1 );
+	}
+
+	FailureMap createFailureMap( const elementSampler::ElementRanges& ranges,
+								 const int numberOfSemiMajorAxisBins,
+								 const int numberOfEccentricityBins,
+								 const int numberOfInclinationBins )
+	{
+		FailureMap map;
+		map.ranges = ranges;
+		map.numberOfSemiMajorAxisBins = std::max( numberOfSemiMajorAxisBins, 1 );
+		map.numberOfEccentricityBins = std::max( numberOfEccentricityBins, 1 );
+		map.numberOfInclinationBins = std::max( numberOfInclinationBins, 1 );
+
+		BinStatistics emptyBin;
+		emptyBin.numberOfSamples = 0;
+		std::fill( emptyBin.outcomes, emptyBin.outcomes + numberOfOutcomes, 0 );
+		std::fill( emptyBin.iterationHistogram, emptyBin.iterationHistogram + numberOfIterationBuckets, 0 );
+		std::fill( emptyBin.residualHistogram, emptyBin.residualHistogram + numberOfResidualBuckets, 0 );
+		emptyBin.iterationSum = 0;
+		map.bins.assign( map.numberOfSemiMajorAxisBins * map.numberOfEccentricityBins * map.numberOfInclinationBins,
+						 emptyBin );
+		return map;
+	}
+
+	void mergeFailureMaps( const FailureMap& source, FailureMap& target )
+	{
+		if( source.bins.size( ) != target.bins.size( ) )
+		{
+			throw std::runtime_error( "Cannot merge failure maps with different bins" );
+		}
+		for( std::size_t b = 0; b < source.bins.size( ); b++ )
+		{
+			const BinStatistics& from = source.bins[ b ];
+			BinStatistics& to = target.bins[ b ];
+			to.numberOfSamples += from.numberOfSamples;
+			for( int k = 0; k < numberOfOutcomes; k++ )
+			{
+				to.outcomes[ k ] += from.outcomes[ k ];
+			}
+			for( int k = 0; k < numberOfIterationBuckets; k++ )
+			{
+				to.iterationHistogram[ k ] += from.iterationHistogram[ k ];
+			}
+			for( int k = 0; k < numberOfResidualBuckets; k++ )
+			{
+				to.residualHistogram[ k ] += from.residualHistogram[ k ];
+			}
+			to.iterationSum += from.iterationSum;
+		}
+	}
+
+	void computeWilsonInterval( const long numberOfFailures, const long numberOfSamples, const Real quantile,
+								Real& lowerBound, Real& upperBound )
+	{
+		if( numberOfSamples <= 0 )
+		{
+			lowerBound = 0.0;
+			upperBound = 1.0;
+			return;
+		}
+		const Real n = static_cast< Real >( numberOfSamples );
+		const Real rate = numberOfFailures / n;
+		const Real z2 = quantile * quantile;
+		const Real denominator = 1.0 + z2 / n;
+		const Real center = ( rate + z2 / ( 2.0 * n ) ) / denominator;
+		const Real halfWidth = quantile * std::sqrt( rate * ( 1.0 - rate ) / n + z2 / ( 4.0 * n * n ) ) / denominator;
+		lowerBound = std::max( center - halfWidth, 0.0 );
+		upperBound = std::min( center + halfWidth, 1.0 );
+	}
+
+	CampaignSettings getDefaultCampaignSettings( )
+	{
+		const Real km2m = 1000.0;
+		const Real EarthRadius = kXKMPER * km2m; // unit m
+
+		CampaignSettings settings;
+		elementSampler::ElementRanges& ranges = settings.ranges;
+		ranges.semiMajorAxis = { EarthRadius + 200 * km2m, EarthRadius + 2000 * km2m };
+		ranges.eccentricity = { 0.0, 0.25 };
+		ranges.inclination = { 0.0, sml::convertDegreesToRadians( 180.0 ) };
+		ranges.rightAscendingNode = { 0.0, sml::convertDegreesToRadians( 360.0 ) };
+		ranges.argumentPerigee = ranges.rightAscendingNode;
+		ranges.eccentricAnomaly = ranges.rightAscendingNode;
+
+		settings.sampler = elementSampler::getDefaultSettings( );
+		settings.sampler.minimumPerigeeRadius = EarthRadius + 100 * km2m;
+		settings.numberOfSemiMajorAxisBins = 8;
+		settings.numberOfEccentricityBins = 10;
+		settings.numberOfInclinationBins = 9;
+		settings.method = atomFit;
+		settings.epoch = DateTime( 2016, 2, 1 );
+		settings.fitSettings = atomTransfer::getDefaultAtomSolverSettings( );
+		settings.residualTolerance = 1.0;
+		settings.samplesPerRound = 65536;
+		settings.maximumNumberOfSamples = 10000000;
+		settings.minimumBinSamples = 100;
+		settings.targetHalfWidth = 0.01;
+		settings.quantile = 1.96;
+		settings.numberOfThreads = 0;
+		return settings;
+	}
+
+	//! Outcome of a solver status text that is not "success".
+	FitOutcome classifySolverStatus( const std::string& solverStatus )
+	{
+		// ATOM leaves GSL_CONTINUE as the status when it runs out of iterations
+		if( solverStatus == gsl_strerror( GSL_EMAXITER ) || solverStatus == gsl_strerror( GSL_CONTINUE ) )
+		{
+			return iterationLimit;
+		}
+		if( solverStatus == gsl_strerror( GSL_ENOPROG ) || solverStatus == gsl_strerror( GSL_ENOPROGJ ) )
+		{
+			return noProgress;
+		}
+		return solverError;
+	}
+
+	//! Histogram bucket of an iteration count: 0 for up to one iteration, k for 2^k up to 2^(k+1) - 1.
+	int findIterationBucket( const int iterations )
+	{
+		int bucket = 0;
+		for( int count = iterations; count > 1 && bucket < numberOfIterationBuckets - 1; count /= 2 )
+		{
+			bucket++;
+		}
+		return bucket;
+	}
+
+	//! Histogram bucket of a position residual [km]: 0 below 1e-6 km, one per decade, and the last from 1e3 km or NaN.
+	int findResidualBucket( const Real residual )
+	{
+		if( residual < 1.0e-6 )
+		{
+			return 0;
+		}
+		if( !( residual < 1.0e3 ) )
+		{
+			return numberOfResidualBuckets - 1;
+		}
+		const int bucket = 1 + static_cast< int >( std::floor( std::log10( residual ) + 6.0 ) );
+		return std::min( std::max( bucket, 1 ), numberOfResidualBuckets - 2 );
+	}
+
+	//! Convert the state of one set of elements, check the TLE with SGP4 and count the outcome in its bin.
+	void addSample( const Vector6& keplerianElements, const CampaignSettings& settings, FailureMap& map )
+	{
+		const int semiMajorAxisBin = findBinIndex( keplerianElements[ 0 ], map.ranges.semiMajorAxis,
+												   map.numberOfSemiMajorAxisBins );
+		const int eccentricityBin = findBinIndex( keplerianElements[ 1 ], map.ranges.eccentricity,
+												  map.numberOfEccentricityBins );
+		const int inclinationBin = findBinIndex( keplerianElements[ 2 ], map.ranges.inclination,
+												 map.numberOfInclinationBins );
+		BinStatistics& bin = map.bins[ ( semiMajorAxisBin * map.numberOfEccentricityBins + eccentricityBin )
+									   * map.numberOfInclinationBins + inclinationBin ];
+		bin.numberOfSamples++;
+
+		std::string solverStatus;
+		int iterations = 0;
+		Real residual = 0.0;
+		try
+		{
+			// the conversions take the state in km and km/s
+			const Vector6 cartesianState = TleGen::computeCartesianState( keplerianElements );
+			const Tle referenceTle = meanElementConverter::createReferenceTle( cartesianState, settings.epoch );
+			Tle fittedTle;
+			if( settings.method == atomFit )
+			{
+				fittedTle = atom::convertCartesianStateToTwoLineElements< Real, Vector6 >( cartesianState,
+					settings.epoch, solverStatus, iterations, referenceTle, kMU, kXKMPER,
+					settings.fitSettings.absoluteTolerance, settings.fitSettings.relativeTolerance,
+					settings.fitSettings.maximumIterations );
+			}
+			else
+			{
+				tleFitter::FitStatistics statistics;
+				fittedTle = tleFitter::convertCartesianStateToTwoLineElements( cartesianState, settings.epoch,
+					referenceTle, settings.fitSettings, solverStatus, statistics );
+				iterations = statistics.numberOfIterations;
+			}
+
+			if( solverStatus.find( "success" ) != std::string::npos )
+			{
+				const Vector6 fittedState = tleCatalog::getStateVector( SGP4( fittedTle ).FindPosition( 0.0 ) );
+				residual = std::sqrt( ( fittedState[ 0 ] - cartesianState[ 0 ] ) * ( fittedState[ 0 ] - cartesianState[ 0 ] )
+									  + ( fittedState[ 1 ] - cartesianState[ 1 ] ) * ( fittedState[ 1 ] - cartesianState[ 1 ] )
+									  + ( fittedState[ 2 ] - cartesianState[ 2 ] ) * ( fittedState[ 2 ] - cartesianState[ 2 ] ) );
+			}
+		}
+		catch( const std::exception& )
+		{
+			bin.outcomes[ thrownException ]++;
+			return;
+		}
+
+		if( solverStatus.find( "success" ) == std::string::npos )
+		{
+			bin.outcomes[ classifySolverStatus( solverStatus ) ]++;
+			return;
+		}
+		bin.outcomes[ residual <= settings.residualTolerance ? convergedFit : inaccurateFit ]++;
+		bin.iterationHistogram[ findIterationBucket( iterations ) ]++;
+		bin.residualHistogram[ findResidualBucket( residual ) ]++;
+		bin.iterationSum += iterations;
+	}
+
+	CampaignSummary runCampaign( const CampaignSettings& settings, FailureMap& map )
+	{
+		const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now( );
+		map = createFailureMap( settings.ranges, settings.numberOfSemiMajorAxisBins, settings.numberOfEccentricityBins,
+								settings.numberOfInclinationBins );
+
+		const int numberOfThreads = parallelFor::getNumberOfThreads( settings.numberOfThreads );
+		const int samplesPerRound = std::max( settings.samplesPerRound, 1 );
+		elementSampler::SamplerSettings samplerSettings = settings.sampler;
+		samplerSettings.numberOfThreads = numberOfThreads;
+		std::vector< FailureMap > threadMaps( numberOfThreads, map );
+
+		CampaignSummary summary;
+		summary.numberOfSamples = 0;
+		summary.numberOfFailures = 0;
+		summary.numberOfRounds = 0;
+		summary.numberOfOccupiedBins = 0;
+		summary.isConverged = false;
+		summary.maximumHalfWidth = 1.0;
+
+		while( summary.numberOfSamples < settings.maximumNumberOfSamples )
+		{
+			const int roundSamples = static_cast< int >(
+				std::min< long >( samplesPerRound, settings.maximumNumberOfSamples - summary.numberOfSamples ) );
+			// every round draws a new design: for the default Sobol design the seed only changes the scramble
+			// and shift, so each round is an independent randomisation of the first roundSamples points; the
+			// stride of 6 also keeps the seeds seed + k of the six uniform elements apart between rounds
+			const elementSampler::Vector2D keplerianElements = elementSampler::mapUnitSamples(
+				elementSampler::generateUnitSamples( samplerSettings.design, roundSamples,
+													 samplerSettings.seed + 6 * summary.numberOfRounds, numberOfThreads ),
+				settings.ranges, samplerSettings );
+
+			parallelFor::parallelFor( roundSamples, numberOfThreads,
+									  [ & ]( const int blockBegin, const int blockEnd, const int thread )
+			{
+				for( int k = blockBegin; k < blockEnd; k++ )
+				{
+					addSample( keplerianElements[ k ], settings, threadMaps[ thread ] );
+				}
+			} );
+			for( int t = 0; t < numberOfThreads; t++ )
+			{
+				mergeFailureMaps( threadMaps[ t ], map );
+				threadMaps[ t ] = createFailureMap( settings.ranges, settings.numberOfSemiMajorAxisBins,
+													settings.numberOfEccentricityBins, settings.numberOfInclinationBins );
+			}
+			summary.numberOfSamples += roundSamples;
+			summary.numberOfRounds++;
+
+			// stop once the failure rate of every occupied bin is known to the target width
+			summary.numberOfFailures = 0;
+			summary.numberOfOccupiedBins = 0;
+			summary.maximumHalfWidth = 0.0;
+			bool isConverged = true;
+			for( std::size_t b = 0; b < map.bins.size( ); b++ )
+			{
+				const BinStatistics& bin = map.bins[ b ];
+				if( bin.numberOfSamples == 0 )
+				{
+					continue;
+				}
+				const long failures = bin.numberOfSamples - bin.outcomes[ convergedFit ];
+				Real lowerBound = 0.0;
+				Real upperBound = 1.0;
+				computeWilsonInterval( failures, bin.numberOfSamples, settings.quantile, lowerBound, upperBound );
+				const Real halfWidth = 0.5 * ( upperBound - lowerBound );
+				summary.numberOfFailures += failures;
+				summary.numberOfOccupiedBins++;
+				summary.maximumHalfWidth = std::max( summary.maximumHalfWidth, halfWidth );
+				if( halfWidth > settings.targetHalfWidth || bin.numberOfSamples < settings.minimumBinSamples )
+				{
+					isConverged = false;
+				}
+			}
+			if( isConverged )
+			{
+				summary.isConverged = true;
+				break;
+			}
+		}
+
+		summary.seconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+		return summary;
+	}
+
+	void writeFailureMap( const std::string& path, const FailureMap& map, const Real quantile )
+	{
+		std::ofstream file( path.c_str( ) );
+		if( !file )
+		{
+			throw std::runtime_error( "Cannot write failure map file: " + path );
+		}
+
+		file << "a_min_km,a_max_km,e_min,e_max,i_min_deg,i_max_deg,samples,failure_rate,rate_lower,rate_upper";
+		for( int k = 0; k < numberOfOutcomes; k++ )
+		{
+			file << "," << getOutcomeName( static_cast< FitOutcome >( k ) );
+		}
+		file << ",mean_iterations";
+		for( int k = 0; k < numberOfIterationBuckets; k++ )
+		{
+			file << ",iterations_" << ( 1 << k ) << ( k + 1 < numberOfIterationBuckets ? "" : "+" );
+		}
+		file << ",residual_below_1e-6_km";
+		for( int k = 1; k < numberOfResidualBuckets; k++ )
+		{
+			file << ",residual_1e" << k - 7 << "_km" << ( k + 1 < numberOfResidualBuckets ? "" : "+" );
+		}
+		file << "\n";
+
+		const Real m2km = 1.0e-3;
+		const Real aWidth = ( map.ranges.semiMajorAxis[ 1 ] - map.ranges.semiMajorAxis[ 0 ] ) / map.numberOfSemiMajorAxisBins;
+		const Real eWidth = ( map.ranges.eccentricity[ 1 ] - map.ranges.eccentricity[ 0 ] ) / map.numberOfEccentricityBins;
+		const Real iWidth = ( map.ranges.inclination[ 1 ] - map.ranges.inclination[ 0 ] ) / map.numberOfInclinationBins;
+		file << std::setprecision( 6 );
+		for( int a = 0; a < map.numberOfSemiMajorAxisBins; a++ )
+		{
+			for( int e = 0; e < map.numberOfEccentricityBins; e++ )
+			{
+				for( int i = 0; i < map.numberOfInclinationBins; i++ )
+				{
+					const BinStatistics& bin = map.bins[ ( a * map.numberOfEccentricityBins + e ) * map.numberOfInclinationBins + i ];
+					if( bin.numberOfSamples == 0 )
+					{
+						continue;
+					}
+					const long failures = bin.numberOfSamples - bin.outcomes[ convergedFit ];
+					const long fits = bin.outcomes[ convergedFit ] + bin.outcomes[ inaccurateFit ];
+					Real lowerBound = 0.0;
+					Real upperBound = 1.0;
+					computeWilsonInterval( failures, bin.numberOfSamples, quantile, lowerBound, upperBound );
+
+					file << ( map.ranges.semiMajorAxis[ 0 ] + a * aWidth ) * m2km << ","
+						 << ( map.ranges.semiMajorAxis[ 0 ] + ( a + 1 ) * aWidth ) * m2km << ","
+						 << map.ranges.eccentricity[ 0 ] + e * eWidth << ","
+						 << map.ranges.eccentricity[ 0 ] + ( e + 1 ) * eWidth << ","
+						 << sml::convertRadiansToDegrees( map.ranges.inclination[ 0 ] + i * iWidth ) << ","
+						 << sml::convertRadiansToDegrees( map.ranges.inclination[ 0 ] + ( i + 1 ) * iWidth ) << ","
+						 << bin.numberOfSamples << ","
+						 << static_cast< Real >( failures ) / bin.numberOfSamples << ","
+						 << lowerBound << "," << upperBound;
+					for( int k = 0; k < numberOfOutcomes; k++ )
+					{
+						file << "," << bin.outcomes[ k ];
+					}
+					file << "," << ( fits > 0 ? static_cast< Real >( bin.iterationSum ) / fits : 0.0 );
+					for( int k = 0; k < numberOfIterationBuckets; k++ )
+					{
+						file << "," << bin.iterationHistogram[ k ];
+					}
+					for( int k = 0; k < numberOfResidualBuckets; k++ )
+					{
+						file << "," << bin.residualHistogram[ k ];
+					}
+					file << "\n";
+				}
+			}
+		}
+		file.close( );
+		if( !file )
+		{
+			throw std::runtime_error( "Failed writing failure map file: " + path );
+		}
+	}
+
+} // namespace fitCampaign
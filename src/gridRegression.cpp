@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/atomBatch.hpp"
+#include "CppProject/atomTransfer.hpp"
+#include "CppProject/atomWorkspace.hpp"
+#include "CppProject/gridRegression.hpp"
+#include "CppProject/gridSearch.hpp"
+#include "CppProject/parallelFor.hpp"
+#include "CppProject/resultsStore.hpp"
+#include "CppProject/tleCatalog.hpp"
+
+namespace gridRegression
+{
+
+	//! Index of every catalog object by NORAD number.
+	/*!
+	 * @throws	std::runtime_error if a cell refers to an object that is not in the catalog
+	 */
+	std::map< int, int > indexCatalog( const std::vector< Tle >& catalog, const std::vector< ResultRecord >& cells )
+	{
+		std::map< int, int > catalogIndex;
+		for( unsigned int k = 0; k < catalog.size( ); k++ )
+		{
+			catalogIndex[ catalog[ k ].NoradNumber( ) ] = k;
+		}
+		for( unsigned int c = 0; c < cells.size( ); c++ )
+		{
+			if( catalogIndex.count( cells[ c ].departureObjectId ) == 0 || catalogIndex.count( cells[ c ].arrivalObjectId ) == 0 )
+			{
+				throw std::runtime_error( "Reference row refers to an object that is not in the catalog" );
+			}
+		}
+		return catalogIndex;
+	}
+
+	//! Evaluate cells [ begin, end ) with SGP4 + Lambert + ATOM; converged cells are appended to results.
+	void evaluateCells( const std::vector< Tle >& catalog,
+						const std::map< int, int >& catalogIndex,
+						const std::vector< ResultRecord >& cells,
+						const int begin,
+						const int end,
+						std::vector< ResultRecord >& results )
+	{
+		std::string solverStatusSummary;
+		for( int c = begin; c < end; c++ )
+		{
+			const Tle& departureObject = catalog[ catalogIndex.find( cells[ c ].departureObjectId )->second ];
+			const Tle& arrivalObject = catalog[ catalogIndex.find( cells[ c ].arrivalObjectId )->second ];
+
+			// propagators are built per cell, like the arrival propagator of the original grid loop
+			const SGP4 sgp4Departure( departureObject );
+			const SGP4 sgp4Arrival( arrivalObject );
+			atomTransfer::TransferResult transfer;
+			if( atomTransfer::evaluateTransfer( departureObject, sgp4Departure, arrivalObject, sgp4Arrival,
+												DateTime( cells[ c ].departureEpochTicks ), cells[ c ].timeOfFlight,
+												transfer, solverStatusSummary ) )
+			{
+				ResultRecord result = cells[ c ];
+				result.atomDeltaV = transfer.atomDeltaV;
+				result.lambertDeltaV = transfer.lambertDeltaV;
+				results.push_back( result );
+			}
+		}
+	}
+
+	//! Evaluate cells [ begin, end ) like evaluateCells, with the solver workspace of the calling thread.
+	void evaluateCellsWithWorkspace( const std::vector< Tle >& catalog,
+									 const std::map< int, int >& catalogIndex,
+									 const std::vector< ResultRecord >& cells,
+									 const int begin,
+									 const int end,
+									 std::vector< ResultRecord >& results )
+	{
+		std::string solverStatusSummary;
+		atomWorkspace::AtomSolverWorkspace workspace;
+		const atomTransfer::AtomSolverSettings solverSettings = atomTransfer::getDefaultAtomSolverSettings( );
+		for( int c = begin; c < end; c++ )
+		{
+			const Tle& departureObject = catalog[ catalogIndex.find( cells[ c ].departureObjectId )->second ];
+			const Tle& arrivalObject = catalog[ catalogIndex.find( cells[ c ].arrivalObjectId )->second ];
+
+			const SGP4 sgp4Departure( departureObject );
+			const SGP4 sgp4Arrival( arrivalObject );
+			atomTransfer::TransferResult transfer;
+			if( atomTransfer::evaluateTransfer( departureObject, sgp4Departure, arrivalObject, sgp4Arrival,
+												DateTime( cells[ c ].departureEpochTicks ), cells[ c ].timeOfFlight,
+												solverSettings, workspace, transfer, solverStatusSummary ) )
+			{
+				ResultRecord result = cells[ c ];
+				result.atomDeltaV = transfer.atomDeltaV;
+				result.lambertDeltaV = transfer.lambertDeltaV;
+				results.push_back( result );
+			}
+		}
+	}
+
+	//! Evaluate cells [ begin, end ) in two stages: a loose screening solve, then a tight solve started from it.
+	/*!
+	 * Every cell is refined, so the results must reproduce the reference of a single tight solve.
+	 * Cells whose screening solve fails are solved from the Lambert guess instead.
+	 */
+	void evaluateCellsStaged( const std::vector< Tle >& catalog,
+							  const std::map< int, int >& catalogIndex,
+							  const std::vector< ResultRecord >& cells,
+							  const int begin,
+							  const int end,
+							  std::vector< ResultRecord >& results )
+	{
+		std::string solverStatusSummary;
+		const atomTransfer::AtomSolverSettings screeningSettings = gridSearch::getDefaultGridSearchSpec( ).screeningSettings;
+		const atomTransfer::AtomSolverSettings solverSettings = atomTransfer::getDefaultAtomSolverSettings( );
+		for( int c = begin; c < end; c++ )
+		{
+			const Tle& departureObject = catalog[ catalogIndex.find( cells[ c ].departureObjectId )->second ];
+			const Tle& arrivalObject = catalog[ catalogIndex.find( cells[ c ].arrivalObjectId )->second ];
+
+			const SGP4 sgp4Departure( departureObject );
+			const SGP4 sgp4Arrival( arrivalObject );
+			const DateTime departureEpoch( cells[ c ].departureEpochTicks );
+			atomTransfer::TransferResult screening;
+			atomTransfer::TransferResult transfer;
+			const bool isConverged
+				= atomTransfer::evaluateTransfer( departureObject, sgp4Departure, arrivalObject, sgp4Arrival, departureEpoch,
+												  cells[ c ].timeOfFlight, screeningSettings, screening, solverStatusSummary )
+				? atomTransfer::refineTransfer( departureObject, sgp4Departure, arrivalObject, sgp4Arrival, screening,
+												solverSettings, transfer, solverStatusSummary )
+				: atomTransfer::evaluateTransfer( departureObject, sgp4Departure, arrivalObject, sgp4Arrival, departureEpoch,
+												  cells[ c ].timeOfFlight, solverSettings, transfer, solverStatusSummary );
+			if( isConverged )
+			{
+				ResultRecord result = cells[ c ];
+				result.atomDeltaV = transfer.atomDeltaV;
+				result.lambertDeltaV = transfer.lambertDeltaV;
+				results.push_back( result );
+			}
+		}
+	}
+
+	//! Evaluate cells [ begin, end ) like evaluateCells, solved together by a lock-step batched solver.
+	void evaluateCellsInBatches( const std::vector< Tle >& catalog,
+								 const std::map< int, int >& catalogIndex,
+								 const std::vector< ResultRecord >& cells,
+								 const int begin,
+								 const int end,
+								 std::vector< ResultRecord >& results )
+	{
+		const atomTransfer::AtomSolverSettings solverSettings = atomTransfer::getDefaultAtomSolverSettings( );
+		std::string solverStatusSummary;
+		std::vector< atomBatch::TransferProblem > problems( end - begin );
+		std::vector< atomBatch::TransferSolution > solutions;
+		std::vector< atomTransfer::TransferResult > transfers( end - begin );
+		for( int c = begin; c < end; c++ )
+		{
+			const Tle& departureObject = catalog[ catalogIndex.find( cells[ c ].departureObjectId )->second ];
+			const Tle& arrivalObject = catalog[ catalogIndex.find( cells[ c ].arrivalObjectId )->second ];
+
+			const SGP4 sgp4Departure( departureObject );
+			const SGP4 sgp4Arrival( arrivalObject );
+			atomTransfer::prepareBatchTransfer( departureObject, sgp4Departure, arrivalObject, sgp4Arrival,
+												DateTime( cells[ c ].departureEpochTicks ), cells[ c ].timeOfFlight,
+												solverSettings, transfers[ c - begin ], problems[ c - begin ] );
+		}
+
+		atomBatch::BatchTransferSolver solver;
+		solver.solve( problems, solverSettings, solutions );
+		for( int c = begin; c < end; c++ )
+		{
+			atomTransfer::TransferResult& transfer = transfers[ c - begin ];
+			if( atomTransfer::completeBatchTransfer( problems[ c - begin ], solutions[ c - begin ], transfer, solverStatusSummary ) )
+			{
+				ResultRecord result = cells[ c ];
+				result.atomDeltaV = transfer.atomDeltaV;
+				result.lambertDeltaV = transfer.lambertDeltaV;
+				results.push_back( result );
+			}
+		}
+	}
+
+	std::vector< ResultRecord > evaluateCellsSerial( const std::vector< Tle >& catalog,
+													 const std::vector< ResultRecord >& cells )
+	{
+		const std::map< int, int > catalogIndex = indexCatalog( catalog, cells );
+		std::vector< ResultRecord > results;
+		evaluateCells( catalog, catalogIndex, cells, 0, cells.size( ), results );
+		return results;
+	}
+
+	//! Evaluator of cells [ begin, end ) on the calling thread, appending converged cells to results
+	typedef void ( *RangeEvaluator )( const std::vector< Tle >& catalog,
+									  const std::map< int, int >& catalogIndex,
+									  const std::vector< ResultRecord >& cells,
+									  const int begin,
+									  const int end,
+									  std::vector< ResultRecord >& results );
+
+	//! Spread the cells over all hardware threads in contiguous ranges and concatenate the results in cell order.
+	std::vector< ResultRecord > evaluateCellsOnAllThreads( const std::vector< Tle >& catalog,
+														   const std::vector< ResultRecord >& cells,
+														   const RangeEvaluator evaluateRange )
+	{
+		const std::map< int, int > catalogIndex = indexCatalog( catalog, cells );
+		const int numberOfThreads = parallelFor::getNumberOfThreads( 0 );
+		std::vector< std::vector< ResultRecord > > threadResults( numberOfThreads );
+		parallelFor::parallelFor( cells.size( ), numberOfThreads,
+								  [ & ]( const int begin, const int end, const int thread )
+		{
+			evaluateRange( catalog, catalogIndex, cells, begin, end, threadResults[ thread ] );
+		} );
+
+		std::vector< ResultRecord > results;
+		for( int t = 0; t < numberOfThreads; t++ )
+		{
+			results.insert( results.end( ), threadResults[ t ].begin( ), threadResults[ t ].end( ) );
+		}
+		return results;
+	}
+
+	std::vector< ResultRecord > evaluateCellsParallel( const std::vector< Tle >& catalog,
+													   const std::vector< ResultRecord >& cells )
+	{
+		return evaluateCellsOnAllThreads( catalog, cells, evaluateCells );
+	}
+
+	std::vector< ResultRecord > evaluateCellsWorkspace( const std::vector< Tle >& catalog,
+														const std::vector< ResultRecord >& cells )
+	{
+		return evaluateCellsOnAllThreads( catalog, cells, evaluateCellsWithWorkspace );
+	}
+
+	std::vector< ResultRecord > evaluateCellsRefined( const std::vector< Tle >& catalog,
+													  const std::vector< ResultRecord >& cells )
+	{
+		return evaluateCellsOnAllThreads( catalog, cells, evaluateCellsStaged );
+	}
+
+	std::vector< ResultRecord > evaluateCellsBatched( const std::vector< Tle >& catalog,
+													  const std::vector< ResultRecord >& cells )
+	{
+		return evaluateCellsOnAllThreads( catalog, cells, evaluateCellsInBatches );
+	}
+
+	CellEvaluator findCellEvaluator( const std::string& name )
+	{
+		if( name == "serial" )
+		{
+			return evaluateCellsSerial;
+		}
+		if( name == "parallel" )
+		{
+			return evaluateCellsParallel;
+		}
+		if( name == "workspace" )
+		{
+			return evaluateCellsWorkspace;
+		}
+		if( name == "refined" )
+		{
+			return evaluateCellsRefined;
+		}
+		if( name == "batched" )
+		{
+			return evaluateCellsBatched;
+		}
+		return NULL;
+	}
+
+	//! Order on the grid cell: departure ID, arrival ID, epoch and time-of-flight.
+	bool isBeforeCell( const ResultRecord& first, const ResultRecord& second )
+	{
+		if( first.departureObjectId != second.departureObjectId )
+			return first.departureObjectId < second.departureObjectId;
+		if( first.arrivalObjectId != second.arrivalObjectId )
+			return first.arrivalObjectId < second.arrivalObjectId;
+		if( first.departureEpochTicks != second.departureEpochTicks )
+			return first.departureEpochTicks < second.departureEpochTicks;
+		return first.timeOfFlight < second.timeOfFlight;
+	}
+
+	RegressionComparison compareResults( const std::vector< ResultRecord >& reference,
+										 const std::vector< ResultRecord >& results,
+										 const RegressionTolerance& tolerance )
+	{
+		// the stores sort and deduplicate both sides, so the rows can be matched in one sweep
+		const resultsStore::ResultsStore referenceStore( reference );
+		const resultsStore::ResultsStore resultStore( results );
+		const std::vector< ResultRecord >& referenceRows = referenceStore.records( );
+		const std::vector< ResultRecord >& resultRows = resultStore.records( );
+
+		RegressionComparison comparison;
+		comparison.numberOfReferenceRows = referenceRows.size( );
+		comparison.numberOfMatchedRows = 0;
+		comparison.numberOfMissingRows = 0;
+		comparison.numberOfExtraRows = 0;
+		comparison.numberOfDriftingRows = 0;
+		comparison.maximumAtomDeltaVDrift = 0.0;
+		comparison.maximumLambertDeltaVDrift = 0.0;
+
+		unsigned int r = 0;
+		unsigned int s = 0;
+		while( r < referenceRows.size( ) || s < resultRows.size( ) )
+		{
+			if( s == resultRows.size( ) || ( r < referenceRows.size( ) && isBeforeCell( referenceRows[ r ], resultRows[ s ] ) ) )
+			{
+				comparison.numberOfMissingRows++;
+				r++;
+				continue;
+			}
+			if( r == referenceRows.size( ) || isBeforeCell( resultRows[ s ], referenceRows[ r ] ) )
+			{
+				comparison.numberOfExtraRows++;
+				s++;
+				continue;
+			}
+
+			const ResultRecord& expected = referenceRows[ r ];
+			const ResultRecord& actual = resultRows[ s ];
+			const Real atomDrift = std::fabs( actual.atomDeltaV - expected.atomDeltaV );
+			const Real lambertDrift = std::fabs( actual.lambertDeltaV - expected.lambertDeltaV );
+			comparison.numberOfMatchedRows++;
+			comparison.maximumAtomDeltaVDrift = std::max( comparison.maximumAtomDeltaVDrift, atomDrift );
+			comparison.maximumLambertDeltaVDrift = std::max( comparison.maximumLambertDeltaVDrift, lambertDrift );
+			if( atomDrift > tolerance.absoluteDeltaV + tolerance.relativeDeltaV * std::fabs( expected.atomDeltaV )
+				|| lambertDrift > tolerance.absoluteDeltaV + tolerance.relativeDeltaV * std::fabs( expected.lambertDeltaV ) )
+			{
+				comparison.numberOfDriftingRows++;
+				comparison.driftingRows.push_back( std::make_pair( expected, actual ) );
+			}
+			r++;
+			s++;
+		}
+		return comparison;
+	}
+
+	bool isPassing( const RegressionComparison& comparison )
+	{
+		return comparison.numberOfMissingRows == 0
+			&& comparison.numberOfExtraRows == 0
+			&& comparison.numberOfDriftingRows == 0;
+	}
+
+	RegressionReport runRegression( const std::string& catalogPath,
+									const std::string& referencePath,
+									const RegressionTolerance& tolerance,
+									CellEvaluator baseline,
+									CellEvaluator candidate )
+	{
+		const std::vector< Tle > catalog = tleCatalog::readTleCatalog( catalogPath );
+		resultsStore::IngestionSummary summary;
+		const std::vector< ResultRecord > reference
+			= resultsStore::readResultFiles( std::vector< std::string >( 1, referencePath ), summary );
+		if( summary.numberOfFiles == 0 || reference.empty( ) )
+		{
+			throw std::runtime_error( "No reference results in " + referencePath );
+		}
+
+		RegressionReport report;
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now( );
+		const std::vector< ResultRecord > baselineResults = baseline( catalog, reference );
+		report.baselineSeconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+
+		begin = std::chrono::steady_clock::now( );
+		const std::vector< ResultRecord > candidateResults = candidate( catalog, reference );
+		report.candidateSeconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+
+		report.baseline = compareResults( reference, baselineResults, tolerance );
+		report.candidate = compareResults( reference, candidateResults, tolerance );
+		return report;
+	}
+
+} // namespace gridRegression
@@ -0,0 +1,784 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/atomBatch.hpp"
+#include "CppProject/atomTransfer.hpp"
+#include "CppProject/atomWorkspace.hpp"
+#include "CppProject/epochPlanner.hpp"
+#include "CppProject/gridSearch.hpp"
+#include "CppProject/j2Propagator.hpp"
+#include "CppProject/mixedPrecisionScreening.hpp"
+#include "CppProject/parallelFor.hpp"
+#include "CppProject/tleCatalog.hpp"
+#include "CppProject/twoTierScreening.hpp"
+
+namespace gridSearch
+{
+
+	std::vector< DateTime > computeDepartureEpochs( const DateTime& startEpoch, const int departureIndex, const int epochSteps )
+	{
+		std::vector< DateTime > departureEpochs( epochSteps );
+		for( int l = 0; l < epochSteps; l++ )
+		{
+			const Real offset = 100.0 * ( departureIndex * ( epochSteps * ( epochSteps - 1 ) / 2 ) + l * ( l + 1 ) / 2 );
+			departureEpochs[ l ] = startEpoch.AddSeconds( offset );
+		}
+		return departureEpochs;
+	}
+
+	std::vector< Real > computeTimesOfFlight( const int timeOfFlightSteps,
+											  const Real firstTimeOfFlight,
+											  const Real timeOfFlightStep )
+	{
+		std::vector< Real > timesOfFlight( timeOfFlightSteps );
+		for( int p = 0; p < timeOfFlightSteps; p++ )
+		{
+			timesOfFlight[ p ] = firstTimeOfFlight + p * timeOfFlightStep;
+		}
+		return timesOfFlight;
+	}
+
+	GridSearchSpec getDefaultGridSearchSpec( )
+	{
+		GridSearchSpec spec;
+		spec.catalogPath = "../../src/catalog_rocketbodies_5withlowDV.txt";
+		spec.startEpoch = DateTime( 2016, 2, 1 );
+		spec.epochPattern = accumulatingEpochs;
+		spec.numberOfEpochSteps = 100;
+		spec.windowMinutes = 0.0;
+		spec.numberOfTimeOfFlightSteps = 1000;
+		spec.firstTimeOfFlight = 10.0;
+		spec.timeOfFlightStep = 60.0;
+		spec.shortlistSize = 0;
+		spec.useSinglePrecisionScreening = false;
+		spec.screeningMargin = 1.0e-3;
+		spec.solverSettings = atomTransfer::getDefaultAtomSolverSettings( );
+		spec.refinementSize = 0;
+		spec.screeningSettings = spec.solverSettings;
+		spec.screeningSettings.absoluteTolerance = 1.0e-4;
+		spec.screeningSettings.relativeTolerance = 1.0e-3;
+		spec.screeningSettings.maximumIterations = 10;
+		spec.useSolverWorkspace = false;
+		spec.batchSize = 0;
+		spec.numberOfThreads = 1;
+		return spec;
+	}
+
+	CsvResultSink::CsvResultSink( std::ostream& outputStream, const bool writeHeader )
+		: outputStream( outputStream ),
+		  isHeaderPending( writeHeader )
+	{ }
+
+	void CsvResultSink::beginRun( const GridSearchSpec& )
+	{
+		if( isHeaderPending )
+		{
+			atomTransfer::writeTransferHeader( outputStream );
+			isHeaderPending = false;
+		}
+	}
+
+	void CsvResultSink::consumeResult( const atomTransfer::TransferResult& result )
+	{
+		atomTransfer::writeTransferResult( outputStream, result );
+	}
+
+	void CollectingResultSink::consumeResult( const atomTransfer::TransferResult& result )
+	{
+		results.push_back( result );
+	}
+
+	BestTransferSink::BestTransferSink( ResultSink* forwardSink )
+		: forwardSink( forwardSink )
+	{ }
+
+	void BestTransferSink::beginRun( const GridSearchSpec& spec )
+	{
+		if( forwardSink != NULL )
+		{
+			forwardSink->beginRun( spec );
+		}
+	}
+
+	void BestTransferSink::consumeResult( const atomTransfer::TransferResult& result )
+	{
+		const std::pair< int, int > pairIds( result.departureObjectId, result.arrivalObjectId );
+		std::map< std::pair< int, int >, atomTransfer::TransferResult >::iterator best = bestTransfers.find( pairIds );
+		if( best == bestTransfers.end( ) )
+		{
+			bestTransfers[ pairIds ] = result;
+		}
+		else if( result.atomDeltaV < best->second.atomDeltaV )
+		{
+			best->second = result;
+		}
+		if( forwardSink != NULL )
+		{
+			forwardSink->consumeResult( result );
+		}
+	}
+
+	void BestTransferSink::consumeFailure( const atomTransfer::TransferResult& result )
+	{
+		if( forwardSink != NULL )
+		{
+			forwardSink->consumeFailure( result );
+		}
+	}
+
+	void BestTransferSink::endRun( const GridSearchSummary& summary )
+	{
+		if( forwardSink != NULL )
+		{
+			forwardSink->endRun( summary );
+		}
+	}
+
+	OrderedResultSink::OrderedResultSink( const std::vector< Tle >& catalog, ResultSink& forwardSink )
+		: forwardSink( forwardSink )
+	{
+		for( unsigned int k = 0; k < catalog.size( ); k++ )
+		{
+			catalogIndex.insert( std::make_pair( static_cast< int >( catalog[ k ].NoradNumber( ) ), static_cast< int >( k ) ) );
+		}
+	}
+
+	void OrderedResultSink::beginRun( const GridSearchSpec& spec )
+	{
+		cells.clear( );
+		forwardSink.beginRun( spec );
+	}
+
+	void OrderedResultSink::addCell( const atomTransfer::TransferResult& result, const bool isConverged )
+	{
+		const std::map< int, int >::const_iterator departure = catalogIndex.find( result.departureObjectId );
+		const std::map< int, int >::const_iterator arrival = catalogIndex.find( result.arrivalObjectId );
+		OrderedCell cell;
+		cell.departureIndex = departure == catalogIndex.end( ) ? -1 : departure->second;
+		cell.arrivalIndex = arrival == catalogIndex.end( ) ? -1 : arrival->second;
+		cell.isConverged = isConverged;
+		cell.result = result;
+		cells.push_back( cell );
+	}
+
+	void OrderedResultSink::consumeResult( const atomTransfer::TransferResult& result )
+	{
+		addCell( result, true );
+	}
+
+	void OrderedResultSink::consumeFailure( const atomTransfer::TransferResult& result )
+	{
+		addCell( result, false );
+	}
+
+	bool OrderedResultSink::compareCells( const OrderedCell& first, const OrderedCell& second )
+	{
+		if( first.departureIndex != second.departureIndex )
+		{
+			return first.departureIndex < second.departureIndex;
+		}
+		if( first.result.departureEpoch.Ticks( ) != second.result.departureEpoch.Ticks( ) )
+		{
+			return first.result.departureEpoch.Ticks( ) < second.result.departureEpoch.Ticks( );
+		}
+		if( first.arrivalIndex != second.arrivalIndex )
+		{
+			return first.arrivalIndex < second.arrivalIndex;
+		}
+		return first.result.timeOfFlight < second.result.timeOfFlight;
+	}
+
+	void OrderedResultSink::endRun( const GridSearchSummary& summary )
+	{
+		std::stable_sort( cells.begin( ), cells.end( ), compareCells );
+		for( unsigned int k = 0; k < cells.size( ); k++ )
+		{
+			if( cells[ k ].isConverged )
+			{
+				forwardSink.consumeResult( cells[ k ].result );
+			}
+			else
+			{
+				forwardSink.consumeFailure( cells[ k ].result );
+			}
+		}
+		cells.clear( );
+		forwardSink.endRun( summary );
+	}
+
+	bool compareAtomDeltaV( const atomTransfer::TransferResult& first, const atomTransfer::TransferResult& second )
+	{
+		return first.atomDeltaV < second.atomDeltaV;
+	}
+
+	std::vector< atomTransfer::TransferResult > BestTransferSink::getBestTransfers( ) const
+	{
+		std::vector< atomTransfer::TransferResult > transfers;
+		for( std::map< std::pair< int, int >, atomTransfer::TransferResult >::const_iterator best = bestTransfers.begin( );
+			 best != bestTransfers.end( ); ++best )
+		{
+			transfers.push_back( best->second );
+		}
+		std::stable_sort( transfers.begin( ), transfers.end( ), compareAtomDeltaV );
+		return transfers;
+	}
+
+	AnytimeSettings getDefaultAnytimeSettings( )
+	{
+		AnytimeSettings settings;
+		settings.epochsPerWindow = 10;
+		settings.promiseTimeOfFlightStride = 20;
+		settings.maximumSeconds = 0.0;
+		settings.maximumEvaluations = 0;
+		settings.targetDeltaV = 0.0;
+		settings.numberOfTargetPairs = 0;
+		return settings;
+	}
+
+	std::string getStopReasonName( const StopReason reason )
+	{
+		switch( reason )
+		{
+			case searchCompleted:
+				return "search completed";
+			case timeBudgetReached:
+				return "time budget reached";
+			case evaluationBudgetReached:
+				return "evaluation budget reached";
+			case targetReached:
+				return "target reached";
+		}
+		return "unknown";
+	}
+
+	const std::vector< Tle >& GridSearchEngine::loadCatalog( const std::string& catalogPath )
+	{
+		return findCatalogCache( catalogPath ).objects;
+	}
+
+	void GridSearchEngine::clearCache( )
+	{
+		catalogCaches.clear( );
+	}
+
+	const GridSearchEngine::CatalogCache& GridSearchEngine::findCatalogCache( const std::string& catalogPath )
+	{
+		std::map< std::string, CatalogCache >::iterator cache = catalogCaches.find( catalogPath );
+		if( cache != catalogCaches.end( ) )
+		{
+			return cache->second;
+		}
+
+		CatalogCache& newCache = catalogCaches[ catalogPath ];
+		newCache.objects = tleCatalog::readTleCatalog( catalogPath );
+		for( unsigned int k = 0; k < newCache.objects.size( ); k++ )
+		{
+			newCache.sgp4Propagators.push_back( SGP4( newCache.objects[ k ] ) );
+			newCache.j2Propagators.push_back( j2Propagator::J2Propagator( newCache.objects[ k ] ) );
+		}
+		return newCache;
+	}
+
+	//! Mission window of the uniform and planned patterns [min]; that of the accumulating pattern if the spec leaves it at 0.
+	Real computeWindowMinutes( const GridSearchSpec& spec, const int DebrisObjects )
+	{
+		Real windowMinutes = spec.windowMinutes;
+		if( windowMinutes <= 0.0 && DebrisObjects > 1 )
+		{
+			windowMinutes = ( computeDepartureEpochs( spec.startEpoch, DebrisObjects - 2, spec.numberOfEpochSteps ).back( )
+							  - spec.startEpoch ).TotalMinutes( );
+		}
+		return windowMinutes;
+	}
+
+	//! Departure epochs of a pair for the epoch pattern of a run.
+	std::vector< DateTime > computePairDepartureEpochs( const GridSearchSpec& spec,
+														const std::vector< Tle >& objects,
+														const int departureIndex,
+														const int arrivalIndex,
+														const Real windowMinutes,
+														const epochPlanner::PlannerSettings& plannerSettings )
+	{
+		if( spec.epochPattern == accumulatingEpochs )
+		{
+			return computeDepartureEpochs( spec.startEpoch, departureIndex, spec.numberOfEpochSteps );
+		}
+		if( spec.epochPattern == uniformEpochs )
+		{
+			return epochPlanner::computeUniformDepartureEpochs( spec.startEpoch, windowMinutes, spec.numberOfEpochSteps );
+		}
+		const epochPlanner::PairPhasing phasing
+			= epochPlanner::computePairPhasing( objects[ departureIndex ], objects[ arrivalIndex ] );
+		return epochPlanner::planDepartureEpochs( phasing, spec.startEpoch, windowMinutes, plannerSettings );
+	}
+
+	//! Solve one cell with the solver selected by the spec and the given settings; returns whether ATOM converged.
+	bool evaluateGridCell( const GridSearchSpec& spec,
+						   const atomTransfer::AtomSolverSettings& solverSettings,
+						   const std::vector< Tle >& objects,
+						   const std::vector< SGP4 >& sgp4Propagators,
+						   const int departureIndex,
+						   const int arrivalIndex,
+						   const DateTime& departureEpoch,
+						   const Real timeOfFlight,
+						   atomWorkspace::AtomSolverWorkspace& workspace,
+						   atomTransfer::TransferResult& result,
+						   std::string& solverStatusSummary )
+	{
+		if( spec.useSolverWorkspace )
+		{
+			return atomTransfer::evaluateTransfer( objects[ departureIndex ], sgp4Propagators[ departureIndex ],
+												   objects[ arrivalIndex ], sgp4Propagators[ arrivalIndex ],
+												   departureEpoch, timeOfFlight, solverSettings,
+												   workspace, result, solverStatusSummary );
+		}
+		return atomTransfer::evaluateTransfer( objects[ departureIndex ], sgp4Propagators[ departureIndex ],
+											   objects[ arrivalIndex ], sgp4Propagators[ arrivalIndex ],
+											   departureEpoch, timeOfFlight, solverSettings,
+											   result, solverStatusSummary );
+	}
+
+	//! Refine a screened cell with the tight settings of the spec; returns whether ATOM converged.
+	bool refineGridCell( const GridSearchSpec& spec,
+						 const std::vector< Tle >& objects,
+						 const std::vector< SGP4 >& sgp4Propagators,
+						 const int departureIndex,
+						 const int arrivalIndex,
+						 const atomTransfer::TransferResult& screeningResult,
+						 atomWorkspace::AtomSolverWorkspace& workspace,
+						 atomTransfer::TransferResult& result,
+						 std::string& solverStatusSummary )
+	{
+		if( spec.useSolverWorkspace )
+		{
+			return atomTransfer::refineTransfer( objects[ departureIndex ], sgp4Propagators[ departureIndex ],
+												 objects[ arrivalIndex ], sgp4Propagators[ arrivalIndex ],
+												 screeningResult, spec.solverSettings, workspace, result, solverStatusSummary );
+		}
+		return atomTransfer::refineTransfer( objects[ departureIndex ], sgp4Propagators[ departureIndex ],
+											 objects[ arrivalIndex ], sgp4Propagators[ arrivalIndex ],
+											 screeningResult, spec.solverSettings, result, solverStatusSummary );
+	}
+
+	GridSearchSummary GridSearchEngine::run( const GridSearchSpec& spec, ResultSink& sink )
+	{
+		const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now( );
+		const CatalogCache& cache = findCatalogCache( spec.catalogPath );
+		const int DebrisObjects = cache.objects.size( );
+		const int numberOfPairObjects = std::max( DebrisObjects - 1, 0 );
+		const std::vector< Real > timesOfFlight
+			= computeTimesOfFlight( spec.numberOfTimeOfFlightSteps, spec.firstTimeOfFlight, spec.timeOfFlightStep );
+
+		const Real windowMinutes = computeWindowMinutes( spec, DebrisObjects );
+		epochPlanner::PlannerSettings plannerSettings = epochPlanner::getDefaultSettings( );
+		plannerSettings.numberOfEpochs = spec.numberOfEpochSteps;
+		plannerSettings.maximumTimeOfFlight = timesOfFlight.empty( ) ? 0.0 : timesOfFlight.back( );
+
+		GridSearchSummary summary;
+		summary.numberOfCells = 0;
+		summary.numberOfConvergedCells = 0;
+		summary.numberOfFailedCells = 0;
+		summary.numberOfRefinedCells = 0;
+		summary.numberOfScreenedOnlyCells = 0;
+		summary.numberOfIterations = 0;
+		std::mutex sinkMutex;
+		const bool isStaged = spec.refinementSize > 0;
+		mixedPrecisionScreening::ScreeningSettings screeningSettings;
+		screeningSettings.shortlistSize = spec.shortlistSize;
+		screeningSettings.deltaVMargin = spec.screeningMargin;
+		sink.beginRun( spec );
+
+		// departure objects are spread over the threads; each solves all of its arrival objects
+		parallelFor::parallelFor( numberOfPairObjects, spec.numberOfThreads,
+								  [ & ]( const int beginObject, const int endObject, const int )
+		{
+			std::string SolverStatusSummary;
+			atomWorkspace::AtomSolverWorkspace workspace; // allocated once per thread, reused for all its cells
+			std::vector< std::vector< atomTransfer::TransferResult > > screenedResults( numberOfPairObjects );
+			const auto consumeCell = [ & ]( const int m, const atomTransfer::TransferResult& result, const bool isConverged )
+			{
+				if( isStaged && isConverged )
+				{
+					// kept for the refinement of the pair
+					screenedResults[ m ].push_back( result );
+				}
+				std::lock_guard< std::mutex > lock( sinkMutex );
+				summary.numberOfCells++;
+				summary.numberOfIterations += result.numberOfIterations;
+				if( !isConverged )
+				{
+					summary.numberOfFailedCells++;
+					sink.consumeFailure( result );
+				}
+				else if( !isStaged )
+				{
+					summary.numberOfConvergedCells++;
+					sink.consumeResult( result );
+				}
+			};
+
+			// batched run: cells are queued and solved batchSize at a time
+			atomBatch::BatchTransferSolver batchSolver( std::max( spec.batchSize, 1 ) );
+			std::vector< atomBatch::TransferProblem > batchProblems;
+			std::vector< atomBatch::TransferSolution > batchSolutions;
+			std::vector< atomTransfer::TransferResult > batchResults;
+			std::vector< int > batchArrivalIndices;
+			const auto flushCells = [ & ]( )
+			{
+				if( batchProblems.empty( ) )
+				{
+					return;
+				}
+				batchSolver.solve( batchProblems, isStaged ? spec.screeningSettings : spec.solverSettings, batchSolutions );
+				for( unsigned int k = 0; k < batchProblems.size( ); k++ )
+				{
+					const bool isConverged = atomTransfer::completeBatchTransfer( batchProblems[ k ], batchSolutions[ k ],
+																				  batchResults[ k ], SolverStatusSummary );
+					consumeCell( batchArrivalIndices[ k ], batchResults[ k ], isConverged );
+				}
+				batchProblems.clear( );
+				batchResults.clear( );
+				batchArrivalIndices.clear( );
+			};
+
+			const auto evaluateCell = [ & ]( const int i, const int m, const DateTime& departureEpoch, const Real timeOfFlight )
+			{
+				atomTransfer::TransferResult result;
+				result.numberOfIterations = 0;
+				if( spec.batchSize > 0 )
+				{
+					atomBatch::TransferProblem problem;
+					atomTransfer::prepareBatchTransfer( cache.objects[ i ], cache.sgp4Propagators[ i ],
+														cache.objects[ m ], cache.sgp4Propagators[ m ],
+														departureEpoch, timeOfFlight,
+														isStaged ? spec.screeningSettings : spec.solverSettings, result, problem );
+					batchProblems.push_back( problem );
+					batchResults.push_back( result );
+					batchArrivalIndices.push_back( m );
+					if( static_cast< int >( batchProblems.size( ) ) == spec.batchSize )
+					{
+						flushCells( );
+					}
+					return;
+				}
+				const bool isConverged = evaluateGridCell( spec, isStaged ? spec.screeningSettings : spec.solverSettings,
+														   cache.objects, cache.sgp4Propagators, i, m, departureEpoch,
+														   timeOfFlight, workspace, result, SolverStatusSummary );
+				consumeCell( m, result, isConverged );
+			};
+
+			// staged run: solve the best screened cells of every pair of departure object i again with the tight settings
+			const auto refineCells = [ & ]( const int i )
+			{
+				flushCells( );
+				for( int m = 0; m < numberOfPairObjects; m++ )
+				{
+					std::vector< atomTransfer::TransferResult >& screened = screenedResults[ m ];
+					const int numberOfRefinements = std::min( spec.refinementSize, static_cast< int >( screened.size( ) ) );
+					std::partial_sort( screened.begin( ), screened.begin( ) + numberOfRefinements, screened.end( ),
+									   compareAtomDeltaV );
+					for( int k = 0; k < numberOfRefinements; k++ )
+					{
+						atomTransfer::TransferResult result;
+						result.numberOfIterations = 0;
+						const bool isConverged = refineGridCell( spec, cache.objects, cache.sgp4Propagators, i, m, screened[ k ],
+																 workspace, result, SolverStatusSummary );
+						std::lock_guard< std::mutex > lock( sinkMutex );
+						summary.numberOfRefinedCells++;
+						summary.numberOfIterations += result.numberOfIterations;
+						if( isConverged )
+						{
+							summary.numberOfConvergedCells++;
+							sink.consumeResult( result );
+						}
+						else
+						{
+							summary.numberOfFailedCells++;
+							sink.consumeFailure( result );
+						}
+					}
+					std::lock_guard< std::mutex > lock( sinkMutex );
+					for( unsigned int k = numberOfRefinements; k < screened.size( ); k++ )
+					{
+						summary.numberOfScreenedOnlyCells++;
+						sink.consumeScreenedResult( screened[ k ] );
+					}
+					screened.clear( );
+				}
+			};
+
+			for( int i = beginObject; i < endObject; i++ )
+			{
+				// departure epochs towards every arrival object
+				std::vector< std::vector< DateTime > > departureEpochs( numberOfPairObjects );
+				unsigned int maximumEpochSteps = 0;
+				for( int m = 0; m < numberOfPairObjects; m++ )
+				{
+					if( i == m )
+					{
+						continue;
+					}
+					departureEpochs[ m ] = computePairDepartureEpochs( spec, cache.objects, i, m, windowMinutes, plannerSettings );
+					maximumEpochSteps = std::max( maximumEpochSteps, static_cast< unsigned int >( departureEpochs[ m ].size( ) ) );
+				}
+
+				if( spec.shortlistSize > 0 )
+				{
+					// two-tier: J2 (or single-precision SGP4) + Lambert over the pair grid, SGP4 + ATOM on the shortlisted cells only
+					for( int m = 0; m < numberOfPairObjects; m++ )
+					{
+						if( i == m )
+						{
+							continue;
+						}
+						const std::vector< twoTierScreening::ScreeningCell > shortlist = spec.useSinglePrecisionScreening
+							? mixedPrecisionScreening::screenTransferGrid( cache.sgp4Propagators[ i ], cache.sgp4Propagators[ m ],
+																		   departureEpochs[ m ], timesOfFlight, screeningSettings )
+							: twoTierScreening::screenTransferGrid( cache.j2Propagators[ i ], cache.j2Propagators[ m ],
+																	departureEpochs[ m ], timesOfFlight, spec.shortlistSize );
+						for( unsigned int k = 0; k < shortlist.size( ); k++ )
+						{
+							evaluateCell( i, m, departureEpochs[ m ][ shortlist[ k ].epochIndex ],
+										  timesOfFlight[ shortlist[ k ].timeOfFlightIndex ] );
+						}
+					}
+					if( isStaged )
+					{
+						refineCells( i );
+					}
+					continue;
+				}
+
+				// full grid, in the loop order of the original grid search
+				for( unsigned int l = 0; l < maximumEpochSteps; l++ )
+				{
+					for( int m = 0; m < numberOfPairObjects; m++ )
+					{
+						if( i == m || l >= departureEpochs[ m ].size( ) )
+						{
+							continue;
+						}
+						for( unsigned int p = 0; p < timesOfFlight.size( ); p++ )
+						{
+							evaluateCell( i, m, departureEpochs[ m ][ l ], timesOfFlight[ p ] );
+						}
+					}
+				}
+				if( isStaged )
+				{
+					refineCells( i );
+				}
+			}
+			flushCells( );
+		} );
+
+		summary.seconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+		sink.endRun( summary );
+		return summary;
+	}
+
+	//! Window of consecutive departure epochs of a pair, ranked by its promise
+	struct AnytimeCell
+	{
+		int departureIndex;
+		int arrivalIndex;
+		int firstEpoch;
+		int endEpoch;
+		Real promise;		// lowest J2 + Lambert delta-V on the promise subset [km/s]
+	};
+
+	bool compareCellPromise( const AnytimeCell& first, const AnytimeCell& second )
+	{
+		return first.promise < second.promise;
+	}
+
+	AnytimeSummary GridSearchEngine::runAnytime( const GridSearchSpec& spec, const AnytimeSettings& settings, ResultSink& sink )
+	{
+		const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now( );
+		const CatalogCache& cache = findCatalogCache( spec.catalogPath );
+		const int DebrisObjects = cache.objects.size( );
+		const int numberOfPairObjects = std::max( DebrisObjects - 1, 0 );
+		const std::vector< Real > timesOfFlight
+			= computeTimesOfFlight( spec.numberOfTimeOfFlightSteps, spec.firstTimeOfFlight, spec.timeOfFlightStep );
+		std::vector< Real > promiseTimesOfFlight;
+		for( unsigned int p = 0; p < timesOfFlight.size( ); p += std::max( settings.promiseTimeOfFlightStride, 1 ) )
+		{
+			promiseTimesOfFlight.push_back( timesOfFlight[ p ] );
+		}
+
+		const Real windowMinutes = computeWindowMinutes( spec, DebrisObjects );
+		epochPlanner::PlannerSettings plannerSettings = epochPlanner::getDefaultSettings( );
+		plannerSettings.numberOfEpochs = spec.numberOfEpochSteps;
+		plannerSettings.maximumTimeOfFlight = timesOfFlight.empty( ) ? 0.0 : timesOfFlight.back( );
+
+		// departure epochs and cells of every pair, indexed by i * numberOfPairObjects + m
+		const int epochsPerWindow = std::max( settings.epochsPerWindow, 1 );
+		std::vector< std::vector< DateTime > > pairEpochs( numberOfPairObjects * numberOfPairObjects );
+		std::vector< std::vector< AnytimeCell > > pairCells( numberOfPairObjects * numberOfPairObjects );
+		parallelFor::parallelFor( numberOfPairObjects, spec.numberOfThreads,
+								  [ & ]( const int beginObject, const int endObject, const int )
+		{
+			for( int i = beginObject; i < endObject; i++ )
+			{
+				for( int m = 0; m < numberOfPairObjects; m++ )
+				{
+					if( i == m )
+					{
+						continue;
+					}
+					const int pairIndex = i * numberOfPairObjects + m;
+					const std::vector< DateTime >& epochs = pairEpochs[ pairIndex ]
+						= computePairDepartureEpochs( spec, cache.objects, i, m, windowMinutes, plannerSettings );
+					for( unsigned int first = 0; first < epochs.size( ); first += epochsPerWindow )
+					{
+						AnytimeCell cell;
+						cell.departureIndex = i;
+						cell.arrivalIndex = m;
+						cell.firstEpoch = first;
+						cell.endEpoch = std::min( first + epochsPerWindow, static_cast< unsigned int >( epochs.size( ) ) );
+						const std::vector< twoTierScreening::ScreeningCell > best = twoTierScreening::screenTransferGrid(
+							cache.j2Propagators[ i ], cache.j2Propagators[ m ],
+							std::vector< DateTime >( epochs.begin( ) + cell.firstEpoch, epochs.begin( ) + cell.endEpoch ),
+							promiseTimesOfFlight, 1 );
+						cell.promise = best.empty( ) ? std::numeric_limits< Real >::infinity( ) : best[ 0 ].lambertDeltaV;
+						pairCells[ pairIndex ].push_back( cell );
+					}
+				}
+			}
+		} );
+
+		// most promising first; ties keep the order of the original loop
+		std::vector< AnytimeCell > cells;
+		for( unsigned int k = 0; k < pairCells.size( ); k++ )
+		{
+			cells.insert( cells.end( ), pairCells[ k ].begin( ), pairCells[ k ].end( ) );
+		}
+		std::stable_sort( cells.begin( ), cells.end( ), compareCellPromise );
+
+		AnytimeSummary anytimeSummary;
+		anytimeSummary.numberOfRankedCells = cells.size( );
+		anytimeSummary.numberOfStartedCells = 0;
+		anytimeSummary.rankingSeconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+
+		GridSearchSummary& summary = anytimeSummary.gridSummary;
+		summary.numberOfCells = 0;
+		summary.numberOfConvergedCells = 0;
+		summary.numberOfFailedCells = 0;
+		summary.numberOfRefinedCells = 0;
+		summary.numberOfScreenedOnlyCells = 0;
+		summary.numberOfIterations = 0;
+		std::mutex sinkMutex;
+		// a pair counts once towards the target, however many of its cells reach it
+		std::set< std::pair< int, int > > targetPairs;
+		std::atomic< long > nextCell( 0 );
+		std::atomic< long > numberOfEvaluations( 0 );
+		std::atomic< int > stopCode( -1 );		// StopReason of the first stop condition met, -1 while running
+		const auto stop = [ & ]( const StopReason reason )
+		{
+			int running = -1;
+			stopCode.compare_exchange_strong( running, reason );
+		};
+		sink.beginRun( spec );
+
+		// every thread takes the next cell in order of promise until the cells or the budget run out
+		const int numberOfThreads = parallelFor::getNumberOfThreads( spec.numberOfThreads );
+		parallelFor::parallelFor( numberOfThreads, numberOfThreads, [ & ]( const int, const int, const int )
+		{
+			std::string SolverStatusSummary;
+			atomWorkspace::AtomSolverWorkspace workspace;
+			while( stopCode.load( ) < 0 )
+			{
+				const long c = nextCell++;
+				if( c >= static_cast< long >( cells.size( ) ) )
+				{
+					break;
+				}
+				const AnytimeCell& cell = cells[ c ];
+				const int i = cell.departureIndex;
+				const int m = cell.arrivalIndex;
+				const std::vector< DateTime >& epochs = pairEpochs[ i * numberOfPairObjects + m ];
+				const std::vector< DateTime > windowEpochs( epochs.begin( ) + cell.firstEpoch, epochs.begin( ) + cell.endEpoch );
+				const int numberOfPoints = windowEpochs.size( ) * timesOfFlight.size( );
+				const std::vector< twoTierScreening::ScreeningCell > ranking = twoTierScreening::screenTransferGrid(
+					cache.j2Propagators[ i ], cache.j2Propagators[ m ], windowEpochs, timesOfFlight,
+					spec.shortlistSize > 0 ? std::min( spec.shortlistSize, numberOfPoints ) : numberOfPoints );
+
+				{
+					std::lock_guard< std::mutex > lock( sinkMutex );
+					anytimeSummary.numberOfStartedCells++;
+				}
+				for( unsigned int k = 0; k < ranking.size( ); k++ )
+				{
+					if( settings.maximumSeconds > 0.0
+						&& std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( ) >= settings.maximumSeconds )
+					{
+						stop( timeBudgetReached );
+					}
+					if( settings.maximumEvaluations > 0 && numberOfEvaluations++ >= settings.maximumEvaluations )
+					{
+						stop( evaluationBudgetReached );
+					}
+					if( stopCode.load( ) >= 0 )
+					{
+						break;
+					}
+
+					atomTransfer::TransferResult result;
+					result.numberOfIterations = 0;
+					const bool isConverged = evaluateGridCell( spec, spec.solverSettings, cache.objects, cache.sgp4Propagators, i, m,
+															   windowEpochs[ ranking[ k ].epochIndex ],
+															   timesOfFlight[ ranking[ k ].timeOfFlightIndex ],
+															   workspace, result, SolverStatusSummary );
+					std::lock_guard< std::mutex > lock( sinkMutex );
+					summary.numberOfCells++;
+					summary.numberOfIterations += result.numberOfIterations;
+					if( isConverged )
+					{
+						summary.numberOfConvergedCells++;
+						sink.consumeResult( result );
+						if( result.atomDeltaV <= settings.targetDeltaV )
+						{
+							targetPairs.insert( std::make_pair( i, m ) );
+							if( settings.numberOfTargetPairs > 0
+								&& static_cast< int >( targetPairs.size( ) ) >= settings.numberOfTargetPairs )
+							{
+								stop( targetReached );
+							}
+						}
+					}
+					else
+					{
+						summary.numberOfFailedCells++;
+						sink.consumeFailure( result );
+					}
+				}
+			}
+		} );
+
+		anytimeSummary.numberOfTargetPairs = targetPairs.size( );
+		anytimeSummary.stopReason = stopCode.load( ) < 0 ? searchCompleted : static_cast< StopReason >( stopCode.load( ) );
+		summary.seconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+		sink.endRun( summary );
+		return anytimeSummary;
+	}
+
+} // namespace gridSearch
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <cmath>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Globals.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/j2Propagator.hpp"
+
+namespace j2Propagator
+{
+
+	MeanElements computeMeanElements( const Tle& tle )
+	{
+		MeanElements elements;
+		elements.epoch = tle.Epoch( );
+		elements.eccentricity = tle.Eccentricity( );
+		elements.inclination = tle.Inclination( false );
+		elements.rightAscendingNode = tle.RightAscendingNode( false );
+		elements.argumentPerigee = tle.ArgumentPerigee( false );
+		elements.meanAnomaly = tle.MeanAnomaly( false );
+		elements.meanMotionDt2 = tle.MeanMotionDt2( ) * kTWOPI / ( kMINUTES_PER_DAY * kMINUTES_PER_DAY );
+
+		// recover the original (Brouwer) mean motion and semi-major axis from the Kozai mean motion
+		// in the TLE, in the same way as SGP4 does during initialisation (earth radii and minutes)
+		const Real kozaiMeanMotion = tle.MeanMotion( ) * kTWOPI / kMINUTES_PER_DAY;
+		const Real cosio = std::cos( elements.inclination );
+		const Real theta2 = cosio * cosio;
+		const Real x3thm1 = 3.0 * theta2 - 1.0;
+		const Real betao2 = 1.0 - elements.eccentricity * elements.eccentricity;
+		const Real betao = std::sqrt( betao2 );
+
+		const Real a1 = std::pow( kXKE / kozaiMeanMotion, kTWOTHIRD );
+		const Real del1 = 1.5 * kCK2 * x3thm1 / ( a1 * a1 * betao * betao2 );
+		const Real ao = a1 * ( 1.0 - del1 * ( 0.5 * kTWOTHIRD + del1 * ( 1.0 + 134.0 / 81.0 * del1 ) ) );
+		const Real delo = 1.5 * kCK2 * x3thm1 / ( ao * ao * betao * betao2 );
+		const Real meanMotion = kozaiMeanMotion / ( 1.0 + delo );
+		const Real semiMajorAxis = ao / ( 1.0 - delo );
+
+		elements.meanMotion = meanMotion;
+		elements.semiMajorAxis = semiMajorAxis * kXKMPER;
+
+		// first-order J2 secular rates, identical to the leading terms used by SGP4
+		const Real pinvsq = 1.0 / ( semiMajorAxis * semiMajorAxis * betao2 * betao2 );
+		const Real temp1 = 3.0 * kCK2 * pinvsq * meanMotion;
+		elements.meanAnomalyRate = meanMotion + 0.5 * temp1 * betao * x3thm1;
+		elements.argumentPerigeeRate = -0.5 * temp1 * ( 1.0 - 5.0 * theta2 );
+		elements.rightAscendingNodeRate = -temp1 * cosio;
+
+		return elements;
+	}
+
+	J2Propagator::J2Propagator( const Tle& tle )
+		: elements( computeMeanElements( tle ) )
+	{ }
+
+	void J2Propagator::findState( const DateTime& epoch, array3& position, array3& velocity ) const
+	{
+		findState( ( epoch - elements.epoch ).TotalMinutes( ), position, velocity );
+	}
+
+	void J2Propagator::findState( const Real minutesSinceEpoch, array3& position, array3& velocity ) const
+	{
+		const Real t = minutesSinceEpoch;
+		const Real e = elements.eccentricity;
+		const Real a = elements.semiMajorAxis;
+
+		const Real raan = elements.rightAscendingNode + elements.rightAscendingNodeRate * t;
+		const Real argumentPerigee = elements.argumentPerigee + elements.argumentPerigeeRate * t;
+		const Real meanAnomaly = std::fmod( elements.meanAnomaly + elements.meanAnomalyRate * t
+											+ elements.meanMotionDt2 * t * t, kTWOPI );
+
+		// closed-form starter followed by a few Newton steps is plenty for the small eccentricities in LEO
+		Real eccentricAnomaly = meanAnomaly + e * std::sin( meanAnomaly ) * ( 1.0 + e * std::cos( meanAnomaly ) );
+		for( int iteration = 0; iteration < 10; iteration++ )
+		{
+			const Real delta = ( eccentricAnomaly - e * std::sin( eccentricAnomaly ) - meanAnomaly )
+							   / ( 1.0 - e * std::cos( eccentricAnomaly ) );
+			eccentricAnomaly -= delta;
+			if( std::fabs( delta ) < 1.0e-12 )
+			{
+				break;
+			}
+		}
+
+		const Real cosE = std::cos( eccentricAnomaly );
+		const Real sinE = std::sin( eccentricAnomaly );
+		const Real sqrtOneMinusE2 = std::sqrt( 1.0 - e * e );
+		const Real radius = a * ( 1.0 - e * cosE );
+
+		// position and velocity in the perifocal frame
+		const Real xPerifocal = a * ( cosE - e );
+		const Real yPerifocal = a * sqrtOneMinusE2 * sinE;
+		const Real velocityFactor = std::sqrt( kMU * a ) / radius;
+		const Real vxPerifocal = -velocityFactor * sinE;
+		const Real vyPerifocal = velocityFactor * sqrtOneMinusE2 * cosE;
+
+		// rotate to the inertial frame
+		const Real cosRaan = std::cos( raan );
+		const Real sinRaan = std::sin( raan );
+		const Real cosArgumentPerigee = std::cos( argumentPerigee );
+		const Real sinArgumentPerigee = std::sin( argumentPerigee );
+		const Real cosInclination = std::cos( elements.inclination );
+		const Real sinInclination = std::sin( elements.inclination );
+
+		const Real p1 = cosRaan * cosArgumentPerigee - sinRaan * sinArgumentPerigee * cosInclination;
+		const Real p2 = sinRaan * cosArgumentPerigee + cosRaan * sinArgumentPerigee * cosInclination;
+		const Real p3 = sinArgumentPerigee * sinInclination;
+		const Real q1 = -cosRaan * sinArgumentPerigee - sinRaan * cosArgumentPerigee * cosInclination;
+		const Real q2 = -sinRaan * sinArgumentPerigee + cosRaan * cosArgumentPerigee * cosInclination;
+		const Real q3 = cosArgumentPerigee * sinInclination;
+
+		position[ 0 ] = p1 * xPerifocal + q1 * yPerifocal;
+		position[ 1 ] = p2 * xPerifocal + q2 * yPerifocal;
+		position[ 2 ] = p3 * xPerifocal + q3 * yPerifocal;
+		velocity[ 0 ] = p1 * vxPerifocal + q1 * vyPerifocal;
+		velocity[ 1 ] = p2 * vxPerifocal + q2 * vyPerifocal;
+		velocity[ 2 ] = p3 * vxPerifocal + q3 * vyPerifocal;
+	}
+
+} // namespace j2Propagator
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <limits>
+
+#include <boost/array.hpp>
+
+#include <SML/sml.hpp>
+
+#include <pykep/src/lambert_problem.cpp>
+#include <pykep/src/lambert_problem.h>
+#include <pykep/src/keplerian_toolbox.h>
+
+#include "CppProject/lambertDeltaV.hpp"
+
+namespace lambertDeltaV
+{
+
+	Real computeLambertDeltaV( const array3& departurePosition,
+							   const array3& departureVelocity,
+							   const array3& arrivalPosition,
+							   const array3& arrivalVelocity,
+							   const Real timeOfFlight,
+							   const Real gravitationalParameter,
+							   array3& transferDepartureVelocity )
+	{
+		kep_toolbox::lambert_problem targeter( departurePosition, arrivalPosition, timeOfFlight, gravitationalParameter, 0, 5 );
+		const int numberOfSolutions = targeter.get_v1( ).size( );
+
+		// magnitude of the total delta-V of one transfer between two points, minimised over all solutions
+		Real minimumDeltaV = std::numeric_limits< Real >::max( );
+		for ( int j = 0; j < numberOfSolutions; j++ )
+		{
+			const array3& departureTransferVelocity = targeter.get_v1( )[ j ]; // velocity of the s/c at the departure point in the transfer orbit
+			const array3& arrivalTransferVelocity = targeter.get_v2( )[ j ];
+
+			const array3 departureDeltaV = sml::add( departureTransferVelocity, sml::multiply( departureVelocity, -1.0 ) );
+			const array3 arrivalDeltaV = sml::add( arrivalTransferVelocity, sml::multiply( arrivalVelocity, -1.0 ) );
+			const Real transferDeltaV = sml::norm< Real >( departureDeltaV ) + sml::norm< Real >( arrivalDeltaV );
+
+			if( transferDeltaV < minimumDeltaV )
+			{
+				minimumDeltaV = transferDeltaV;
+				transferDepartureVelocity = departureTransferVelocity;
+			}
+		}
+
+		return minimumDeltaV;
+	}
+
+} // namespace lambertDeltaV
@@ -6,8 +6,54 @@
 
 // This program will make use of the ATOM solver to construct a transfer trajectory
 // between two points in space.  
-
+//
+// Usage: ATOM_ADR_main [mode] [arguments]
+//   grid                           full SGP4 + ATOM grid search (default)
+//   two-tier [shortlist size]      J2 + Lambert screening of the grid, SGP4 + ATOM on the shortlist only
+//   tier-agreement                 agreement between the J2 and SGP4 tiers on the bundled catalogs
+//   precision-check [shortlist size] [top cells]
+//                                  single-precision shortlists vs. the double-precision Lambert ranking of each pair
+//   mixed-precision [shortlist size] [margin km/s]
+//                                  two-tier grid screened with SGP4 + Lambert in single precision instead of J2
+//   tle-guess-study [samples] [uniform|sobol|lhs]
+//                                  TLE fit iterations/failures with empty vs. analytic reference TLEs
+//   tle-fitter-study [samples] [uniform|sobol|lhs]
+//                                  TLE fit failures, work and agreement of the ATOM fit vs. the analytic-Jacobian fit
+//   sampler-convergence [max samples] [replicates]
+//                                  discrepancy and mean-perigee error of the uniform, Sobol and Latin hypercube designs
+//   ephemeris [error bound km]     fit (or load) Chebyshev interpolants of the catalog over the grid window
+//   results-store [threads]        merge the Atom_Solver_*.csv outputs into an indexed binary results store
+//   conjunctions [km] [days]       screen the LEO rocket-body catalog for close approaches under a miss distance
+//   planned-grid [epochs]          grid search on departure epochs proposed per pair by the synodic epoch planner
+//   uniform-grid [epochs]          grid search on evenly spaced departure epochs over the same window
+//   staged-grid [tof steps] [refinements]
+//                                  loose screening + tight refinement vs. single tight solves on a reduced grid
+//   anytime [seconds] [target km/s] [target pairs]
+//                                  grid search in order of promise under a time budget, stopping early on the target
+//   tiled-ephemeris [days] [objects per tile] [samples per tile]
+//                                  write the catalog as an out-of-core tiled ephemeris and screen it with Lambert
+//   batched-grid [tof steps] [batch size]
+//                                  cell-by-cell vs. lock-step batched ATOM solves of a reduced grid on one thread
+//   auto-tune [repeats]            calibrate the grid threads on this machine and store the profile
+//   synthetic-catalog [objects] [leo|meo] [tof steps]
+//                                  write a synthetic 3-line TLE catalog and, with tof steps, run a reduced grid on it
+//   fit-campaign [max samples] [half width] [atom|analytic]
+//                                  Monte Carlo failure map of the Cartesian-to-TLE fit over LEO (a, e, i) bins
+//   blocked-sweep [epochs] [tof steps] [objects per tile] [epochs per tile]
+//                                  all-pairs Lambert sweep in object order vs. blocked tiles, with cache counters
+//   reachability [norad] [budget m/s] [days] [check]
+//                                  objects of the LEO rocket-body catalog reachable from one object within a delta-V
+//                                  budget; with check, compared against a sweep of every target without bounds
+//
+// The machine profile written by auto-tune (../../src/Atom_Machine_Profile.txt) is loaded by every
+// later run on the same machine and sets the threads of the grid search on the grid catalog, the work
+// it was calibrated on. Modes with other work (other catalogs, the anytime and staged searches, the
+// fit studies and sweeps) keep one thread per hardware thread.
+
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -16,272 +62,946 @@
 #include <exception>
 #include <cstdlib>
 #include <iterator>
+#include <limits>
+#include <algorithm>
+
+#include <SML/sml.hpp>
 
+#include <libsgp4/DateTime.h>
 #include <libsgp4/Globals.h>
 #include <libsgp4/SGP4.h>
 #include <libsgp4/Tle.h>
 
-#include <Atom/atom.hpp>
-#include <Atom/convertCartesianStateToTwoLineElements.hpp>
+#include "CppProject/autoTuner.hpp"
+#include "CppProject/catalogGenerator.hpp"
+#include "CppProject/conjunctionScreening.hpp"
+#include "CppProject/elementSampler.hpp"
+#include "CppProject/ephemerisInterpolator.hpp"
+#include "CppProject/fitCampaign.hpp"
+#include "CppProject/gridSearch.hpp"
+#include "CppProject/lambertDeltaV.hpp"
+#include "CppProject/mixedPrecisionScreening.hpp"
+#include "CppProject/pairTraversal.hpp"
+#include "CppProject/parallelFor.hpp"
+#include "CppProject/reachabilityMap.hpp"
+#include "CppProject/resultsStore.hpp"
+#include "CppProject/tiledEphemeris.hpp"
+#include "CppProject/tleCatalog.hpp"
+#include "CppProject/tleFitter.hpp"
+#include "CppProject/TleGen.hpp"
+#include "CppProject/twoTierScreening.hpp"
 
-#include <SML/sml.hpp>
-#include <SML/constants.hpp>
-#include <SML/basicFunctions.hpp>
-#include <SML/linearAlgebra.hpp>
 
-#include <boost/array.hpp>
+typedef double Real;
 
-#include <pykep/src/lambert_problem.cpp>
-#include <pykep/src/lambert_problem.h>
-#include <pykep/src/keplerian_toolbox.h>
+//! Run one grid search specification and append its results to a grid output file.
+void runGridSearch( gridSearch::GridSearchEngine& engine, const gridSearch::GridSearchSpec& spec, const std::string& outputPath )
+{
+    std::ofstream outputfile( outputPath.c_str( ), std::ofstream::app );
+    gridSearch::CsvResultSink sink( outputfile, true );
+    // threads finish cells in any order; with more than one the rows are sorted into the grid loop order
+    gridSearch::OrderedResultSink orderedSink( engine.loadCatalog( spec.catalogPath ), sink );
+    const gridSearch::GridSearchSummary summary
+        = engine.run( spec, spec.numberOfThreads == 1 ? static_cast< gridSearch::ResultSink& >( sink ) : orderedSink );
+    outputfile.close( );
+    std::cout << "Cells = " << summary.numberOfCells << ", converged = " << summary.numberOfConvergedCells
+              << ", time [s] = " << summary.seconds << std::endl;
+    std::cout << "Fail count = " << summary.numberOfFailedCells << std::endl;
+}
 
+//! Largest Atom delta-V difference [km/s] of results against reference results of the same cells, and the
+//! number of results without a reference cell.
+void compareCellDeltaV( const std::vector< atomTransfer::TransferResult >& references,
+                        const std::vector< atomTransfer::TransferResult >& results,
+                        Real& maximumDifference,
+                        int& numberOfUnmatchedCells )
+{
+    const auto getCellKey = [ ]( const atomTransfer::TransferResult& result )
+    {
+        std::ostringstream cell;
+        cell << result.departureObjectId << "," << result.arrivalObjectId << "," << result.departureEpoch.Ticks( )
+             << "," << result.timeOfFlight;
+        return cell.str( );
+    };
+
+    std::map< std::string, Real > referenceDeltaV;
+    for( unsigned int k = 0; k < references.size( ); k++ )
+    {
+        referenceDeltaV[ getCellKey( references[ k ] ) ] = references[ k ].atomDeltaV;
+    }
 
-typedef double Real;
-typedef std::vector < Real > Vector6;
-typedef std::vector < Real > Vector3;
-typedef std::vector < Real > Vector2;
-typedef std::vector < std::vector < Real > > Vector2D;
-typedef boost::array < Real, 3 > array3; 
-
-//! Remove newline characters from string.
-void removeNewline( std::string& string )
+    maximumDifference = 0.0;
+    numberOfUnmatchedCells = 0;
+    for( unsigned int k = 0; k < results.size( ); k++ )
+    {
+        const std::map< std::string, Real >::const_iterator reference = referenceDeltaV.find( getCellKey( results[ k ] ) );
+        if( reference == referenceDeltaV.end( ) )
+        {
+            numberOfUnmatchedCells++;
+            continue;
+        }
+        maximumDifference = std::max( maximumDifference, std::fabs( results[ k ].atomDeltaV - reference->second ) );
+    }
+}
+
+//! Compare a staged run (loose screening, tight refinement of the best cells per pair) with single tight solves.
+void runStagedGrid( gridSearch::GridSearchEngine& engine, gridSearch::GridSearchSpec spec )
+{
+    spec.refinementSize = 0;
+    gridSearch::CollectingResultSink tightSink;
+    const gridSearch::GridSearchSummary tight = engine.run( spec, tightSink );
+
+    spec.refinementSize = spec.refinementSize > 0 ? spec.refinementSize : 10;
+    gridSearch::CollectingResultSink stagedSink;
+    const gridSearch::GridSearchSummary staged = engine.run( spec, stagedSink );
+
+    // the refined cells must reproduce the delta-V of the single tight solve of the same cell
+    Real maximumDifference = 0.0;
+    int numberOfUnmatchedCells = 0;
+    compareCellDeltaV( tightSink.results, stagedSink.results, maximumDifference, numberOfUnmatchedCells );
+
+    std::cout << "Single tight solve: cells = " << tight.numberOfCells << ", converged = " << tight.numberOfConvergedCells
+              << ", iterations = " << tight.numberOfIterations << ", time [s] = " << tight.seconds << std::endl;
+    std::cout << "Staged: cells = " << staged.numberOfCells << ", refined = " << staged.numberOfRefinedCells
+              << ", screened only = " << staged.numberOfScreenedOnlyCells
+              << ", converged = " << staged.numberOfConvergedCells << ", iterations = " << staged.numberOfIterations
+              << ", time [s] = " << staged.seconds << std::endl;
+    std::cout << "Iteration savings = " << tight.numberOfIterations - staged.numberOfIterations << " ("
+              << 100.0 * ( tight.numberOfIterations - staged.numberOfIterations ) / std::max( tight.numberOfIterations, 1L )
+              << " %), refined cells without a tight solution = " << numberOfUnmatchedCells
+              << ", max |refined - tight| Atom Delta-V [km/s] = " << maximumDifference << std::endl;
+}
+
+//! Compare a grid solved cell by cell with the same grid solved in lock-step batches, on one thread.
+void runBatchedGrid( gridSearch::GridSearchEngine& engine, gridSearch::GridSearchSpec spec, const int batchSize )
 {
-    string.erase( std::remove( string.begin( ), string.end( ), '\r' ), string.end( ) );
-    string.erase( std::remove( string.begin( ), string.end( ), '\n' ), string.end( ) );
+    spec.numberOfThreads = 1;
+    spec.batchSize = 0;
+    gridSearch::CollectingResultSink singleSink;
+    const gridSearch::GridSearchSummary single = engine.run( spec, singleSink );
+
+    spec.batchSize = batchSize;
+    gridSearch::CollectingResultSink batchedSink;
+    const gridSearch::GridSearchSummary batched = engine.run( spec, batchedSink );
+
+    Real maximumDifference = 0.0;
+    int numberOfUnmatchedCells = 0;
+    compareCellDeltaV( singleSink.results, batchedSink.results, maximumDifference, numberOfUnmatchedCells );
+
+    std::cout << "One at a time: cells = " << single.numberOfCells << ", converged = " << single.numberOfConvergedCells
+              << ", iterations = " << single.numberOfIterations << ", solves/s = "
+              << single.numberOfCells / std::max( single.seconds, 1.0e-9 ) << std::endl;
+    std::cout << "Batches of " << batchSize << ": cells = " << batched.numberOfCells << ", converged = "
+              << batched.numberOfConvergedCells << ", iterations = " << batched.numberOfIterations << ", solves/s = "
+              << batched.numberOfCells / std::max( batched.seconds, 1.0e-9 ) << std::endl;
+    std::cout << "Speed-up = " << single.seconds / std::max( batched.seconds, 1.0e-9 )
+              << ", batched cells converged only in batches = " << numberOfUnmatchedCells
+              << ", max |batched - single| Atom Delta-V [km/s] = " << maximumDifference << std::endl;
 }
 
-//! Convert SGP4 ECI object to state vector.
-Vector6 getStateVector( const Eci state )
+//! Calibrate the grid threads on this machine and store them as its machine profile.
+void runAutoTune( gridSearch::GridSearchEngine& engine, const gridSearch::GridSearchSpec& spec, const int numberOfRepeats )
 {
-    Vector6 result( 6 );
-    result[ 0 ] = state.Position( ).x;
-    result[ 1 ] = state.Position( ).y;
-    result[ 2 ] = state.Position( ).z;
-    result[ 3 ] = state.Velocity( ).x;
-    result[ 4 ] = state.Velocity( ).y;
-    result[ 5 ] = state.Velocity( ).z;
-    return result;
+    autoTuner::TuningSettings settings = autoTuner::getDefaultTuningSettings( );
+    settings.numberOfRepeats = numberOfRepeats;
+    const autoTuner::MachineProfile profile = autoTuner::tuneMachineProfile( engine, spec, settings, std::cout );
+    const std::string path = autoTuner::getMachineProfilePath( );
+    autoTuner::writeMachineProfile( path, profile );
+    std::cout << "Profile of " << profile.hostName << " (" << profile.hardwareThreads << " hardware threads): threads = "
+              << profile.numberOfThreads << ", cells/s = " << profile.cellsPerSecond << " (" << path << ")" << std::endl;
 }
 
-int main(void)
+//! Run a grid search in order of promise under a budget and report the best transfer per pair found.
+void runAnytimeSearch( gridSearch::GridSearchEngine& engine, const gridSearch::GridSearchSpec& spec,
+                       const gridSearch::AnytimeSettings& settings, const std::string& outputPath )
 {
-    // conversion from km to m
-    const double km2m = 1000; 
-    
-    // earth radius and diameter
+    std::ofstream outputfile( outputPath.c_str( ), std::ofstream::app );
+    gridSearch::CsvResultSink csvSink( outputfile, true );
+    gridSearch::BestTransferSink sink( &csvSink );
+    const gridSearch::AnytimeSummary summary = engine.runAnytime( spec, settings, sink );
+    outputfile.close( );
+    std::cout << "Ranked cells = " << summary.numberOfRankedCells << ", ranking time [s] = " << summary.rankingSeconds
+              << ", cells started = " << summary.numberOfStartedCells << std::endl;
+    std::cout << "Evaluations = " << summary.gridSummary.numberOfCells
+              << ", converged = " << summary.gridSummary.numberOfConvergedCells
+              << ", pairs at or below the target = " << summary.numberOfTargetPairs
+              << ", time [s] = " << summary.gridSummary.seconds
+              << ", stopped: " << gridSearch::getStopReasonName( summary.stopReason ) << std::endl;
+
+    const std::vector< atomTransfer::TransferResult > bestTransfers = sink.getBestTransfers( );
+    std::cout << "Departure ID,Arrival ID,Departure Epoch,time-of-flight [s],Atom Delta-V [km/s],Lambert Delta-V [km/s]" << std::endl;
+    for( unsigned int k = 0; k < bestTransfers.size( ); k++ )
+    {
+        std::cout << bestTransfers[ k ].departureObjectId << "," << bestTransfers[ k ].arrivalObjectId << ","
+                  << bestTransfers[ k ].departureEpoch << "," << bestTransfers[ k ].timeOfFlight << ","
+                  << bestTransfers[ k ].atomDeltaV << "," << bestTransfers[ k ].lambertDeltaV << std::endl;
+    }
+}
+
+//! Reduced grid of the tier and precision checks: 12 departure epochs two hours apart from 2016-02-01 and
+//! 100 times of flight every 10 minutes, up to ~16.5 hours.
+void createReducedGrid( std::vector< DateTime >& departureEpochs, std::vector< Real >& timesOfFlight )
+{
+    departureEpochs.clear( );
+    for( int l = 0; l < 12; l++ )
+    {
+        departureEpochs.push_back( DateTime( 2016, 2, 1 ).AddSeconds( l * 7200.0 ) );
+    }
+    timesOfFlight.clear( );
+    for( int p = 0; p < 100; p++ )
+    {
+        timesOfFlight.push_back( 10 + p * 600 );
+    }
+}
+
+//! Print the agreement between the J2 and SGP4 tiers on the bundled catalogs.
+void runTierAgreement( )
+{
+    const char* catalogs[ ] = { "../../src/catalog_rocketbodies_5withlowDV.txt",
+                                "../../src/ADRcatalog.txt",
+                                "../../src/catalog_rocketbodiesLEO_SAFE1000km.txt" };
+    const unsigned int maximumObjects = 20; // keeps the all-pairs SGP4 reference affordable on the large catalog
+
+    std::vector< DateTime > departureEpochs;
+    std::vector< Real > timesOfFlight;
+    createReducedGrid( departureEpochs, timesOfFlight );
+    const int shortlistSize = 60;
+    const int recallDepth = 10;
+
+    for( int c = 0; c < 3; c++ )
+    {
+        std::vector< Tle > catalog = tleCatalog::readTleCatalog( catalogs[ c ] );
+        if( catalog.size( ) > maximumObjects )
+        {
+            catalog.resize( maximumObjects );
+        }
+
+        const twoTierScreening::TierAgreement agreement
+            = twoTierScreening::measureTierAgreement( catalog, departureEpochs, timesOfFlight, shortlistSize, recallDepth );
+
+        std::cout << catalogs[ c ] << std::endl;
+        std::cout << "  pairs = " << agreement.numberOfPairs << ", cells = " << agreement.numberOfCells << std::endl;
+        std::cout << "  max position error [km] = " << agreement.maximumPositionError << std::endl;
+        std::cout << "  mean position error [km] = " << agreement.meanPositionError << std::endl;
+        std::cout << "  mean |Lambert delta-V difference| [km/s] = " << agreement.meanAbsoluteDeltaVDifference << std::endl;
+        std::cout << "  top-" << recallDepth << " recall in J2 shortlist of " << shortlistSize << " = "
+                  << agreement.topCellRecall << std::endl;
+    }
+}
+
+//! Check that single-precision screening keeps the best double-precision cells of every pair of the bundled catalogs.
+void runPrecisionCheck( const int shortlistSize, const int topCells )
+{
+    const char* catalogs[ ] = { "../../src/catalog_rocketbodies_5withlowDV.txt",
+                                "../../src/ADRcatalog.txt" };
+    const unsigned int maximumObjects = 10; // the double-precision reference solves the full grid of every pair
+
+    std::vector< DateTime > departureEpochs;
+    std::vector< Real > timesOfFlight;
+    createReducedGrid( departureEpochs, timesOfFlight );
+    mixedPrecisionScreening::ScreeningSettings settings = mixedPrecisionScreening::getDefaultScreeningSettings( );
+    settings.shortlistSize = shortlistSize;
+
+    for( int c = 0; c < 2; c++ )
+    {
+        std::vector< Tle > catalog = tleCatalog::readTleCatalog( catalogs[ c ] );
+        if( catalog.size( ) > maximumObjects )
+        {
+            catalog.resize( maximumObjects );
+        }
+
+        const mixedPrecisionScreening::PrecisionCheck check = mixedPrecisionScreening::checkScreeningPrecision(
+            catalog, departureEpochs, timesOfFlight, settings, topCells );
+
+        std::cout << catalogs[ c ] << std::endl;
+        std::cout << "  pairs = " << check.numberOfPairs << ", cells = " << check.numberOfCells
+                  << ", mean shortlist = " << check.meanShortlistSize << std::endl;
+        std::cout << "  max |delta-V difference| [km/s] = " << check.maximumDeltaVDifference
+                  << ", mean = " << check.meanDeltaVDifference << std::endl;
+        std::cout << "  top-" << topCells << " cells dropped = " << check.numberOfDroppedTopCells << " of "
+                  << check.numberOfTopCells << ", required margin [km/s] = " << check.requiredMargin
+                  << ( check.numberOfDroppedTopCells == 0 ? " (pass)" : " (FAIL)" ) << std::endl;
+        std::cout << "  Lambert sweep time [s]: single = " << check.singleSweepSeconds
+                  << ", double = " << check.doubleSweepSeconds << std::endl;
+    }
+}
+
+//! Element ranges of the random LEO population of the TLE fit studies [m, -, rad, rad, rad, rad].
+elementSampler::ElementRanges getLeoElementRanges( )
+{
+    const double km2m = 1000;
     const double EarthRadius = kXKMPER * km2m; // unit m
-    const double EarthDiam = 2 * EarthRadius;
-    
-    // grav. parameter 'mu' of earth
-    const double muEarth = kMU*( pow( 10, 9 ) ); // unit m^3/s^2
-    
-    // vectors to store arrival and departure velocities for the transfer trajectory
-    Vector3 DepartureVelocity( 3 );
-    Vector3 ArrivalVelocity( 3 );
-
-    // read the TLE file. Line based parsing, using string streams
-    std::string line;
-    
-    std::ifstream tlefile( "../../src/catalog_rocketbodies_5withlowDV.txt" );
-    
-    if( !tlefile.is_open() )
-        perror("error while opening file");
-
-    std::vector < Tle > tleObjects; // vector of TLE objects
-    
-
-    while( !tlefile.eof( ) )
-    {
-        std::vector < std::string > tleStrings;
-
-        std::getline( tlefile, line ); // read line from the catalog file
-        removeNewline( line ); // remove new line characters such as '/n'
-        tleStrings.push_back( line );
-        // std::cout << line << std::endl;
-
-        std::getline( tlefile, line );
-        removeNewline( line );
-        tleStrings.push_back( line );
-        // std::cout << line << std::endl;
-
-        std::getline( tlefile, line );
-        removeNewline( line );
-        tleStrings.push_back( line );
-        // std::cout << line << std::endl << std::endl;
-
-        tleObjects.push_back( Tle( tleStrings[ 0 ], tleStrings[ 1 ], tleStrings[ 2 ] ) );
-    }
-    tlefile.close( );
-    
+
+    elementSampler::ElementRanges ranges;
+    ranges.semiMajorAxis = { EarthRadius + 200 * km2m, EarthRadius + 2000 * km2m };
+    ranges.eccentricity = { 0.0, 0.1 };
+    ranges.inclination = { 0.0, sml::convertDegreesToRadians( 180.0 ) };
+    ranges.rightAscendingNode = { 0.0, sml::convertDegreesToRadians( 360.0 ) };
+    ranges.argumentPerigee = ranges.rightAscendingNode;
+    ranges.eccentricAnomaly = ranges.rightAscendingNode;
+    return ranges;
+}
+
+//! Compare the TLE fit started from an empty reference TLE and from the analytic mean elements.
+void runTleGuessStudy( const int numberOfSamples, const elementSampler::SamplingDesign design )
+{
+    // random LEO population with the perigee at least 100 km above the surface
+    elementSampler::SamplerSettings settings = elementSampler::getDefaultSettings( );
+    settings.design = design;
+    settings.minimumPerigeeRadius = ( kXKMPER + 100.0 ) * 1000.0;
+    const TleGen::Vector2D randKepElem
+        = elementSampler::sampleKeplerianElements( getLeoElementRanges( ), numberOfSamples, settings );
+
+    const TleGen::ReferenceTleComparison comparison = TleGen::compareReferenceTles( randKepElem );
+    std::cout << "Samples = " << comparison.numberOfSamples << std::endl;
+    std::cout << "Empty reference TLE:    failures = " << comparison.emptyReferenceFailures
+              << ", mean iterations = " << comparison.emptyReferenceMeanIterations
+              << ", max iterations = " << comparison.emptyReferenceMaximumIterations << std::endl;
+    std::cout << "Analytic reference TLE: failures = " << comparison.meanElementReferenceFailures
+              << ", mean iterations = " << comparison.meanElementReferenceMeanIterations
+              << ", max iterations = " << comparison.meanElementReferenceMaximumIterations << std::endl;
+}
+
+//! Compare the ATOM library TLE fit with the analytic-Jacobian fit on a random LEO population.
+void runTleFitterStudy( const int numberOfSamples, const elementSampler::SamplingDesign design )
+{
+    // random LEO population with the perigee at least 100 km above the surface
+    elementSampler::SamplerSettings settings = elementSampler::getDefaultSettings( );
+    settings.design = design;
+    settings.minimumPerigeeRadius = ( kXKMPER + 100.0 ) * 1000.0;
+    const TleGen::Vector2D randKepElem
+        = elementSampler::sampleKeplerianElements( getLeoElementRanges( ), numberOfSamples, settings );
+
+    const tleFitter::FitterComparison comparison = tleFitter::compareFitters( randKepElem );
+    std::cout << "Samples = " << comparison.numberOfSamples << std::endl;
+    std::cout << "ATOM fit:     failures = " << comparison.atomFailures
+              << ", mean iterations = " << comparison.atomMeanIterations
+              << ", time [s] = " << comparison.atomSeconds << std::endl;
+    std::cout << "Analytic fit: failures = " << comparison.analyticFailures
+              << ", mean iterations = " << comparison.analyticMeanIterations
+              << ", mean propagations = " << comparison.analyticMeanPropagations
+              << ", time [s] = " << comparison.analyticSeconds << std::endl;
+    std::cout << "Common fits = " << comparison.numberOfCommonFits
+              << ", max position difference [km] = " << comparison.maximumPositionDifference
+              << ", max velocity difference [km/s] = " << comparison.maximumVelocityDifference << std::endl;
+}
+
+//! Print the discrepancy and mean-perigee error of the uniform, Sobol and Latin hypercube designs.
+void runSamplerConvergence( const int maximumSamples, const int numberOfReplicates )
+{
+    std::vector< int > sampleSizes;
+    for( int n = 64; n <= maximumSamples; n *= 2 )
+    {
+        sampleSizes.push_back( n );
+    }
+    const std::vector< elementSampler::ConvergencePoint > convergence
+        = elementSampler::compareConvergence( getLeoElementRanges( ), sampleSizes, numberOfReplicates, 0 );
+
+    std::cout << "Design,Samples,Centered discrepancy,RMS mean perigee error [m]" << std::endl;
+    for( unsigned int k = 0; k < convergence.size( ); k++ )
+    {
+        std::cout << elementSampler::getDesignName( convergence[ k ].design ) << "," << convergence[ k ].numberOfSamples << ","
+                  << convergence[ k ].meanDiscrepancy << "," << convergence[ k ].rmsMeanPerigeeError << std::endl;
+    }
+}
+
+//! Write a synthetic catalog, load it as a grid catalog and optionally run a reduced grid search on it.
+void runSyntheticCatalog( const int numberOfSamples, const catalogGenerator::Population population,
+                          const int numberOfTimeOfFlightSteps )
+{
+    std::ostringstream path;
+    path << "../../src/catalog_synthetic_" << catalogGenerator::getPopulationName( population ) << "_"
+         << numberOfSamples << ".txt";
+
+    const catalogGenerator::CatalogSettings settings = catalogGenerator::getDefaultCatalogSettings( population );
+    const catalogGenerator::CatalogSummary summary
+        = catalogGenerator::generateCatalog( path.str( ), numberOfSamples, settings );
+    std::cout << "Samples = " << summary.numberOfSamples << ", TLEs written = " << summary.numberOfObjects
+              << ", failed fits = " << summary.numberOfFailedFits << ", mean iterations = " << summary.meanIterations
+              << ", size [MB] = " << summary.numberOfBytes / 1.0e6 << ", time [s] = " << summary.seconds << std::endl;
+
+    // the catalog is read back through the grid search path, as any bundled catalog
+    gridSearch::GridSearchEngine engine;
+    gridSearch::GridSearchSpec spec = gridSearch::getDefaultGridSearchSpec( );
+    spec.catalogPath = path.str( );
+    const std::vector< Tle >& tleObjects = engine.loadCatalog( spec.catalogPath );
+    std::cout << "Catalog " << spec.catalogPath << ": objects = " << tleObjects.size( ) << std::endl;
+
+    if( numberOfTimeOfFlightSteps > 0 && tleObjects.size( ) > 1 )
+    {
+        spec.numberOfEpochSteps = 10;
+        spec.numberOfTimeOfFlightSteps = numberOfTimeOfFlightSteps;
+        spec.numberOfThreads = 0;
+        runGridSearch( engine, spec, "../../src/Atom_Solver_Synthetic.csv" );
+    }
+}
+
+//! Map the failure rate of the Cartesian-to-TLE fit over LEO until its intervals reach a half-width.
+void runFitCampaign( const long maximumSamples, const Real targetHalfWidth, const fitCampaign::FitMethod method )
+{
+    fitCampaign::CampaignSettings settings = fitCampaign::getDefaultCampaignSettings( );
+    settings.maximumNumberOfSamples = maximumSamples;
+    settings.targetHalfWidth = targetHalfWidth;
+    settings.method = method;
+
+    fitCampaign::FailureMap map;
+    const fitCampaign::CampaignSummary summary = fitCampaign::runCampaign( settings, map );
+    fitCampaign::writeFailureMap( "../../src/Atom_Fit_Campaign.csv", map, settings.quantile );
+    std::cout << "Fit = " << fitCampaign::getMethodName( method ) << ", samples = " << summary.numberOfSamples
+              << ", rounds = " << summary.numberOfRounds << ", failures = " << summary.numberOfFailures
+              << ", occupied bins = " << summary.numberOfOccupiedBins << std::endl;
+    std::cout << ( summary.isConverged ? "Converged" : "Sample limit reached" )
+              << ": max interval half-width = " << summary.maximumHalfWidth
+              << ", time [s] = " << summary.seconds << std::endl;
+}
+
+//! Fit or load the catalog interpolants over the grid window and report their error and cost.
+void runEphemeris( const std::string& catalogPath, const std::vector< Tle >& tleObjects, const Real positionErrorBound )
+{
+    // the window covers every departure epoch of the grid plus the longest time of flight
+    const DateTime startEpoch( 2016, 2, 1 );
     const int DebrisObjects = tleObjects.size( );
-    std::cout << "Total debris objects = " << DebrisObjects << std::endl; 
-    
-    int failCount = 0;
-    int catchDepartureID;
-    int catchArrivalID;
-    DateTime departureEpoch( 2016, 2, 1 ); // year month day
-
-    std::ofstream outputfile;
-    outputfile.open( "../../src/Atom_Solver_Grid3.csv", std::ofstream::app );
-    outputfile << "Departure ID" << "," << "Arrival ID" << "," << "Departure Epoch" << "," << "time-of-flight [s]";
-    outputfile << "," << "Atom Delta-V [km/s]" << "," << "Lambert Delta-V [km/s]" << std::endl;
-    
-    const int timeOfFlightSteps = 1000;
-     
-            for( int i = 0; i < DebrisObjects - 1; i++ )
-            {
-                Tle departureObject = tleObjects[ i ]; // first tle element is assumed to be the starting point and not the debris itself
-                SGP4 sgp4Departure( departureObject );
+    const DateTime lastDeparture = gridSearch::computeDepartureEpochs( startEpoch, DebrisObjects - 2, 100 ).back( );
+    const Real windowMinutes = ( lastDeparture - startEpoch ).TotalMinutes( ) + gridSearch::computeTimesOfFlight( 1000 ).back( ) / 60.0 + 1.0;
+
+    const ephemerisInterpolator::CatalogEphemeris ephemeris
+        = ephemerisInterpolator::loadOrFitCatalogEphemeris( catalogPath, tleObjects, startEpoch, windowMinutes, positionErrorBound );
+
+    const int evaluations = 100000;
+    for( int k = 0; k < DebrisObjects; k++ )
+    {
+        const ephemerisInterpolator::ObjectEphemeris& object = ephemeris.objects[ k ];
+        const Real verifiedError = ephemerisInterpolator::verifyObjectEphemeris( object, tleObjects[ k ], startEpoch, 40 );
+
+        // cost of a state evaluation with the interpolant and with SGP4
+        ephemerisInterpolator::array3 position;
+        ephemerisInterpolator::array3 velocity;
+        Real checksum = 0.0; // keeps the timed loops from being optimised away
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now( );
+        for( int j = 0; j < evaluations; j++ )
+        {
+            object.findState( windowMinutes * j / evaluations, position, velocity );
+            checksum += position[ 0 ];
+        }
+        const Real interpolantSeconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+
+        const SGP4 sgp4( tleObjects[ k ] );
+        begin = std::chrono::steady_clock::now( );
+        for( int j = 0; j < evaluations; j++ )
+        {
+            checksum -= sgp4.FindPosition( startEpoch.AddMinutes( windowMinutes * j / evaluations ) ).Position( ).x;
+        }
+        const Real sgp4Seconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+
+        std::cout << object.noradNumber << ": segments = " << object.segments.size( )
+                  << ", fit error [km] = " << object.maximumPositionError
+                  << ( object.isErrorBoundMet ? "" : " (error bound not met)" )
+                  << ", verified error [km] = " << verifiedError
+                  << ", speed-up vs. SGP4 = " << sgp4Seconds / interpolantSeconds
+                  << ", position checksum [km] = " << checksum << std::endl;
+    }
+}
+
+//! Merge the existing result files into the indexed store and report what it holds per pair.
+void runResultsStore( const int numberOfThreads )
+{
+    const std::string directory = "../../src";
+    const char* resultFiles[ ] = { "Atom_Solver_Grid.csv", "Atom_Solver_Grid2.csv", "Atom_Solver_Grid3.csv",
+                                   "Atom_Solver_Results.csv", "Atom_Solver_Grid_Search_Results.csv" };
+    std::vector< std::string > paths;
+    for( unsigned int f = 0; f < sizeof( resultFiles ) / sizeof( resultFiles[ 0 ] ); f++ )
+    {
+        paths.push_back( directory + "/" + resultFiles[ f ] );
+    }
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now( );
+    resultsStore::IngestionSummary summary;
+    const resultsStore::ResultsStore mergedStore( resultsStore::readResultFiles( paths, summary, numberOfThreads ) );
+    const Real ingestSeconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+
+    const std::string storePath = resultsStore::getResultsStorePath( directory );
+    resultsStore::writeResultsStore( storePath, mergedStore );
+    begin = std::chrono::steady_clock::now( );
+    const resultsStore::ResultsStore store = resultsStore::readResultsStore( storePath );
+    const Real loadSeconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+
+    std::cout << "Files = " << summary.numberOfFiles << ", rows = " << summary.numberOfRows
+              << ", repeated headers = " << summary.numberOfHeaderRows
+              << ", malformed rows = " << summary.numberOfMalformedRows
+              << ", duplicates = " << mergedStore.numberOfDuplicates( )
+              << ", unique records = " << store.records( ).size( )
+              << ", pairs = " << store.pairs( ).size( ) << std::endl;
+    std::cout << "CSV ingest [s] = " << ingestSeconds << ", store load [s] = " << loadSeconds
+              << " (" << storePath << ")" << std::endl;
+
+    std::cout << "Departure ID,Arrival ID,Records,Min Atom Delta-V [km/s],Departure Epoch,time-of-flight [s],"
+              << "Atom wins,Mean gain [km/s],Max gain [km/s]" << std::endl;
+    const resultsStore::PairSummary* bestPair = NULL;
+    for( unsigned int p = 0; p < store.pairs( ).size( ); p++ )
+    {
+        const resultsStore::PairSummary& pair = store.pairs( )[ p ];
+        const resultsStore::ResultRecord& best = store.records( )[ pair.bestIndex ];
+        std::cout << pair.departureObjectId << "," << pair.arrivalObjectId << "," << pair.end - pair.begin << ","
+                  << best.atomDeltaV << "," << DateTime( best.departureEpochTicks ) << "," << best.timeOfFlight << ","
+                  << pair.numberOfAtomWins << "," << pair.meanDeltaVGain << "," << pair.maximumDeltaVGain << std::endl;
+        if( bestPair == NULL || best.atomDeltaV < store.records( )[ bestPair->bestIndex ].atomDeltaV )
+        {
+            bestPair = &pair;
+        }
+    }
+
+    if( bestPair != NULL )
+    {
+        const Real binWidth = 3600.0;
+        const resultsStore::TimeOfFlightHistogram histogram
+            = store.computeTimeOfFlightHistogram( bestPair->departureObjectId, bestPair->arrivalObjectId, binWidth );
+        std::cout << "Time-of-flight histogram of pair " << bestPair->departureObjectId << " -> "
+                  << bestPair->arrivalObjectId << " [h]:" << std::endl;
+        for( unsigned int b = 0; b < histogram.counts.size( ); b++ )
+        {
+            std::cout << ( histogram.firstBinStart + b * binWidth ) / 3600.0 << "," << histogram.counts[ b ] << std::endl;
+        }
+    }
+}
+
+//! Screen a catalog for conjunctions over a window starting at the grid start epoch.
+void runConjunctionScreening( const std::string& catalogPath, const Real missDistanceThreshold, const Real windowDays )
+{
+    const std::vector< Tle > tleObjects = tleCatalog::readTleCatalog( catalogPath );
+    conjunctionScreening::ScreeningSettings settings = conjunctionScreening::getDefaultSettings( );
+    settings.missDistanceThreshold = missDistanceThreshold;
+
+    conjunctionScreening::ScreeningStatistics statistics;
+    const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now( );
+    const std::vector< conjunctionScreening::Conjunction > conjunctions = conjunctionScreening::screenConjunctions(
+        tleObjects, DateTime( 2016, 2, 1 ), windowDays * kMINUTES_PER_DAY, settings, statistics );
+    const Real seconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+
+    std::cout << "Objects = " << statistics.numberOfObjects
+              << ", after apogee/perigee filter = " << statistics.numberOfScreenedObjects
+              << ", steps = " << statistics.numberOfSteps
+              << ", screening distance [km] = " << statistics.screeningDistance
+              << ", distance checks = " << statistics.numberOfDistanceChecks
+              << ", encounters refined = " << statistics.numberOfEncounters
+              << ", time [s] = " << seconds << std::endl;
+    std::cout << "First ID,Second ID,Time of closest approach,Miss distance [km],Relative speed [km/s]" << std::endl;
+    for( unsigned int k = 0; k < conjunctions.size( ); k++ )
+    {
+        std::cout << conjunctions[ k ].firstObjectId << "," << conjunctions[ k ].secondObjectId << ","
+                  << conjunctions[ k ].timeOfClosestApproach << "," << conjunctions[ k ].missDistance << ","
+                  << conjunctions[ k ].relativeSpeed << std::endl;
+    }
+}
 
-                for( int l = 0; l < 100; l++ )
+//! Write the catalog as a tiled ephemeris and find the best Lambert transfer per departure object from the tiles.
+void runTiledEphemeris( const std::string& catalogPath, const Real windowDays, const int objectsPerBlock, const int samplesPerBlock )
+{
+    const std::vector< Tle > tleObjects = tleCatalog::readTleCatalog( catalogPath );
+    const Real sampleStep = 60.0;
+    const int departureStride = 60;     // samples between departure epochs
+    const int timeOfFlightStride = 30;  // samples between times of flight
+    const Real maximumTimeOfFlight = 16.0 * 3600.0;
+    const int maximumTimeOfFlightSamples = maximumTimeOfFlight / sampleStep;
+    const int numberOfThreads = parallelFor::getNumberOfThreads( 0 );
+
+    const std::string path = tiledEphemeris::getTiledEphemerisPath( catalogPath );
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now( );
+    tiledEphemeris::writeTiledEphemeris( path, tleObjects, DateTime( 2016, 2, 1 ), windowDays * kMINUTES_PER_DAY,
+                                         sampleStep, objectsPerBlock, samplesPerBlock, numberOfThreads );
+    const Real writeSeconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+
+    const tiledEphemeris::TiledEphemeris ephemeris( path );
+    const tiledEphemeris::TileLayout& layout = ephemeris.getLayout( );
+    std::cout << "Samples = " << layout.numberOfSamples << ", tiles = " << layout.getNumberOfObjectBlocks( ) << " x "
+              << layout.getNumberOfTimeBlocks( ) << ", column [MB] = " << ephemeris.getTimeBlockBytes( ) / 1.0e6
+              << ", write time [s] = " << writeSeconds << " (" << path << ")" << std::endl;
+
+    // best transfer per departure object and thread, merged after the traversal
+    struct BestTransfer
+    {
+        Real deltaV;
+        int arrivalIndex;
+        int departureSample;
+        int timeOfFlightSamples;
+    };
+    const BestTransfer noTransfer = { std::numeric_limits< Real >::infinity( ), -1, 0, 0 };
+    std::vector< std::vector< BestTransfer > > bestTransfers(
+        numberOfThreads, std::vector< BestTransfer >( layout.numberOfObjects, noTransfer ) );
+    std::vector< long > numberOfTransfers( numberOfThreads, 0 );
+
+    const tiledEphemeris::TileVisitor visitor = [ & ]( const int departureBlock, const int arrivalBlock,
+                                                       const int timeBlock, const int thread )
+    {
+        const int lastDeparture = std::min( ( departureBlock + 1 ) * layout.objectsPerBlock, layout.numberOfObjects );
+        const int lastArrival = std::min( ( arrivalBlock + 1 ) * layout.objectsPerBlock, layout.numberOfObjects );
+        const int lastSample = std::min( ( timeBlock + 1 ) * layout.samplesPerBlock, layout.numberOfSamples );
+        lambertDeltaV::array3 departurePosition;
+        lambertDeltaV::array3 departureVelocity;
+        lambertDeltaV::array3 arrivalPosition;
+        lambertDeltaV::array3 arrivalVelocity;
+        lambertDeltaV::array3 transferVelocity;
+        for( int i = departureBlock * layout.objectsPerBlock; i < lastDeparture; i++ )
+        {
+            for( int j = arrivalBlock * layout.objectsPerBlock; j < lastArrival; j++ )
+            {
+                if( i == j )
                 {
-                    departureEpoch = departureEpoch.AddSeconds( l * 100 );
-                
-                    const Eci tleDepartureState = sgp4Departure.FindPosition( departureEpoch );
-                    const Vector6 departureState = getStateVector( tleDepartureState );
-
-                    array3 departurePosition;
-                    array3 departureVelocity;
-                    for( int j = 0; j < 3; j++ )
+                    continue;
+                }
+                // departure epochs on the global stride that fall in this time block
+                const int firstSample = ( timeBlock * layout.samplesPerBlock + departureStride - 1 )
+                                        / departureStride * departureStride;
+                for( int s = firstSample; s < lastSample; s += departureStride )
+                {
+                    ephemeris.findState( i, s, departurePosition.c_array( ), departureVelocity.c_array( ) );
+                    if( departurePosition[ 0 ] != departurePosition[ 0 ] )
                     {
-                        departurePosition[ j ] = departureState[ j ];
-                        departureVelocity[ j ] = departureState[ j + 3 ];
+                        continue;
                     }
-                    const int departureObjectId = static_cast< int >( departureObject.NoradNumber( ) );
-                    // std::cout << "departure Object ID = " << departureObjectId << std::endl;
-                    catchDepartureID = departureObjectId; // for the catch segment of the program
-                    
-                    // Loop over arrival objects.
-                    for ( int m = 0; m < DebrisObjects - 1; m++ )
+                    for( int m = timeOfFlightStride; m <= maximumTimeOfFlightSamples
+                                                     && s + m < layout.numberOfSamples; m += timeOfFlightStride )
                     {
-                        // Skip the case of the departure and arrival objects being the same.
-                        if ( i == m )
+                        ephemeris.findState( j, s + m, arrivalPosition.c_array( ), arrivalVelocity.c_array( ) );
+                        if( arrivalPosition[ 0 ] != arrivalPosition[ 0 ] )
                         {
                             continue;
                         }
-
-                        Tle arrivalObject = tleObjects[ m ];
-                        SGP4 sgp4Arrival( arrivalObject );
-
-                        const int arrivalObjectId = static_cast< int >( arrivalObject.NoradNumber( ) );
-                        // std::cout << "Arrival Object ID = " << arrivalObjectId << std::endl;
-                        catchArrivalID = arrivalObjectId;
-
-                        // Loop over time-of-flight grid.
-                        for ( int p = 0; p < timeOfFlightSteps; p++ )
+                        const Real deltaV = lambertDeltaV::computeLambertDeltaV(
+                            departurePosition, departureVelocity, arrivalPosition, arrivalVelocity,
+                            m * layout.sampleStep, kMU, transferVelocity );
+                        numberOfTransfers[ thread ]++;
+                        BestTransfer& best = bestTransfers[ thread ][ i ];
+                        if( deltaV < best.deltaV )
                         {
-                            const double TOF = 10 + p * 60;
-
-                            const DateTime arrivalEpoch = departureEpoch.AddSeconds( TOF );
-                            const Eci tleArrivalState = sgp4Arrival.FindPosition( arrivalEpoch );
-                            const Vector6 arrivalState = getStateVector( tleArrivalState );
-
-                            array3 arrivalPosition;
-                            array3 arrivalVelocity;
-                            for( int j = 0; j < 3; j++ )
-                            {
-                                arrivalPosition[ j ] = arrivalState[ j ];
-                                arrivalVelocity[ j ] = arrivalState[ j + 3 ];
-                            } 
-
-                            kep_toolbox::lambert_problem targeter( departurePosition, arrivalPosition, TOF, kMU, 0, 5 );
-                            const int numberOfSolutions = targeter.get_v1( ).size( );
-                            std::vector< array3 > departureDeltaVs( numberOfSolutions ); // delta-V components at the departure point
-                            std::vector< array3 > arrivalDeltaVs( numberOfSolutions );                
-                            std::vector< Real > transferDeltaVs( numberOfSolutions ); // magnitude of the total delta-V of one transfer between two points
-
-                            for ( int j = 0; j < numberOfSolutions; j++ )
-                            {
-                                array3 transferDepartureVelocity = targeter.get_v1( )[ j ]; // velocity of the s/c at the departure point in the transfer orbit
-                                array3 transferArrivalVelocity = targeter.get_v2( )[ j ];
-
-                                departureDeltaVs[ j ] = sml::add( transferDepartureVelocity, sml::multiply( departureVelocity, -1.0 ) );
-                                arrivalDeltaVs[ j ] = sml::add( transferArrivalVelocity, sml::multiply( arrivalVelocity, -1.0 ) );
-
-                                transferDeltaVs[ j ] = sml::norm< Real >( departureDeltaVs[ j ] ) + sml::norm< Real >( arrivalDeltaVs[ j ] );
-                            }
-
-                            const std::vector< Real >::iterator minDeltaVIterator = std::min_element( transferDeltaVs.begin( ), transferDeltaVs.end( ) );
-                            const int minimumDeltaVIndex = std::distance( transferDeltaVs.begin( ), minDeltaVIterator );
-
-                            
-                            array3 minIndexDepartureVelocity = targeter.get_v1( )[ minimumDeltaVIndex ]; // best guess for velocity in transfer orbit at the departure point
-                            Vector3 departureVelocityGuess( 3 );
-                            Vector3 atomDeparturePosition( 3 );
-                            Vector3 atomArrivalPosition( 3 );
-                            
-                            for( int j = 0; j < 3; j++ )
-                            {
-                                departureVelocityGuess[ j ] = minIndexDepartureVelocity[ j ];
-                                atomDeparturePosition[ j ] = departurePosition[ j ];
-                                atomArrivalPosition[ j ] = arrivalPosition[ j ];
-                            }
-
-                            array3 atomDepartureVelocity;
-                            array3 atomArrivalVelocity;
-                            
-                            std::string SolverStatusSummary;
-                            int numberOfIterations;
-                            const int maxIterations = 100;
-                            const Tle referenceTle = departureObject;
-                            Vector6 atomVelocities( 6 );
-                            
-                            try
-                            {
-                                atomVelocities = atom::executeAtomSolver< Real, Vector3, Vector6 >( atomDeparturePosition, 
-                                                                                                    departureEpoch, 
-                                                                                                    atomArrivalPosition, 
-                                                                                                    TOF, 
-                                                                                                    departureVelocityGuess, 
-                                                                                                    SolverStatusSummary, 
-                                                                                                    numberOfIterations, 
-                                                                                                    referenceTle, 
-                                                                                                    kMU, 
-                                                                                                    kXKMPER, 
-                                                                                                    1.0e-10, 
-                                                                                                    1.0e-5, 
-                                                                                                    maxIterations );
-                            
-                                // std::cout << "!!!!!!!!!!!!!!!!SUCCESS!!!!!!!!!!!!" << std::endl;
-                                // std::cout << "Departure ID = " << departureObjectId << std::endl;
-                                // std::cout << "Arrival ID = " << arrivalObjectId << std::endl;
-                                
-                                outputfile << departureObjectId << "," << arrivalObjectId << ",";
-                                outputfile << departureEpoch << "," << TOF << ",";
-
-                                for( int k = 0; k < 3; k++)
-                                {
-                                    atomDepartureVelocity[ k ] = atomVelocities[ k ];
-                                    atomArrivalVelocity[ k ] = atomVelocities[ k + 3 ];
-                                }
-                                
-                                array3 atomDepartureDeltaV;
-                                array3 atomArrivalDeltaV;
-                                Real AtomDeltaV;
-
-                                atomDepartureDeltaV = sml::add( atomDepartureVelocity, sml::multiply( departureVelocity, -1.0 ) );
-                                atomArrivalDeltaV = sml::add( atomArrivalVelocity, sml::multiply( arrivalVelocity, -1.0 ) );
-
-                                AtomDeltaV = sml::norm< Real >( atomDepartureDeltaV ) + sml::norm< Real >( atomArrivalDeltaV );
-
-                                // std::cout << "Atom Total Delta V = " << AtomDeltaV << std::endl;
-                                // std::cout << "Lambert Delta V = " << transferDeltaVs[ minimumDeltaVIndex ] << std::endl;
-                                // std::cout << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!" << std::endl << std::endl;
-
-                                outputfile << AtomDeltaV << "," << transferDeltaVs[ minimumDeltaVIndex ] << std::endl;
-                            }
-                            catch( const std::exception& err )   
-                            {
-                                ++failCount;
-                                // std::cout << "Exception Caught = " << err.what( ) << std::endl;
-                                // std::cout << "For departure ID = " << catchDepartureID << " " << "For Arrival ID = " << catchArrivalID << std::endl << std::endl;
-                                // std::cout << "Fail count = " << failCount << std::endl;
-                            }
-                        }  
+                            const BestTransfer transfer = { deltaV, j, s, m };
+                            best = transfer;
+                        }
                     }
                 }
             }
-            outputfile.close( );
+        }
+    };
+
+    const tiledEphemeris::TraversalStatistics statistics
+        = tiledEphemeris::traverseTiles( ephemeris, maximumTimeOfFlight, visitor, numberOfThreads );
+    long totalTransfers = 0;
+    for( int thread = 0; thread < numberOfThreads; thread++ )
+    {
+        totalTransfers += numberOfTransfers[ thread ];
+    }
+    std::cout << "Tile visits = " << statistics.numberOfTileVisits << ", lookahead [time blocks] = "
+              << statistics.lookaheadTimeBlocks << ", working set [MB] = " << statistics.workingSetBytes / 1.0e6
+              << ", Lambert transfers = " << totalTransfers << ", time [s] = " << statistics.seconds
+              << ", major page faults = " << statistics.majorPageFaults
+              << ", minor page faults = " << statistics.minorPageFaults << std::endl;
+
+    std::cout << "Departure ID,Arrival ID,Departure Epoch,time-of-flight [s],Lambert Delta-V [km/s]" << std::endl;
+    for( int i = 0; i < layout.numberOfObjects; i++ )
+    {
+        BestTransfer best = noTransfer;
+        for( int thread = 0; thread < numberOfThreads; thread++ )
+        {
+            if( bestTransfers[ thread ][ i ].deltaV < best.deltaV )
+            {
+                best = bestTransfers[ thread ][ i ];
+            }
+        }
+        if( best.arrivalIndex >= 0 )
+        {
+            std::cout << ephemeris.getNoradNumbers( )[ i ] << "," << ephemeris.getNoradNumbers( )[ best.arrivalIndex ] << ","
+                      << layout.windowStart.AddSeconds( best.departureSample * layout.sampleStep ) << ","
+                      << best.timeOfFlightSamples * layout.sampleStep << "," << best.deltaV << std::endl;
+        }
+    }
+}
+
+//! Sweep all pairs of the catalog with Lambert in object order and in blocked order and compare work, cache events and results.
+void runBlockedSweep( const std::string& catalogPath, const pairTraversal::SweepSettings& settings )
+{
+    const std::vector< Tle > tleObjects = tleCatalog::readTleCatalog( catalogPath );
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now( );
+    const pairTraversal::StateTable table = pairTraversal::sampleStateTable(
+        tleObjects, DateTime( 2016, 2, 1 ), 60.0, pairTraversal::getNumberOfSamples( settings ), settings.numberOfThreads );
+    std::cout << "Objects = " << table.numberOfObjects << ", samples = " << table.numberOfSamples << ", table [MB] = "
+              << table.values.size( ) * sizeof( Real ) / 1.0e6 << ", SGP4 time [s] = "
+              << std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( ) << std::endl;
+
+    const pairTraversal::TraversalOrder orders[ ] = { pairTraversal::objectOrder, pairTraversal::blockedOrder };
+    std::vector< pairTraversal::SweepResult > results;
+    for( int k = 0; k < 2; k++ )
+    {
+        results.push_back( pairTraversal::sweepTransfers( table, settings, orders[ k ] ) );
+        const pairTraversal::SweepResult& result = results.back( );
+        std::cout << pairTraversal::getOrderName( orders[ k ] ) << " order: time [s] = " << result.seconds
+                  << ", transfers = " << result.numberOfTransfers << ", state loads = " << result.numberOfStateLoads
+                  << ", endpoints = " << result.numberOfEndpoints << std::endl;
+        if( result.counters.isAvailable )
+        {
+            std::cout << "  L1D read misses = " << result.counters.level1DataMisses << ", LLC references = "
+                      << result.counters.lastLevelReferences << ", LLC misses = " << result.counters.lastLevelMisses
+                      << std::endl;
+        }
+        else
+        {
+            std::cout << "  cache counters n/a (perf_event_open not permitted)" << std::endl;
+        }
+    }
+
+    int numberOfMismatches = 0;
+    for( int i = 0; i < table.numberOfObjects; i++ )
+    {
+        const pairTraversal::BestTransfer& first = results[ 0 ].bestTransfers[ i ];
+        const pairTraversal::BestTransfer& second = results[ 1 ].bestTransfers[ i ];
+        if( first.deltaV != second.deltaV || first.arrivalIndex != second.arrivalIndex
+            || first.departureSample != second.departureSample || first.timeOfFlightSamples != second.timeOfFlightSamples )
+        {
+            numberOfMismatches++;
+        }
+    }
+    std::cout << "Speed-up = " << results[ 0 ].seconds / results[ 1 ].seconds << ", best transfers that differ = "
+              << numberOfMismatches << " of " << table.numberOfObjects << std::endl;
+}
+
+//! Find the objects of a catalog reachable from one object within a delta-V budget, optionally checked against a sweep without bounds.
+void runReachability( const std::string& catalogPath, const unsigned int noradNumber, reachabilityMap::ReachabilityQuery query,
+                      const bool checkBounds )
+{
+    const std::vector< Tle > tleObjects = tleCatalog::readTleCatalog( catalogPath );
+    bool isFound = false;
+    for( unsigned int k = 0; k < tleObjects.size( ) && !isFound; k++ )
+    {
+        if( noradNumber == 0 || tleObjects[ k ].NoradNumber( ) == noradNumber )
+        {
+            query.departureIndex = k;
+            isFound = true;
+        }
+    }
+    if( !isFound )
+    {
+        throw std::runtime_error( "Departure object not in catalog: " + catalogPath );
+    }
+
+    const reachabilityMap::ReachabilityMap map = reachabilityMap::computeReachabilityMap( tleObjects, query );
+    const std::string outputPath = "../../src/Atom_Reachability_Map.csv";
+    reachabilityMap::writeReachabilityMap( outputPath, tleObjects, query, map );
+
+    int statusCounts[ 4 ] = { 0, 0, 0, 0 };
+    for( unsigned int k = 0; k < map.targets.size( ); k++ )
+    {
+        statusCounts[ map.targets[ k ].status ]++;
+    }
+    std::cout << "Departure object " << tleObjects[ map.departureIndex ].NoradNumber( ) << ", budget [km/s] = "
+              << query.deltaVBudget << ", window [days] = " << query.windowLength / 86400.0 << std::endl;
+    std::cout << "  targets = " << map.targets.size( ) << ", reachable = " << map.numberOfReachable;
+    for( int k = 0; k < 4; k++ )
+    {
+        std::cout << ", " << reachabilityMap::getStatusName( static_cast< reachabilityMap::TargetStatus >( k ) )
+                  << " = " << statusCounts[ k ];
+    }
+    std::cout << std::endl;
+    std::cout << "  Lambert solves = " << map.numberOfTransfers << " of " << map.numberOfGridCells << " grid cells"
+              << ", bound time [s] = " << map.boundSeconds << ", sweep time [s] = " << map.sweepSeconds
+              << " (" << outputPath << ")" << std::endl;
+
+    if( checkBounds )
+    {
+        // every target swept over the whole grid: the reachable sets must agree
+        reachabilityMap::ReachabilityQuery fullQuery = query;
+        fullQuery.useBounds = false;
+        fullQuery.stopAtFirstReachableEpoch = false;
+        const reachabilityMap::ReachabilityMap fullMap = reachabilityMap::computeReachabilityMap( tleObjects, fullQuery );
+        int numberOfMissed = 0;
+        Real lowestPrunedDeltaV = std::numeric_limits< Real >::infinity( );
+        for( unsigned int k = 0; k < map.targets.size( ); k++ )
+        {
+            const reachabilityMap::TargetResult& target = map.targets[ k ];
+            numberOfMissed += fullMap.targets[ k ].status == reachabilityMap::reachable
+                              && target.status != reachabilityMap::reachable ? 1 : 0;
+            if( target.status == reachabilityMap::energyPruned || target.status == reachabilityMap::planePruned )
+            {
+                lowestPrunedDeltaV = std::min( lowestPrunedDeltaV, fullMap.targets[ k ].deltaV );
+            }
+        }
+        std::cout << "  full sweep: reachable = " << fullMap.numberOfReachable << ", Lambert solves = "
+                  << fullMap.numberOfTransfers << ", sweep time [s] = " << fullMap.sweepSeconds << ", speed-up = "
+                  << ( fullMap.boundSeconds + fullMap.sweepSeconds ) / ( map.boundSeconds + map.sweepSeconds ) << std::endl;
+        std::cout << "  reachable targets missed = " << numberOfMissed << ", lowest delta-V of a pruned target [km/s] = "
+                  << lowestPrunedDeltaV << ( numberOfMissed == 0 ? " (pass)" : " (FAIL)" ) << std::endl;
+    }
+}
+
+int main( const int numberOfInputs, const char* inputArguments[ ] )
+{
+    const std::string mode = numberOfInputs > 1 ? inputArguments[ 1 ] : "grid";
+
+    // parameters tuned for this machine by an earlier auto-tune run, defaults otherwise
+    autoTuner::MachineProfile profile = autoTuner::getDefaultMachineProfile( );
+    const bool hasProfile = mode != "auto-tune"
+                            && autoTuner::loadMachineProfile( autoTuner::getMachineProfilePath( ), profile );
+
+    if( mode == "tier-agreement" )
+    {
+        runTierAgreement( );
+        return EXIT_SUCCESS;
+    }
+    if( mode == "precision-check" )
+    {
+        runPrecisionCheck( numberOfInputs > 2 ? std::atoi( inputArguments[ 2 ] ) : 60,
+                           numberOfInputs > 3 ? std::atoi( inputArguments[ 3 ] ) : 10 );
+        return EXIT_SUCCESS;
+    }
+    if( mode == "tle-guess-study" )
+    {
+        runTleGuessStudy( numberOfInputs > 2 ? std::atoi( inputArguments[ 2 ] ) : 10000,
+                          elementSampler::findDesign( numberOfInputs > 3 ? inputArguments[ 3 ] : "sobol" ) );
+        return EXIT_SUCCESS;
+    }
+    if( mode == "tle-fitter-study" )
+    {
+        runTleFitterStudy( numberOfInputs > 2 ? std::atoi( inputArguments[ 2 ] ) : 10000,
+                           elementSampler::findDesign( numberOfInputs > 3 ? inputArguments[ 3 ] : "sobol" ) );
+        return EXIT_SUCCESS;
+    }
+    if( mode == "sampler-convergence" )
+    {
+        runSamplerConvergence( numberOfInputs > 2 ? std::atoi( inputArguments[ 2 ] ) : 4096,
+                               numberOfInputs > 3 ? std::atoi( inputArguments[ 3 ] ) : 8 );
+        return EXIT_SUCCESS;
+    }
+    if( mode == "synthetic-catalog" )
+    {
+        runSyntheticCatalog( numberOfInputs > 2 ? std::atoi( inputArguments[ 2 ] ) : 10000,
+                             catalogGenerator::findPopulation( numberOfInputs > 3 ? inputArguments[ 3 ] : "leo" ),
+                             numberOfInputs > 4 ? std::atoi( inputArguments[ 4 ] ) : 0 );
+        return EXIT_SUCCESS;
+    }
+    if( mode == "fit-campaign" )
+    {
+        runFitCampaign( numberOfInputs > 2 ? std::atol( inputArguments[ 2 ] ) : 10000000,
+                        numberOfInputs > 3 ? std::atof( inputArguments[ 3 ] ) : 0.01,
+                        fitCampaign::findMethod( numberOfInputs > 4 ? inputArguments[ 4 ] : "atom" ) );
+        return EXIT_SUCCESS;
+    }
+    if( mode == "results-store" )
+    {
+        runResultsStore( numberOfInputs > 2 ? std::atoi( inputArguments[ 2 ] ) : 0 );
+        return EXIT_SUCCESS;
+    }
+    if( mode == "conjunctions" )
+    {
+        runConjunctionScreening( "../../src/catalog_rocketbodiesLEO_SAFE1000km.txt",
+                                 numberOfInputs > 2 ? std::atof( inputArguments[ 2 ] ) : 5.0,
+                                 numberOfInputs > 3 ? std::atof( inputArguments[ 3 ] ) : 1.0 );
+        return EXIT_SUCCESS;
+    }
+    if( mode == "tiled-ephemeris" )
+    {
+        runTiledEphemeris( "../../src/catalog_rocketbodiesLEO_SAFE1000km.txt",
+                           numberOfInputs > 2 ? std::atof( inputArguments[ 2 ] ) : 1.0,
+                           numberOfInputs > 3 ? std::atoi( inputArguments[ 3 ] ) : 32,
+                           numberOfInputs > 4 ? std::atoi( inputArguments[ 4 ] ) : 240 );
+        return EXIT_SUCCESS;
+    }
+
+    if( mode == "blocked-sweep" )
+    {
+        pairTraversal::SweepSettings settings = pairTraversal::getDefaultSweepSettings( );
+        settings.numberOfDepartureEpochs = numberOfInputs > 2 ? std::atoi( inputArguments[ 2 ] ) : settings.numberOfDepartureEpochs;
+        settings.numberOfTimesOfFlight = numberOfInputs > 3 ? std::atoi( inputArguments[ 3 ] ) : settings.numberOfTimesOfFlight;
+        if( numberOfInputs > 4 )
+        {
+            settings.departureObjectsPerTile = std::atoi( inputArguments[ 4 ] );
+            settings.arrivalObjectsPerTile = settings.departureObjectsPerTile;
+        }
+        settings.epochsPerTile = numberOfInputs > 5 ? std::atoi( inputArguments[ 5 ] ) : settings.epochsPerTile;
+        runBlockedSweep( "../../src/catalog_rocketbodiesLEO_SAFE1000km.txt", settings );
+        return EXIT_SUCCESS;
+    }
+
+    if( mode == "reachability" )
+    {
+        reachabilityMap::ReachabilityQuery query = reachabilityMap::getDefaultReachabilityQuery( );
+        query.deltaVBudget = numberOfInputs > 3 ? std::atof( inputArguments[ 3 ] ) / 1000.0 : query.deltaVBudget;
+        query.windowLength = numberOfInputs > 4 ? std::atof( inputArguments[ 4 ] ) * 86400.0 : query.windowLength;
+        runReachability( "../../src/catalog_rocketbodiesLEO_SAFE1000km.txt",
+                         numberOfInputs > 2 ? std::atoi( inputArguments[ 2 ] ) : 0, query,
+                         numberOfInputs > 5 && std::string( inputArguments[ 5 ] ) == "check" );
+        return EXIT_SUCCESS;
+    }
+
+    gridSearch::GridSearchEngine engine;
+    gridSearch::GridSearchSpec spec = gridSearch::getDefaultGridSearchSpec( );
+    const std::vector < Tle >& tleObjects = engine.loadCatalog( spec.catalogPath );
+    const int DebrisObjects = tleObjects.size( );
+    std::cout << "Total debris objects = " << DebrisObjects << std::endl; 
+    if( hasProfile )
+    {
+        autoTuner::applyMachineProfile( profile, spec );
+        std::cout << "Machine profile: threads = " << profile.numberOfThreads << std::endl;
+    }
+
+    if( mode == "ephemeris" )
+    {
+        runEphemeris( spec.catalogPath, tleObjects, numberOfInputs > 2 ? std::atof( inputArguments[ 2 ] ) : 0.01 );
+    }
+    else if( mode == "two-tier" )
+    {
+        spec.shortlistSize = numberOfInputs > 2 ? std::atoi( inputArguments[ 2 ] ) : 2000;
+        runGridSearch( engine, spec, "../../src/Atom_Solver_TwoTier.csv" );
+    }
+    else if( mode == "mixed-precision" )
+    {
+        spec.shortlistSize = numberOfInputs > 2 ? std::atoi( inputArguments[ 2 ] ) : 2000;
+        spec.useSinglePrecisionScreening = true;
+        if( numberOfInputs > 3 )
+        {
+            spec.screeningMargin = std::atof( inputArguments[ 3 ] );
+        }
+        runGridSearch( engine, spec, "../../src/Atom_Solver_MixedPrecision.csv" );
+    }
+    else if( mode == "planned-grid" || mode == "uniform-grid" )
+    {
+        const bool usePlanner = mode == "planned-grid";
+        spec.epochPattern = usePlanner ? gridSearch::plannedEpochs : gridSearch::uniformEpochs;
+        spec.numberOfEpochSteps = numberOfInputs > 2 ? std::atoi( inputArguments[ 2 ] ) : 100;
+        runGridSearch( engine, spec, usePlanner ? "../../src/Atom_Solver_Planned.csv" : "../../src/Atom_Solver_Uniform.csv" );
+    }
+    else if( mode == "staged-grid" )
+    {
+        spec.numberOfEpochSteps = 10;
+        spec.numberOfTimeOfFlightSteps = numberOfInputs > 2 ? std::atoi( inputArguments[ 2 ] ) : 100;
+        spec.refinementSize = numberOfInputs > 3 ? std::atoi( inputArguments[ 3 ] ) : 10;
+        spec.numberOfThreads = 0;
+        runStagedGrid( engine, spec );
+    }
+    else if( mode == "batched-grid" )
+    {
+        spec.numberOfEpochSteps = 10;
+        spec.numberOfTimeOfFlightSteps = numberOfInputs > 2 ? std::atoi( inputArguments[ 2 ] ) : 100;
+        runBatchedGrid( engine, spec, numberOfInputs > 3 ? std::atoi( inputArguments[ 3 ] ) : 64 );
+    }
+    else if( mode == "anytime" )
+    {
+        gridSearch::AnytimeSettings settings = gridSearch::getDefaultAnytimeSettings( );
+        settings.maximumSeconds = numberOfInputs > 2 ? std::atof( inputArguments[ 2 ] ) : 600.0;
+        settings.targetDeltaV = numberOfInputs > 3 ? std::atof( inputArguments[ 3 ] ) : 0.0;
+        settings.numberOfTargetPairs = numberOfInputs > 4 ? std::atoi( inputArguments[ 4 ] ) : 0;
+        spec.numberOfThreads = 0;
+        runAnytimeSearch( engine, spec, settings, "../../src/Atom_Solver_Anytime.csv" );
+    }
+    else if( mode == "auto-tune" )
+    {
+        runAutoTune( engine, spec, numberOfInputs > 2 ? std::atoi( inputArguments[ 2 ] ) : 2 );
+    }
+    else if( mode == "grid" )
+    {
+        runGridSearch( engine, spec, "../../src/Atom_Solver_Grid3.csv" );
+    }
+    else
+    {
+        std::cerr << "Unknown mode: " << mode << std::endl;
+        return EXIT_FAILURE;
+    }
 
-   return EXIT_SUCCESS;
-}
\ No newline at end of file
+    return EXIT_SUCCESS;
+}
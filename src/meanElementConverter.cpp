@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Globals.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/meanElementConverter.hpp"
+#include "CppProject/tleFormat.hpp"
+
+namespace meanElementConverter
+{
+
+	SgpMeanElements convertCartesianStateToMeanElements( const Vector6& cartesianState )
+	{
+		// work in the SGP4 units of earth radii and minutes, in which mu = kXKE^2
+		const Real mu = kXKE * kXKE;
+		const Real position[ 3 ] = { cartesianState[ 0 ] / kXKMPER,
+									 cartesianState[ 1 ] / kXKMPER,
+									 cartesianState[ 2 ] / kXKMPER };
+		const Real velocity[ 3 ] = { cartesianState[ 3 ] * 60.0 / kXKMPER,
+									 cartesianState[ 4 ] * 60.0 / kXKMPER,
+									 cartesianState[ 5 ] * 60.0 / kXKMPER };
+
+		// osculating radius, radial and transverse velocity, node, inclination and argument of latitude
+		const Real radius = std::sqrt( position[ 0 ] * position[ 0 ] + position[ 1 ] * position[ 1 ] + position[ 2 ] * position[ 2 ] );
+		const Real radialVelocity = ( position[ 0 ] * velocity[ 0 ] + position[ 1 ] * velocity[ 1 ] + position[ 2 ] * velocity[ 2 ] ) / radius;
+		const Real angularMomentum[ 3 ] = { position[ 1 ] * velocity[ 2 ] - position[ 2 ] * velocity[ 1 ],
+											position[ 2 ] * velocity[ 0 ] - position[ 0 ] * velocity[ 2 ],
+											position[ 0 ] * velocity[ 1 ] - position[ 1 ] * velocity[ 0 ] };
+		const Real angularMomentumNorm = std::sqrt( angularMomentum[ 0 ] * angularMomentum[ 0 ]
+													+ angularMomentum[ 1 ] * angularMomentum[ 1 ]
+													+ angularMomentum[ 2 ] * angularMomentum[ 2 ] );
+		const Real transverseVelocity = angularMomentumNorm / radius;
+
+		const Real inclination = std::acos( angularMomentum[ 2 ] / angularMomentumNorm );
+		Real rightAscendingNode = 0.0;
+		if( std::sin( inclination ) > 1.0e-12 )
+		{
+			rightAscendingNode = std::atan2( angularMomentum[ 0 ], -angularMomentum[ 1 ] );
+		}
+
+		// argument of latitude measured from the node in the orbital plane
+		const Real node[ 3 ] = { std::cos( rightAscendingNode ), std::sin( rightAscendingNode ), 0.0 };
+		const Real normal[ 3 ] = { angularMomentum[ 0 ] / angularMomentumNorm,
+								   angularMomentum[ 1 ] / angularMomentumNorm,
+								   angularMomentum[ 2 ] / angularMomentumNorm };
+		const Real inPlane[ 3 ] = { normal[ 1 ] * node[ 2 ] - normal[ 2 ] * node[ 1 ],
+									normal[ 2 ] * node[ 0 ] - normal[ 0 ] * node[ 2 ],
+									normal[ 0 ] * node[ 1 ] - normal[ 1 ] * node[ 0 ] };
+		const Real argumentLatitude = std::atan2( position[ 0 ] * inPlane[ 0 ] + position[ 1 ] * inPlane[ 1 ] + position[ 2 ] * inPlane[ 2 ],
+												  position[ 0 ] * node[ 0 ] + position[ 1 ] * node[ 1 ] + position[ 2 ] * node[ 2 ] );
+
+		// remove the SGP4 short-period corrections; they are evaluated with the current estimate of the
+		// mean elements, so a few fixed-point passes give a consistent first-order inverse
+		Real meanRadius = radius;
+		Real meanRadialVelocity = radialVelocity;
+		Real meanTransverseVelocity = transverseVelocity;
+		Real meanArgumentLatitude = argumentLatitude;
+		Real meanRightAscendingNode = rightAscendingNode;
+		Real meanInclination = inclination;
+		Real semiMajorAxis = radius;
+		Real eccentricitySquared = 0.0;
+		for( int pass = 0; pass < 4; pass++ )
+		{
+			const Real semiLatusRectum = ( meanRadius * meanTransverseVelocity ) * ( meanRadius * meanTransverseVelocity ) / mu;
+			semiMajorAxis = 1.0 / ( 2.0 / meanRadius - ( meanRadialVelocity * meanRadialVelocity
+														 + meanTransverseVelocity * meanTransverseVelocity ) / mu );
+			if( !( semiMajorAxis > 0.0 ) )
+			{
+				throw std::domain_error( "Mean element conversion requires a bound (elliptical) orbit" );
+			}
+			eccentricitySquared = std::max( 0.0, 1.0 - semiLatusRectum / semiMajorAxis );
+
+			const Real betal = std::sqrt( 1.0 - eccentricitySquared );
+			const Real meanMotion = kXKE / std::pow( semiMajorAxis, 1.5 );
+			const Real cosio = std::cos( meanInclination );
+			const Real sinio = std::sin( meanInclination );
+			const Real theta2 = cosio * cosio;
+			const Real x3thm1 = 3.0 * theta2 - 1.0;
+			const Real x1mth2 = 1.0 - theta2;
+			const Real x7thm1 = 7.0 * theta2 - 1.0;
+			const Real temp1 = kCK2 / semiLatusRectum;
+			const Real temp2 = temp1 / semiLatusRectum;
+			const Real sin2u = std::sin( 2.0 * meanArgumentLatitude );
+			const Real cos2u = std::cos( 2.0 * meanArgumentLatitude );
+
+			meanRadius = ( radius - 0.5 * temp1 * x1mth2 * cos2u ) / ( 1.0 - 1.5 * temp2 * betal * x3thm1 );
+			meanArgumentLatitude = argumentLatitude + 0.25 * temp2 * x7thm1 * sin2u;
+			meanRightAscendingNode = rightAscendingNode - 1.5 * temp2 * cosio * sin2u;
+			meanInclination = inclination - 1.5 * temp2 * cosio * sinio * cos2u;
+			meanRadialVelocity = radialVelocity + meanMotion * temp1 * x1mth2 * sin2u;
+			meanTransverseVelocity = transverseVelocity - meanMotion * temp1 * ( x1mth2 * cos2u + 1.5 * x3thm1 );
+		}
+
+		// two-body elements of the mean state
+		const Real semiLatusRectum = ( meanRadius * meanTransverseVelocity ) * ( meanRadius * meanTransverseVelocity ) / mu;
+		semiMajorAxis = 1.0 / ( 2.0 / meanRadius - ( meanRadialVelocity * meanRadialVelocity
+													 + meanTransverseVelocity * meanTransverseVelocity ) / mu );
+		const Real eCosTrueAnomaly = semiLatusRectum / meanRadius - 1.0;
+		const Real eSinTrueAnomaly = meanRadialVelocity * std::sqrt( semiLatusRectum ) / kXKE;
+		const Real eccentricity = std::sqrt( eCosTrueAnomaly * eCosTrueAnomaly + eSinTrueAnomaly * eSinTrueAnomaly );
+		if( !( semiMajorAxis > 0.0 ) || !( eccentricity < 1.0 ) )
+		{
+			throw std::domain_error( "Mean element conversion requires a bound (elliptical) orbit" );
+		}
+		const Real trueAnomaly = std::atan2( eSinTrueAnomaly, eCosTrueAnomaly );
+		const Real eccentricAnomaly = std::atan2( std::sqrt( std::max( 0.0, 1.0 - eccentricity * eccentricity ) ) * std::sin( trueAnomaly ),
+												  eccentricity + std::cos( trueAnomaly ) );
+
+		SgpMeanElements elements;
+		elements.inclination = meanInclination;
+		elements.rightAscendingNode = std::fmod( meanRightAscendingNode + kTWOPI, kTWOPI );
+		elements.eccentricity = eccentricity;
+		elements.argumentPerigee = std::fmod( meanArgumentLatitude - trueAnomaly + 2.0 * kTWOPI, kTWOPI );
+		elements.meanAnomaly = std::fmod( eccentricAnomaly - eccentricity * std::sin( eccentricAnomaly ) + kTWOPI, kTWOPI );
+
+		// SGP4 recovers the Brouwer semi-major axis from the Kozai mean motion in the TLE; invert that
+		// mapping by fixed-point iteration on the Kozai mean motion
+		const Real cosio = std::cos( meanInclination );
+		const Real x3thm1 = 3.0 * cosio * cosio - 1.0;
+		const Real betao2 = 1.0 - eccentricity * eccentricity;
+		const Real betao = std::sqrt( betao2 );
+		Real kozaiMeanMotion = kXKE / std::pow( semiMajorAxis, 1.5 );
+		for( int iteration = 0; iteration < 10; iteration++ )
+		{
+			const Real a1 = std::pow( kXKE / kozaiMeanMotion, kTWOTHIRD );
+			const Real del1 = 1.5 * kCK2 * x3thm1 / ( a1 * a1 * betao * betao2 );
+			const Real ao = a1 * ( 1.0 - del1 * ( 0.5 * kTWOTHIRD + del1 * ( 1.0 + 134.0 / 81.0 * del1 ) ) );
+			const Real delo = 1.5 * kCK2 * x3thm1 / ( ao * ao * betao * betao2 );
+			const Real recoveredSemiMajorAxis = ao / ( 1.0 - delo );
+			kozaiMeanMotion *= std::pow( recoveredSemiMajorAxis / semiMajorAxis, 1.5 );
+		}
+		elements.meanMotion = kozaiMeanMotion * kMINUTES_PER_DAY / kTWOPI;
+
+		return elements;
+	}
+
+	//! Replace the epoch and elements of a set of TLE fields and create the TLE.
+	Tle createTleWithMeanElements( tleFormat::TleElements fields, const Vector6& cartesianState, const DateTime& epoch )
+	{
+		const SgpMeanElements elements = convertCartesianStateToMeanElements( cartesianState );
+		fields.epoch = epoch;
+		fields.inclination = elements.inclination * 180.0 / kPI;
+		fields.rightAscendingNode = elements.rightAscendingNode * 180.0 / kPI;
+		fields.eccentricity = elements.eccentricity;
+		fields.argumentPerigee = elements.argumentPerigee * 180.0 / kPI;
+		fields.meanAnomaly = elements.meanAnomaly * 180.0 / kPI;
+		fields.meanMotion = elements.meanMotion;
+		return tleFormat::createTle( fields );
+	}
+
+	Tle createReferenceTle( const Vector6& cartesianState, const DateTime& epoch, const Tle& templateTle )
+	{
+		return createTleWithMeanElements( tleFormat::getTleElements( templateTle ), cartesianState, epoch );
+	}
+
+	Tle createReferenceTle( const Vector6& cartesianState, const DateTime& epoch )
+	{
+		tleFormat::TleElements fields;
+		fields.name = "";
+		fields.noradNumber = 0;
+		fields.classification = 'U';
+		fields.internationalDesignator = "";
+		fields.meanMotionDt2 = 0.0;
+		fields.meanMotionDdt6 = 0.0;
+		fields.bStar = 0.0;
+		fields.elementSetNumber = 999;
+		fields.revolutionNumber = 0;
+		return createTleWithMeanElements( fields, cartesianState, epoch );
+	}
+
+} // namespace meanElementConverter
@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <vector>
+
+#include <boost/array.hpp>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Eci.h>
+#include <libsgp4/Globals.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/lambertDeltaV.hpp"
+#include "CppProject/lambertKernel.hpp"
+#include "CppProject/mixedPrecisionScreening.hpp"
+
+namespace mixedPrecisionScreening
+{
+
+	typedef boost::array< Real, 3 > array3;
+
+	//! Number of stored state components: x, y, z [km], vx, vy, vz [km/s]
+	const int numberOfComponents = 6;
+
+	//! Revolutions of the Lambert solutions, as lambertDeltaV::computeLambertDeltaV
+	const int lambertRevolutions = 5;
+
+	bool compareCells( const twoTierScreening::ScreeningCell& first, const twoTierScreening::ScreeningCell& second )
+	{
+		return first.lambertDeltaV < second.lambertDeltaV;
+	}
+
+	//! SGP4 states of the epochs in double precision, component by component, NaN where SGP4 fails.
+	void sampleStateValues( const SGP4& propagator, const std::vector< DateTime >& epochs, std::vector< Real >& values )
+	{
+		const int numberOfStates = epochs.size( );
+		values.assign( static_cast< std::size_t >( numberOfComponents ) * numberOfStates,
+					   std::numeric_limits< Real >::quiet_NaN( ) );
+		for( int k = 0; k < numberOfStates; k++ )
+		{
+			try
+			{
+				const Eci state = propagator.FindPosition( epochs[ k ] );
+				values[ k ] = state.Position( ).x;
+				values[ numberOfStates + k ] = state.Position( ).y;
+				values[ 2 * numberOfStates + k ] = state.Position( ).z;
+				values[ 3 * numberOfStates + k ] = state.Velocity( ).x;
+				values[ 4 * numberOfStates + k ] = state.Velocity( ).y;
+				values[ 5 * numberOfStates + k ] = state.Velocity( ).z;
+			}
+			catch( const std::exception& )
+			{
+				continue;
+			}
+		}
+	}
+
+	StateBlock convertStateValues( const std::vector< Real >& values )
+	{
+		StateBlock block;
+		block.numberOfStates = values.size( ) / numberOfComponents;
+		block.values.assign( values.begin( ), values.end( ) );
+		return block;
+	}
+
+	StateBlock sampleStates( const SGP4& propagator, const std::vector< DateTime >& epochs )
+	{
+		std::vector< Real > values;
+		sampleStateValues( propagator, epochs, values );
+		return convertStateValues( values );
+	}
+
+	//! Arrival epochs of a pair grid: time of flight p of departure epoch l at l * timesOfFlight.size( ) + p.
+	std::vector< DateTime > computeArrivalEpochs( const std::vector< DateTime >& departureEpochs,
+												  const std::vector< Real >& timesOfFlight )
+	{
+		std::vector< DateTime > arrivalEpochs;
+		arrivalEpochs.reserve( departureEpochs.size( ) * timesOfFlight.size( ) );
+		for( unsigned int l = 0; l < departureEpochs.size( ); l++ )
+		{
+			for( unsigned int p = 0; p < timesOfFlight.size( ); p++ )
+			{
+				arrivalEpochs.push_back( departureEpochs[ l ].AddSeconds( timesOfFlight[ p ] ) );
+			}
+		}
+		return arrivalEpochs;
+	}
+
+	//! Copy the state of one epoch out of a component-by-component array; false if it is NaN.
+	template< typename Scalar >
+	bool loadState( const Scalar* values, const int numberOfStates, const int state, Scalar position[ 3 ], Scalar velocity[ 3 ] )
+	{
+		for( int k = 0; k < 3; k++ )
+		{
+			position[ k ] = values[ k * numberOfStates + state ];
+			velocity[ k ] = values[ ( k + 3 ) * numberOfStates + state ];
+		}
+		return position[ 0 ] == position[ 0 ] && velocity[ 0 ] == velocity[ 0 ];
+	}
+
+	//! Lambert delta-V of every cell with the kernel in the precision of the states.
+	template< typename Scalar >
+	void sweepCells( const Scalar* departureValues, const int numberOfDepartureStates,
+					 const Scalar* arrivalValues, const int numberOfArrivalStates,
+					 const std::vector< Real >& timesOfFlight, std::vector< Scalar >& deltaVs )
+	{
+		const int timeOfFlightSteps = timesOfFlight.size( );
+		const Scalar gravitationalParameter = static_cast< Scalar >( kMU );
+		deltaVs.assign( numberOfArrivalStates, std::numeric_limits< Scalar >::max( ) );
+
+		lambertKernel::Solver< Scalar > solver;
+		Scalar departurePosition[ 3 ], departureVelocity[ 3 ], arrivalPosition[ 3 ], arrivalVelocity[ 3 ];
+		for( int l = 0; l < numberOfDepartureStates; l++ )
+		{
+			if( !loadState( departureValues, numberOfDepartureStates, l, departurePosition, departureVelocity ) )
+			{
+				continue;
+			}
+			for( int p = 0; p < timeOfFlightSteps; p++ )
+			{
+				const int cell = l * timeOfFlightSteps + p;
+				if( cell >= numberOfArrivalStates
+					|| !loadState( arrivalValues, numberOfArrivalStates, cell, arrivalPosition, arrivalVelocity ) )
+				{
+					continue;
+				}
+				deltaVs[ cell ] = solver.computeMinimumDeltaV( departurePosition, departureVelocity, arrivalPosition,
+															   arrivalVelocity, static_cast< Scalar >( timesOfFlight[ p ] ),
+															   gravitationalParameter, lambertRevolutions );
+			}
+		}
+	}
+
+	void sweepDeltaV( const StateBlock& departureStates,
+					  const StateBlock& arrivalStates,
+					  const std::vector< Real >& timesOfFlight,
+					  std::vector< Single >& deltaVs )
+	{
+		if( departureStates.values.empty( ) || arrivalStates.values.empty( ) )
+		{
+			deltaVs.assign( arrivalStates.numberOfStates, std::numeric_limits< Single >::max( ) );
+			return;
+		}
+		sweepCells( &departureStates.values[ 0 ], departureStates.numberOfStates,
+					&arrivalStates.values[ 0 ], arrivalStates.numberOfStates, timesOfFlight, deltaVs );
+	}
+
+	ScreeningSettings getDefaultScreeningSettings( )
+	{
+		ScreeningSettings settings;
+		settings.shortlistSize = 2000;
+		settings.deltaVMargin = 1.0e-3;
+		return settings;
+	}
+
+	//! Shortlist of the cells with the lowest single-precision delta-V, with the cells within the margin of the cut.
+	std::vector< twoTierScreening::ScreeningCell > shortlistCells( const std::vector< Single >& deltaVs,
+																   const int timeOfFlightSteps,
+																   const ScreeningSettings& settings )
+	{
+		const int numberOfCells = deltaVs.size( );
+		std::vector< twoTierScreening::ScreeningCell > cells( numberOfCells );
+		for( int k = 0; k < numberOfCells; k++ )
+		{
+			cells[ k ].epochIndex = k / timeOfFlightSteps;
+			cells[ k ].timeOfFlightIndex = k % timeOfFlightSteps;
+			cells[ k ].lambertDeltaV = deltaVs[ k ] < std::numeric_limits< Single >::max( )
+									   ? static_cast< Real >( deltaVs[ k ] ) : std::numeric_limits< Real >::max( );
+		}
+
+		const int keep = std::min( std::max( settings.shortlistSize, 0 ), numberOfCells );
+		std::partial_sort( cells.begin( ), cells.begin( ) + keep, cells.end( ), compareCells );
+		std::vector< twoTierScreening::ScreeningCell >::iterator end = cells.begin( ) + keep;
+		if( keep > 0 && cells[ keep - 1 ].lambertDeltaV < std::numeric_limits< Real >::max( ) )
+		{
+			// cells the rounding error could have put on the wrong side of the cut
+			const Real cut = cells[ keep - 1 ].lambertDeltaV + settings.deltaVMargin;
+			end = std::partition( end, cells.end( ), [ cut ]( const twoTierScreening::ScreeningCell& cell )
+			{
+				return cell.lambertDeltaV <= cut;
+			} );
+			std::sort( cells.begin( ) + keep, end, compareCells );
+		}
+		cells.erase( end, cells.end( ) );
+		return cells;
+	}
+
+	std::vector< twoTierScreening::ScreeningCell > screenTransferGrid( const SGP4& departurePropagator,
+																	   const SGP4& arrivalPropagator,
+																	   const std::vector< DateTime >& departureEpochs,
+																	   const std::vector< Real >& timesOfFlight,
+																	   const ScreeningSettings& settings )
+	{
+		const StateBlock departureStates = sampleStates( departurePropagator, departureEpochs );
+		const StateBlock arrivalStates
+			= sampleStates( arrivalPropagator, computeArrivalEpochs( departureEpochs, timesOfFlight ) );
+		std::vector< Single > deltaVs;
+		sweepDeltaV( departureStates, arrivalStates, timesOfFlight, deltaVs );
+		return shortlistCells( deltaVs, timesOfFlight.size( ), settings );
+	}
+
+	//! Lambert delta-V of every cell with the PyKEP solver, the largest Real where it fails.
+	void sweepReferenceDeltaV( const std::vector< Real >& departureValues,
+							   const std::vector< Real >& arrivalValues,
+							   const std::vector< Real >& timesOfFlight,
+							   std::vector< Real >& deltaVs )
+	{
+		const int numberOfDepartureStates = departureValues.size( ) / numberOfComponents;
+		const int numberOfArrivalStates = arrivalValues.size( ) / numberOfComponents;
+		const int timeOfFlightSteps = timesOfFlight.size( );
+		deltaVs.assign( numberOfArrivalStates, std::numeric_limits< Real >::max( ) );
+
+		array3 departurePosition, departureVelocity, arrivalPosition, arrivalVelocity, transferDepartureVelocity;
+		for( int l = 0; l < numberOfDepartureStates; l++ )
+		{
+			if( !loadState( &departureValues[ 0 ], numberOfDepartureStates, l, departurePosition.data( ),
+							departureVelocity.data( ) ) )
+			{
+				continue;
+			}
+			for( int p = 0; p < timeOfFlightSteps; p++ )
+			{
+				const int cell = l * timeOfFlightSteps + p;
+				if( !loadState( &arrivalValues[ 0 ], numberOfArrivalStates, cell, arrivalPosition.data( ),
+								arrivalVelocity.data( ) ) )
+				{
+					continue;
+				}
+				try
+				{
+					deltaVs[ cell ] = lambertDeltaV::computeLambertDeltaV( departurePosition, departureVelocity,
+																		   arrivalPosition, arrivalVelocity,
+																		   timesOfFlight[ p ], kMU, transferDepartureVelocity );
+				}
+				catch( const std::exception& )
+				{
+					continue;
+				}
+			}
+		}
+	}
+
+	PrecisionCheck checkScreeningPrecision( const std::vector< Tle >& catalog,
+											const std::vector< DateTime >& departureEpochs,
+											const std::vector< Real >& timesOfFlight,
+											const ScreeningSettings& settings,
+											const int topCells )
+	{
+		const int numberOfObjects = catalog.size( );
+		const int timeOfFlightSteps = timesOfFlight.size( );
+		const std::vector< DateTime > arrivalEpochs = computeArrivalEpochs( departureEpochs, timesOfFlight );
+
+		PrecisionCheck check;
+		check.numberOfPairs = 0;
+		check.numberOfCells = 0;
+		check.maximumDeltaVDifference = 0.0;
+		check.meanDeltaVDifference = 0.0;
+		check.meanShortlistSize = 0.0;
+		check.numberOfTopCells = 0;
+		check.numberOfDroppedTopCells = 0;
+		check.requiredMargin = 0.0;
+		check.singleSweepSeconds = 0.0;
+		check.doubleSweepSeconds = 0.0;
+		long numberOfDifferences = 0;
+		if( departureEpochs.empty( ) || timesOfFlight.empty( ) )
+		{
+			return check;
+		}
+
+		std::vector< Real > departureValues, arrivalValues;
+		std::vector< Real > referenceDeltaVs, kernelDeltaVs;
+		std::vector< Single > deltaVs;
+		for( int i = 0; i < numberOfObjects; i++ )
+		{
+			const SGP4 departurePropagator( catalog[ i ] );
+			sampleStateValues( departurePropagator, departureEpochs, departureValues );
+			const StateBlock departureStates = convertStateValues( departureValues );
+
+			for( int m = 0; m < numberOfObjects; m++ )
+			{
+				if( i == m )
+				{
+					continue;
+				}
+				sampleStateValues( SGP4( catalog[ m ] ), arrivalEpochs, arrivalValues );
+				const StateBlock arrivalStates = convertStateValues( arrivalValues );
+
+				std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now( );
+				sweepDeltaV( departureStates, arrivalStates, timesOfFlight, deltaVs );
+				check.singleSweepSeconds += std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+
+				begin = std::chrono::steady_clock::now( );
+				sweepCells( &departureValues[ 0 ], departureStates.numberOfStates, &arrivalValues[ 0 ],
+							arrivalStates.numberOfStates, timesOfFlight, kernelDeltaVs );
+				check.doubleSweepSeconds += std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+
+				sweepReferenceDeltaV( departureValues, arrivalValues, timesOfFlight, referenceDeltaVs );
+				const int numberOfCells = referenceDeltaVs.size( );
+				for( int k = 0; k < numberOfCells; k++ )
+				{
+					if( referenceDeltaVs[ k ] < maximumCheckedDeltaV && deltaVs[ k ] < std::numeric_limits< Single >::max( ) )
+					{
+						const Real difference = std::fabs( deltaVs[ k ] - referenceDeltaVs[ k ] );
+						check.maximumDeltaVDifference = std::max( check.maximumDeltaVDifference, difference );
+						check.meanDeltaVDifference += difference;
+						numberOfDifferences++;
+					}
+				}
+
+				const std::vector< twoTierScreening::ScreeningCell > shortlist
+					= shortlistCells( deltaVs, timeOfFlightSteps, settings );
+				std::vector< bool > shortlisted( numberOfCells, false );
+				for( unsigned int k = 0; k < shortlist.size( ); k++ )
+				{
+					shortlisted[ shortlist[ k ].epochIndex * timeOfFlightSteps + shortlist[ k ].timeOfFlightIndex ] = true;
+				}
+				const int keep = std::min( settings.shortlistSize, numberOfCells );
+				const Real cut = keep > 0 ? shortlist[ keep - 1 ].lambertDeltaV : 0.0;
+
+				// the best cells of the double-precision path, and the margin each of them needs
+				std::vector< int > ranking;
+				for( int k = 0; k < numberOfCells; k++ )
+				{
+					if( referenceDeltaVs[ k ] < std::numeric_limits< Real >::max( ) )
+					{
+						ranking.push_back( k );
+					}
+				}
+				const int depth = std::min( topCells, static_cast< int >( ranking.size( ) ) );
+				std::partial_sort( ranking.begin( ), ranking.begin( ) + depth, ranking.end( ),
+								   [ & ]( const int first, const int second )
+				{
+					return referenceDeltaVs[ first ] < referenceDeltaVs[ second ];
+				} );
+				for( int k = 0; k < depth; k++ )
+				{
+					const int cell = ranking[ k ];
+					check.numberOfTopCells++;
+					if( !shortlisted[ cell ] )
+					{
+						check.numberOfDroppedTopCells++;
+					}
+					const Real requiredMargin = deltaVs[ cell ] < std::numeric_limits< Single >::max( )
+												? deltaVs[ cell ] - cut : std::numeric_limits< Real >::max( );
+					check.requiredMargin = std::max( check.requiredMargin, requiredMargin );
+				}
+
+				check.numberOfPairs++;
+				check.numberOfCells += numberOfCells;
+				check.meanShortlistSize += shortlist.size( );
+			}
+		}
+
+		if( numberOfDifferences > 0 )
+		{
+			check.meanDeltaVDifference /= numberOfDifferences;
+		}
+		if( check.numberOfPairs > 0 )
+		{
+			check.meanShortlistSize /= check.numberOfPairs;
+		}
+		return check;
+	}
+
+} // namespace mixedPrecisionScreening
@@ -0,0 +1,480 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Eci.h>
+#include <libsgp4/Globals.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/lambertKernel.hpp"
+#include "CppProject/pairTraversal.hpp"
+#include "CppProject/parallelFor.hpp"
+
+namespace pairTraversal
+{
+
+	typedef lambertKernel::Solver< Real > LambertSolver;
+	typedef LambertSolver::Endpoint Endpoint;
+
+	//! Number of stored state components: x, y, z [km], vx, vy, vz [km/s]
+	const int numberOfComponents = 6;
+
+	//! Revolutions of the Lambert solutions, as lambertDeltaV::computeLambertDeltaV
+	const int lambertRevolutions = 5;
+
+	const char* getOrderName( const TraversalOrder order )
+	{
+		switch( order )
+		{
+			case objectOrder: return "object";
+			case blockedOrder: return "blocked";
+		}
+		return "";
+	}
+
+	TraversalOrder findOrder( const std::string& name )
+	{
+		const TraversalOrder orders[ ] = { objectOrder, blockedOrder };
+		for( int k = 0; k < 2; k++ )
+		{
+			if( name == getOrderName( orders[ k ] ) )
+			{
+				return orders[ k ];
+			}
+		}
+		throw std::runtime_error( "Unknown traversal order: " + name );
+	}
+
+	StateTable sampleStateTable( const std::vector< Tle >& catalog,
+								 const DateTime& start,
+								 const Real sampleStep,
+								 const int numberOfSamples,
+								 const int numberOfThreads )
+	{
+		StateTable table;
+		table.start = start;
+		table.sampleStep = sampleStep;
+		table.numberOfObjects = catalog.size( );
+		table.numberOfSamples = numberOfSamples;
+		table.values.assign( static_cast< std::size_t >( table.numberOfObjects ) * numberOfSamples * numberOfComponents,
+							 std::numeric_limits< Real >::quiet_NaN( ) );
+
+		parallelFor::parallelFor( table.numberOfObjects, parallelFor::getNumberOfThreads( numberOfThreads ),
+								  [ & ]( const int beginObject, const int endObject, const int )
+		{
+			for( int o = beginObject; o < endObject; o++ )
+			{
+				const SGP4 sgp4( catalog[ o ] );
+				for( int s = 0; s < numberOfSamples; s++ )
+				{
+					Real* state = &table.values[ ( static_cast< std::size_t >( o ) * numberOfSamples + s ) * numberOfComponents ];
+					try
+					{
+						const Eci eci = sgp4.FindPosition( start.AddSeconds( s * sampleStep ) );
+						state[ 0 ] = eci.Position( ).x;
+						state[ 1 ] = eci.Position( ).y;
+						state[ 2 ] = eci.Position( ).z;
+						state[ 3 ] = eci.Velocity( ).x;
+						state[ 4 ] = eci.Velocity( ).y;
+						state[ 5 ] = eci.Velocity( ).z;
+					}
+					catch( const std::exception& )
+					{
+						// the object has decayed; the remaining samples stay NaN
+						break;
+					}
+				}
+			}
+		} );
+		return table;
+	}
+
+	SweepSettings getDefaultSweepSettings( )
+	{
+		SweepSettings settings;
+		settings.numberOfDepartureEpochs = 24;
+		settings.departureStride = 60;
+		settings.numberOfTimesOfFlight = 32;
+		settings.timeOfFlightStride = 30;
+		settings.departureObjectsPerTile = 8;
+		settings.arrivalObjectsPerTile = 8;
+		settings.epochsPerTile = 6;
+		settings.numberOfThreads = 0;
+		return settings;
+	}
+
+	int getNumberOfSamples( const SweepSettings& settings )
+	{
+		return ( settings.numberOfDepartureEpochs - 1 ) * settings.departureStride
+			   + settings.numberOfTimesOfFlight * settings.timeOfFlightStride + 1;
+	}
+
+	//! Hardware cache counters of the process, opened before the worker threads start so that they inherit them
+	class CacheCounterGroup
+	{
+	public:
+
+		CacheCounterGroup( )
+		{
+			const unsigned int types[ ] = { PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE };
+			const unsigned long long configs[ ] = {
+				PERF_COUNT_HW_CACHE_L1D | ( PERF_COUNT_HW_CACHE_OP_READ << 8 ) | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 ),
+				PERF_COUNT_HW_CACHE_REFERENCES,
+				PERF_COUNT_HW_CACHE_MISSES };
+			for( int k = 0; k < numberOfEvents; k++ )
+			{
+				struct perf_event_attr attributes;
+				std::memset( &attributes, 0, sizeof( attributes ) );
+				attributes.size = sizeof( attributes );
+				attributes.type = types[ k ];
+				attributes.config = configs[ k ];
+				attributes.disabled = 1;
+				attributes.inherit = 1;
+				attributes.exclude_kernel = 1;
+				attributes.exclude_hv = 1;
+				descriptors[ k ] = static_cast< int >( syscall( __NR_perf_event_open, &attributes, 0, -1, -1, 0 ) );
+			}
+		}
+
+		~CacheCounterGroup( )
+		{
+			for( int k = 0; k < numberOfEvents; k++ )
+			{
+				if( descriptors[ k ] >= 0 )
+				{
+					close( descriptors[ k ] );
+				}
+			}
+		}
+
+		void start( )
+		{
+			for( int k = 0; k < numberOfEvents; k++ )
+			{
+				if( descriptors[ k ] >= 0 )
+				{
+					ioctl( descriptors[ k ], PERF_EVENT_IOC_RESET, 0 );
+					ioctl( descriptors[ k ], PERF_EVENT_IOC_ENABLE, 0 );
+				}
+			}
+		}
+
+		//! Stop the counters and read them; the worker threads must have exited for their events to be included.
+		CacheCounters stop( )
+		{
+			long values[ numberOfEvents ];
+			bool isAvailable = true;
+			for( int k = 0; k < numberOfEvents; k++ )
+			{
+				long long value = 0;
+				if( descriptors[ k ] < 0 )
+				{
+					isAvailable = false;
+				}
+				else
+				{
+					ioctl( descriptors[ k ], PERF_EVENT_IOC_DISABLE, 0 );
+					if( read( descriptors[ k ], &value, sizeof( value ) ) != sizeof( value ) )
+					{
+						isAvailable = false;
+					}
+				}
+				values[ k ] = static_cast< long >( value );
+			}
+
+			CacheCounters counters;
+			counters.isAvailable = isAvailable;
+			counters.level1DataMisses = values[ 0 ];
+			counters.lastLevelReferences = values[ 1 ];
+			counters.lastLevelMisses = values[ 2 ];
+			return counters;
+		}
+
+	private:
+
+		CacheCounterGroup( const CacheCounterGroup& );
+
+		CacheCounterGroup& operator=( const CacheCounterGroup& );
+
+		static const int numberOfEvents = 3;
+		int descriptors[ numberOfEvents ];
+	};
+
+	//! Endpoint of a stored state; false if SGP4 failed on it.
+	bool loadEndpoint( const StateTable& table, const int object, const int sample, Endpoint& endpoint )
+	{
+		const Real* state = &table.values[ ( static_cast< std::size_t >( object ) * table.numberOfSamples + sample )
+										   * numberOfComponents ];
+		if( state[ 0 ] != state[ 0 ] )
+		{
+			return false;
+		}
+		endpoint = LambertSolver::createEndpoint( state, state + 3 );
+		return true;
+	}
+
+	//! Keep a transfer if it has a lower delta-V than the best one, or the same delta-V and lower indices.
+	void updateBestTransfer( const BestTransfer& transfer, BestTransfer& best )
+	{
+		if( transfer.deltaV < best.deltaV
+			|| ( transfer.deltaV == best.deltaV
+				 && ( transfer.arrivalIndex < best.arrivalIndex
+					  || ( transfer.arrivalIndex == best.arrivalIndex
+						   && ( transfer.departureSample < best.departureSample
+								|| ( transfer.departureSample == best.departureSample
+									 && transfer.timeOfFlightSamples < best.timeOfFlightSamples ) ) ) ) ) )
+		{
+			best = transfer;
+		}
+	}
+
+	//! Work counters of one thread
+	struct ThreadCounters
+	{
+		long numberOfTransfers;
+		long numberOfStateLoads;
+		long numberOfEndpoints;
+	};
+
+	//! Cells of departure objects [ beginObject, endObject ) in the loop order of the grid search.
+	void sweepObjectRows( const StateTable& table, const SweepSettings& settings, const int beginObject, const int endObject,
+						  std::vector< BestTransfer >& bestTransfers, ThreadCounters& counters )
+	{
+		const Real gravitationalParameter = kMU;
+		LambertSolver solver;
+		Endpoint departure;
+		Endpoint arrival;
+		for( int i = beginObject; i < endObject; i++ )
+		{
+			for( int l = 0; l < settings.numberOfDepartureEpochs; l++ )
+			{
+				const int departureSample = l * settings.departureStride;
+				counters.numberOfStateLoads++;
+				if( departureSample >= table.numberOfSamples || !loadEndpoint( table, i, departureSample, departure ) )
+				{
+					continue;
+				}
+				counters.numberOfEndpoints++;
+				for( int j = 0; j < table.numberOfObjects; j++ )
+				{
+					if( i == j )
+					{
+						continue;
+					}
+					for( int p = 1; p <= settings.numberOfTimesOfFlight; p++ )
+					{
+						const int timeOfFlightSamples = p * settings.timeOfFlightStride;
+						if( departureSample + timeOfFlightSamples >= table.numberOfSamples )
+						{
+							break;
+						}
+						counters.numberOfStateLoads++;
+						if( !loadEndpoint( table, j, departureSample + timeOfFlightSamples, arrival ) )
+						{
+							continue;
+						}
+						counters.numberOfEndpoints++;
+						const BestTransfer transfer = {
+							solver.computeMinimumDeltaV( departure, arrival, timeOfFlightSamples * table.sampleStep,
+														 gravitationalParameter, lambertRevolutions ),
+							j, departureSample, timeOfFlightSamples };
+						counters.numberOfTransfers++;
+						updateBestTransfer( transfer, bestTransfers[ i ] );
+					}
+				}
+			}
+		}
+	}
+
+	int computeGreatestCommonDivisor( const int first, const int second )
+	{
+		return second == 0 ? first : computeGreatestCommonDivisor( second, first % second );
+	}
+
+	//! Cells of departure object blocks [ beginBlock, endBlock ), tile by tile.
+	void sweepTileRows( const StateTable& table, const SweepSettings& settings, const int beginBlock, const int endBlock,
+						std::vector< BestTransfer >& bestTransfers, ThreadCounters& counters )
+	{
+		const Real gravitationalParameter = kMU;
+		const int departureObjectsPerTile = std::max( settings.departureObjectsPerTile, 1 );
+		const int arrivalObjectsPerTile = std::max( settings.arrivalObjectsPerTile, 1 );
+		const int epochsPerTile = std::max( settings.epochsPerTile, 1 );
+		const int numberOfArrivalBlocks = ( table.numberOfObjects + arrivalObjectsPerTile - 1 ) / arrivalObjectsPerTile;
+
+		// arrival samples of a tile lie on the grid of the common divisor of the strides; a slot per grid point
+		const int slotStride = computeGreatestCommonDivisor( settings.departureStride, settings.timeOfFlightStride );
+		const int slotsPerTile = ( ( epochsPerTile - 1 ) * settings.departureStride
+								   + ( settings.numberOfTimesOfFlight - 1 ) * settings.timeOfFlightStride ) / slotStride + 1;
+
+		LambertSolver solver;
+		std::vector< Endpoint > departures( departureObjectsPerTile * epochsPerTile );
+		std::vector< bool > isDepartureValid( departures.size( ) );
+		std::vector< Endpoint > arrivals( arrivalObjectsPerTile * slotsPerTile );
+		std::vector< bool > isArrivalValid( arrivals.size( ) );
+		std::vector< bool > isSlotUsed( slotsPerTile );
+
+		for( int d = beginBlock; d < endBlock; d++ )
+		{
+			const int firstDeparture = d * departureObjectsPerTile;
+			const int tileDepartures = std::min( departureObjectsPerTile, table.numberOfObjects - firstDeparture );
+			for( int firstEpoch = 0; firstEpoch < settings.numberOfDepartureEpochs; firstEpoch += epochsPerTile )
+			{
+				const int tileEpochs = std::min( epochsPerTile, settings.numberOfDepartureEpochs - firstEpoch );
+				const int firstSample = firstEpoch * settings.departureStride;
+				const int firstArrivalSample = firstSample + settings.timeOfFlightStride;
+
+				// departure endpoints of the tile rows, once for all arrival blocks
+				for( int o = 0; o < tileDepartures; o++ )
+				{
+					for( int l = 0; l < tileEpochs; l++ )
+					{
+						const int sample = firstSample + l * settings.departureStride;
+						const int k = o * epochsPerTile + l;
+						counters.numberOfStateLoads++;
+						isDepartureValid[ k ] = sample < table.numberOfSamples
+												&& loadEndpoint( table, firstDeparture + o, sample, departures[ k ] );
+						counters.numberOfEndpoints += isDepartureValid[ k ] ? 1 : 0;
+					}
+				}
+
+				// arrival samples the cells of the tile reach; shared by the cells of several epochs
+				std::fill( isSlotUsed.begin( ), isSlotUsed.end( ), false );
+				for( int l = 0; l < tileEpochs; l++ )
+				{
+					for( int p = 0; p < settings.numberOfTimesOfFlight; p++ )
+					{
+						isSlotUsed[ ( l * settings.departureStride + p * settings.timeOfFlightStride ) / slotStride ] = true;
+					}
+				}
+
+				for( int k = 0; k < numberOfArrivalBlocks; k++ )
+				{
+					// alternate the direction of the arrival blocks so consecutive epoch blocks start on the last one
+					const int a = ( firstEpoch / epochsPerTile ) % 2 == 0 ? k : numberOfArrivalBlocks - 1 - k;
+					const int firstArrival = a * arrivalObjectsPerTile;
+					const int tileArrivals = std::min( arrivalObjectsPerTile, table.numberOfObjects - firstArrival );
+
+					// arrival endpoints of the tile, each computed once for all of its departure objects and epochs
+					for( int o = 0; o < tileArrivals; o++ )
+					{
+						for( int slot = 0; slot < slotsPerTile; slot++ )
+						{
+							const int sample = firstArrivalSample + slot * slotStride;
+							const int m = o * slotsPerTile + slot;
+							isArrivalValid[ m ] = false;
+							if( !isSlotUsed[ slot ] || sample >= table.numberOfSamples )
+							{
+								continue;
+							}
+							counters.numberOfStateLoads++;
+							isArrivalValid[ m ] = loadEndpoint( table, firstArrival + o, sample, arrivals[ m ] );
+							counters.numberOfEndpoints += isArrivalValid[ m ] ? 1 : 0;
+						}
+					}
+
+					for( int i = 0; i < tileDepartures; i++ )
+					{
+						BestTransfer& best = bestTransfers[ firstDeparture + i ];
+						for( int l = 0; l < tileEpochs; l++ )
+						{
+							if( !isDepartureValid[ i * epochsPerTile + l ] )
+							{
+								continue;
+							}
+							const Endpoint& departure = departures[ i * epochsPerTile + l ];
+							const int departureSample = firstSample + l * settings.departureStride;
+							for( int j = 0; j < tileArrivals; j++ )
+							{
+								if( firstDeparture + i == firstArrival + j )
+								{
+									continue;
+								}
+								for( int p = 0; p < settings.numberOfTimesOfFlight; p++ )
+								{
+									const int offset = l * settings.departureStride + p * settings.timeOfFlightStride;
+									const int m = j * slotsPerTile + offset / slotStride;
+									if( !isArrivalValid[ m ] )
+									{
+										continue;
+									}
+									const int timeOfFlightSamples = ( p + 1 ) * settings.timeOfFlightStride;
+									const BestTransfer transfer = {
+										solver.computeMinimumDeltaV( departure, arrivals[ m ], timeOfFlightSamples * table.sampleStep,
+																	 gravitationalParameter, lambertRevolutions ),
+										firstArrival + j, departureSample, timeOfFlightSamples };
+									counters.numberOfTransfers++;
+									updateBestTransfer( transfer, best );
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	SweepResult sweepTransfers( const StateTable& table, const SweepSettings& settings, const TraversalOrder order )
+	{
+		const int numberOfThreads = parallelFor::getNumberOfThreads( settings.numberOfThreads );
+		const BestTransfer noTransfer = { std::numeric_limits< Real >::infinity( ), -1, 0, 0 };
+
+		SweepResult result;
+		result.bestTransfers.assign( table.numberOfObjects, noTransfer );
+		const ThreadCounters noCounters = { 0, 0, 0 };
+		std::vector< ThreadCounters > threadCounters( numberOfThreads, noCounters );
+
+		// opened before the threads start: they inherit the counters and add their events when they exit
+		CacheCounterGroup cacheCounters;
+		cacheCounters.start( );
+		const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now( );
+		if( order == objectOrder )
+		{
+			parallelFor::parallelFor( table.numberOfObjects, numberOfThreads,
+									  [ & ]( const int beginObject, const int endObject, const int thread )
+			{
+				sweepObjectRows( table, settings, beginObject, endObject, result.bestTransfers, threadCounters[ thread ] );
+			} );
+		}
+		else
+		{
+			const int objectsPerTile = std::max( settings.departureObjectsPerTile, 1 );
+			parallelFor::parallelFor( ( table.numberOfObjects + objectsPerTile - 1 ) / objectsPerTile, numberOfThreads,
+									  [ & ]( const int beginBlock, const int endBlock, const int thread )
+			{
+				sweepTileRows( table, settings, beginBlock, endBlock, result.bestTransfers, threadCounters[ thread ] );
+			} );
+		}
+		result.seconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+		result.counters = cacheCounters.stop( );
+
+		result.numberOfTransfers = 0;
+		result.numberOfStateLoads = 0;
+		result.numberOfEndpoints = 0;
+		for( int t = 0; t < numberOfThreads; t++ )
+		{
+			result.numberOfTransfers += threadCounters[ t ].numberOfTransfers;
+			result.numberOfStateLoads += threadCounters[ t ].numberOfStateLoads;
+			result.numberOfEndpoints += threadCounters[ t ].numberOfEndpoints;
+		}
+		return result;
+	}
+
+} // namespace pairTraversal
@@ -0,0 +1,338 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Eci.h>
+#include <libsgp4/Globals.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/j2Propagator.hpp"
+#include "CppProject/lambertKernel.hpp"
+#include "CppProject/parallelFor.hpp"
+#include "CppProject/reachabilityMap.hpp"
+
+namespace reachabilityMap
+{
+
+	typedef lambertKernel::Solver< Real > LambertSolver;
+	typedef LambertSolver::Endpoint Endpoint;
+
+	//! Revolutions of the Lambert solutions, as lambertDeltaV::computeLambertDeltaV
+	const int lambertRevolutions = 5;
+
+	ReachabilityQuery getDefaultReachabilityQuery( )
+	{
+		ReachabilityQuery query;
+		query.departureIndex = 0;
+		query.windowStart = DateTime( 2016, 2, 1 );
+		query.windowLength = 14.0 * 86400.0;
+		query.departureStep = 3600.0;
+		query.minimumTimeOfFlight = 600.0;
+		query.maximumTimeOfFlight = 12.0 * 3600.0;
+		query.timeOfFlightStep = 600.0;
+		query.deltaVBudget = 0.5;
+		query.boundMargin = 0.02;
+		query.useBounds = true;
+		query.stopAtFirstReachableEpoch = false;
+		query.numberOfThreads = 0;
+		return query;
+	}
+
+	int getNumberOfDepartureEpochs( const ReachabilityQuery& query )
+	{
+		return std::max( static_cast< int >( query.windowLength / query.departureStep ), 1 );
+	}
+
+	int getNumberOfTimesOfFlight( const ReachabilityQuery& query )
+	{
+		return std::max( static_cast< int >( ( query.maximumTimeOfFlight - query.minimumTimeOfFlight ) / query.timeOfFlightStep ) + 1, 1 );
+	}
+
+	//! Range of cos( angle ) over an interval of angles [rad].
+	void computeCosineRange( const Real lowerAngle, const Real upperAngle, Real& minimumCosine, Real& maximumCosine )
+	{
+		if( upperAngle - lowerAngle >= kTWOPI )
+		{
+			minimumCosine = -1.0;
+			maximumCosine = 1.0;
+			return;
+		}
+		minimumCosine = std::min( std::cos( lowerAngle ), std::cos( upperAngle ) );
+		maximumCosine = std::max( std::cos( lowerAngle ), std::cos( upperAngle ) );
+		if( std::floor( upperAngle / kTWOPI ) * kTWOPI >= lowerAngle )
+		{
+			maximumCosine = 1.0;
+		}
+		if( std::floor( ( upperAngle - kPI ) / kTWOPI ) * kTWOPI + kPI >= lowerAngle )
+		{
+			minimumCosine = -1.0;
+		}
+	}
+
+	TransferBounds computeTransferBounds( const j2Propagator::MeanElements& departure,
+										  const j2Propagator::MeanElements& arrival,
+										  const ReachabilityQuery& query )
+	{
+		TransferBounds bounds;
+
+		// energy: the whole gap spent at the highest speed either orbit reaches, its perigee speed
+		const Real departurePerigeeSpeed = std::sqrt( kMU * ( 1.0 + departure.eccentricity )
+													  / ( departure.semiMajorAxis * ( 1.0 - departure.eccentricity ) ) );
+		const Real arrivalPerigeeSpeed = std::sqrt( kMU * ( 1.0 + arrival.eccentricity )
+													/ ( arrival.semiMajorAxis * ( 1.0 - arrival.eccentricity ) ) );
+		const Real maximumSpeed = std::max( departurePerigeeSpeed, arrivalPerigeeSpeed );
+		const Real energyGap = std::fabs( 0.5 * kMU / departure.semiMajorAxis - 0.5 * kMU / arrival.semiMajorAxis );
+		bounds.energyBound = std::sqrt( maximumSpeed * maximumSpeed + 2.0 * energyGap ) - maximumSpeed;
+
+		// plane: the node difference is linear in the departure and arrival epochs, so its range over
+		// the window is spanned by the corners of the (departure epoch, time of flight) grid [min]
+		const Real lastDeparture = ( getNumberOfDepartureEpochs( query ) - 1 ) * query.departureStep / 60.0;
+		const Real shortestFlight = query.minimumTimeOfFlight / 60.0;
+		const Real longestFlight = ( query.minimumTimeOfFlight
+									 + ( getNumberOfTimesOfFlight( query ) - 1 ) * query.timeOfFlightStep ) / 60.0;
+		const Real departureOffset = ( query.windowStart - departure.epoch ).TotalMinutes( );
+		const Real arrivalOffset = ( query.windowStart - arrival.epoch ).TotalMinutes( );
+		Real lowerNodeDifference = std::numeric_limits< Real >::infinity( );
+		Real upperNodeDifference = -std::numeric_limits< Real >::infinity( );
+		const Real departureTimes[ ] = { 0.0, 0.0, lastDeparture, lastDeparture };
+		const Real flightTimes[ ] = { shortestFlight, longestFlight, shortestFlight, longestFlight };
+		for( int k = 0; k < 4; k++ )
+		{
+			const Real nodeDifference
+				= arrival.rightAscendingNode + arrival.rightAscendingNodeRate * ( arrivalOffset + departureTimes[ k ] + flightTimes[ k ] )
+				- departure.rightAscendingNode - departure.rightAscendingNodeRate * ( departureOffset + departureTimes[ k ] );
+			lowerNodeDifference = std::min( lowerNodeDifference, nodeDifference );
+			upperNodeDifference = std::max( upperNodeDifference, nodeDifference );
+		}
+		Real minimumCosine = 0.0;
+		Real maximumCosine = 0.0;
+		computeCosineRange( lowerNodeDifference, upperNodeDifference, minimumCosine, maximumCosine );
+
+		// cosine of the angle between the normals; a plane and its reverse are the same plane
+		const Real constantTerm = std::cos( departure.inclination ) * std::cos( arrival.inclination );
+		const Real nodeTerm = std::sin( departure.inclination ) * std::sin( arrival.inclination );
+		const Real largestCosine = std::min( std::max( std::fabs( constantTerm + nodeTerm * minimumCosine ),
+													   std::fabs( constantTerm + nodeTerm * maximumCosine ) ), 1.0 );
+		const Real smallestSine = std::sqrt( 1.0 - largestCosine * largestCosine );
+
+		const Real departureApogeeSpeed = std::sqrt( kMU * ( 1.0 - departure.eccentricity )
+													 / ( departure.semiMajorAxis * ( 1.0 + departure.eccentricity ) ) );
+		const Real arrivalApogeeSpeed = std::sqrt( kMU * ( 1.0 - arrival.eccentricity )
+												   / ( arrival.semiMajorAxis * ( 1.0 + arrival.eccentricity ) ) );
+		bounds.planeBound = std::min( departureApogeeSpeed, arrivalApogeeSpeed ) * smallestSine;
+		return bounds;
+	}
+
+	const char* getStatusName( const TargetStatus status )
+	{
+		switch( status )
+		{
+			case energyPruned: return "energy-pruned";
+			case planePruned: return "plane-pruned";
+			case unreachable: return "unreachable";
+			case reachable: return "reachable";
+		}
+		return "";
+	}
+
+	//! Lambert endpoint of the SGP4 state of an object; false if SGP4 fails (e.g. after decay).
+	bool findEndpoint( const SGP4& propagator, const DateTime& epoch, Endpoint& endpoint )
+	{
+		try
+		{
+			const Eci eci = propagator.FindPosition( epoch );
+			const Real position[ 3 ] = { eci.Position( ).x, eci.Position( ).y, eci.Position( ).z };
+			const Real velocity[ 3 ] = { eci.Velocity( ).x, eci.Velocity( ).y, eci.Velocity( ).z };
+			endpoint = LambertSolver::createEndpoint( position, velocity );
+			return true;
+		}
+		catch( const std::exception& )
+		{
+			return false;
+		}
+	}
+
+	//! Sweep the grid of a query for one target, departure epoch by departure epoch.
+	void sweepTarget( const SGP4& arrivalPropagator,
+					  const std::vector< Endpoint >& departures,
+					  const std::vector< bool >& isDepartureValid,
+					  const ReachabilityQuery& query,
+					  LambertSolver& solver,
+					  TargetResult& target )
+	{
+		const Real gravitationalParameter = kMU;
+		const int numberOfTimesOfFlight = getNumberOfTimesOfFlight( query );
+		Endpoint arrival;
+		for( unsigned int l = 0; l < departures.size( ); l++ )
+		{
+			if( !isDepartureValid[ l ] )
+			{
+				continue;
+			}
+			for( int p = 0; p < numberOfTimesOfFlight; p++ )
+			{
+				const Real timeOfFlight = query.minimumTimeOfFlight + p * query.timeOfFlightStep;
+				if( !findEndpoint( arrivalPropagator, query.windowStart.AddSeconds( l * query.departureStep + timeOfFlight ), arrival ) )
+				{
+					continue;
+				}
+				const Real deltaV = solver.computeMinimumDeltaV( departures[ l ], arrival, timeOfFlight,
+																 gravitationalParameter, lambertRevolutions );
+				target.numberOfTransfers++;
+				if( deltaV < target.deltaV )
+				{
+					target.deltaV = deltaV;
+					target.departureEpochIndex = l;
+					target.timeOfFlight = timeOfFlight;
+				}
+			}
+			if( query.stopAtFirstReachableEpoch && target.deltaV <= query.deltaVBudget )
+			{
+				break;
+			}
+		}
+		target.status = target.deltaV <= query.deltaVBudget ? reachable : unreachable;
+	}
+
+	ReachabilityMap computeReachabilityMap( const std::vector< Tle >& catalog, const ReachabilityQuery& query )
+	{
+		if( query.departureIndex < 0 || query.departureIndex >= static_cast< int >( catalog.size( ) ) )
+		{
+			throw std::runtime_error( "Departure object of the reachability query is not in the catalog" );
+		}
+
+		ReachabilityMap map;
+		map.departureIndex = query.departureIndex;
+		map.numberOfReachable = 0;
+		map.numberOfTransfers = 0;
+		const int numberOfDepartureEpochs = getNumberOfDepartureEpochs( query );
+		map.numberOfGridCells = static_cast< long >( catalog.size( ) - 1 ) * numberOfDepartureEpochs
+								* getNumberOfTimesOfFlight( query );
+
+		// analytic bounds on every target; the survivors are swept
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now( );
+		const j2Propagator::MeanElements departureElements = j2Propagator::computeMeanElements( catalog[ query.departureIndex ] );
+		std::vector< int > survivors;
+		for( unsigned int j = 0; j < catalog.size( ); j++ )
+		{
+			if( static_cast< int >( j ) == query.departureIndex )
+			{
+				continue;
+			}
+			TargetResult target;
+			target.targetIndex = j;
+			target.bounds = computeTransferBounds( departureElements, j2Propagator::computeMeanElements( catalog[ j ] ), query );
+			target.deltaV = std::numeric_limits< Real >::infinity( );
+			target.departureEpochIndex = -1;
+			target.timeOfFlight = 0.0;
+			target.numberOfTransfers = 0;
+			target.status = unreachable;
+			if( query.useBounds && target.bounds.energyBound > query.deltaVBudget + query.boundMargin )
+			{
+				target.status = energyPruned;
+			}
+			else if( query.useBounds && target.bounds.planeBound > query.deltaVBudget + query.boundMargin )
+			{
+				target.status = planePruned;
+			}
+			else
+			{
+				survivors.push_back( map.targets.size( ) );
+			}
+			map.targets.push_back( target );
+		}
+		map.boundSeconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+
+		// departure endpoints are shared by all targets
+		begin = std::chrono::steady_clock::now( );
+		const SGP4 departurePropagator( catalog[ query.departureIndex ] );
+		std::vector< Endpoint > departures( numberOfDepartureEpochs );
+		std::vector< bool > isDepartureValid( numberOfDepartureEpochs );
+		for( int l = 0; l < numberOfDepartureEpochs; l++ )
+		{
+			isDepartureValid[ l ] = findEndpoint( departurePropagator, query.windowStart.AddSeconds( l * query.departureStep ),
+												  departures[ l ] );
+		}
+
+		// targets end early by different amounts, so every thread takes the next target as it finishes
+		std::atomic< int > nextSurvivor( 0 );
+		const int numberOfThreads = parallelFor::getNumberOfThreads( query.numberOfThreads );
+		parallelFor::parallelFor( numberOfThreads, numberOfThreads, [ & ]( const int, const int, const int )
+		{
+			LambertSolver solver;
+			while( true )
+			{
+				const int s = nextSurvivor++;
+				if( s >= static_cast< int >( survivors.size( ) ) )
+				{
+					break;
+				}
+				TargetResult& target = map.targets[ survivors[ s ] ];
+				const SGP4 arrivalPropagator( catalog[ target.targetIndex ] );
+				sweepTarget( arrivalPropagator, departures, isDepartureValid, query, solver, target );
+			}
+		} );
+		map.sweepSeconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+
+		for( unsigned int k = 0; k < map.targets.size( ); k++ )
+		{
+			map.numberOfTransfers += map.targets[ k ].numberOfTransfers;
+			map.numberOfReachable += map.targets[ k ].status == reachable ? 1 : 0;
+		}
+		return map;
+	}
+
+	void writeReachabilityMap( const std::string& path,
+							   const std::vector< Tle >& catalog,
+							   const ReachabilityQuery& query,
+							   const ReachabilityMap& map )
+	{
+		std::ofstream file( path.c_str( ) );
+		if( !file )
+		{
+			throw std::runtime_error( "Cannot write reachability map file: " + path );
+		}
+
+		file << "departure_norad,target_norad,status,energy_bound_km_s,plane_bound_km_s,delta_v_km_s,"
+			 << "departure_epoch,time_of_flight_s,transfers\n";
+		file << std::setprecision( 10 );
+		for( unsigned int k = 0; k < map.targets.size( ); k++ )
+		{
+			const TargetResult& target = map.targets[ k ];
+			file << catalog[ map.departureIndex ].NoradNumber( ) << "," << catalog[ target.targetIndex ].NoradNumber( ) << ","
+				 << getStatusName( target.status ) << "," << target.bounds.energyBound << "," << target.bounds.planeBound << ",";
+			if( target.departureEpochIndex >= 0 )
+			{
+				file << target.deltaV << "," << query.windowStart.AddSeconds( target.departureEpochIndex * query.departureStep )
+					 << "," << target.timeOfFlight;
+			}
+			else
+			{
+				file << ",,";
+			}
+			file << "," << target.numberOfTransfers << "\n";
+		}
+		file.close( );
+		if( !file )
+		{
+			throw std::runtime_error( "Failed writing reachability map file: " + path );
+		}
+	}
+
+} // namespace reachabilityMap
@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include <libsgp4/DateTime.h>
+
+#include "CppProject/parallelFor.hpp"
+#include "CppProject/resultsStore.hpp"
+
+namespace resultsStore
+{
+
+	//! Outcome of parsing one line of a result file.
+	enum LineType
+	{
+		recordLine,
+		headerLine,
+		emptyLine,
+		malformedLine
+	};
+
+	//! Parse a result row: departure ID, arrival ID, "YYYY-MM-DD hh:mm:ss.uuuuuu UTC", TOF, ATOM dV, Lambert dV.
+	LineType parseResultLine( const std::string& line, ResultRecord& record )
+	{
+		if( line.empty( ) || line == "\r" )
+		{
+			return emptyLine;
+		}
+		if( line.compare( 0, 12, "Departure ID" ) == 0 )
+		{
+			return headerLine;
+		}
+
+		const char* cursor = line.c_str( );
+		char* end;
+		record.departureObjectId = std::strtol( cursor, &end, 10 );
+		if( end == cursor || *end != ',' )
+		{
+			return malformedLine;
+		}
+		cursor = end + 1;
+		record.arrivalObjectId = std::strtol( cursor, &end, 10 );
+		if( end == cursor || *end != ',' )
+		{
+			return malformedLine;
+		}
+		cursor = end + 1;
+
+		int year, month, day, hour, minute, second, microsecond;
+		int epochLength = 0;
+		if( std::sscanf( cursor, "%4d-%2d-%2d %2d:%2d:%2d.%6d UTC%n",
+						 &year, &month, &day, &hour, &minute, &second, &microsecond, &epochLength ) != 7
+			|| epochLength == 0 || cursor[ epochLength ] != ',' )
+		{
+			return malformedLine;
+		}
+		record.departureEpochTicks = DateTime( year, month, day, hour, minute, second ).AddSeconds( microsecond * 1.0e-6 ).Ticks( );
+		cursor += epochLength + 1;
+
+		Real* values[ 3 ] = { &record.timeOfFlight, &record.atomDeltaV, &record.lambertDeltaV };
+		for( int j = 0; j < 3; j++ )
+		{
+			*values[ j ] = std::strtod( cursor, &end );
+			if( end == cursor || ( j < 2 && *end != ',' ) )
+			{
+				return malformedLine;
+			}
+			cursor = end + 1;
+		}
+		return recordLine;
+	}
+
+	//! Chunk of a file buffer, aligned to line boundaries.
+	struct Chunk
+	{
+		const std::string* buffer;
+		std::size_t begin;
+		std::size_t end;
+	};
+
+	std::vector< ResultRecord > readResultFiles( const std::vector< std::string >& paths,
+												 IngestionSummary& summary,
+												 const int numberOfThreads )
+	{
+		const int threadsPerFile = parallelFor::getNumberOfThreads( numberOfThreads );
+
+		// read the files in one go and split each into line aligned chunks, one per thread
+		std::vector< std::string > buffers( paths.size( ) );
+		std::vector< Chunk > chunks;
+		summary.numberOfFiles = 0;
+		for( unsigned int f = 0; f < paths.size( ); f++ )
+		{
+			std::ifstream file( paths[ f ].c_str( ), std::ios::binary );
+			if( !file.is_open( ) )
+			{
+				std::cerr << "Skipping result file that cannot be opened: " << paths[ f ] << std::endl;
+				continue;
+			}
+			buffers[ f ].assign( std::istreambuf_iterator< char >( file ), std::istreambuf_iterator< char >( ) );
+			summary.numberOfFiles++;
+
+			const std::string& buffer = buffers[ f ];
+			std::size_t begin = 0;
+			for( int t = 1; t <= threadsPerFile && begin < buffer.size( ); t++ )
+			{
+				std::size_t end = buffer.size( );
+				if( t < threadsPerFile )
+				{
+					end = buffer.find( '\n', std::max( begin, buffer.size( ) * t / threadsPerFile ) );
+					end = ( end == std::string::npos ) ? buffer.size( ) : end + 1;
+				}
+				const Chunk chunk = { &buffer, begin, end };
+				chunks.push_back( chunk );
+				begin = end;
+			}
+		}
+
+		// parse the chunks in parallel, each into its own list so that file order is preserved
+		std::vector< std::vector< ResultRecord > > chunkRecords( chunks.size( ) );
+		std::vector< IngestionSummary > chunkSummaries( chunks.size( ) );
+		parallelFor::parallelFor( chunks.size( ), numberOfThreads,
+								  [ & ]( const int begin, const int end, const int )
+		{
+			std::string line;
+			for( int c = begin; c < end; c++ )
+			{
+				const std::string& buffer = *chunks[ c ].buffer;
+				IngestionSummary& chunkSummary = chunkSummaries[ c ];
+				chunkSummary.numberOfRows = 0;
+				chunkSummary.numberOfHeaderRows = 0;
+				chunkSummary.numberOfMalformedRows = 0;
+
+				std::size_t lineStart = chunks[ c ].begin;
+				while( lineStart < chunks[ c ].end )
+				{
+					std::size_t lineEnd = buffer.find( '\n', lineStart );
+					if( lineEnd == std::string::npos || lineEnd > chunks[ c ].end )
+					{
+						lineEnd = chunks[ c ].end;
+					}
+					line.assign( buffer, lineStart, lineEnd - lineStart );
+					lineStart = lineEnd + 1;
+
+					ResultRecord record;
+					switch( parseResultLine( line, record ) )
+					{
+						case recordLine:
+							chunkSummary.numberOfRows++;
+							chunkRecords[ c ].push_back( record );
+							break;
+						case headerLine:
+							chunkSummary.numberOfHeaderRows++;
+							break;
+						case malformedLine:
+							chunkSummary.numberOfRows++;
+							chunkSummary.numberOfMalformedRows++;
+							break;
+						case emptyLine:
+							break;
+					}
+				}
+			}
+		} );
+
+		summary.numberOfRows = 0;
+		summary.numberOfHeaderRows = 0;
+		summary.numberOfMalformedRows = 0;
+		std::size_t numberOfRecords = 0;
+		for( unsigned int c = 0; c < chunks.size( ); c++ )
+		{
+			summary.numberOfRows += chunkSummaries[ c ].numberOfRows;
+			summary.numberOfHeaderRows += chunkSummaries[ c ].numberOfHeaderRows;
+			summary.numberOfMalformedRows += chunkSummaries[ c ].numberOfMalformedRows;
+			numberOfRecords += chunkRecords[ c ].size( );
+		}
+
+		std::vector< ResultRecord > records;
+		records.reserve( numberOfRecords );
+		for( unsigned int c = 0; c < chunks.size( ); c++ )
+		{
+			records.insert( records.end( ), chunkRecords[ c ].begin( ), chunkRecords[ c ].end( ) );
+		}
+		return records;
+	}
+
+	//! Order on departure ID, arrival ID, epoch and time-of-flight, best ATOM delta-V first.
+	bool compareRecords( const ResultRecord& first, const ResultRecord& second )
+	{
+		if( first.departureObjectId != second.departureObjectId )
+			return first.departureObjectId < second.departureObjectId;
+		if( first.arrivalObjectId != second.arrivalObjectId )
+			return first.arrivalObjectId < second.arrivalObjectId;
+		if( first.departureEpochTicks != second.departureEpochTicks )
+			return first.departureEpochTicks < second.departureEpochTicks;
+		if( first.timeOfFlight != second.timeOfFlight )
+			return first.timeOfFlight < second.timeOfFlight;
+		return first.atomDeltaV < second.atomDeltaV;
+	}
+
+	//! True if both records describe the same grid point.
+	bool isSameGridPoint( const ResultRecord& first, const ResultRecord& second )
+	{
+		return first.departureObjectId == second.departureObjectId
+			&& first.arrivalObjectId == second.arrivalObjectId
+			&& first.departureEpochTicks == second.departureEpochTicks
+			&& first.timeOfFlight == second.timeOfFlight;
+	}
+
+	//! Order of pair summaries on departure and arrival ID.
+	bool comparePairs( const PairSummary& pair, const std::pair< int, int >& key )
+	{
+		return pair.departureObjectId < key.first
+			|| ( pair.departureObjectId == key.first && pair.arrivalObjectId < key.second );
+	}
+
+	ResultsStore::ResultsStore( )
+		: duplicateCount( 0 )
+	{ }
+
+	ResultsStore::ResultsStore( std::vector< ResultRecord > records )
+		: duplicateCount( 0 )
+	{
+		// sorting puts duplicates next to each other with the lowest ATOM delta-V first, which
+		// std::unique keeps
+		std::sort( records.begin( ), records.end( ), compareRecords );
+		const std::vector< ResultRecord >::iterator last = std::unique( records.begin( ), records.end( ), isSameGridPoint );
+		duplicateCount = records.end( ) - last;
+		records.erase( last, records.end( ) );
+		storedRecords.swap( records );
+		buildIndex( );
+	}
+
+	void ResultsStore::buildIndex( )
+	{
+		pairIndex.clear( );
+		unsigned int begin = 0;
+		while( begin < storedRecords.size( ) )
+		{
+			PairSummary pair;
+			pair.departureObjectId = storedRecords[ begin ].departureObjectId;
+			pair.arrivalObjectId = storedRecords[ begin ].arrivalObjectId;
+			pair.begin = begin;
+			pair.bestIndex = begin;
+			pair.numberOfAtomWins = 0;
+			pair.meanDeltaVGain = 0.0;
+			pair.maximumDeltaVGain = -std::numeric_limits< Real >::max( );
+
+			unsigned int end = begin;
+			while( end < storedRecords.size( )
+				   && storedRecords[ end ].departureObjectId == pair.departureObjectId
+				   && storedRecords[ end ].arrivalObjectId == pair.arrivalObjectId )
+			{
+				const ResultRecord& record = storedRecords[ end ];
+				if( record.atomDeltaV < storedRecords[ pair.bestIndex ].atomDeltaV )
+				{
+					pair.bestIndex = end;
+				}
+				const Real gain = record.lambertDeltaV - record.atomDeltaV;
+				if( gain > 0.0 )
+				{
+					pair.numberOfAtomWins++;
+				}
+				pair.meanDeltaVGain += gain;
+				pair.maximumDeltaVGain = std::max( pair.maximumDeltaVGain, gain );
+				end++;
+			}
+			pair.end = end;
+			pair.meanDeltaVGain /= ( end - begin );
+			pairIndex.push_back( pair );
+			begin = end;
+		}
+	}
+
+	const PairSummary* ResultsStore::findPair( const int departureObjectId, const int arrivalObjectId ) const
+	{
+		const std::pair< int, int > key( departureObjectId, arrivalObjectId );
+		const std::vector< PairSummary >::const_iterator pair
+			= std::lower_bound( pairIndex.begin( ), pairIndex.end( ), key, comparePairs );
+		if( pair == pairIndex.end( ) || pair->departureObjectId != departureObjectId || pair->arrivalObjectId != arrivalObjectId )
+		{
+			return NULL;
+		}
+		return &( *pair );
+	}
+
+	const ResultRecord* ResultsStore::findMinimumDeltaV( const int departureObjectId, const int arrivalObjectId ) const
+	{
+		const PairSummary* pair = findPair( departureObjectId, arrivalObjectId );
+		return pair == NULL ? NULL : &storedRecords[ pair->bestIndex ];
+	}
+
+	std::vector< ResultRecord > ResultsStore::findEpoch( const int departureObjectId,
+														 const int arrivalObjectId,
+														 const DateTime& departureEpoch ) const
+	{
+		const PairSummary* pair = findPair( departureObjectId, arrivalObjectId );
+		if( pair == NULL )
+		{
+			return std::vector< ResultRecord >( );
+		}
+
+		// records of a pair are sorted on epoch first, so the epoch is a contiguous range
+		ResultRecord key = storedRecords[ pair->begin ];
+		key.departureEpochTicks = departureEpoch.Ticks( );
+		key.timeOfFlight = -std::numeric_limits< Real >::max( );
+		std::vector< ResultRecord >::const_iterator record
+			= std::lower_bound( storedRecords.begin( ) + pair->begin, storedRecords.begin( ) + pair->end, key, compareRecords );
+		std::vector< ResultRecord > result;
+		for( ; record != storedRecords.begin( ) + pair->end && record->departureEpochTicks == key.departureEpochTicks; ++record )
+		{
+			result.push_back( *record );
+		}
+		return result;
+	}
+
+	TimeOfFlightHistogram ResultsStore::computeTimeOfFlightHistogram( const int departureObjectId,
+																	  const int arrivalObjectId,
+																	  const Real binWidth ) const
+	{
+		if( binWidth <= 0.0 )
+		{
+			throw std::domain_error( "Histogram bin width must be positive" );
+		}
+
+		TimeOfFlightHistogram histogram;
+		histogram.firstBinStart = 0.0;
+		histogram.binWidth = binWidth;
+		const PairSummary* pair = findPair( departureObjectId, arrivalObjectId );
+		if( pair == NULL )
+		{
+			return histogram;
+		}
+
+		Real minimumTimeOfFlight = std::numeric_limits< Real >::max( );
+		Real maximumTimeOfFlight = -std::numeric_limits< Real >::max( );
+		for( unsigned int r = pair->begin; r < pair->end; r++ )
+		{
+			minimumTimeOfFlight = std::min( minimumTimeOfFlight, storedRecords[ r ].timeOfFlight );
+			maximumTimeOfFlight = std::max( maximumTimeOfFlight, storedRecords[ r ].timeOfFlight );
+		}
+
+		histogram.firstBinStart = std::floor( minimumTimeOfFlight / binWidth ) * binWidth;
+		histogram.counts.assign( static_cast< int >( ( maximumTimeOfFlight - histogram.firstBinStart ) / binWidth ) + 1, 0 );
+		for( unsigned int r = pair->begin; r < pair->end; r++ )
+		{
+			const int bin = static_cast< int >( ( storedRecords[ r ].timeOfFlight - histogram.firstBinStart ) / binWidth );
+			histogram.counts[ std::min( bin, static_cast< int >( histogram.counts.size( ) ) - 1 ) ]++;
+		}
+		return histogram;
+	}
+
+	std::string getResultsStorePath( const std::string& directory )
+	{
+		return directory + "/Atom_Solver_Results.store";
+	}
+
+	const char resultsStoreMagic[ 8 ] = { 'A', 'T', 'O', 'M', 'R', 'E', 'S', '1' };
+
+	template< typename T >
+	void writeValue( std::ofstream& file, const T value )
+	{
+		file.write( reinterpret_cast< const char* >( &value ), sizeof( T ) );
+	}
+
+	template< typename T >
+	T readValue( std::ifstream& file )
+	{
+		T value;
+		file.read( reinterpret_cast< char* >( &value ), sizeof( T ) );
+		return value;
+	}
+
+	void writeResultsStore( const std::string& path, const ResultsStore& store )
+	{
+		std::ofstream file( path.c_str( ), std::ios::binary );
+		file.write( resultsStoreMagic, sizeof( resultsStoreMagic ) );
+		writeValue< boost::uint64_t >( file, store.records( ).size( ) );
+		for( unsigned int r = 0; r < store.records( ).size( ); r++ )
+		{
+			const ResultRecord& record = store.records( )[ r ];
+			writeValue< boost::int32_t >( file, record.departureObjectId );
+			writeValue< boost::int32_t >( file, record.arrivalObjectId );
+			writeValue< boost::int64_t >( file, record.departureEpochTicks );
+			writeValue< Real >( file, record.timeOfFlight );
+			writeValue< Real >( file, record.atomDeltaV );
+			writeValue< Real >( file, record.lambertDeltaV );
+		}
+	}
+
+	ResultsStore readResultsStore( const std::string& path )
+	{
+		std::ifstream file( path.c_str( ), std::ios::binary );
+		char magic[ 8 ];
+		if( !file.read( magic, sizeof( magic ) ) || std::memcmp( magic, resultsStoreMagic, sizeof( magic ) ) != 0 )
+		{
+			throw std::runtime_error( "Not a results store: " + path );
+		}
+
+		std::vector< ResultRecord > records( readValue< boost::uint64_t >( file ) );
+		for( unsigned int r = 0; r < records.size( ) && file; r++ )
+		{
+			ResultRecord& record = records[ r ];
+			record.departureObjectId = readValue< boost::int32_t >( file );
+			record.arrivalObjectId = readValue< boost::int32_t >( file );
+			record.departureEpochTicks = readValue< boost::int64_t >( file );
+			record.timeOfFlight = readValue< Real >( file );
+			record.atomDeltaV = readValue< Real >( file );
+			record.lambertDeltaV = readValue< Real >( file );
+		}
+
+		if( !file )
+		{
+			throw std::runtime_error( "Truncated results store: " + path );
+		}
+		return ResultsStore( records );
+	}
+
+} // namespace resultsStore
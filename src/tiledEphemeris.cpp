@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/cstdint.hpp>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Eci.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/parallelFor.hpp"
+#include "CppProject/tiledEphemeris.hpp"
+
+namespace tiledEphemeris
+{
+
+	const char tiledEphemerisMagic[ 8 ] = { 'A', 'T', 'O', 'M', 'T', 'I', 'L', '1' };
+
+	//! Tiles and the header are aligned to this many bytes (a page on the usual platforms)
+	const std::size_t tileAlignment = 4096;
+
+	std::size_t alignToTile( const std::size_t bytes )
+	{
+		return ( bytes + tileAlignment - 1 ) / tileAlignment * tileAlignment;
+	}
+
+	template< typename T >
+	void writeValue( std::ofstream& file, const T value )
+	{
+		file.write( reinterpret_cast< const char* >( &value ), sizeof( T ) );
+	}
+
+	template< typename T >
+	T readValue( const char*& cursor )
+	{
+		T value;
+		std::memcpy( &value, cursor, sizeof( T ) );
+		cursor += sizeof( T );
+		return value;
+	}
+
+	int TileLayout::getNumberOfObjectBlocks( ) const
+	{
+		return ( numberOfObjects + objectsPerBlock - 1 ) / objectsPerBlock;
+	}
+
+	int TileLayout::getNumberOfTimeBlocks( ) const
+	{
+		return ( numberOfSamples + samplesPerBlock - 1 ) / samplesPerBlock;
+	}
+
+	std::size_t TileLayout::getTileValueBytes( ) const
+	{
+		return static_cast< std::size_t >( numberOfComponents ) * objectsPerBlock * samplesPerBlock * sizeof( Real );
+	}
+
+	//! Bytes of the header: magic, layout and NORAD numbers, padded to the tile alignment.
+	std::size_t getHeaderBytes( const int numberOfObjects )
+	{
+		return alignToTile( sizeof( tiledEphemerisMagic ) + sizeof( boost::int64_t ) + sizeof( Real )
+							+ 4 * sizeof( boost::int32_t ) + numberOfObjects * sizeof( boost::uint32_t ) );
+	}
+
+	std::string getTiledEphemerisPath( const std::string& catalogPath )
+	{
+		return catalogPath + ".tiles";
+	}
+
+	TileLayout writeTiledEphemeris( const std::string& path,
+									const std::vector< Tle >& catalog,
+									const DateTime& windowStart,
+									const Real windowMinutes,
+									const Real sampleStep,
+									const int objectsPerBlock,
+									const int samplesPerBlock,
+									const int numberOfThreads )
+	{
+		TileLayout layout;
+		layout.windowStart = windowStart;
+		layout.sampleStep = sampleStep;
+		layout.numberOfSamples = static_cast< int >( std::floor( windowMinutes * 60.0 / sampleStep ) ) + 1;
+		layout.numberOfObjects = catalog.size( );
+		layout.objectsPerBlock = objectsPerBlock;
+		layout.samplesPerBlock = samplesPerBlock;
+		const int numberOfObjectBlocks = layout.getNumberOfObjectBlocks( );
+		const int numberOfTimeBlocks = layout.getNumberOfTimeBlocks( );
+		const std::size_t headerBytes = getHeaderBytes( layout.numberOfObjects );
+		const std::size_t tileBytes = alignToTile( layout.getTileValueBytes( ) );
+
+		std::ofstream file( path.c_str( ), std::ios::binary );
+		if( !file )
+		{
+			throw std::runtime_error( "Cannot write tiled ephemeris file: " + path );
+		}
+		file.write( tiledEphemerisMagic, sizeof( tiledEphemerisMagic ) );
+		writeValue< boost::int64_t >( file, windowStart.Ticks( ) );
+		writeValue< Real >( file, sampleStep );
+		writeValue< boost::int32_t >( file, layout.numberOfSamples );
+		writeValue< boost::int32_t >( file, layout.numberOfObjects );
+		writeValue< boost::int32_t >( file, objectsPerBlock );
+		writeValue< boost::int32_t >( file, samplesPerBlock );
+		for( int k = 0; k < layout.numberOfObjects; k++ )
+		{
+			writeValue< boost::uint32_t >( file, catalog[ k ].NoradNumber( ) );
+		}
+
+		// one object block at a time: sample all its objects over the window, then scatter its tiles
+		// over the columns of the file
+		const std::size_t blockValues = static_cast< std::size_t >( numberOfComponents ) * objectsPerBlock
+										* numberOfTimeBlocks * samplesPerBlock;
+		std::vector< Real > blockStates( blockValues );
+		std::vector< char > tile( tileBytes, 0 );
+		for( int b = 0; b < numberOfObjectBlocks; b++ )
+		{
+			std::fill( blockStates.begin( ), blockStates.end( ), std::numeric_limits< Real >::quiet_NaN( ) );
+			const int firstObject = b * objectsPerBlock;
+			const int blockObjects = std::min( objectsPerBlock, layout.numberOfObjects - firstObject );
+
+			// states are kept per object and component over the whole window: [ object ][ component ][ sample ]
+			parallelFor::parallelFor( blockObjects, numberOfThreads,
+									  [ & ]( const int begin, const int end, const int )
+			{
+				for( int o = begin; o < end; o++ )
+				{
+					const SGP4 sgp4( catalog[ firstObject + o ] );
+					Real* objectStates = &blockStates[ static_cast< std::size_t >( o ) * numberOfComponents
+													   * numberOfTimeBlocks * samplesPerBlock ];
+					const std::size_t componentStride = static_cast< std::size_t >( numberOfTimeBlocks ) * samplesPerBlock;
+					for( int s = 0; s < layout.numberOfSamples; s++ )
+					{
+						try
+						{
+							const Eci state = sgp4.FindPosition( windowStart.AddSeconds( s * sampleStep ) );
+							objectStates[ s ] = state.Position( ).x;
+							objectStates[ componentStride + s ] = state.Position( ).y;
+							objectStates[ 2 * componentStride + s ] = state.Position( ).z;
+							objectStates[ 3 * componentStride + s ] = state.Velocity( ).x;
+							objectStates[ 4 * componentStride + s ] = state.Velocity( ).y;
+							objectStates[ 5 * componentStride + s ] = state.Velocity( ).z;
+						}
+						catch( const std::exception& )
+						{
+							// decayed or invalid: the remaining samples stay NaN
+							break;
+						}
+					}
+				}
+			} );
+
+			for( int t = 0; t < numberOfTimeBlocks; t++ )
+			{
+				Real* tileValues = reinterpret_cast< Real* >( &tile[ 0 ] );
+				for( int c = 0; c < numberOfComponents; c++ )
+				{
+					for( int o = 0; o < objectsPerBlock; o++ )
+					{
+						const Real* source = &blockStates[ ( static_cast< std::size_t >( o ) * numberOfComponents + c )
+														   * numberOfTimeBlocks * samplesPerBlock
+														   + static_cast< std::size_t >( t ) * samplesPerBlock ];
+						std::copy( source, source + samplesPerBlock,
+								   tileValues + ( static_cast< std::size_t >( c ) * objectsPerBlock + o ) * samplesPerBlock );
+					}
+				}
+				file.seekp( headerBytes + ( static_cast< std::size_t >( t ) * numberOfObjectBlocks + b ) * tileBytes );
+				file.write( &tile[ 0 ], tileBytes );
+			}
+		}
+
+		if( !file )
+		{
+			throw std::runtime_error( "Failed writing tiled ephemeris file: " + path );
+		}
+		return layout;
+	}
+
+	TiledEphemeris::TiledEphemeris( const std::string& path )
+		: fileDescriptor( -1 ),
+		  mapping( NULL ),
+		  mappingBytes( 0 ),
+		  dataOffset( 0 ),
+		  tileBytes( 0 )
+	{
+		fileDescriptor = open( path.c_str( ), O_RDONLY );
+		struct stat fileStatus;
+		if( fileDescriptor < 0 || fstat( fileDescriptor, &fileStatus ) != 0 )
+		{
+			if( fileDescriptor >= 0 )
+			{
+				close( fileDescriptor );
+			}
+			throw std::runtime_error( "Cannot open tiled ephemeris file: " + path );
+		}
+		mappingBytes = fileStatus.st_size;
+		void* address = mappingBytes > 0 ? mmap( NULL, mappingBytes, PROT_READ, MAP_SHARED, fileDescriptor, 0 ) : MAP_FAILED;
+		if( address == MAP_FAILED )
+		{
+			close( fileDescriptor );
+			throw std::runtime_error( "Cannot map tiled ephemeris file: " + path );
+		}
+		mapping = static_cast< char* >( address );
+
+		const char* cursor = mapping;
+		const std::size_t fixedHeaderBytes = sizeof( tiledEphemerisMagic ) + sizeof( boost::int64_t ) + sizeof( Real )
+											 + 4 * sizeof( boost::int32_t );
+		if( mappingBytes < fixedHeaderBytes || std::memcmp( cursor, tiledEphemerisMagic, sizeof( tiledEphemerisMagic ) ) != 0 )
+		{
+			munmap( mapping, mappingBytes );
+			close( fileDescriptor );
+			throw std::runtime_error( "Not a tiled ephemeris file: " + path );
+		}
+		cursor += sizeof( tiledEphemerisMagic );
+		layout.windowStart = DateTime( readValue< boost::int64_t >( cursor ) );
+		layout.sampleStep = readValue< Real >( cursor );
+		layout.numberOfSamples = readValue< boost::int32_t >( cursor );
+		layout.numberOfObjects = readValue< boost::int32_t >( cursor );
+		layout.objectsPerBlock = readValue< boost::int32_t >( cursor );
+		layout.samplesPerBlock = readValue< boost::int32_t >( cursor );
+
+		dataOffset = getHeaderBytes( layout.numberOfObjects );
+		tileBytes = alignToTile( layout.getTileValueBytes( ) );
+		if( mappingBytes < dataOffset + tileBytes * layout.getNumberOfObjectBlocks( ) * layout.getNumberOfTimeBlocks( ) )
+		{
+			munmap( mapping, mappingBytes );
+			close( fileDescriptor );
+			throw std::runtime_error( "Truncated tiled ephemeris file: " + path );
+		}
+		noradNumbers.resize( layout.numberOfObjects );
+		for( int k = 0; k < layout.numberOfObjects; k++ )
+		{
+			noradNumbers[ k ] = readValue< boost::uint32_t >( cursor );
+		}
+	}
+
+	TiledEphemeris::~TiledEphemeris( )
+	{
+		munmap( mapping, mappingBytes );
+		close( fileDescriptor );
+	}
+
+	const Real* TiledEphemeris::findTile( const int objectBlock, const int timeBlock ) const
+	{
+		const std::size_t tileIndex = static_cast< std::size_t >( timeBlock ) * layout.getNumberOfObjectBlocks( ) + objectBlock;
+		return reinterpret_cast< const Real* >( mapping + dataOffset + tileIndex * tileBytes );
+	}
+
+	void TiledEphemeris::findState( const int objectIndex, const int sampleIndex, Real position[ 3 ], Real velocity[ 3 ] ) const
+	{
+		const int object = objectIndex % layout.objectsPerBlock;
+		const int sample = sampleIndex % layout.samplesPerBlock;
+		const Real* tile = findTile( objectIndex / layout.objectsPerBlock, sampleIndex / layout.samplesPerBlock );
+		const std::size_t componentStride = static_cast< std::size_t >( layout.objectsPerBlock ) * layout.samplesPerBlock;
+		const Real* value = tile + static_cast< std::size_t >( object ) * layout.samplesPerBlock + sample;
+		for( int j = 0; j < 3; j++ )
+		{
+			position[ j ] = value[ j * componentStride ];
+			velocity[ j ] = value[ ( j + 3 ) * componentStride ];
+		}
+	}
+
+	std::size_t TiledEphemeris::getTimeBlockBytes( ) const
+	{
+		return tileBytes * layout.getNumberOfObjectBlocks( );
+	}
+
+	void TiledEphemeris::prefetchTimeBlock( const int timeBlock ) const
+	{
+		if( timeBlock >= 0 && timeBlock < layout.getNumberOfTimeBlocks( ) )
+		{
+			madvise( const_cast< char* >( reinterpret_cast< const char* >( findTile( 0, timeBlock ) ) ),
+					 getTimeBlockBytes( ), MADV_WILLNEED );
+		}
+	}
+
+	void TiledEphemeris::releaseTimeBlock( const int timeBlock ) const
+	{
+		if( timeBlock >= 0 && timeBlock < layout.getNumberOfTimeBlocks( ) )
+		{
+			madvise( const_cast< char* >( reinterpret_cast< const char* >( findTile( 0, timeBlock ) ) ),
+					 getTimeBlockBytes( ), MADV_DONTNEED );
+		}
+	}
+
+	TraversalStatistics traverseTiles( const TiledEphemeris& ephemeris,
+									   const Real maximumTimeOfFlight,
+									   const TileVisitor& visitor,
+									   const int numberOfThreads )
+	{
+		const TileLayout& layout = ephemeris.getLayout( );
+		const int numberOfObjectBlocks = layout.getNumberOfObjectBlocks( );
+		const int numberOfTimeBlocks = layout.getNumberOfTimeBlocks( );
+		const Real timeBlockSeconds = layout.samplesPerBlock * layout.sampleStep;
+
+		TraversalStatistics statistics;
+		statistics.numberOfTileVisits = 0;
+		statistics.lookaheadTimeBlocks = static_cast< int >( std::ceil( maximumTimeOfFlight / timeBlockSeconds ) );
+		statistics.workingSetBytes = ( statistics.lookaheadTimeBlocks + 2 ) * ephemeris.getTimeBlockBytes( );
+
+		struct rusage usage;
+		getrusage( RUSAGE_SELF, &usage );
+		const long majorFaultsBefore = usage.ru_majflt;
+		const long minorFaultsBefore = usage.ru_minflt;
+		const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now( );
+
+		for( int t = 0; t <= std::min( statistics.lookaheadTimeBlocks, numberOfTimeBlocks - 1 ); t++ )
+		{
+			ephemeris.prefetchTimeBlock( t );
+		}
+		for( int t = 0; t < numberOfTimeBlocks; t++ )
+		{
+			ephemeris.prefetchTimeBlock( t + statistics.lookaheadTimeBlocks + 1 );
+			parallelFor::parallelFor( numberOfObjectBlocks, numberOfThreads,
+									  [ & ]( const int beginBlock, const int endBlock, const int thread )
+			{
+				for( int d = beginBlock; d < endBlock; d++ )
+				{
+					for( int k = 0; k < numberOfObjectBlocks; k++ )
+					{
+						const int a = d % 2 == 0 ? k : numberOfObjectBlocks - 1 - k;
+						visitor( d, a, t, thread );
+					}
+				}
+			} );
+			statistics.numberOfTileVisits += static_cast< long >( numberOfObjectBlocks ) * numberOfObjectBlocks;
+			ephemeris.releaseTimeBlock( t );
+		}
+
+		statistics.seconds = std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+		getrusage( RUSAGE_SELF, &usage );
+		statistics.majorPageFaults = usage.ru_majflt - majorFaultsBefore;
+		statistics.minorPageFaults = usage.ru_minflt - minorFaultsBefore;
+		return statistics;
+	}
+
+} // namespace tiledEphemeris
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <libsgp4/Eci.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/tleCatalog.hpp"
+
+namespace tleCatalog
+{
+
+	void removeNewline( std::string& string )
+	{
+		string.erase( std::remove( string.begin( ), string.end( ), '\r' ), string.end( ) );
+		string.erase( std::remove( string.begin( ), string.end( ), '\n' ), string.end( ) );
+	}
+
+	std::vector< Tle > readTleCatalog( const std::string& catalogPath )
+	{
+		// read the TLE file. Line based parsing, using string streams
+		std::ifstream tlefile( catalogPath.c_str( ) );
+		if( !tlefile.is_open( ) )
+			perror( "error while opening file" );
+
+		std::vector< Tle > tleObjects; // vector of TLE objects
+		std::string nameLine;
+		std::string lineOne;
+		std::string lineTwo;
+		while( std::getline( tlefile, nameLine ) )
+		{
+			removeNewline( nameLine );
+			if( nameLine.empty( ) )
+			{
+				break;
+			}
+
+			std::getline( tlefile, lineOne );
+			removeNewline( lineOne );
+			std::getline( tlefile, lineTwo );
+			removeNewline( lineTwo );
+
+			tleObjects.push_back( Tle( nameLine, lineOne, lineTwo ) );
+		}
+		tlefile.close( );
+
+		return tleObjects;
+	}
+
+	Vector6 getStateVector( const Eci& state )
+	{
+		Vector6 result( 6 );
+		result[ 0 ] = state.Position( ).x;
+		result[ 1 ] = state.Position( ).y;
+		result[ 2 ] = state.Position( ).z;
+		result[ 3 ] = state.Velocity( ).x;
+		result[ 4 ] = state.Velocity( ).y;
+		result[ 5 ] = state.Velocity( ).z;
+		return result;
+	}
+
+} // namespace tleCatalog
@@ -0,0 +1,507 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gsl/gsl_errno.h>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Eci.h>
+#include <libsgp4/Globals.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include <Atom/convertCartesianStateToTwoLineElements.hpp>
+
+#include "CppProject/dualNumber.hpp"
+#include "CppProject/meanElementConverter.hpp"
+#include "CppProject/sgp4Kernel.hpp"
+#include "CppProject/tleCatalog.hpp"
+#include "CppProject/tleFitter.hpp"
+#include "CppProject/tleFormat.hpp"
+#include "CppProject/TleGen.hpp"
+
+namespace tleFitter
+{
+
+	typedef dualNumber::Dual< 6 > Dual6;
+
+	//! Damping of the first Levenberg-Marquardt step, relative to the diagonal of the normal matrix
+	const Real initialDamping = 1.0e-3;
+
+	//! Damping below which the solver returns to Newton steps
+	const Real minimumDamping = 1.0e-9;
+
+	//! Damping above which the fit stops without progress
+	const Real maximumDamping = 1.0e12;
+
+	//! Residual of a fit and its Jacobian with respect to the unknowns of the fit
+	/*!
+	 * Positions are scaled by the earth radius and velocities by the circular velocity at one earth
+	 * radius, so both halves of the residual weigh alike in the norm used to accept a step.
+	 */
+	struct FitResidual
+	{
+		Real values[ 6 ];
+		Real jacobian[ 6 ][ 6 ];		// [ residual ][ unknown ]
+		Real norm;
+	};
+
+	//! Unknowns of the fit from mean elements: i, raan [rad], e sin( w ), e cos( w ), M + w [rad], n [rev/day]
+	/*!
+	 * The eccentricity vector and the mean argument of latitude are solved for instead of e, w and M,
+	 * which are degenerate for near-circular orbits: there only w + M is observable, and the Jacobian
+	 * in e, w and M is close to singular.
+	 */
+	void getUnknowns( const meanElementConverter::SgpMeanElements& meanElements, Real x[ 6 ] )
+	{
+		x[ 0 ] = meanElements.inclination;
+		x[ 1 ] = meanElements.rightAscendingNode;
+		x[ 2 ] = meanElements.eccentricity * std::sin( meanElements.argumentPerigee );
+		x[ 3 ] = meanElements.eccentricity * std::cos( meanElements.argumentPerigee );
+		x[ 4 ] = meanElements.meanAnomaly + meanElements.argumentPerigee;
+		x[ 5 ] = meanElements.meanMotion;
+	}
+
+	//! Mean elements of the unknowns of the fit, with the angles wrapped to [0, 2 pi).
+	meanElementConverter::SgpMeanElements getMeanElements( const Real x[ 6 ] )
+	{
+		meanElementConverter::SgpMeanElements meanElements;
+		const Real argumentPerigee = std::atan2( x[ 2 ], x[ 3 ] );
+		meanElements.inclination = x[ 0 ];
+		meanElements.rightAscendingNode = std::fmod( std::fmod( x[ 1 ], kTWOPI ) + kTWOPI, kTWOPI );
+		meanElements.eccentricity = std::sqrt( x[ 2 ] * x[ 2 ] + x[ 3 ] * x[ 3 ] );
+		meanElements.argumentPerigee = std::fmod( argumentPerigee + kTWOPI, kTWOPI );
+		meanElements.meanAnomaly = std::fmod( std::fmod( x[ 4 ] - argumentPerigee, kTWOPI ) + kTWOPI, kTWOPI );
+		meanElements.meanMotion = x[ 5 ];
+		return meanElements;
+	}
+
+	//! Evaluate the scaled residual and its Jacobian at x with one dual-number propagation; false outside the kernel domain.
+	bool evaluateResidual( const Real x[ 6 ], const Real bStar, const Real targetState[ 6 ],
+						   sgp4Kernel::Propagator< Dual6 >& propagator, FitResidual& residual )
+	{
+		const Dual6 eSinW = Dual6::variable( x[ 2 ], 2 );
+		// the direction of the eccentricity vector is undefined at zero; any direction will do
+		const Dual6 eCosW = Dual6::variable( x[ 2 ] == 0.0 && x[ 3 ] == 0.0 ? 1.0e-12 : x[ 3 ], 3 );
+		sgp4Kernel::MeanElements< Dual6 > elements;
+		elements.inclination = Dual6::variable( x[ 0 ], 0 );
+		elements.rightAscendingNode = Dual6::variable( x[ 1 ], 1 );
+		elements.eccentricity = sqrt( eSinW * eSinW + eCosW * eCosW );
+		elements.argumentPerigee = atan2( eSinW, eCosW );
+		elements.meanAnomaly = Dual6::variable( x[ 4 ], 4 ) - elements.argumentPerigee;
+		elements.meanMotion = Dual6::variable( x[ 5 ], 5 );
+		elements.bStar = bStar;
+
+		Dual6 state[ 6 ];
+		try
+		{
+			propagator.initialise( elements );
+			propagator.findState( Dual6( 0.0 ), state, state + 3 );
+		}
+		catch( const std::domain_error& )
+		{
+			return false;
+		}
+
+		const Real velocityUnit = kXKMPER * kXKE / 60.0;
+		residual.norm = 0.0;
+		for( int j = 0; j < 6; j++ )
+		{
+			const Real scale = j < 3 ? 1.0 / kXKMPER : 1.0 / velocityUnit;
+			residual.values[ j ] = ( state[ j ].value - targetState[ j ] ) * scale;
+			for( int k = 0; k < 6; k++ )
+			{
+				residual.jacobian[ j ][ k ] = state[ j ].gradient[ k ] * scale;
+			}
+			residual.norm += residual.values[ j ] * residual.values[ j ];
+		}
+		residual.norm = std::sqrt( residual.norm );
+		return residual.norm == residual.norm;
+	}
+
+	bool solveLinearSystem( const int size, Real* matrix, Real* vector )
+	{
+		for( int column = 0; column < size; column++ )
+		{
+			int pivot = column;
+			for( int row = column + 1; row < size; row++ )
+			{
+				if( std::fabs( matrix[ row * size + column ] ) > std::fabs( matrix[ pivot * size + column ] ) )
+				{
+					pivot = row;
+				}
+			}
+			if( matrix[ pivot * size + column ] == 0.0 )
+			{
+				return false;
+			}
+			if( pivot != column )
+			{
+				for( int j = 0; j < size; j++ )
+				{
+					std::swap( matrix[ pivot * size + j ], matrix[ column * size + j ] );
+				}
+				std::swap( vector[ pivot ], vector[ column ] );
+			}
+			for( int row = column + 1; row < size; row++ )
+			{
+				const Real factor = matrix[ row * size + column ] / matrix[ column * size + column ];
+				for( int j = column; j < size; j++ )
+				{
+					matrix[ row * size + j ] -= factor * matrix[ column * size + j ];
+				}
+				vector[ row ] -= factor * vector[ column ];
+			}
+		}
+		for( int row = size - 1; row >= 0; row-- )
+		{
+			for( int j = row + 1; j < size; j++ )
+			{
+				vector[ row ] -= matrix[ row * size + j ] * vector[ j ];
+			}
+			vector[ row ] /= matrix[ row * size + row ];
+		}
+		return true;
+	}
+
+	//! Step of the current residual: Newton without damping, Levenberg-Marquardt with; false if singular.
+	bool computeStep( const FitResidual& residual, const Real damping, Real step[ 6 ] )
+	{
+		Real matrix[ 6 ][ 6 ];
+		if( damping == 0.0 )
+		{
+			for( int j = 0; j < 6; j++ )
+			{
+				step[ j ] = -residual.values[ j ];
+				for( int k = 0; k < 6; k++ )
+				{
+					matrix[ j ][ k ] = residual.jacobian[ j ][ k ];
+				}
+			}
+			return solveLinearSystem( 6, &matrix[ 0 ][ 0 ], step );
+		}
+
+		// ( J^T J + damping diag( J^T J ) ) step = -J^T r
+		for( int j = 0; j < 6; j++ )
+		{
+			step[ j ] = 0.0;
+			for( int m = 0; m < 6; m++ )
+			{
+				step[ j ] -= residual.jacobian[ m ][ j ] * residual.values[ m ];
+			}
+			for( int k = 0; k < 6; k++ )
+			{
+				matrix[ j ][ k ] = 0.0;
+				for( int m = 0; m < 6; m++ )
+				{
+					matrix[ j ][ k ] += residual.jacobian[ m ][ j ] * residual.jacobian[ m ][ k ];
+				}
+			}
+		}
+		for( int j = 0; j < 6; j++ )
+		{
+			matrix[ j ][ j ] *= 1.0 + damping;
+		}
+		return solveLinearSystem( 6, &matrix[ 0 ][ 0 ], step );
+	}
+
+	int fitMeanElements( const Vector6& cartesianState,
+						 const Real bStar,
+						 const atomTransfer::AtomSolverSettings& settings,
+						 meanElementConverter::SgpMeanElements& meanElements,
+						 FitStatistics& statistics )
+	{
+		statistics.numberOfIterations = 0;
+		statistics.numberOfRejectedSteps = 0;
+		statistics.numberOfPropagations = 1;
+
+		Real targetState[ 6 ];
+		for( int j = 0; j < 6; j++ )
+		{
+			targetState[ j ] = cartesianState[ j ];
+		}
+		Real x[ 6 ];
+		getUnknowns( meanElements, x );
+
+		sgp4Kernel::Propagator< Dual6 > propagator;
+		FitResidual residual;
+		if( !evaluateResidual( x, bStar, targetState, propagator, residual ) )
+		{
+			return GSL_EDOM;
+		}
+
+		int status = GSL_CONTINUE;
+		Real damping = 0.0;
+		// a step only counts as converged if no step was rejected since the last accepted one: a step
+		// that is small only because the damping was raised says nothing about the distance to the root
+		bool isCycleRejected = false;
+		FitResidual trialResidual;
+		while( status == GSL_CONTINUE && statistics.numberOfIterations < settings.maximumIterations )
+		{
+			statistics.numberOfIterations++;
+			Real step[ 6 ];
+			if( !computeStep( residual, damping, step ) )
+			{
+				if( damping > 0.0 )
+				{
+					return GSL_ESING;
+				}
+				damping = initialDamping;
+				statistics.numberOfRejectedSteps++;
+				isCycleRejected = true;
+				continue;
+			}
+
+			// the step test of gsl_multiroot_test_delta, on the trial point
+			Real trial[ 6 ];
+			bool isConverged = true;
+			for( int j = 0; j < 6; j++ )
+			{
+				trial[ j ] = x[ j ] + step[ j ];
+				isConverged = isConverged
+							  && std::fabs( step[ j ] ) < settings.absoluteTolerance + settings.relativeTolerance * std::fabs( trial[ j ] );
+			}
+
+			statistics.numberOfPropagations++;
+			const bool isValid = evaluateResidual( trial, bStar, targetState, propagator, trialResidual );
+			if( !isValid || trialResidual.norm > residual.norm )
+			{
+				// at the root the residual only changes by round-off; stop at x if it passes the
+				// test of gsl_multiroot_test_residual
+				Real residualSum = 0.0;
+				for( int j = 0; j < 6; j++ )
+				{
+					residualSum += std::fabs( residual.values[ j ] );
+				}
+				if( isValid && isConverged && residualSum < settings.absoluteTolerance )
+				{
+					status = GSL_SUCCESS;
+					break;
+				}
+
+				statistics.numberOfRejectedSteps++;
+				isCycleRejected = true;
+				damping = damping == 0.0 ? initialDamping : 10.0 * damping;
+				if( damping > maximumDamping )
+				{
+					return GSL_ENOPROG;
+				}
+				continue;
+			}
+
+			std::copy( trial, trial + 6, x );
+			residual = trialResidual;
+			damping = damping * 0.1 < minimumDamping ? 0.0 : damping * 0.1;
+			if( isConverged && !isCycleRejected )
+			{
+				status = GSL_SUCCESS;
+			}
+			isCycleRejected = false;
+		}
+		if( status != GSL_SUCCESS )
+		{
+			return GSL_EMAXITER;
+		}
+
+		meanElements = getMeanElements( x );
+		return GSL_SUCCESS;
+	}
+
+	int fitTwoLineElements( const Vector6& cartesianState,
+							const DateTime& epoch,
+							const Tle& templateTle,
+							const atomTransfer::AtomSolverSettings& settings,
+							Tle& fittedTle,
+							FitStatistics& statistics )
+	{
+		statistics.numberOfIterations = 0;
+		statistics.numberOfRejectedSteps = 0;
+		statistics.numberOfPropagations = 0;
+
+		meanElementConverter::SgpMeanElements meanElements;
+		try
+		{
+			meanElements = meanElementConverter::convertCartesianStateToMeanElements( cartesianState );
+		}
+		catch( const std::domain_error& )
+		{
+			return GSL_EDOM;
+		}
+
+		const int status = fitMeanElements( cartesianState, templateTle.BStar( ), settings, meanElements, statistics );
+		if( status != GSL_SUCCESS )
+		{
+			return status;
+		}
+
+		tleFormat::TleElements elements = tleFormat::getTleElements( templateTle );
+		const Real radiansToDegrees = 180.0 / kPI;
+		elements.epoch = epoch;
+		elements.inclination = meanElements.inclination * radiansToDegrees;
+		elements.rightAscendingNode = meanElements.rightAscendingNode * radiansToDegrees;
+		elements.eccentricity = meanElements.eccentricity;
+		elements.argumentPerigee = meanElements.argumentPerigee * radiansToDegrees;
+		elements.meanAnomaly = meanElements.meanAnomaly * radiansToDegrees;
+		elements.meanMotion = meanElements.meanMotion;
+		fittedTle = tleFormat::createTle( elements );
+		return GSL_SUCCESS;
+	}
+
+	Tle convertCartesianStateToTwoLineElements( const Vector6& cartesianState,
+												const DateTime& epoch,
+												const Tle& templateTle,
+												const atomTransfer::AtomSolverSettings& settings,
+												std::string& solverStatus,
+												FitStatistics& statistics )
+	{
+		Tle fittedTle;
+		const int status = fitTwoLineElements( cartesianState, epoch, templateTle, settings, fittedTle, statistics );
+		solverStatus = gsl_strerror( status );
+		if( status == GSL_SUCCESS )
+		{
+			return fittedTle;
+		}
+		// the analytic mean elements do not exist for every state
+		try
+		{
+			return meanElementConverter::createReferenceTle( cartesianState, epoch, templateTle );
+		}
+		catch( const std::domain_error& )
+		{
+			return templateTle;
+		}
+	}
+
+	//! Position [km] and velocity [km/s] difference of two TLEs at their epoch.
+	void compareStates( const Tle& firstTle, const Tle& secondTle, Real& positionDifference, Real& velocityDifference )
+	{
+		const Eci firstState = SGP4( firstTle ).FindPosition( 0.0 );
+		const Eci secondState = SGP4( secondTle ).FindPosition( 0.0 );
+		const Vector6 first = tleCatalog::getStateVector( firstState );
+		const Vector6 second = tleCatalog::getStateVector( secondState );
+		positionDifference = std::sqrt( ( first[ 0 ] - second[ 0 ] ) * ( first[ 0 ] - second[ 0 ] )
+										+ ( first[ 1 ] - second[ 1 ] ) * ( first[ 1 ] - second[ 1 ] )
+										+ ( first[ 2 ] - second[ 2 ] ) * ( first[ 2 ] - second[ 2 ] ) );
+		velocityDifference = std::sqrt( ( first[ 3 ] - second[ 3 ] ) * ( first[ 3 ] - second[ 3 ] )
+										+ ( first[ 4 ] - second[ 4 ] ) * ( first[ 4 ] - second[ 4 ] )
+										+ ( first[ 5 ] - second[ 5 ] ) * ( first[ 5 ] - second[ 5 ] ) );
+	}
+
+	FitterComparison compareFitters( const Vector2D& randKepElem )
+	{
+		FitterComparison comparison;
+		comparison.numberOfSamples = randKepElem.size( );
+		comparison.atomFailures = 0;
+		comparison.atomMeanIterations = 0.0;
+		comparison.atomSeconds = 0.0;
+		comparison.analyticFailures = 0;
+		comparison.analyticMeanIterations = 0.0;
+		comparison.analyticMeanPropagations = 0.0;
+		comparison.analyticSeconds = 0.0;
+		comparison.numberOfCommonFits = 0;
+		comparison.maximumPositionDifference = 0.0;
+		comparison.maximumVelocityDifference = 0.0;
+
+		// the epoch of the analytic reference TLE and the tolerances of TleGen::TleGen
+		const DateTime conversionEpoch( 2016, 2, 1 );
+		const atomTransfer::AtomSolverSettings settings = atomTransfer::getDefaultAtomSolverSettings( );
+		for( int k = 0; k < comparison.numberOfSamples; k++ )
+		{
+			const Vector6 cartesianState = TleGen::computeCartesianState( randKepElem[ k ] );
+			Tle referenceTle;
+			try
+			{
+				referenceTle = meanElementConverter::createReferenceTle( cartesianState, conversionEpoch );
+			}
+			catch( const std::exception& )
+			{
+				comparison.atomFailures++;
+				comparison.analyticFailures++;
+				continue;
+			}
+
+			std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now( );
+			std::string atomStatus;
+			int atomIterations = 0;
+			Tle atomTle;
+			try
+			{
+				atomTle = atom::convertCartesianStateToTwoLineElements< Real, Vector6 >( cartesianState, conversionEpoch,
+					atomStatus, atomIterations, referenceTle, kMU, kXKMPER, settings.absoluteTolerance,
+					settings.relativeTolerance, settings.maximumIterations );
+			}
+			catch( const std::exception& )
+			{
+				atomStatus = "exception";
+			}
+			comparison.atomSeconds += std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+			const bool isAtomConverged = atomStatus.find( "success" ) != std::string::npos;
+
+			begin = std::chrono::steady_clock::now( );
+			std::string analyticStatus;
+			FitStatistics statistics;
+			const Tle analyticTle = convertCartesianStateToTwoLineElements( cartesianState, conversionEpoch, referenceTle,
+																			settings, analyticStatus, statistics );
+			comparison.analyticSeconds += std::chrono::duration< Real >( std::chrono::steady_clock::now( ) - begin ).count( );
+			const bool isAnalyticConverged = analyticStatus.find( "success" ) != std::string::npos;
+
+			if( isAtomConverged )
+			{
+				comparison.atomMeanIterations += atomIterations;
+			}
+			else
+			{
+				comparison.atomFailures++;
+			}
+			if( isAnalyticConverged )
+			{
+				comparison.analyticMeanIterations += statistics.numberOfIterations;
+				comparison.analyticMeanPropagations += statistics.numberOfPropagations;
+			}
+			else
+			{
+				comparison.analyticFailures++;
+			}
+
+			if( isAtomConverged && isAnalyticConverged )
+			{
+				Real positionDifference = 0.0;
+				Real velocityDifference = 0.0;
+				try
+				{
+					compareStates( atomTle, analyticTle, positionDifference, velocityDifference );
+				}
+				catch( const std::exception& )
+				{
+					continue;
+				}
+				comparison.numberOfCommonFits++;
+				comparison.maximumPositionDifference = std::max( comparison.maximumPositionDifference, positionDifference );
+				comparison.maximumVelocityDifference = std::max( comparison.maximumVelocityDifference, velocityDifference );
+			}
+		}
+
+		const int atomSuccesses = comparison.numberOfSamples - comparison.atomFailures;
+		const int analyticSuccesses = comparison.numberOfSamples - comparison.analyticFailures;
+		if( atomSuccesses > 0 )
+		{
+			comparison.atomMeanIterations /= atomSuccesses;
+		}
+		if( analyticSuccesses > 0 )
+		{
+			comparison.analyticMeanIterations /= analyticSuccesses;
+			comparison.analyticMeanPropagations /= analyticSuccesses;
+		}
+		return comparison;
+	}
+
+} // namespace tleFitter
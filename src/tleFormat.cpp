@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/tleFormat.hpp"
+
+namespace tleFormat
+{
+
+	//! Wrap an angle in degrees to [0, 360) after rounding it to the 4 decimals of the TLE format.
+	Real wrapDegrees( const Real angle )
+	{
+		Real wrapped = std::fmod( angle, 360.0 );
+		if( wrapped < 0.0 )
+		{
+			wrapped += 360.0;
+		}
+		wrapped = std::floor( wrapped * 1.0e4 + 0.5 ) * 1.0e-4;
+		if( wrapped >= 360.0 )
+		{
+			wrapped -= 360.0;
+		}
+		return wrapped;
+	}
+
+	//! Format a value in the TLE "assumed decimal point" exponential notation, e.g. " 15030-3".
+	std::string formatExponent( const Real value )
+	{
+		char buffer[ 32 ];
+		if( value == 0.0 )
+		{
+			return " 00000-0";
+		}
+
+		int exponent = static_cast< int >( std::floor( std::log10( std::fabs( value ) ) ) ) + 1;
+		long mantissa = static_cast< long >( std::floor( std::fabs( value ) / std::pow( 10.0, exponent ) * 1.0e5 + 0.5 ) );
+		if( mantissa >= 100000 )
+		{
+			mantissa /= 10;
+			exponent++;
+		}
+		if( exponent > 9 || exponent < -9 )
+		{
+			return " 00000-0";
+		}
+
+		std::snprintf( buffer, sizeof( buffer ), "%c%05ld%c%1d", value < 0.0 ? '-' : ' ', mantissa,
+					   exponent < 0 ? '-' : '+', std::abs( exponent ) );
+		return std::string( buffer );
+	}
+
+	TleElements getTleElements( const Tle& tle )
+	{
+		TleElements elements;
+		elements.name = tle.Name( );
+		elements.noradNumber = tle.NoradNumber( );
+		elements.classification = 'U';
+		elements.internationalDesignator = tle.IntDesignator( );
+		elements.epoch = tle.Epoch( );
+		elements.meanMotionDt2 = tle.MeanMotionDt2( );
+		elements.meanMotionDdt6 = tle.MeanMotionDdt6( );
+		elements.bStar = tle.BStar( );
+		elements.inclination = tle.Inclination( true );
+		elements.rightAscendingNode = tle.RightAscendingNode( true );
+		elements.eccentricity = tle.Eccentricity( );
+		elements.argumentPerigee = tle.ArgumentPerigee( true );
+		elements.meanAnomaly = tle.MeanAnomaly( true );
+		elements.meanMotion = tle.MeanMotion( );
+		elements.elementSetNumber = 999;
+		elements.revolutionNumber = tle.OrbitNumber( );
+		return elements;
+	}
+
+	int computeChecksum( const std::string& line )
+	{
+		int checksum = 0;
+		const unsigned int length = line.size( ) < 68 ? line.size( ) : 68;
+		for( unsigned int k = 0; k < length; k++ )
+		{
+			if( std::isdigit( static_cast< unsigned char >( line[ k ] ) ) )
+			{
+				checksum += line[ k ] - '0';
+			}
+			else if( line[ k ] == '-' )
+			{
+				checksum += 1;
+			}
+		}
+		return checksum % 10;
+	}
+
+	std::string formatLineOne( const TleElements& elements )
+	{
+		char buffer[ 128 ];
+
+		// epoch as two-digit year and fractional day of year
+		const DateTime& epoch = elements.epoch;
+		const int year = epoch.Year( );
+		const Real dayOfYear = epoch.DayOfYear( year, epoch.Month( ), epoch.Day( ) )
+							   + ( epoch.Hour( ) + ( epoch.Minute( ) + ( epoch.Second( ) + epoch.Microsecond( ) * 1.0e-6 ) / 60.0 ) / 60.0 ) / 24.0;
+
+		// first derivative of the mean motion with the leading zero dropped, e.g. " .00005439"
+		char derivative[ 16 ];
+		std::snprintf( derivative, sizeof( derivative ), "%.8f", std::fmin( std::fabs( elements.meanMotionDt2 ), 0.99999999 ) );
+
+		std::snprintf( buffer, sizeof( buffer ), "1 %05u%c %-8.8s %02d%012.8f %c%s %s %s 0 %4u",
+					   elements.noradNumber % 100000,
+					   elements.classification,
+					   elements.internationalDesignator.c_str( ),
+					   year % 100,
+					   dayOfYear,
+					   elements.meanMotionDt2 < 0.0 ? '-' : ' ',
+					   derivative + 1,
+					   formatExponent( elements.meanMotionDdt6 ).c_str( ),
+					   formatExponent( elements.bStar ).c_str( ),
+					   elements.elementSetNumber % 10000 );
+
+		std::string line( buffer );
+		line += static_cast< char >( '0' + computeChecksum( line ) );
+		return line;
+	}
+
+	std::string formatLineTwo( const TleElements& elements )
+	{
+		char buffer[ 128 ];
+
+		long eccentricity = static_cast< long >( std::floor( elements.eccentricity * 1.0e7 + 0.5 ) );
+		if( eccentricity > 9999999 )
+		{
+			eccentricity = 9999999;
+		}
+
+		std::snprintf( buffer, sizeof( buffer ), "2 %05u %8.4f %8.4f %07ld %8.4f %8.4f %11.8f%5u",
+					   elements.noradNumber % 100000,
+					   wrapDegrees( elements.inclination ),
+					   wrapDegrees( elements.rightAscendingNode ),
+					   eccentricity,
+					   wrapDegrees( elements.argumentPerigee ),
+					   wrapDegrees( elements.meanAnomaly ),
+					   elements.meanMotion,
+					   elements.revolutionNumber % 100000 );
+
+		std::string line( buffer );
+		line += static_cast< char >( '0' + computeChecksum( line ) );
+		return line;
+	}
+
+	Tle createTle( const TleElements& elements )
+	{
+		return Tle( elements.name, formatLineOne( elements ), formatLineTwo( elements ) );
+	}
+
+} // namespace tleFormat
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <vector>
+
+#include <boost/array.hpp>
+
+#include <libsgp4/DateTime.h>
+#include <libsgp4/Eci.h>
+#include <libsgp4/Globals.h>
+#include <libsgp4/SGP4.h>
+#include <libsgp4/Tle.h>
+
+#include "CppProject/j2Propagator.hpp"
+#include "CppProject/lambertDeltaV.hpp"
+#include "CppProject/twoTierScreening.hpp"
+
+namespace twoTierScreening
+{
+
+	typedef boost::array< Real, 3 > array3;
+
+	//! Order screening cells by ascending delta-V.
+	bool compareCells( const ScreeningCell& first, const ScreeningCell& second )
+	{
+		return first.lambertDeltaV < second.lambertDeltaV;
+	}
+
+	//! Lambert delta-V between two states, or the largest representable value if Lambert fails.
+	Real computeCellDeltaV( const array3& departurePosition,
+							const array3& departureVelocity,
+							const array3& arrivalPosition,
+							const array3& arrivalVelocity,
+							const Real timeOfFlight )
+	{
+		array3 transferDepartureVelocity;
+		try
+		{
+			return lambertDeltaV::computeLambertDeltaV( departurePosition, departureVelocity,
+														arrivalPosition, arrivalVelocity,
+														timeOfFlight, kMU, transferDepartureVelocity );
+		}
+		catch( const std::exception& )
+		{
+			return std::numeric_limits< Real >::max( );
+		}
+	}
+
+	//! Copy the position and velocity of an SGP4 ECI object into arrays.
+	void copyState( const Eci& state, array3& position, array3& velocity )
+	{
+		position[ 0 ] = state.Position( ).x;
+		position[ 1 ] = state.Position( ).y;
+		position[ 2 ] = state.Position( ).z;
+		velocity[ 0 ] = state.Velocity( ).x;
+		velocity[ 1 ] = state.Velocity( ).y;
+		velocity[ 2 ] = state.Velocity( ).z;
+	}
+
+	Real computePositionError( const array3& first, const array3& second )
+	{
+		return std::sqrt( ( first[ 0 ] - second[ 0 ] ) * ( first[ 0 ] - second[ 0 ] )
+						  + ( first[ 1 ] - second[ 1 ] ) * ( first[ 1 ] - second[ 1 ] )
+						  + ( first[ 2 ] - second[ 2 ] ) * ( first[ 2 ] - second[ 2 ] ) );
+	}
+
+	std::vector< ScreeningCell > screenTransferGrid( const j2Propagator::J2Propagator& departurePropagator,
+													 const j2Propagator::J2Propagator& arrivalPropagator,
+													 const std::vector< DateTime >& departureEpochs,
+													 const std::vector< Real >& timesOfFlight,
+													 const int shortlistSize )
+	{
+		const int epochSteps = departureEpochs.size( );
+		const int timeOfFlightSteps = timesOfFlight.size( );
+
+		std::vector< ScreeningCell > cells;
+		cells.reserve( epochSteps * timeOfFlightSteps );
+
+		array3 departurePosition;
+		array3 departureVelocity;
+		array3 arrivalPosition;
+		array3 arrivalVelocity;
+		for( int l = 0; l < epochSteps; l++ )
+		{
+			departurePropagator.findState( departureEpochs[ l ], departurePosition, departureVelocity );
+			const Real departureMinutes = ( departureEpochs[ l ] - arrivalPropagator.meanElements( ).epoch ).TotalMinutes( );
+
+			for( int p = 0; p < timeOfFlightSteps; p++ )
+			{
+				arrivalPropagator.findState( departureMinutes + timesOfFlight[ p ] / 60.0, arrivalPosition, arrivalVelocity );
+
+				ScreeningCell cell;
+				cell.epochIndex = l;
+				cell.timeOfFlightIndex = p;
+				cell.lambertDeltaV = computeCellDeltaV( departurePosition, departureVelocity,
+														arrivalPosition, arrivalVelocity, timesOfFlight[ p ] );
+				cells.push_back( cell );
+			}
+		}
+
+		const int numberOfCells = cells.size( );
+		const int keep = std::min( shortlistSize, numberOfCells );
+		std::partial_sort( cells.begin( ), cells.begin( ) + keep, cells.end( ), compareCells );
+		cells.resize( keep );
+		return cells;
+	}
+
+	TierAgreement measureTierAgreement( const std::vector< Tle >& catalog,
+										const std::vector< DateTime >& departureEpochs,
+										const std::vector< Real >& timesOfFlight,
+										const int shortlistSize,
+										const int recallDepth )
+	{
+		const int numberOfObjects = catalog.size( );
+		const int epochSteps = departureEpochs.size( );
+		const int timeOfFlightSteps = timesOfFlight.size( );
+		const int cellsPerPair = epochSteps * timeOfFlightSteps;
+
+		TierAgreement agreement;
+		agreement.numberOfPairs = 0;
+		agreement.numberOfCells = 0;
+		agreement.maximumPositionError = 0.0;
+		agreement.meanPositionError = 0.0;
+		agreement.meanAbsoluteDeltaVDifference = 0.0;
+		agreement.topCellRecall = 0.0;
+
+		int numberOfStates = 0;
+		int numberOfDeltaVs = 0;
+		int recalledCells = 0;
+		int checkedCells = 0;
+
+		array3 sgp4DeparturePosition, sgp4DepartureVelocity, sgp4ArrivalPosition, sgp4ArrivalVelocity;
+		array3 j2DeparturePosition, j2DepartureVelocity, j2ArrivalPosition, j2ArrivalVelocity;
+
+		for( int i = 0; i < numberOfObjects; i++ )
+		{
+			const SGP4 sgp4Departure( catalog[ i ] );
+			const j2Propagator::J2Propagator j2Departure( catalog[ i ] );
+
+			for( int m = 0; m < numberOfObjects; m++ )
+			{
+				if( i == m )
+				{
+					continue;
+				}
+
+				const SGP4 sgp4Arrival( catalog[ m ] );
+				const j2Propagator::J2Propagator j2Arrival( catalog[ m ] );
+
+				std::vector< ScreeningCell > sgp4Cells;
+				sgp4Cells.reserve( cellsPerPair );
+				for( int l = 0; l < epochSteps; l++ )
+				{
+					try
+					{
+						copyState( sgp4Departure.FindPosition( departureEpochs[ l ] ), sgp4DeparturePosition, sgp4DepartureVelocity );
+					}
+					catch( const std::exception& )
+					{
+						continue;
+					}
+					j2Departure.findState( departureEpochs[ l ], j2DeparturePosition, j2DepartureVelocity );
+
+					const Real departureError = computePositionError( sgp4DeparturePosition, j2DeparturePosition );
+					agreement.maximumPositionError = std::max( agreement.maximumPositionError, departureError );
+					agreement.meanPositionError += departureError;
+					numberOfStates++;
+
+					for( int p = 0; p < timeOfFlightSteps; p++ )
+					{
+						const DateTime arrivalEpoch = departureEpochs[ l ].AddSeconds( timesOfFlight[ p ] );
+						try
+						{
+							copyState( sgp4Arrival.FindPosition( arrivalEpoch ), sgp4ArrivalPosition, sgp4ArrivalVelocity );
+						}
+						catch( const std::exception& )
+						{
+							continue;
+						}
+						j2Arrival.findState( arrivalEpoch, j2ArrivalPosition, j2ArrivalVelocity );
+
+						const Real arrivalError = computePositionError( sgp4ArrivalPosition, j2ArrivalPosition );
+						agreement.maximumPositionError = std::max( agreement.maximumPositionError, arrivalError );
+						agreement.meanPositionError += arrivalError;
+						numberOfStates++;
+
+						ScreeningCell cell;
+						cell.epochIndex = l;
+						cell.timeOfFlightIndex = p;
+						cell.lambertDeltaV = computeCellDeltaV( sgp4DeparturePosition, sgp4DepartureVelocity,
+																sgp4ArrivalPosition, sgp4ArrivalVelocity, timesOfFlight[ p ] );
+						const Real j2DeltaV = computeCellDeltaV( j2DeparturePosition, j2DepartureVelocity,
+																j2ArrivalPosition, j2ArrivalVelocity, timesOfFlight[ p ] );
+						if( cell.lambertDeltaV < std::numeric_limits< Real >::max( )
+							&& j2DeltaV < std::numeric_limits< Real >::max( ) )
+						{
+							agreement.meanAbsoluteDeltaVDifference += std::fabs( cell.lambertDeltaV - j2DeltaV );
+							numberOfDeltaVs++;
+						}
+						sgp4Cells.push_back( cell );
+					}
+				}
+
+				const std::vector< ScreeningCell > shortlist
+					= screenTransferGrid( j2Departure, j2Arrival, departureEpochs, timesOfFlight, shortlistSize );
+				std::vector< bool > shortlisted( cellsPerPair, false );
+				for( unsigned int k = 0; k < shortlist.size( ); k++ )
+				{
+					shortlisted[ shortlist[ k ].epochIndex * timeOfFlightSteps + shortlist[ k ].timeOfFlightIndex ] = true;
+				}
+
+				const int numberOfSgp4Cells = sgp4Cells.size( );
+				const int depth = std::min( recallDepth, numberOfSgp4Cells );
+				std::partial_sort( sgp4Cells.begin( ), sgp4Cells.begin( ) + depth, sgp4Cells.end( ), compareCells );
+				for( int k = 0; k < depth; k++ )
+				{
+					if( shortlisted[ sgp4Cells[ k ].epochIndex * timeOfFlightSteps + sgp4Cells[ k ].timeOfFlightIndex ] )
+					{
+						recalledCells++;
+					}
+					checkedCells++;
+				}
+
+				agreement.numberOfPairs++;
+				agreement.numberOfCells += numberOfSgp4Cells;
+			}
+		}
+
+		if( numberOfStates > 0 )
+		{
+			agreement.meanPositionError /= numberOfStates;
+		}
+		if( numberOfDeltaVs > 0 )
+		{
+			agreement.meanAbsoluteDeltaVDifference /= numberOfDeltaVs;
+		}
+		if( checkedCells > 0 )
+		{
+			agreement.topCellRecall = static_cast< Real >( recalledCells ) / checkedCells;
+		}
+		return agreement;
+	}
+
+} // namespace twoTierScreening
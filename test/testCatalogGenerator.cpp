@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+// Round trip of a generated catalog: writes a small LEO catalog with catalogGenerator::generateCatalog,
+// checks the checksum digit of every element line against tleFormat::computeChecksum, and reads the
+// file back with tleCatalog::readTleCatalog, which must return every written object with the same
+// NORAD number and element lines. The catalog written on several threads, in blocks smaller than
+// the catalog, must be the same file.
+//
+// Usage: test_ATOM_ADR_catalog_generator [catalog path]
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <libsgp4/Tle.h>
+
+#include "CppProject/catalogGenerator.hpp"
+#include "CppProject/tleCatalog.hpp"
+#include "CppProject/tleFormat.hpp"
+
+//! Contents of a file.
+std::string readFile( const std::string& path )
+{
+	std::ifstream file( path.c_str( ), std::ios::binary );
+	std::ostringstream contents;
+	contents << file.rdbuf( );
+	return contents.str( );
+}
+
+//! Whether the last character of an element line is the checksum of the rest of the line.
+bool isChecksumValid( const std::string& line )
+{
+	return line.size( ) == 69 && line[ 68 ] == '0' + tleFormat::computeChecksum( line.substr( 0, 68 ) );
+}
+
+int main( const int numberOfInputs, const char* inputArguments[ ] )
+{
+	const std::string path = numberOfInputs > 1 ? inputArguments[ 1 ] : "catalogGeneratorTest.txt";
+	const int numberOfSamples = 24;
+
+	catalogGenerator::CatalogSettings settings = catalogGenerator::getDefaultCatalogSettings( catalogGenerator::leoPopulation );
+	settings.name = "TEST";
+	settings.objectsPerBlock = 5;
+
+	catalogGenerator::CatalogSummary summary;
+	std::string serialFile;
+	std::string threadedFile;
+	std::vector< Tle > catalog;
+	try
+	{
+		settings.numberOfThreads = 3;
+		catalogGenerator::generateCatalog( path, numberOfSamples, settings );
+		threadedFile = readFile( path );
+		settings.numberOfThreads = 1;
+		summary = catalogGenerator::generateCatalog( path, numberOfSamples, settings );
+		serialFile = readFile( path );
+		catalog = tleCatalog::readTleCatalog( path );
+	}
+	catch( const std::exception& error )
+	{
+		std::cerr << error.what( ) << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::remove( path.c_str( ) );
+
+	// the name, line 1 and line 2 of every object
+	std::vector< std::string > lines;
+	std::istringstream stream( serialFile );
+	std::string line;
+	while( std::getline( stream, line ) )
+	{
+		tleCatalog::removeNewline( line );
+		lines.push_back( line );
+	}
+
+	int numberOfBadChecksums = 0;
+	int numberOfMismatches = 0;
+	const bool isCountConsistent = summary.numberOfObjects > 0
+								   && static_cast< int >( lines.size( ) ) == 3 * summary.numberOfObjects
+								   && static_cast< int >( catalog.size( ) ) == summary.numberOfObjects;
+	for( unsigned int k = 0; isCountConsistent && k < catalog.size( ); k++ )
+	{
+		const std::string& lineOne = lines[ 3 * k + 1 ];
+		const std::string& lineTwo = lines[ 3 * k + 2 ];
+		if( !isChecksumValid( lineOne ) || !isChecksumValid( lineTwo ) )
+		{
+			numberOfBadChecksums++;
+		}
+		if( catalog[ k ].Line1( ) != lineOne || catalog[ k ].Line2( ) != lineTwo
+			|| catalog[ k ].NoradNumber( ) != static_cast< unsigned int >( std::atoi( lineOne.substr( 2, 5 ).c_str( ) ) ) )
+		{
+			numberOfMismatches++;
+		}
+	}
+	const bool isThreadIndependent = serialFile == threadedFile;
+
+	std::cout << summary.numberOfObjects << " of " << numberOfSamples << " objects written, " << catalog.size( )
+			  << " read back, " << numberOfBadChecksums << " bad checksums, " << numberOfMismatches
+			  << " mismatched objects, thread independent = " << isThreadIndependent << std::endl;
+	return isCountConsistent && numberOfBadChecksums == 0 && numberOfMismatches == 0 && isThreadIndependent
+		   ? EXIT_SUCCESS : EXIT_FAILURE;
+}
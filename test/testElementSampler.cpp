@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+// Check of the stratification of the element sampler designs: the first 2^m scrambled Sobol points
+// put exactly one point in every interval of width 2^-m of each coordinate, and exactly one point in
+// every elementary box of area 2^-m of the first two coordinates, since the scramble and digital
+// shift keep the (0, m, 2)-net property of the unscrambled sequence. A Latin hypercube of N samples
+// puts exactly one sample in every stratum of width 1 / N of each coordinate. Both designs must give
+// the same points on one thread and on several, whose blocks start in the middle of the sequence.
+//
+// Usage: test_ATOM_ADR_element_sampler
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "CppProject/elementSampler.hpp"
+
+typedef double Real;
+
+//! Whether every cell of a regular partition of coordinate d into numberOfCells intervals holds exactly one point.
+bool isStratified( const elementSampler::Vector2D& samples, const int d, const int numberOfCells )
+{
+	std::vector< int > counts( numberOfCells, 0 );
+	for( unsigned int n = 0; n < samples.size( ); n++ )
+	{
+		const int cell = static_cast< int >( samples[ n ][ d ] * numberOfCells );
+		if( cell < 0 || cell >= numberOfCells || ++counts[ cell ] > 1 )
+		{
+			return false;
+		}
+	}
+	return static_cast< int >( samples.size( ) ) == numberOfCells;
+}
+
+//! Whether every elementary box of 2^k by 2^( m - k ) cells of the first two coordinates holds exactly one point.
+bool isNet( const elementSampler::Vector2D& samples, const int m )
+{
+	for( int k = 0; k <= m; k++ )
+	{
+		const int rows = 1 << k;
+		const int columns = 1 << ( m - k );
+		std::vector< int > counts( rows * columns, 0 );
+		for( unsigned int n = 0; n < samples.size( ); n++ )
+		{
+			const int box = static_cast< int >( samples[ n ][ 0 ] * rows ) * columns
+							+ static_cast< int >( samples[ n ][ 1 ] * columns );
+			if( ++counts[ box ] > 1 )
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int main( )
+{
+	bool isPassed = true;
+
+	// Sobol points: every power of two up to 256, for two seeds
+	const int seeds[ 2 ] = { 1, 7 };
+	for( int s = 0; s < 2; s++ )
+	{
+		const elementSampler::Vector2D sobol = elementSampler::generateUnitSamples( elementSampler::sobolDesign, 256, seeds[ s ], 1 );
+		const elementSampler::Vector2D threaded = elementSampler::generateUnitSamples( elementSampler::sobolDesign, 256, seeds[ s ], 3 );
+		const bool isThreadIndependent = sobol == threaded;
+		bool isSobolStratified = true;
+		for( int m = 0; m <= 8; m++ )
+		{
+			const elementSampler::Vector2D first( sobol.begin( ), sobol.begin( ) + ( 1 << m ) );
+			for( int d = 0; d < elementSampler::numberOfElements; d++ )
+			{
+				isSobolStratified = isSobolStratified && isStratified( first, d, 1 << m );
+			}
+			isSobolStratified = isSobolStratified && isNet( first, m );
+		}
+		std::cout << "sobol, seed " << seeds[ s ] << ": stratified = " << isSobolStratified
+				  << ", thread independent = " << isThreadIndependent << std::endl;
+		isPassed = isPassed && isSobolStratified && isThreadIndependent;
+	}
+
+	// Latin hypercube: sample counts that are not powers of two, for two seeds
+	const int sampleSizes[ 3 ] = { 1, 10, 97 };
+	for( int s = 0; s < 2; s++ )
+	{
+		for( int k = 0; k < 3; k++ )
+		{
+			const elementSampler::Vector2D lhs = elementSampler::generateUnitSamples( elementSampler::latinHypercubeDesign,
+																					   sampleSizes[ k ], seeds[ s ], 1 );
+			const elementSampler::Vector2D threaded = elementSampler::generateUnitSamples( elementSampler::latinHypercubeDesign,
+																							sampleSizes[ k ], seeds[ s ], 3 );
+			bool isLhsStratified = true;
+			for( int d = 0; d < elementSampler::numberOfElements; d++ )
+			{
+				isLhsStratified = isLhsStratified && isStratified( lhs, d, sampleSizes[ k ] );
+			}
+			const bool isThreadIndependent = lhs == threaded;
+			std::cout << "lhs, seed " << seeds[ s ] << ", " << sampleSizes[ k ] << " samples: stratified = "
+					  << isLhsStratified << ", thread independent = " << isThreadIndependent << std::endl;
+			isPassed = isPassed && isLhsStratified && isThreadIndependent;
+		}
+	}
+	return isPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
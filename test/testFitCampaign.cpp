@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+// Check of the Wilson score interval used as the stopping rule of the fit campaign: the bounds of
+// fitCampaign::computeWilsonInterval are compared with reference values of the closed form
+// ( k + z^2 / 2 -+ z sqrt( k ( n - k ) / n + z^2 / 4 ) ) / ( n + z^2 ), clipped to [0, 1], including
+// the cases without failures, with only failures and without samples.
+//
+// Usage: test_ATOM_ADR_fit_campaign
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "CppProject/fitCampaign.hpp"
+
+typedef double Real;
+
+int main( )
+{
+	// failures, samples, quantile, lower bound, upper bound
+	const int numberOfCases = 7;
+	const Real cases[ numberOfCases ][ 5 ] = { { 0.0, 10.0, 1.96, 0.0, 0.277540168767 },
+											   { 5.0, 10.0, 1.96, 0.236589593615, 0.763410406385 },
+											   { 10.0, 10.0, 1.96, 0.722459831233, 1.0 },
+											   { 1.0, 100.0, 1.96, 0.001767386566, 0.054487524761 },
+											   { 37.0, 250.0, 1.96, 0.109319208705, 0.197335019758 },
+											   { 3.0, 40.0, 2.5758, 0.019163516910, 0.251766354511 },
+											   { 0.0, 0.0, 1.96, 0.0, 1.0 } };
+	const Real tolerance = 1.0e-11;
+
+	bool isPassed = true;
+	for( int n = 0; n < numberOfCases; n++ )
+	{
+		Real lowerBound = -1.0;
+		Real upperBound = -1.0;
+		fitCampaign::computeWilsonInterval( static_cast< long >( cases[ n ][ 0 ] ), static_cast< long >( cases[ n ][ 1 ] ),
+											cases[ n ][ 2 ], lowerBound, upperBound );
+		const Real difference = std::max( std::fabs( lowerBound - cases[ n ][ 3 ] ), std::fabs( upperBound - cases[ n ][ 4 ] ) );
+		std::cout << cases[ n ][ 0 ] << " of " << cases[ n ][ 1 ] << ", z = " << cases[ n ][ 2 ] << ": [" << lowerBound
+				  << ", " << upperBound << "], difference = " << difference << std::endl;
+		isPassed = isPassed && difference <= tolerance;
+	}
+	return isPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+// Golden-result regression of the grid path: replays the cells of a reference file (column layout of
+// Atom_Solver_Grid3.csv) with a baseline and a candidate evaluator and reports speed-up and drift.
+//
+// Usage: test_ATOM_ADR_regression catalog reference [candidate] [absolute tolerance km/s] [relative tolerance] [baseline]
+//   candidate                      evaluator under test: serial, parallel (default), workspace, refined or batched
+//   baseline                       evaluator the speed-up is measured against, serial by default
+// The run fails if the candidate misses a reference row or drifts outside the tolerance.
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include <libsgp4/DateTime.h>
+
+#include "CppProject/gridRegression.hpp"
+
+//! Print the drift summary of one evaluator.
+void printComparison( const std::string& name, const gridRegression::RegressionComparison& comparison, const double seconds )
+{
+	std::cout << name << ": time [s] = " << seconds
+			  << ", matched = " << comparison.numberOfMatchedRows << "/" << comparison.numberOfReferenceRows
+			  << ", missing = " << comparison.numberOfMissingRows
+			  << ", extra = " << comparison.numberOfExtraRows
+			  << ", drifting = " << comparison.numberOfDriftingRows
+			  << ", max Atom drift [km/s] = " << comparison.maximumAtomDeltaVDrift
+			  << ", max Lambert drift [km/s] = " << comparison.maximumLambertDeltaVDrift << std::endl;
+	for( unsigned int k = 0; k < comparison.driftingRows.size( ); k++ )
+	{
+		const gridRegression::ResultRecord& expected = comparison.driftingRows[ k ].first;
+		const gridRegression::ResultRecord& actual = comparison.driftingRows[ k ].second;
+		std::cout << "  " << expected.departureObjectId << "," << expected.arrivalObjectId << ","
+				  << DateTime( expected.departureEpochTicks ) << "," << expected.timeOfFlight
+				  << ": Atom " << expected.atomDeltaV << " -> " << actual.atomDeltaV
+				  << ", Lambert " << expected.lambertDeltaV << " -> " << actual.lambertDeltaV << std::endl;
+	}
+}
+
+int main( const int numberOfInputs, const char* inputArguments[ ] )
+{
+	if( numberOfInputs < 3 )
+	{
+		std::cerr << "Usage: " << inputArguments[ 0 ]
+				  << " catalog reference [candidate] [absolute tolerance km/s] [relative tolerance] [baseline]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const std::string candidateName = numberOfInputs > 3 ? inputArguments[ 3 ] : "parallel";
+	const gridRegression::CellEvaluator candidate = gridRegression::findCellEvaluator( candidateName );
+	if( candidate == NULL )
+	{
+		std::cerr << "Unknown candidate evaluator: " << candidateName << std::endl;
+		return EXIT_FAILURE;
+	}
+	const std::string baselineName = numberOfInputs > 6 ? inputArguments[ 6 ] : "serial";
+	const gridRegression::CellEvaluator baseline = gridRegression::findCellEvaluator( baselineName );
+	if( baseline == NULL )
+	{
+		std::cerr << "Unknown baseline evaluator: " << baselineName << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// the reference files hold six significant digits, so the default tolerance sits just above that
+	gridRegression::RegressionTolerance tolerance;
+	tolerance.absoluteDeltaV = numberOfInputs > 4 ? std::atof( inputArguments[ 4 ] ) : 1.0e-5;
+	tolerance.relativeDeltaV = numberOfInputs > 5 ? std::atof( inputArguments[ 5 ] ) : 1.0e-5;
+
+	try
+	{
+		const gridRegression::RegressionReport report = gridRegression::runRegression(
+			inputArguments[ 1 ], inputArguments[ 2 ], tolerance, baseline, candidate );
+
+		printComparison( "baseline (" + baselineName + ")", report.baseline, report.baselineSeconds );
+		printComparison( "candidate (" + candidateName + ")", report.candidate, report.candidateSeconds );
+		std::cout << "Speed-up = " << report.baselineSeconds / report.candidateSeconds << std::endl;
+
+		if( !gridRegression::isPassing( report.candidate ) )
+		{
+			std::cout << "FAILED: candidate results drift from the reference" << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::cout << "PASSED" << std::endl;
+	}
+	catch( const std::exception& error )
+	{
+		std::cerr << "Regression run failed: " << error.what( ) << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
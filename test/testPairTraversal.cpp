@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+// Check of the traversal orders of the all-pairs Lambert sweep: on a small state table of circular
+// orbits, with one missing state, the object order and the blocked order must return the same best
+// transfer of every departure object, on one thread and on several, with tiles that do not divide
+// the grid evenly.
+//
+// Usage: test_ATOM_ADR_pair_traversal
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "CppProject/pairTraversal.hpp"
+
+typedef double Real;
+
+//! Table of circular orbits of radius [km], inclination and right ascension [rad] and initial argument of latitude [rad].
+pairTraversal::StateTable createStateTable( const Real orbits[ ][ 4 ], const int numberOfObjects, const Real sampleStep,
+											const int numberOfSamples )
+{
+	const Real mu = 398600.4418; // [km^3/s^2]
+
+	pairTraversal::StateTable table;
+	table.sampleStep = sampleStep;
+	table.numberOfObjects = numberOfObjects;
+	table.numberOfSamples = numberOfSamples;
+	table.values.resize( numberOfObjects * numberOfSamples * 6 );
+	for( int object = 0; object < numberOfObjects; object++ )
+	{
+		const Real radius = orbits[ object ][ 0 ];
+		const Real speed = std::sqrt( mu / radius );
+		const Real cosI = std::cos( orbits[ object ][ 1 ] );
+		const Real sinI = std::sin( orbits[ object ][ 1 ] );
+		const Real cosO = std::cos( orbits[ object ][ 2 ] );
+		const Real sinO = std::sin( orbits[ object ][ 2 ] );
+		for( int sample = 0; sample < numberOfSamples; sample++ )
+		{
+			const Real u = orbits[ object ][ 3 ] + speed / radius * sample * sampleStep;
+			const Real planePosition[ 2 ] = { radius * std::cos( u ), radius * std::sin( u ) };
+			const Real planeVelocity[ 2 ] = { -speed * std::sin( u ), speed * std::cos( u ) };
+			Real* state = &table.values[ ( object * numberOfSamples + sample ) * 6 ];
+			const Real* plane[ 2 ] = { planePosition, planeVelocity };
+			for( int k = 0; k < 2; k++ )
+			{
+				state[ 3 * k ] = cosO * plane[ k ][ 0 ] - sinO * cosI * plane[ k ][ 1 ];
+				state[ 3 * k + 1 ] = sinO * plane[ k ][ 0 ] + cosO * cosI * plane[ k ][ 1 ];
+				state[ 3 * k + 2 ] = sinI * plane[ k ][ 1 ];
+			}
+		}
+	}
+	return table;
+}
+
+//! Whether two sweeps found the same best transfer for every departure object.
+bool isSameTransfers( const pairTraversal::SweepResult& first, const pairTraversal::SweepResult& second )
+{
+	if( first.bestTransfers.size( ) != second.bestTransfers.size( ) )
+	{
+		return false;
+	}
+	for( unsigned int k = 0; k < first.bestTransfers.size( ); k++ )
+	{
+		const pairTraversal::BestTransfer& a = first.bestTransfers[ k ];
+		const pairTraversal::BestTransfer& b = second.bestTransfers[ k ];
+		if( a.deltaV != b.deltaV || a.arrivalIndex != b.arrivalIndex || a.departureSample != b.departureSample
+			|| a.timeOfFlightSamples != b.timeOfFlightSamples )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int main( )
+{
+	// LEO orbits of different radius, plane and phase
+	const int numberOfObjects = 5;
+	const Real orbits[ numberOfObjects ][ 4 ] = { { 7000.0, 1.70, 0.3, 0.0 },
+												  { 7050.0, 1.72, 0.4, 1.0 },
+												  { 7100.0, 1.68, 0.2, 2.5 },
+												  { 6950.0, 1.71, 0.5, 4.0 },
+												  { 7200.0, 1.69, 0.1, 5.5 } };
+
+	pairTraversal::SweepSettings settings = pairTraversal::getDefaultSweepSettings( );
+	settings.numberOfDepartureEpochs = 4;
+	settings.departureStride = 3;
+	settings.numberOfTimesOfFlight = 5;
+	settings.timeOfFlightStride = 10;
+	settings.departureObjectsPerTile = 2;
+	settings.arrivalObjectsPerTile = 3;
+	settings.epochsPerTile = 3;
+
+	pairTraversal::StateTable table = createStateTable( orbits, numberOfObjects, 60.0, pairTraversal::getNumberOfSamples( settings ) );
+	// a state where SGP4 failed, the arrival state of object 3 at departure sample 6 after 10 samples
+	table.values[ ( 3 * table.numberOfSamples + 16 ) * 6 ] = std::numeric_limits< Real >::quiet_NaN( );
+
+	settings.numberOfThreads = 1;
+	const pairTraversal::SweepResult reference = pairTraversal::sweepTransfers( table, settings, pairTraversal::objectOrder );
+	bool isPassed = true;
+	for( int k = 0; k < numberOfObjects; k++ )
+	{
+		isPassed = isPassed && reference.bestTransfers[ k ].deltaV < std::numeric_limits< Real >::infinity( );
+	}
+	std::cout << "object order, 1 thread: " << reference.numberOfTransfers << " transfers, solved = " << isPassed << std::endl;
+
+	const int threads[ 2 ] = { 1, 3 };
+	const pairTraversal::TraversalOrder orders[ 2 ] = { pairTraversal::objectOrder, pairTraversal::blockedOrder };
+	for( int t = 0; t < 2; t++ )
+	{
+		for( int o = 0; o < 2; o++ )
+		{
+			settings.numberOfThreads = threads[ t ];
+			const pairTraversal::SweepResult result = pairTraversal::sweepTransfers( table, settings, orders[ o ] );
+			const bool isSame = isSameTransfers( reference, result ) && result.numberOfTransfers == reference.numberOfTransfers;
+			std::cout << pairTraversal::getOrderName( orders[ o ] ) << " order, " << threads[ t ] << " threads: "
+					  << result.numberOfTransfers << " transfers, same best transfers = " << isSame << std::endl;
+			isPassed = isPassed && isSame;
+		}
+	}
+	return isPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2016 Abhishek Agrawal (abhishek.agrawal@protonmail.com)
+ * Distributed under the MIT License.
+ * See accompanying file LICENSE.md or copy at http://opensource.org/licenses/MIT
+ */
+
+// Check of the exact Jacobian the TLE fitter relies on: propagates sets of mean elements with
+// sgp4Kernel::Propagator in dualNumber::Dual arithmetic and compares the gradients of the state with
+// central finite differences of the plain propagator.
+//
+// Usage: test_ATOM_ADR_jacobian [relative tolerance]
+// The run fails if a partial derivative differs from its finite difference by more than the tolerance
+// times the largest partial derivative of the same state component.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+#include "CppProject/dualNumber.hpp"
+#include "CppProject/sgp4Kernel.hpp"
+
+typedef double Real;
+typedef dualNumber::Dual< 6 > Dual6;
+
+//! Mean elements i, raan, e, w, M [rad] and n [rev/day] as an array, in the order of the dual variables.
+void getElementArray( const sgp4Kernel::MeanElements< Real >& elements, Real array[ 6 ] )
+{
+	array[ 0 ] = elements.inclination;
+	array[ 1 ] = elements.rightAscendingNode;
+	array[ 2 ] = elements.eccentricity;
+	array[ 3 ] = elements.argumentPerigee;
+	array[ 4 ] = elements.meanAnomaly;
+	array[ 5 ] = elements.meanMotion;
+}
+
+//! State [km, km/s] of the plain propagator for an element array, minutes after the epoch.
+void findState( const Real array[ 6 ], const Real bStar, const Real minutesSinceEpoch, Real state[ 6 ] )
+{
+	sgp4Kernel::MeanElements< Real > elements;
+	elements.inclination = array[ 0 ];
+	elements.rightAscendingNode = array[ 1 ];
+	elements.eccentricity = array[ 2 ];
+	elements.argumentPerigee = array[ 3 ];
+	elements.meanAnomaly = array[ 4 ];
+	elements.meanMotion = array[ 5 ];
+	elements.bStar = bStar;
+	sgp4Kernel::Propagator< Real > propagator;
+	propagator.initialise( elements );
+	propagator.findState( minutesSinceEpoch, state, state + 3 );
+}
+
+//! Largest difference between the dual-number Jacobian and central differences, relative to each state component.
+Real compareJacobian( const sgp4Kernel::MeanElements< Real >& elements, const Real minutesSinceEpoch )
+{
+	Real array[ 6 ];
+	getElementArray( elements, array );
+
+	sgp4Kernel::MeanElements< Dual6 > dualElements;
+	dualElements.inclination = Dual6::variable( array[ 0 ], 0 );
+	dualElements.rightAscendingNode = Dual6::variable( array[ 1 ], 1 );
+	dualElements.eccentricity = Dual6::variable( array[ 2 ], 2 );
+	dualElements.argumentPerigee = Dual6::variable( array[ 3 ], 3 );
+	dualElements.meanAnomaly = Dual6::variable( array[ 4 ], 4 );
+	dualElements.meanMotion = Dual6::variable( array[ 5 ], 5 );
+	dualElements.bStar = elements.bStar;
+	sgp4Kernel::Propagator< Dual6 > propagator;
+	propagator.initialise( dualElements );
+	Dual6 state[ 6 ];
+	propagator.findState( Dual6( minutesSinceEpoch ), state, state + 3 );
+
+	// central differences, with steps that balance truncation and round-off in double precision
+	Real finiteDifferences[ 6 ][ 6 ];
+	for( int k = 0; k < 6; k++ )
+	{
+		const Real step = 1.0e-6 * std::max( std::fabs( array[ k ] ), k == 2 ? 1.0e-3 : 1.0 );
+		Real upper[ 6 ];
+		Real lower[ 6 ];
+		std::copy( array, array + 6, upper );
+		std::copy( array, array + 6, lower );
+		upper[ k ] += step;
+		lower[ k ] -= step;
+		Real upperState[ 6 ];
+		Real lowerState[ 6 ];
+		findState( upper, elements.bStar, minutesSinceEpoch, upperState );
+		findState( lower, elements.bStar, minutesSinceEpoch, lowerState );
+		for( int j = 0; j < 6; j++ )
+		{
+			finiteDifferences[ j ][ k ] = ( upperState[ j ] - lowerState[ j ] ) / ( 2.0 * step );
+		}
+	}
+
+	Real maximumDifference = 0.0;
+	for( int j = 0; j < 6; j++ )
+	{
+		Real scale = 0.0;
+		for( int k = 0; k < 6; k++ )
+		{
+			scale = std::max( scale, std::fabs( state[ j ].gradient[ k ] ) );
+		}
+		for( int k = 0; k < 6; k++ )
+		{
+			const Real difference = std::fabs( state[ j ].gradient[ k ] - finiteDifferences[ j ][ k ] ) / scale;
+			if( !( difference <= maximumDifference ) )
+			{
+				maximumDifference = difference;
+			}
+		}
+	}
+	return maximumDifference;
+}
+
+int main( const int numberOfInputs, const char* inputArguments[ ] )
+{
+	const Real tolerance = numberOfInputs > 1 ? std::atof( inputArguments[ 1 ] ) : 1.0e-5;
+
+	// near-circular LEO, eccentric LEO and a retrograde orbit close to the 225 minute limit
+	const int numberOfCases = 3;
+	const Real cases[ numberOfCases ][ 7 ] = { { 1.4, 0.3, 1.0e-3, 1.2, 2.5, 15.2, 1.0e-4 },
+											   { 0.9, 4.1, 0.12, 5.3, 0.4, 12.8, 3.0e-5 },
+											   { 1.9, 2.2, 0.02, 0.7, 4.6, 6.6, 0.0 } };
+	const int numberOfTimes = 3;
+	const Real minutesSinceEpoch[ numberOfTimes ] = { 0.0, 47.0, 1440.0 };
+
+	bool isPassed = true;
+	for( int n = 0; n < numberOfCases; n++ )
+	{
+		sgp4Kernel::MeanElements< Real > elements;
+		elements.inclination = cases[ n ][ 0 ];
+		elements.rightAscendingNode = cases[ n ][ 1 ];
+		elements.eccentricity = cases[ n ][ 2 ];
+		elements.argumentPerigee = cases[ n ][ 3 ];
+		elements.meanAnomaly = cases[ n ][ 4 ];
+		elements.meanMotion = cases[ n ][ 5 ];
+		elements.bStar = cases[ n ][ 6 ];
+		for( int t = 0; t < numberOfTimes; t++ )
+		{
+			Real difference = 0.0;
+			try
+			{
+				difference = compareJacobian( elements, minutesSinceEpoch[ t ] );
+			}
+			catch( const std::domain_error& error )
+			{
+				std::cerr << "case " << n << ": " << error.what( ) << std::endl;
+				return EXIT_FAILURE;
+			}
+			std::cout << "case " << n << ", " << minutesSinceEpoch[ t ] << " min: max relative difference = "
+					  << difference << std::endl;
+			isPassed = isPassed && difference <= tolerance;
+		}
+	}
+	return isPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}